@@ -43,6 +43,8 @@
 #define FIL_PAGE_END_LSN_OLD_CHKSUM 8
 #define FIL_PAGE_SPACE_OR_CHKSUM 0
 #define UNIV_PAGE_SIZE          (2 * 8192)
+#define BUF_NO_CHECKSUM_MAGIC 0xDEADBEEFUL
+#define UT_CRC32C_POLY 0x82F63B78UL
 
 /* command line argument to do page checks (that's it) */
 /* another argument to specify page ranges... seek to right spot and go from there */
@@ -130,6 +132,53 @@ buf_calc_page_old_checksum(
     return(checksum);
 }
 
+/* CRC-32C of innodb_checksum_algorithm=crc32, a byte at a time */
+static ulint crc32c_table[256];
+
+void
+crc32c_init()
+{
+    ulint i, k, crc;
+
+    for (i= 0; i < 256; i++)
+    {
+      crc= i;
+      for (k= 0; k < 8; k++)
+        crc= (crc & 1) ? (crc >> 1) ^ UT_CRC32C_POLY : crc >> 1;
+      crc32c_table[i]= crc;
+    }
+}
+
+ulint
+ut_crc32c(
+/*======*/
+               /* out: CRC-32C checksum */
+    uchar*   str,    /* in: string of bytes */
+    ulint   len)    /* in: length */
+{
+    ulint crc= 0xFFFFFFFF;
+
+    while (len--)
+      crc= crc32c_table[(crc ^ *str++) & 0xFF] ^ (crc >> 8);
+
+    return(~crc & 0xFFFFFFFF);
+}
+
+ulint
+buf_calc_page_crc32(
+/*================*/
+               /* out: checksum */
+    uchar*    page) /* in: buffer page */
+{
+    /* The same bytes as in buf_calc_page_new_checksum(); the result is
+    stored to both checksum fields */
+    return(ut_crc32c(page + FIL_PAGE_OFFSET,
+                     FIL_PAGE_FILE_FLUSH_LSN - FIL_PAGE_OFFSET)
+           ^ ut_crc32c(page + FIL_PAGE_DATA,
+                       UNIV_PAGE_SIZE - FIL_PAGE_DATA
+                       - FIL_PAGE_END_LSN_OLD_CHKSUM));
+}
+
 
 int main(int argc, char **argv)
 {
@@ -140,6 +189,7 @@ int main(int argc, char **argv)
   int now;                     /* current time */
   int lastt;                   /* last time */
   ulint oldcsum, oldcsumfield, csum, csumfield, logseq, logseqfield; /* ulints for checksum storage */
+  ulint crc32;                 /* CRC-32C of the page */
   struct stat st;              /* for stat, if you couldn't guess */
   unsigned long long int size; /* size of file (has to be 64 bits) */
   ulint pages;                 /* number of pages in file */
@@ -251,6 +301,8 @@ int main(int argc, char **argv)
     }
   }
 
+  crc32c_init();
+
   /* allocate buffer for reading (so we don't realloc every time) */
   p= (uchar *)malloc(UNIV_PAGE_SIZE);
 
@@ -278,26 +330,37 @@ int main(int argc, char **argv)
       return 1;
     }
 
-    /* check old method of checksumming */
-    oldcsum= buf_calc_page_old_checksum(p);
     oldcsumfield= mach_read_from_4(p + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM);
-    if (debug)
-      printf("page %lu: old style: calculated = %lu; recorded = %lu\n", ct, oldcsum, oldcsumfield);
-    if (oldcsumfield != mach_read_from_4(p + FIL_PAGE_LSN) && oldcsumfield != oldcsum)
-    {
-      fprintf(stderr, "page %lu invalid (fails old style checksum)\n", ct);
-      return 1;
-    }
-
-    /* now check the new method */
-    csum= buf_calc_page_new_checksum(p);
     csumfield= mach_read_from_4(p + FIL_PAGE_SPACE_OR_CHKSUM);
-    if (debug)
-      printf("page %lu: new style: calculated = %lu; recorded = %lu\n", ct, csum, csumfield);
-    if (csumfield != 0 && csum != csumfield)
+
+    /* pages written with innodb_checksum_algorithm=crc32 (or none) store
+    the same value to both checksum fields */
+    crc32= csumfield == oldcsumfield ? buf_calc_page_crc32(p) : 0;
+    if (debug && csumfield == oldcsumfield)
+      printf("page %lu: crc32: calculated = %lu; recorded = %lu\n", ct, crc32, csumfield);
+
+    if (csumfield != oldcsumfield
+        || (csumfield != crc32 && csumfield != BUF_NO_CHECKSUM_MAGIC))
     {
-      fprintf(stderr, "page %lu invalid (fails new style checksum)\n", ct);
-      return 1;
+      /* check old method of checksumming */
+      oldcsum= buf_calc_page_old_checksum(p);
+      if (debug)
+        printf("page %lu: old style: calculated = %lu; recorded = %lu\n", ct, oldcsum, oldcsumfield);
+      if (oldcsumfield != mach_read_from_4(p + FIL_PAGE_LSN) && oldcsumfield != oldcsum)
+      {
+        fprintf(stderr, "page %lu invalid (fails old style checksum)\n", ct);
+        return 1;
+      }
+
+      /* now check the new method */
+      csum= buf_calc_page_new_checksum(p);
+      if (debug)
+        printf("page %lu: new style: calculated = %lu; recorded = %lu\n", ct, csum, csumfield);
+      if (csumfield != 0 && csum != csumfield)
+      {
+        fprintf(stderr, "page %lu invalid (fails new style checksum)\n", ct);
+        return 1;
+      }
     }
 
     /* end if this was the last page we were supposed to check */
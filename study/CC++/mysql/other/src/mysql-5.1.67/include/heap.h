@@ -51,6 +51,7 @@ typedef struct st_heapinfo		/* Struct from heap_info */
   int errkey;
   ulonglong auto_increment;
   time_t create_time;
+  uchar *dupp_key_pos;			/* Position to record with dupp key */
 } HEAPINFO;
 
 
@@ -109,6 +110,12 @@ typedef struct st_heap_block
 
 struct st_heap_info;			/* For referense */
 
+typedef struct st_hp_blobdef		/* BLOB column in a record */
+{
+  uint offset;				/* Offset of the column in record */
+  uint packlength;			/* Bytes used for the blob length */
+} HP_BLOBDEF;
+
 typedef struct st_hp_keydef		/* Key definition with open */
 {
   uint flag;				/* HA_NOSAME | HA_NULL_PART_KEY */
@@ -123,6 +130,7 @@ typedef struct st_hp_keydef		/* Key definition with open */
   */
   ha_rows hash_buckets; 
   TREE rb_tree;
+  uint recno_length;			/* Slot number stored in BTREE keys */
   int (*write_key)(struct st_heap_info *info, struct st_hp_keydef *keyinfo,
 		   const uchar *record, uchar *recpos);
   int (*delete_key)(struct st_heap_info *info, struct st_hp_keydef *keyinfo,
@@ -157,6 +165,8 @@ typedef struct st_heap_share
   uint auto_key;
   uint auto_key_type;			/* real type of the auto key segment */
   ulonglong auto_increment;
+  HP_BLOBDEF *blobdef;
+  uint blobs;				/* Number of BLOB columns */
 } HP_SHARE;
 
 struct st_hp_hash_info;
@@ -172,6 +182,7 @@ typedef struct st_heap_info
   uint opt_flag,update;
   uchar *lastkey;			/* Last used key with rkey */
   uchar *recbuf;                         /* Record buffer for rb-tree keys */
+  uchar *dupp_key_pos;			/* Record with duplicate key */
   enum ha_rkey_function last_find_flag;
   TREE_ELEMENT *parents[MAX_TREE_HEIGHT+1];
   TREE_ELEMENT **last_pos;
@@ -192,6 +203,8 @@ typedef struct st_heap_create_info
   ulonglong auto_increment;
   my_bool with_auto_increment;
   my_bool internal_table;
+  HP_BLOBDEF *blobdef;			/* Only for internal tables */
+  uint blobs;
 } HP_CREATE_INFO;
 
 	/* Prototypes for heap-functions */
@@ -235,6 +248,8 @@ int heap_rkey(HP_INFO *info, uchar *record, int inx, const uchar *key,
 extern uchar * heap_find(HP_INFO *info,int inx,const uchar *key);
 extern int heap_check_heap(HP_INFO *info, my_bool print_status);
 extern uchar *heap_position(HP_INFO *info);
+extern ulong heap_record_number(HP_INFO *info, const uchar *pos);
+extern int heap_rrnd_number(HP_INFO *info, uchar *buf, ulong number);
 
 /* The following is for programs that uses the old HEAP interface where
    pointer to rows where a long instead of a (uchar*).
@@ -2165,6 +2165,18 @@ sub environment_setup {
 		   "$basedir/extra/my_print_defaults");
   $ENV{'MYSQL_MY_PRINT_DEFAULTS'}= native_path($exe_my_print_defaults);
 
+  # ----------------------------------------------------
+  # innochecksum
+  # ----------------------------------------------------
+  my $exe_innochecksum=
+    mtr_exe_maybe_exists(vs_config_dirs('extra', 'innochecksum'),
+			 "$path_client_bindir/innochecksum",
+			 "$basedir/extra/innochecksum");
+  if ($exe_innochecksum)
+  {
+    $ENV{'INNOCHECKSUM'}= native_path($exe_innochecksum);
+  }
+
   # ----------------------------------------------------
   # Setup env so childs can execute myisampack and myisamchk
   # ----------------------------------------------------
@@ -0,0 +1,194 @@
+#!/usr/bin/perl
+# Copyright (c) 2001, 2003, 2006 MySQL AB, 2009 Sun Microsystems, Inc.
+# Use is subject to license terms.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Library General Public
+# License as published by the Free Software Foundation; version 2
+# of the License.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public
+# License along with this library; if not, write to the Free
+# Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+# MA 02110-1301, USA
+#
+# Test of table scans where most of the time goes to comparing columns
+# with constants in the WHERE clause.  The conditions are disjunctions,
+# so that every comparison is evaluated for every row.  Run it against
+# two servers and use compare-results to see the difference.
+#
+##################### Standard benchmark inits ##############################
+
+use Cwd;
+use DBI;
+use Getopt::Long;
+use Benchmark;
+
+$opt_loop_count=100000;
+$opt_medium_loop_count=100;
+
+$pwd = cwd(); $pwd = "." if ($pwd eq '');
+require "$pwd/bench-init.pl" || die "Can't read Configuration file: $!\n";
+
+if ($opt_small_test)
+{
+  $opt_loop_count/=10;
+  $opt_medium_loop_count/=10;
+}
+
+print "Testing the speed of table scans with comparisons in WHERE\n";
+print "The test-table has $opt_loop_count rows\n\n";
+
+####
+####  Connect and start timeing
+####
+
+$dbh = $server->connect();
+$start_time=new Benchmark;
+
+####
+#### Create needed tables
+####
+
+goto select_test if ($opt_skip_create);
+
+print "Creating table\n";
+$dbh->do("drop table bench1" . $server->{'drop_attr'});
+
+do_many($dbh,$server->create("bench1",
+			     ["id integer NOT NULL",
+			      "small smallint",
+			      "big bigint",
+			      "created datetime",
+			      "code char(8)",
+			      "name varchar(20)"],
+			     []));
+if ($opt_lock_tables)
+{
+  do_query($dbh,"LOCK TABLES bench1 WRITE");
+}
+
+####
+#### Insert $opt_loop_count records with
+#### id:	0 -> count
+#### small:	id % 1000
+#### big:	id * 1000003
+#### created:	one second apart
+#### code:	distributed values "C0" -> "C99"
+#### name:	distributed values "name0" -> "name9999"
+####
+
+print "Inserting $opt_loop_count rows\n";
+
+$loop_time=new Benchmark;
+$query="insert into bench1 values ";
+$values="";
+for ($id=0 ; $id < $opt_loop_count ; $id++)
+{
+  $created=sprintf("2001-%02d-%02d %02d:%02d:%02d",
+		   1 + $id / 2678400 % 12, 1 + $id / 86400 % 28,
+		   $id / 3600 % 24, $id / 60 % 60, $id % 60);
+  $row="($id," . ($id % 1000) . "," . ($id * 1000003) .
+    ",'$created','C" . ($id % 100) . "','name" . ($id % 10000) . "')";
+  if (!$limits->{'insert_multi_value'})
+  {
+    do_query($dbh,"$query$row");
+    next;
+  }
+  $values.= ($values ? "," : "") . $row;
+  if (length($values) > 10000 || $id == $opt_loop_count-1)
+  {
+    do_query($dbh,"$query$values");
+    $values="";
+  }
+}
+
+$end_time=new Benchmark;
+print "Time to insert ($opt_loop_count): " .
+    timestr(timediff($end_time, $loop_time),"all") . "\n\n";
+
+if ($opt_lock_tables)
+{
+  do_query($dbh,"UNLOCK TABLES");
+}
+
+if ($opt_fast && defined($server->{vacuum}))
+{
+  $server->vacuum(0,\$dbh,"bench1");
+}
+
+if ($opt_lock_tables)
+{
+  do_query($dbh,"LOCK TABLES bench1 READ");
+}
+
+####
+#### Scan the table with different conditions
+####
+
+select_test:
+
+time_scans("where_int",
+	   "select count(*) from bench1 where small < 10 or small > 990 or small = 500 or id < 0");
+time_scans("where_bigint",
+	   "select count(*) from bench1 where big < 1000 or big > 99000000000 or big = 5000015");
+time_scans("where_datetime",
+	   "select count(*) from bench1 where created < '2001-01-01 00:10:00' or created >= '2001-12-01 00:00:00'");
+time_scans("where_char",
+	   "select count(*) from bench1 where code = 'C1' or code = 'C2' or code > 'C98'");
+time_scans("where_varchar",
+	   "select count(*) from bench1 where name = 'name1' or name < 'name1000' or name >= 'name9999'");
+time_scans("where_mixed",
+	   "select count(*) from bench1 where (small > 500 and code <> 'C50') or created = '2001-01-01 01:00:00' or name = 'name42'");
+
+####
+#### End of benchmark
+####
+
+if ($opt_lock_tables)
+{
+  do_query($dbh,"UNLOCK TABLES");
+}
+if (!$opt_skip_delete)
+{
+  do_query($dbh,"drop table bench1" . $server->{'drop_attr'});
+}
+
+if ($opt_fast && defined($server->{vacuum}))
+{
+  $server->vacuum(0,\$dbh);
+}
+
+$dbh->disconnect;				# close connection
+
+end_benchmark($start_time);
+
+
+#
+# Run a query $opt_medium_loop_count times and print the time it took
+#
+
+sub time_scans
+{
+  my ($name,$query)= @_;
+  my ($i,$count,$rows,$estimated);
+
+  $loop_time=new Benchmark;
+  $rows=$estimated=$count=0;
+  for ($i=0 ; $i < $opt_medium_loop_count ; $i++)
+  {
+    $count++;
+    $rows+=fetch_all_rows($dbh,$query);
+    $end_time=new Benchmark;
+    last if ($estimated=predict_query_time($loop_time,$end_time,\$count,$i+1,
+					   $opt_medium_loop_count));
+  }
+  print_time($estimated);
+  print " for $name ($count:$rows): " .
+    timestr(timediff($end_time, $loop_time),"all") . "\n";
+}
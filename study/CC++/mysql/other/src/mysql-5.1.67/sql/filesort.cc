@@ -63,9 +63,67 @@ static uint suffix_length(ulong string_length);
 static uint sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
 		       bool *multi_byte_charset);
 static SORT_ADDON_FIELD *get_addon_fields(THD *thd, Field **ptabfield,
-                                          uint sortlength, uint *plength);
+                                          uint sortlength, uint *plength,
+                                          bool *ppacked);
 static void unpack_addon_fields(struct st_sort_addon_field *addon_field,
                                 uchar *buff);
+static void unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                                       uchar *buff);
+static uint read_packed_to_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                  BUFFPEK *buffpek);
+
+/**
+  Length of a sort record (sort key plus appended data).
+
+  With packed addon fields the records have variable length, which is
+  stored right after the sort key.
+*/
+
+static inline uint sort_rec_length(SORTPARAM *param, uchar *rec)
+{
+  return (param->using_packed_addons ?
+          param->sort_length + uint4korr(rec + param->sort_length) :
+          param->rec_length);
+}
+
+
+/** Read the next portion of a sorted sequence into its merge buffer. */
+
+static inline uint read_next_to_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                       BUFFPEK *buffpek)
+{
+  return (param->using_packed_addons ?
+          read_packed_to_buffer(param, fromfile, buffpek) :
+          read_to_buffer(fromfile, buffpek, param->rec_length));
+}
+
+
+/**
+  End of the array of record pointers in a sort buffer with packed records.
+
+  Packed records are stored from the start of the buffer upwards, while the
+  pointers to them are stored from the end of the buffer downwards.
+*/
+
+static inline uchar **packed_keys_end(SORTPARAM *param, uchar **sort_keys)
+{
+  return sort_keys + param->sort_buffer_size / sizeof(uchar*);
+}
+
+
+/**
+  Get the array of pointers to 'count' packed records, in the order the
+  records were added (the same order as with fixed size records).
+*/
+
+static uchar **packed_keys(SORTPARAM *param, uchar **sort_keys, uint count)
+{
+  uchar **keys= packed_keys_end(param, sort_keys) - count;
+  for (uchar **low= keys, **high= keys + count - 1; low < high; low++, high--)
+    swap_variables(uchar*, *low, *high);
+  return keys;
+}
+
 /**
   Sort a table.
   Creates a set of pointers that can be used to read the rows
@@ -157,13 +215,16 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
     */
     param.addon_field= get_addon_fields(thd, table->field, 
                                         param.sort_length,
-                                        &param.addon_length);
+                                        &param.addon_length,
+                                        &param.using_packed_addons);
   }
 
   table_sort.addon_buf= 0;
   table_sort.addon_length= param.addon_length;
   table_sort.addon_field= param.addon_field;
-  table_sort.unpack= unpack_addon_fields;
+  table_sort.using_packed_addons= param.using_packed_addons;
+  table_sort.unpack= (param.using_packed_addons ?
+                      unpack_packed_addon_fields : unpack_addon_fields);
   if (param.addon_field)
   {
     param.res_length= param.addon_length;
@@ -253,6 +314,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
     goto err;
 
   param.keys--;  			/* TODO: check why we do this */
+  param.sort_buffer_size= table_sort.sort_keys_size;
   param.sort_form= table;
   param.end=(param.local_sortorder=sortorder)+s_length;
   if ((records=find_all_keys(&param,select,sort_keys, &buffpek_pointers,
@@ -263,7 +325,10 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
 
   if (maxbuffer == 0)			// The whole set is in memory
   {
-    if (save_index(&param,sort_keys,(uint) records, &table_sort))
+    uchar **keys= (param.using_packed_addons ?
+                   packed_keys(&param, sort_keys, (uint) records) :
+                   sort_keys);
+    if (save_index(&param, keys, (uint) records, &table_sort))
       goto err;
   }
   else
@@ -534,6 +599,8 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
   int error,flag,quick_select;
   uint idx,indexpos,ref_length;
   uchar *ref_pos,*next_pos,ref_buff[MAX_REFLENGTH];
+  uchar *next_rec, **keys_end;
+  ha_rows written_rows;
   my_off_t record;
   TABLE *sort_form;
   THD *thd= current_thd;
@@ -548,6 +615,9 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
 
   idx=indexpos=0;
   error=quick_select=0;
+  written_rows= 0;
+  next_rec= (uchar*) sort_keys;
+  keys_end= packed_keys_end(param, sort_keys);
   sort_form=param->sort_form;
   file=sort_form->file;
   ref_length=param->ref_length;
@@ -636,14 +706,38 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
     if (!error && (!select ||
                    (!select->skip_record(thd, &skip_record) && !skip_record)))
     {
-      if (idx == param->keys)
+      if (param->using_packed_addons)
       {
-	if (write_keys(param,sort_keys,idx,buffpek_pointers,tempfile))
-	  DBUG_RETURN(HA_POS_ERROR);
-	idx=0;
-	indexpos++;
+        /*
+          Records are appended at next_rec, their pointers are stored
+          below keys_end. Flush when a record of maximal length might
+          not fit between the two.
+        */
+        if (next_rec + param->rec_length > (uchar*) (keys_end - idx - 1))
+        {
+          if (write_keys(param, packed_keys(param, sort_keys, idx), idx,
+                         buffpek_pointers, tempfile))
+            DBUG_RETURN(HA_POS_ERROR);
+          written_rows+= min(idx, param->max_rows);
+          next_rec= (uchar*) sort_keys;
+          idx= 0;
+          indexpos++;
+        }
+        make_sortkey(param, next_rec, ref_pos);
+        *(keys_end - ++idx)= next_rec;
+        next_rec+= sort_rec_length(param, next_rec);
+      }
+      else
+      {
+        if (idx == param->keys)
+        {
+          if (write_keys(param,sort_keys,idx,buffpek_pointers,tempfile))
+            DBUG_RETURN(HA_POS_ERROR);
+          idx=0;
+          indexpos++;
+        }
+        make_sortkey(param,sort_keys[idx++],ref_pos);
       }
-      make_sortkey(param,sort_keys[idx++],ref_pos);
     }
     else
       file->unlock_row();
@@ -670,6 +764,16 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
     file->print_error(error,MYF(ME_ERROR | ME_WAITTANG)); /* purecov: inspected */
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
   }
+  if (param->using_packed_addons)
+  {
+    if (indexpos && idx &&
+        write_keys(param, packed_keys(param, sort_keys, idx), idx,
+                   buffpek_pointers, tempfile))
+      DBUG_RETURN(HA_POS_ERROR);
+    DBUG_RETURN(my_b_inited(tempfile) ?
+                written_rows + min(idx, param->max_rows) :
+                idx);
+  }
   if (indexpos && idx &&
       write_keys(param,sort_keys,idx,buffpek_pointers,tempfile))
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
@@ -729,8 +833,12 @@ write_keys(SORTPARAM *param, register uchar **sort_keys, uint count,
     count=(uint) param->max_rows;               /* purecov: inspected */
   buffpek.count=(ha_rows) count;
   for (end=sort_keys+count ; sort_keys != end ; sort_keys++)
+  {
+    if (param->using_packed_addons)
+      rec_length= sort_rec_length(param, *sort_keys);
     if (my_b_write(tempfile, (uchar*) *sort_keys, (uint) rec_length))
       goto err;
+  }
   if (my_b_write(buffpek_pointers, (uchar*) &buffpek, sizeof(buffpek)))
     goto err;
   DBUG_RETURN(0);
@@ -970,8 +1078,9 @@ static void make_sortkey(register SORTPARAM *param,
     /* 
       Save field values appended to sorted fields.
       First null bit indicators are appended then field values follow.
-      In this implementation we use fixed layout for field values -
-      the same for all records.
+      In the fixed layout every field value occupies its maximal length.
+      In the packed layout the values follow each other and the total
+      length of the appended data is stored in front of the null bits.
     */
     SORT_ADDON_FIELD *addonf= param->addon_field;
     uchar *nulls= to;
@@ -983,13 +1092,19 @@ static void make_sortkey(register SORTPARAM *param,
       if (addonf->null_bit && field->is_null())
       {
         nulls[addonf->null_offset]|= addonf->null_bit;
+        if (!param->using_packed_addons)
+          to+= addonf->length;
       }
+      else if (param->using_packed_addons)
+        to= field->pack(to, field->ptr);
       else
       {
         (void) field->pack(to, field->ptr);
+        to+= addonf->length;
       }
-      to+= addonf->length;
     }
+    if (param->using_packed_addons)
+      int4store(nulls, (uint32) (to - nulls));
   }
   else
   {
@@ -1054,6 +1169,25 @@ static bool save_index(SORTPARAM *param, uchar **sort_keys, uint count,
   offset= param->rec_length-res_length;
   if ((ha_rows) count > param->max_rows)
     count=(uint) param->max_rows;
+  if (param->using_packed_addons)
+  {
+    size_t length= 0;
+    uchar **end= sort_keys+count;
+    offset= param->sort_length;
+    for (uchar **key= sort_keys ; key != end ; key++)
+      length+= uint4korr(*key + offset);
+    if (!(to= table_sort->record_pointers=
+          (uchar*) my_malloc(length, MYF(MY_WME))))
+      DBUG_RETURN(1);
+    table_sort->record_pointers_length= length;
+    for ( ; sort_keys != end ; sort_keys++)
+    {
+      res_length= uint4korr(*sort_keys + offset);
+      memcpy(to, *sort_keys+offset, res_length);
+      to+= res_length;
+    }
+    DBUG_RETURN(0);
+  }
   if (!(to= table_sort->record_pointers= 
         (uchar*) my_malloc(res_length*count, MYF(MY_WME))))
     DBUG_RETURN(1);                 /* purecov: inspected */
@@ -1146,6 +1280,52 @@ uint read_to_buffer(IO_CACHE *fromfile, BUFFPEK *buffpek,
 } /* read_to_buffer */
 
 
+/**
+  Read data with packed addon fields to buffer.
+
+  The buffer of a BUFFPEK has room for max_keys records of maximal length.
+  It is filled with as many complete records as fit into it; the rest of
+  the sequence is read by following calls.
+
+  @retval
+    Number of bytes taken by the records read
+  @retval
+    (uint)-1 if something goes wrong
+*/
+
+static uint read_packed_to_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                  BUFFPEK *buffpek)
+{
+  uint count;
+  size_t length;
+  uchar *pos, *end;
+
+  if (!buffpek->count)
+    return 0;
+  length= (size_t) buffpek->max_keys * param->rec_length;
+  /* The last sequence in the file may be shorter than the buffer */
+  if ((length= my_pread(fromfile->file, buffpek->base, length,
+                        buffpek->file_pos, MYF(0))) == MY_FILE_ERROR)
+    return((uint) -1);                          /* purecov: inspected */
+  pos= buffpek->base;
+  end= pos + length;
+  for (count= 0; count < buffpek->count; count++)
+  {
+    if (pos + param->sort_length + SORT_ADDON_LENGTH_BYTES > end ||
+        pos + sort_rec_length(param, pos) > end)
+      break;
+    pos+= sort_rec_length(param, pos);
+  }
+  if (!count)
+    return((uint) -1);                          /* purecov: inspected */
+  buffpek->key= buffpek->base;
+  buffpek->file_pos+= (uint) (pos - buffpek->base);
+  buffpek->count-= count;
+  buffpek->mem_count= count;
+  return (uint) (pos - buffpek->base);
+} /* read_packed_to_buffer */
+
+
 /**
   Put all room used by freed buffer to use in adjacent buffer.
 
@@ -1254,11 +1434,19 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
   {
     buffpek->base= strpos;
     buffpek->max_keys= maxcount;
-    strpos+= (uint) (error= (int) read_to_buffer(from_file, buffpek,
-                                                                         rec_length));
+    error= (int) read_next_to_buffer(param, from_file, buffpek);
     if (error == -1)
       goto err;					/* purecov: inspected */
-    buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+    if (param->using_packed_addons)
+    {
+      /* Later reads may need the whole area for records of maximal length */
+      strpos+= maxcount * rec_length;
+    }
+    else
+    {
+      strpos+= (uint) error;
+      buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+    }
     queue_insert(&queue, (uchar*) buffpek);
   }
 
@@ -1306,6 +1494,11 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
               goto skip_duplicate;
             memcpy(param->unique_buff, (uchar*) buffpek->key, rec_length);
       }
+      if (param->using_packed_addons)
+      {
+        rec_length= sort_rec_length(param, buffpek->key);
+        res_length= rec_length - offset;
+      }
       if (flag == 0)
       {
         if (my_b_write(to_file,(uchar*) buffpek->key, rec_length))
@@ -1327,14 +1520,13 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       }
 
     skip_duplicate:
-      buffpek->key+= rec_length;
+      buffpek->key+= sort_rec_length(param, buffpek->key);
       if (! --buffpek->mem_count)
       {
-        if (!(error= (int) read_to_buffer(from_file,buffpek,
-                                          rec_length)))
+        if (!(error= (int) read_next_to_buffer(param, from_file, buffpek)))
         {
           VOID(queue_remove(&queue,0));
-          reuse_freed_buff(&queue, buffpek, rec_length);
+          reuse_freed_buff(&queue, buffpek, param->rec_length);
           break;                        /* One buffer have been removed */
         }
         else if (error == -1)
@@ -1368,7 +1560,22 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       buffpek->count= 0;                        /* Don't read more */
     }
     max_rows-= buffpek->mem_count;
-    if (flag == 0)
+    if (param->using_packed_addons)
+    {
+      strpos= buffpek->key;
+      for (ulong count= buffpek->mem_count; count; count--)
+      {
+        rec_length= sort_rec_length(param, strpos);
+        if (flag == 0 ?
+            my_b_write(to_file, strpos, rec_length) :
+            my_b_write(to_file, strpos + offset, rec_length - offset))
+        {
+          error= 1; goto err;                      /* purecov: inspected */
+        }
+        strpos+= rec_length;
+      }
+    }
+    else if (flag == 0)
     {
       if (my_b_write(to_file,(uchar*) buffpek->key,
                      (rec_length*buffpek->mem_count)))
@@ -1391,7 +1598,7 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       }
     }
   }
-  while ((error=(int) read_to_buffer(from_file,buffpek, rec_length))
+  while ((error=(int) read_next_to_buffer(param, from_file, buffpek))
          != -1 && error != 0);
 
 end:
@@ -1543,10 +1750,16 @@ sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
   layouts for the values of the non-sorted fields in the buffer and
   fills them.
 
+  If some of the fields are CHAR/VARCHAR the packed layout is used: the
+  values are stored with their actual lengths, and max_length_for_sort_data
+  is compared with the expected packed length of the fields. The expected
+  length of a string value is bounded by the mean row length of the table.
+
   @param thd                 Current thread
   @param ptabfield           Array of references to the table fields
   @param sortlength          Total length of sorted fields
-  @param[out] plength        Total length of appended fields
+  @param[out] plength        Total (maximal) length of appended fields
+  @param[out] ppacked        Set to 1 if the packed layout is used
 
   @note
     The null bits for the appended values are supposed to be put together
@@ -1559,15 +1772,20 @@ sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
 */
 
 static SORT_ADDON_FIELD *
-get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
+get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength,
+                 bool *ppacked)
 {
   Field **pfield;
   Field *field;
   SORT_ADDON_FIELD *addonf;
   uint length= 0;
+  uint packed_length= 0;
   uint fields= 0;
   uint null_fields= 0;
-  MY_BITMAP *read_set= (*ptabfield)->table->read_set;
+  uint packable_fields= 0;
+  TABLE *table= (*ptabfield)->table;
+  MY_BITMAP *read_set= table->read_set;
+  ulong mean_rec_length= table->file->stats.mean_rec_length;
 
   /*
     If there is a reference to a field in the query add it
@@ -1579,14 +1797,26 @@ get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
     the values directly from sorted fields.
   */
   *plength= 0;
+  *ppacked= 0;
 
   for (pfield= ptabfield; (field= *pfield) ; pfield++)
   {
+    uint field_length;
     if (!bitmap_is_set(read_set, field->field_index))
       continue;
     if (field->flags & BLOB_FLAG)
       return 0;
-    length+= field->max_packed_col_length(field->pack_length());
+    field_length= field->max_packed_col_length(field->pack_length());
+    length+= field_length;
+    if (field->real_type() == MYSQL_TYPE_VARCHAR ||
+        field->real_type() == MYSQL_TYPE_STRING ||
+        field->real_type() == MYSQL_TYPE_VAR_STRING)
+    {
+      packable_fields++;
+      if (mean_rec_length)
+        set_if_smaller(field_length, mean_rec_length + 2);
+    }
+    packed_length+= field_length;
     if (field->maybe_null())
       null_fields++;
     fields++;
@@ -1594,14 +1824,32 @@ get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
   if (!fields)
     return 0;
   length+= (null_fields+7)/8;
+  packed_length+= (null_fields+7)/8;
 
-  if (length+sortlength > thd->variables.max_length_for_sort_data ||
+  if (packable_fields)
+  {
+    /*
+      A record of maximal length must still fit into the merge buffers,
+      so limit the maximal length by the sort buffer.
+    */
+    length+= SORT_ADDON_LENGTH_BYTES;
+    packed_length+= SORT_ADDON_LENGTH_BYTES;
+    if ((length+sortlength)*MERGEBUFF2 > thd->variables.sortbuff_size)
+      packed_length= length;
+  }
+  else
+    packed_length= length;
+
+  if (packed_length+sortlength > thd->variables.max_length_for_sort_data ||
       !(addonf= (SORT_ADDON_FIELD *) my_malloc(sizeof(SORT_ADDON_FIELD)*
                                                (fields+1), MYF(MY_WME))))
     return 0;
 
   *plength= length;
+  *ppacked= packable_fields != 0;
   length= (null_fields+7)/8;
+  if (*ppacked)
+    length+= SORT_ADDON_LENGTH_BYTES;
   null_fields= 0;
   for (pfield= ptabfield; (field= *pfield) ; pfield++)
   {
@@ -1612,6 +1860,8 @@ get_addon_fields(THD *thd, Field **ptabfield, uint sortlength, uint *plength)
     if (field->maybe_null())
     {
       addonf->null_offset= null_fields/8;
+      if (*ppacked)
+        addonf->null_offset+= SORT_ADDON_LENGTH_BYTES;
       addonf->null_bit= 1<<(null_fields & 7);
       null_fields++;
     }
@@ -1664,6 +1914,34 @@ unpack_addon_fields(struct st_sort_addon_field *addon_field, uchar *buff)
   }
 }
 
+
+/**
+  Copy (unpack) values appended to sorted fields in the packed layout.
+
+  Same as unpack_addon_fields(), but the values are stored one after
+  another, so the position of each value follows from the previous one.
+*/
+
+static void
+unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                           uchar *buff)
+{
+  Field *field;
+  SORT_ADDON_FIELD *addonf= addon_field;
+  const uchar *pos= buff + addonf->offset;
+
+  for ( ; (field= addonf->field) ; addonf++)
+  {
+    if (addonf->null_bit && (addonf->null_bit & buff[addonf->null_offset]))
+    {
+      field->set_null();
+      continue;
+    }
+    field->set_notnull();
+    pos= field->unpack(field->ptr, pos);
+  }
+}
+
 /*
 ** functions to change a double or float to a sortable string
 ** The following should work for IEEE
@@ -59,6 +59,7 @@
 #include "ha_partition.h"
 
 #include <mysql/plugin.h>
+#include <myisampack.h>
 
 #include "debug_sync.h"
 
@@ -264,10 +265,15 @@ void ha_partition::init_handler_variables()
   m_extra_cache_size= 0;
   m_extra_prepare_for_update= FALSE;
   m_extra_cache_part_id= NO_CURRENT_PART_ID;
+  m_parallel_scan= NULL;
   m_handler_status= handler_not_initialized;
   m_low_byte_first= 1;
   m_part_field_array= NULL;
   m_ordered_rec_buffer= NULL;
+  m_merge_inputs= NULL;
+  m_merge_tree= NULL;
+  m_merge_no_inputs= 0;
+  m_merge_read_ahead= FALSE;
   m_top_entry= NO_CURRENT_PART_ID;
   m_rec_length= 0;
   m_last_part= 0;
@@ -2616,12 +2622,29 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
   if (bitmap_init(&m_bulk_insert_started, NULL, m_tot_parts + 1, FALSE))
     DBUG_RETURN(error);
   bitmap_clear_all(&m_bulk_insert_started);
+  /* Initialize the bitmaps of partitions locked and to lock on first use */
+  if (bitmap_init(&m_locked_partitions, NULL, m_tot_parts, FALSE))
+  {
+    bitmap_free(&m_bulk_insert_started);
+    DBUG_RETURN(error);
+  }
+  if (bitmap_init(&m_pending_partitions, NULL, m_tot_parts, FALSE))
+  {
+    bitmap_free(&m_locked_partitions);
+    bitmap_free(&m_bulk_insert_started);
+    DBUG_RETURN(error);
+  }
+  bitmap_clear_all(&m_locked_partitions);
+  bitmap_clear_all(&m_pending_partitions);
+  m_pending_start_stmt= FALSE;
   /* Initialize the bitmap we use to determine what partitions are used */
   if (!m_is_clone_of)
   {
     DBUG_ASSERT(!m_clone_mem_root);
     if (bitmap_init(&(m_part_info->used_partitions), NULL, m_tot_parts, TRUE))
     {
+      bitmap_free(&m_pending_partitions);
+      bitmap_free(&m_locked_partitions);
       bitmap_free(&m_bulk_insert_started);
       DBUG_RETURN(error);
     }
@@ -2753,6 +2776,8 @@ err_handler:
   while (file-- != m_file)
     (*file)->close();
 err_alloc:
+  bitmap_free(&m_pending_partitions);
+  bitmap_free(&m_locked_partitions);
   bitmap_free(&m_bulk_insert_started);
   if (!m_is_clone_of)
     bitmap_free(&(m_part_info->used_partitions));
@@ -2828,7 +2853,11 @@ int ha_partition::close(void)
   DBUG_ENTER("ha_partition::close");
 
   DBUG_ASSERT(table->s == table_share);
+  if (m_parallel_scan)
+    end_parallel_scan();
   destroy_record_priority_queue();
+  bitmap_free(&m_pending_partitions);
+  bitmap_free(&m_locked_partitions);
   bitmap_free(&m_bulk_insert_started);
   if (!m_is_clone_of)
     bitmap_free(&(m_part_info->used_partitions));
@@ -2899,12 +2928,27 @@ int ha_partition::external_lock(THD *thd, int lock_type)
   DBUG_ENTER("ha_partition::external_lock");
 
   DBUG_ASSERT(!auto_increment_lock && !auto_increment_safe_stmt_log_lock);
+  /* The workers of a parallel scan must not read unlocked partitions */
+  if (lock_type == F_UNLCK && m_parallel_scan)
+    end_parallel_scan();
   file= m_file;
   m_lock_type= lock_type;
+  m_pending_start_stmt= FALSE;
+  bitmap_clear_all(&m_pending_partitions);
+  if (lock_type != F_UNLCK && lazy_external_lock(thd))
+  {
+    /* Each partition is locked on its first use, see lock_partition() */
+    bitmap_set_all(&m_pending_partitions);
+    DBUG_RETURN(0);
+  }
 
 repeat:
   do
   {
+    /* Partitions not used by the statement were never locked */
+    if (lock_type == F_UNLCK && first &&
+        !bitmap_is_set(&m_locked_partitions, (uint) (file - m_file)))
+      continue;
     DBUG_PRINT("info", ("external_lock(thd, %d) iteration %d",
                         lock_type, (int) (file - m_file)));
     if ((error= (*file)->ha_external_lock(thd, lock_type)))
@@ -2921,6 +2965,14 @@ repeat:
     first= FALSE;
     goto repeat;
   }
+  if (lock_type == F_UNLCK)
+  {
+    bitmap_clear_all(&m_locked_partitions);
+  }
+  else
+  {
+    bitmap_set_all(&m_locked_partitions);
+  }
   DBUG_RETURN(0);
 
 err_handler:
@@ -2928,10 +2980,126 @@ err_handler:
   {
     (*file)->ha_external_lock(thd, F_UNLCK);
   }
+  bitmap_clear_all(&m_locked_partitions);
   DBUG_RETURN(error);
 }
 
 
+/*
+  Check if the partitions can be locked on their first use
+
+  SYNOPSIS
+    lazy_external_lock()
+    thd                  Thread object
+
+  RETURN VALUE
+    TRUE                 Defer external_lock() and start_stmt()
+    FALSE                Lock all partitions now
+
+  DESCRIPTION
+    Statements that read and write rows only use the partitions left by
+    partition pruning, or the partitions rows are inserted into. When the
+    engine allows it, these partitions are locked when the statement first
+    uses them, so that the cost of a statement does not grow with the
+    number of partitions defined. Other statements, like ALTER TABLE,
+    LOCK TABLES and the admin commands, may use any partition and lock
+    all of them.
+*/
+
+bool ha_partition::lazy_external_lock(THD *thd)
+{
+  DBUG_ENTER("ha_partition::lazy_external_lock");
+
+  if (!(m_file[0]->ht->flags & HTON_LAZY_EXTERNAL_LOCK) ||
+      (m_added_file && m_added_file[0]))
+    DBUG_RETURN(FALSE);
+  switch (thd->lex->sql_command) {
+  case SQLCOM_SELECT:
+  case SQLCOM_INSERT:
+  case SQLCOM_INSERT_SELECT:
+  case SQLCOM_REPLACE:
+  case SQLCOM_REPLACE_SELECT:
+  case SQLCOM_UPDATE:
+  case SQLCOM_UPDATE_MULTI:
+  case SQLCOM_DELETE:
+  case SQLCOM_DELETE_MULTI:
+    DBUG_RETURN(TRUE);
+  default:
+    DBUG_RETURN(FALSE);
+  }
+}
+
+
+/*
+  Lock a partition on its first use in the statement
+
+  SYNOPSIS
+    lock_partition()
+    part_id              Partition to lock
+
+  RETURN VALUE
+    >0                   Error code
+    0                    Success
+
+  DESCRIPTION
+    Calls the external_lock() deferred by external_lock(), or the
+    start_stmt() deferred by start_stmt() if the partition is already
+    locked.
+*/
+
+int ha_partition::lock_partition(uint part_id)
+{
+  handler *file= m_file[part_id];
+  int error;
+  DBUG_ENTER("ha_partition::lock_partition");
+  DBUG_PRINT("info", ("partition %u", part_id));
+
+  if (!bitmap_is_set(&m_locked_partitions, part_id))
+  {
+    DBUG_ASSERT(m_lock_type != F_UNLCK);
+    if ((error= file->ha_external_lock(ha_thd(), m_lock_type)))
+      DBUG_RETURN(error);
+    bitmap_set_bit(&m_locked_partitions, part_id);
+  }
+  else if (m_pending_start_stmt &&
+           (error= file->start_stmt(ha_thd(), m_stmt_lock_type)))
+    DBUG_RETURN(error);
+  bitmap_clear_bit(&m_pending_partitions, part_id);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Lock the partitions not yet locked in the statement
+
+  SYNOPSIS
+    lock_pending_partitions()
+    used_only            Only lock the partitions in used_partitions
+
+  RETURN VALUE
+    >0                   Error code
+    0                    Success
+*/
+
+int ha_partition::lock_pending_partitions(bool used_only)
+{
+  uint i;
+  int error;
+  DBUG_ENTER("ha_partition::lock_pending_partitions");
+
+  if (bitmap_is_clear_all(&m_pending_partitions))
+    DBUG_RETURN(0);
+  for (i= 0; i < m_tot_parts; i++)
+  {
+    if (bitmap_is_set(&m_pending_partitions, i) &&
+        (!used_only || bitmap_is_set(&m_part_info->used_partitions, i)) &&
+        (error= lock_partition(i)))
+      DBUG_RETURN(error);
+  }
+  DBUG_RETURN(0);
+}
+
+
 /*
   Get the lock(s) for the table and perform conversion of locks if needed
 
@@ -3007,7 +3175,8 @@ THR_LOCK_DATA **ha_partition::store_lock(THD *thd,
 
   DESCRIPTION
     This method is called instead of external lock when the table is locked
-    before the statement is executed.
+    before the statement is executed. As external_lock(), it is deferred to
+    the first use of each partition when lazy_external_lock() allows it.
 */
 
 int ha_partition::start_stmt(THD *thd, thr_lock_type lock_type)
@@ -3016,6 +3185,13 @@ int ha_partition::start_stmt(THD *thd, thr_lock_type lock_type)
   handler **file;
   DBUG_ENTER("ha_partition::start_stmt");
 
+  if (lazy_external_lock(thd))
+  {
+    m_stmt_lock_type= lock_type;
+    m_pending_start_stmt= TRUE;
+    bitmap_set_all(&m_pending_partitions);
+    DBUG_RETURN(0);
+  }
   file= m_file;
   do
   {
@@ -3264,6 +3440,8 @@ int ha_partition::write_row(uchar * buf)
   }
   m_last_part= part_id;
   DBUG_PRINT("info", ("Insert in partition %d", part_id));
+  if ((error= lock_if_pending(part_id)))
+    goto exit;
   start_part_bulk_insert(thd, part_id);
 
   tmp_disable_binlog(thd); /* Do not replicate the low-level changes. */
@@ -3329,6 +3507,9 @@ int ha_partition::update_row(const uchar *old_data, uchar *new_data)
     goto exit;
   }
 
+  if ((error= lock_if_pending(old_part_id)) ||
+      (error= lock_if_pending(new_part_id)))
+    goto exit;
   m_last_part= new_part_id;
   start_part_bulk_insert(thd, new_part_id);
   if (new_part_id == old_part_id)
@@ -3435,7 +3616,8 @@ int ha_partition::delete_row(const uchar *buf)
   THD *thd= ha_thd();
   DBUG_ENTER("ha_partition::delete_row");
 
-  if ((error= get_part_for_delete(buf, m_rec0, m_part_info, &part_id)))
+  if ((error= get_part_for_delete(buf, m_rec0, m_part_info, &part_id)) ||
+      (error= lock_if_pending(part_id)))
   {
     DBUG_RETURN(error);
   }
@@ -3486,6 +3668,8 @@ int ha_partition::delete_all_rows()
     unlock_auto_increment();
     truncate= TRUE;
   }
+  if ((error= lock_pending_partitions(FALSE)))
+    DBUG_RETURN(error);
   file= m_file;
   do
   {
@@ -3717,6 +3901,9 @@ int ha_partition::rnd_init(bool scan)
     }
   }
 
+  if ((error= lock_pending_partitions(TRUE)))
+    DBUG_RETURN(error);
+
   /* Now we see what the index of our first important partition is */
   DBUG_PRINT("info", ("m_part_info->used_partitions: 0x%lx",
                       (long) m_part_info->used_partitions.bitmap));
@@ -3736,11 +3923,29 @@ int ha_partition::rnd_init(bool scan)
   DBUG_PRINT("info", ("rnd_init on partition %d", part_id));
   if (scan)
   {
+    uint no_parts;
     /*
       rnd_end() is needed for partitioning to reset internal data if scan
       is already in use
     */
     rnd_end();
+    /*
+      A read-only scan over several partitions reads them in parallel if
+      the engine allows it. Rows with blobs are not copied, as the blob
+      data belongs to the handler that read the row.
+    */
+    if (ha_thd()->variables.partition_scan_threads > 1 &&
+        m_lock_type == F_RDLCK && !table->open_by_handler &&
+        !table_share->blob_fields &&
+        (m_file[0]->ht->flags & HTON_PARALLEL_SCAN) &&
+        (no_parts= bitmap_bits_set(&(m_part_info->used_partitions))) > 1 &&
+        !start_parallel_scan(no_parts))
+    {
+      m_scan_value= 1;
+      m_part_spec.start_part= part_id;
+      m_part_spec.end_part= m_tot_parts - 1;
+      DBUG_RETURN(0);
+    }
     late_extra_cache(part_id);
     if ((error= m_file[part_id]->ha_rnd_init(scan)))
       goto err;
@@ -3794,7 +3999,9 @@ int ha_partition::rnd_end()
   case 2:                                       // Error
     break;
   case 1:
-    if (NO_CURRENT_PART_ID != m_part_spec.start_part)         // Table scan
+    if (m_parallel_scan)
+      end_parallel_scan();
+    else if (NO_CURRENT_PART_ID != m_part_spec.start_part)    // Table scan
     {
       late_extra_no_cache(m_part_spec.start_part);
       m_file[m_part_spec.start_part]->ha_rnd_end();
@@ -3852,6 +4059,8 @@ int ha_partition::rnd_next(uchar *buf)
   }
   
   DBUG_ASSERT(m_scan_value == 1);
+  if (m_parallel_scan)
+    DBUG_RETURN(parallel_scan_next(buf));
   file= m_file[part_id];
   
   while (TRUE)
@@ -3906,6 +4115,399 @@ end_dont_reset_start_part:
 }
 
 
+/****************************************************************************
+                MODULE parallel table scan
+****************************************************************************/
+
+/*
+  A parallel table scan starts a number of threads that take the used
+  partitions one at a time, scan them, and put the rows together with
+  their positions into a ring buffer. rnd_next() takes the rows from the
+  buffer in the order in which they were put there.
+
+  The partitions are read with clones of their handlers, which are opened
+  and locked by the thread running the query when the scan starts and
+  closed by it when the scan ends, so that no handler in m_file is ever
+  used by two threads. Each worker scans with a private copy of the TABLE,
+  whose in_use is a private THD, so that the handlers do not update
+  table->status or the statistics of the thread running the query
+  concurrently. The statistics of the workers are added to that thread
+  when the scan ends.
+*/
+
+typedef struct st_partition_scan_worker
+{
+  Partition_scan *scan;
+  THD *thd;
+  TABLE table;
+  pthread_t thread;
+} PARTITION_SCAN_WORKER;
+
+
+class Partition_scan :public Sql_alloc
+{
+public:
+  ha_partition *owner;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond_row;     /* A row was queued or a worker ended */
+  pthread_cond_t cond_space;   /* A row was taken or the scan is aborted */
+  uchar *rows;                 /* Ring buffer of [ref][record] */
+  uint row_length;
+  uint no_rows;                /* Size of the ring buffer in rows */
+  uint first_row;              /* Next row to return */
+  uint queued_rows;
+  MEM_ROOT mem_root;
+  handler **files;             /* Clones of the used partitions */
+  uint *part_ids;              /* Partition of each clone */
+  uint no_files;
+  uint next_file;              /* Next clone to give to a worker */
+  bool extra_cache;
+  uint extra_cache_size;
+  uint no_workers;             /* Number of started workers */
+  uint running_workers;
+  int error;                   /* First error of a worker */
+  bool abort;
+  PARTITION_SCAN_WORKER *workers;
+
+  Partition_scan(ha_partition *owner_arg)
+    :owner(owner_arg), rows(NULL), first_row(0), queued_rows(0), files(NULL),
+     part_ids(NULL), no_files(0), next_file(0), no_workers(0),
+     running_workers(0), error(0), abort(FALSE), workers(NULL)
+  {
+    init_sql_alloc(&mem_root, 1024, 0);
+    pthread_mutex_init(&mutex, MY_MUTEX_INIT_FAST);
+    pthread_cond_init(&cond_row, NULL);
+    pthread_cond_init(&cond_space, NULL);
+  }
+  ~Partition_scan()
+  {
+    my_free(rows, MYF(MY_ALLOW_ZERO_PTR));
+    my_free(workers, MYF(MY_ALLOW_ZERO_PTR));
+    free_root(&mem_root, MYF(0));
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&cond_row);
+    pthread_cond_destroy(&cond_space);
+  }
+};
+
+
+pthread_handler_t partition_scan_thread(void *arg)
+{
+  PARTITION_SCAN_WORKER *worker= (PARTITION_SCAN_WORKER*) arg;
+  my_thread_init();
+  worker->scan->owner->parallel_scan_worker(worker);
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/*
+  Start the threads of a parallel table scan
+
+  SYNOPSIS
+    start_parallel_scan()
+    no_parts                   Number of used partitions
+
+  RETURN VALUE
+    TRUE                       No clone could be opened or no thread could
+                               be started, scan the partitions one after
+                               another
+    FALSE                      Success
+*/
+
+bool ha_partition::start_parallel_scan(uint no_parts)
+{
+  THD *thd= ha_thd();
+  Partition_scan *scan;
+  char name_buff[FN_REFLEN];
+  char *name_buffer_ptr= m_name_buffer_ptr;
+  uint no_threads= (uint) min(thd->variables.partition_scan_threads, no_parts);
+  DBUG_ENTER("ha_partition::start_parallel_scan");
+
+  if (!(scan= new Partition_scan(this)))
+    DBUG_RETURN(TRUE);
+  scan->row_length= m_ref_length + table_share->reclength;
+  scan->no_rows= max(thd->variables.read_buff_size / scan->row_length, 16);
+  scan->extra_cache= m_extra_cache;
+  scan->extra_cache_size= m_extra_cache_size;
+  if (!(scan->rows= (uchar*) my_malloc(scan->no_rows * scan->row_length,
+                                       MYF(0))) ||
+      !(scan->workers= (PARTITION_SCAN_WORKER*)
+        my_malloc(no_threads * sizeof(PARTITION_SCAN_WORKER), MYF(0))) ||
+      !(scan->files= (handler**) alloc_root(&scan->mem_root,
+                                            no_parts * sizeof(handler*))) ||
+      !(scan->part_ids= (uint*) alloc_root(&scan->mem_root,
+                                           no_parts * sizeof(uint))))
+  {
+    delete scan;
+    DBUG_RETURN(TRUE);
+  }
+  m_parallel_scan= scan;
+
+  for (uint i= 0; i < m_tot_parts; i++)
+  {
+    if (bitmap_is_set(&(m_part_info->used_partitions), i))
+    {
+      handler *file;
+      create_partition_name(name_buff, table_share->normalized_path.str,
+                            name_buffer_ptr, NORMAL_PART_NAME, FALSE);
+      if (!(file= m_file[i]->clone(name_buff, &scan->mem_root)))
+        break;
+      if (file->ha_external_lock(thd, F_RDLCK))
+      {
+        file->close();
+        delete file;
+        break;
+      }
+      scan->part_ids[scan->no_files]= i;
+      scan->files[scan->no_files++]= file;
+    }
+    name_buffer_ptr+= strlen(name_buffer_ptr) + 1;
+  }
+  if (scan->no_files < no_parts)
+  {
+    end_parallel_scan();
+    DBUG_RETURN(TRUE);
+  }
+
+  for (uint i= 0; i < no_threads; i++)
+  {
+    PARTITION_SCAN_WORKER *worker= scan->workers + i;
+    if (!(worker->thd= new THD))
+      break;
+    worker->scan= scan;
+    memcpy((char*) &worker->table, (char*) table, sizeof(TABLE));
+    worker->table.in_use= worker->thd;
+    pthread_mutex_lock(&scan->mutex);
+    scan->running_workers++;
+    pthread_mutex_unlock(&scan->mutex);
+    if (pthread_create(&worker->thread, &connection_attrib,
+                       partition_scan_thread, (void*) worker))
+    {
+      pthread_mutex_lock(&scan->mutex);
+      scan->running_workers--;
+      pthread_mutex_unlock(&scan->mutex);
+      pthread_mutex_lock(&LOCK_thread_count);
+      delete worker->thd;
+      pthread_mutex_unlock(&LOCK_thread_count);
+      break;
+    }
+    scan->no_workers++;
+  }
+  if (!scan->no_workers)
+  {
+    end_parallel_scan();
+    DBUG_RETURN(TRUE);
+  }
+  DBUG_PRINT("info", ("parallel scan of %u partitions with %u threads",
+                      no_parts, scan->no_workers));
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Stop the threads of a parallel table scan and free it
+*/
+
+void ha_partition::end_parallel_scan()
+{
+  Partition_scan *scan= m_parallel_scan;
+  THD *thd= ha_thd();
+  DBUG_ENTER("ha_partition::end_parallel_scan");
+
+  pthread_mutex_lock(&scan->mutex);
+  scan->abort= TRUE;
+  pthread_cond_broadcast(&scan->cond_space);
+  pthread_mutex_unlock(&scan->mutex);
+
+  for (uint i= 0; i < scan->no_workers; i++)
+  {
+    PARTITION_SCAN_WORKER *worker= scan->workers + i;
+    pthread_join(worker->thread, NULL);
+    add_to_status(&thd->status_var, &worker->thd->status_var);
+    bzero((char*) &worker->thd->status_var, sizeof(STATUS_VAR));
+    pthread_mutex_lock(&LOCK_thread_count);
+    delete worker->thd;
+    pthread_mutex_unlock(&LOCK_thread_count);
+  }
+  for (uint i= 0; i < scan->no_files; i++)
+  {
+    handler *file= scan->files[i];
+    file->ha_external_lock(thd, F_UNLCK);
+    file->close();
+    delete file;
+  }
+  delete scan;
+  m_parallel_scan= NULL;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Scan partitions in a thread of a parallel table scan
+
+  SYNOPSIS
+    parallel_scan_worker()
+    worker                     The thread
+
+  DESCRIPTION
+    Takes the clone of the next used partition until there are none left,
+    the scan is aborted or an error occurs, and puts its rows into the
+    ring buffer.
+*/
+
+void ha_partition::parallel_scan_worker(PARTITION_SCAN_WORKER *worker)
+{
+  Partition_scan *scan= worker->scan;
+  uchar *buf;
+  int error= 0;
+
+  if (!(buf= (uchar*) my_malloc(table_share->reclength, MYF(0))))
+    error= HA_ERR_OUT_OF_MEM;
+
+  while (!error)
+  {
+    handler *file;
+    uint file_no, part_id;
+
+    pthread_mutex_lock(&scan->mutex);
+    file_no= scan->next_file++;
+    if (scan->abort || file_no >= scan->no_files)
+    {
+      pthread_mutex_unlock(&scan->mutex);
+      break;
+    }
+    pthread_mutex_unlock(&scan->mutex);
+
+    file= scan->files[file_no];
+    part_id= scan->part_ids[file_no];
+    file->change_table_ptr(&worker->table, table_share);
+    if (!(error= file->ha_rnd_init(1)))
+    {
+      if (scan->extra_cache)
+      {
+        if (scan->extra_cache_size == 0)
+          VOID(file->extra(HA_EXTRA_CACHE));
+        else
+          VOID(file->extra_opt(HA_EXTRA_CACHE, scan->extra_cache_size));
+      }
+      while (!(error= file->rnd_next(buf)) ||
+             error == HA_ERR_RECORD_DELETED)
+      {
+        uchar *row;
+        if (error)
+          continue;
+        file->position(buf);
+
+        pthread_mutex_lock(&scan->mutex);
+        while (scan->queued_rows == scan->no_rows && !scan->abort)
+          pthread_cond_wait(&scan->cond_space, &scan->mutex);
+        if (scan->abort)
+        {
+          pthread_mutex_unlock(&scan->mutex);
+          error= HA_ERR_END_OF_FILE;
+          break;
+        }
+        row= scan->rows + ((scan->first_row + scan->queued_rows) %
+                           scan->no_rows) * scan->row_length;
+        int2store(row, part_id);
+        memcpy(row + PARTITION_BYTES_IN_POS, file->ref, file->ref_length);
+        bzero(row + PARTITION_BYTES_IN_POS + file->ref_length,
+              m_ref_length - PARTITION_BYTES_IN_POS - file->ref_length);
+        memcpy(row + m_ref_length, buf, table_share->reclength);
+        scan->queued_rows++;
+        pthread_cond_signal(&scan->cond_row);
+        pthread_mutex_unlock(&scan->mutex);
+      }
+      if (scan->extra_cache)
+        VOID(file->extra(HA_EXTRA_NO_CACHE));
+      file->ha_rnd_end();
+    }
+    file->change_table_ptr(table, table_share);
+    if (error == HA_ERR_END_OF_FILE)
+      error= 0;
+  }
+  my_free(buf, MYF(MY_ALLOW_ZERO_PTR));
+
+  pthread_mutex_lock(&scan->mutex);
+  if (error && !scan->error)
+  {
+    scan->error= error;
+    scan->abort= TRUE;
+    pthread_cond_broadcast(&scan->cond_space);
+  }
+  scan->running_workers--;
+  pthread_cond_signal(&scan->cond_row);
+  pthread_mutex_unlock(&scan->mutex);
+}
+
+
+/*
+  Read next row of a parallel table scan
+
+  SYNOPSIS
+    parallel_scan_next()
+    buf                        buffer that should be filled with data
+
+  RETURN VALUE
+    >0                         Error code
+    0                          Success
+
+  DESCRIPTION
+    Also sets ref to the position of the row, so that position() has
+    nothing to do.
+
+    The wait for the workers is registered with enter_cond(), so that a
+    KILL wakes the thread up. The scan is then aborted and an error is
+    returned, for which the caller sends the kill message.
+*/
+
+int ha_partition::parallel_scan_next(uchar *buf)
+{
+  Partition_scan *scan= m_parallel_scan;
+  THD *thd= ha_thd();
+  int error= 0;
+  DBUG_ENTER("ha_partition::parallel_scan_next");
+
+  pthread_mutex_lock(&scan->mutex);
+  if (!scan->queued_rows && scan->running_workers && !scan->error)
+  {
+    const char *old_msg;
+    old_msg= thd->enter_cond(&scan->cond_row, &scan->mutex,
+                             "Waiting for partition scan");
+    while (!scan->queued_rows && scan->running_workers && !scan->error &&
+           !thd->killed)
+      pthread_cond_wait(&scan->cond_row, &scan->mutex);
+    thd->exit_cond(old_msg);
+    pthread_mutex_lock(&scan->mutex);
+  }
+  if (scan->error)
+    error= scan->error;
+  else if (!scan->queued_rows && thd->killed)
+  {
+    scan->abort= TRUE;
+    pthread_cond_broadcast(&scan->cond_space);
+    error= HA_ERR_GENERIC;
+  }
+  else if (!scan->queued_rows)
+    error= HA_ERR_END_OF_FILE;
+  else
+  {
+    uchar *row= scan->rows + scan->first_row * scan->row_length;
+    memcpy(ref, row, m_ref_length);
+    memcpy(buf, row + m_ref_length, table_share->reclength);
+    m_last_part= uint2korr(row);
+    scan->first_row= (scan->first_row + 1) % scan->no_rows;
+    scan->queued_rows--;
+    pthread_cond_signal(&scan->cond_space);
+  }
+  pthread_mutex_unlock(&scan->mutex);
+  table->status= error ? STATUS_NOT_FOUND : 0;
+  DBUG_RETURN(error);
+}
+
+
 /*
   Save position of current row
 
@@ -3937,6 +4539,16 @@ void ha_partition::position(const uchar *record)
   uint pad_length;
   DBUG_ENTER("ha_partition::position");
 
+  /* The worker that read the row has stored its position in ref */
+  if (m_parallel_scan)
+    DBUG_VOID_RETURN;
+  /* Rows read ahead in an ordered index scan have their position stored */
+  if (m_merge_read_ahead && m_ordered_scan_ongoing && m_merge_no_inputs)
+  {
+    PARTITION_MERGE_INPUT *input= m_merge_inputs + m_merge_tree[0];
+    memcpy(ref, merge_input_row(input, input->cur_row), m_ref_length);
+    DBUG_VOID_RETURN;
+  }
   file->position(record);
   int2store(ref, m_last_part);
   memcpy((ref + PARTITION_BYTES_IN_POS), file->ref, file->ref_length);
@@ -3980,13 +4592,17 @@ void ha_partition::column_bitmaps_signal()
 int ha_partition::rnd_pos(uchar * buf, uchar *pos)
 {
   uint part_id;
+  int error;
   handler *file;
   DBUG_ENTER("ha_partition::rnd_pos");
+  DBUG_ASSERT(!m_parallel_scan);
 
   part_id= uint2korr((const uchar *) pos);
   DBUG_ASSERT(part_id < m_tot_parts);
   file= m_file[part_id];
   m_last_part= part_id;
+  if ((error= lock_if_pending(part_id)))
+    DBUG_RETURN(error);
   DBUG_RETURN(file->rnd_pos(buf, (pos + PARTITION_BYTES_IN_POS)));
 }
 
@@ -4043,6 +4659,13 @@ int ha_partition::rnd_pos_by_record(uchar *record)
 
 /**
   Setup the ordered record buffer and the priority queue.
+
+  The priority queue is a loser tree with one input per used partition.
+  Each input has room for m_merge_max_rows rows. Rows are only read ahead
+  (m_merge_max_rows > 1) in plain reads of the table, since the
+  underlying handlers are then positioned after the row last returned
+  from them: updates, deletes and unlock_row() would act on the wrong row.
+  The read ahead memory is bounded by read_buffer_size.
 */
 
 bool ha_partition::init_record_priority_queue()
@@ -4054,10 +4677,40 @@ bool ha_partition::init_record_priority_queue()
   */
   if (!m_ordered_rec_buffer)
   {
-    uint alloc_len;
+    uint alloc_len, i;
     uint used_parts= bitmap_bits_set(&m_part_info->used_partitions);
-    /* Allocate record buffer for each used partition. */
-    alloc_len= used_parts * (m_rec_length + PARTITION_BYTES_IN_POS);
+    KEY_PART_INFO *key_part= m_curr_key_info[0]->key_part;
+    Field *field= key_part->field;
+    enum thr_lock_type lock_type= table->reginfo.lock_type;
+
+    m_merge_row_length= m_ref_length + m_rec_length;
+    m_merge_max_rows= 1;
+    m_merge_read_ahead= FALSE;
+    if (m_lock_type == F_RDLCK && !table->open_by_handler &&
+        (lock_type == TL_READ || lock_type == TL_READ_HIGH_PRIORITY))
+    {
+      ulong rows= (ha_thd()->variables.read_buff_size /
+                   (used_parts * m_merge_row_length));
+      m_merge_max_rows= (uint) min(max(rows, 2), PARTITION_MERGE_MAX_ROWS);
+      m_merge_read_ahead= TRUE;
+    }
+    /*
+      The first key part is normalized into key_prefix when its sort
+      string orders as the field compares, so that most comparisons of
+      the merge are done on integers.
+    */
+    m_merge_prefix_field= NULL;
+    if (((field->result_type() == INT_RESULT ||
+          field->result_type() == REAL_RESULT) &&
+         field->type() != MYSQL_TYPE_BIT &&
+         field->type() != MYSQL_TYPE_DECIMAL &&
+         field->sort_length() <= 8) ||
+        field->type() == MYSQL_TYPE_NEWDECIMAL)
+      m_merge_prefix_field= field;
+
+    /* Allocate inputs, the tree and the rows of each used partition. */
+    alloc_len= used_parts * (sizeof(PARTITION_MERGE_INPUT) + sizeof(uint) +
+                             m_merge_max_rows * m_merge_row_length);
     /* Allocate a key for temporary use when setting up the scan. */
     alloc_len+= table_share->max_key_length;
 
@@ -4065,31 +4718,21 @@ bool ha_partition::init_record_priority_queue()
       DBUG_RETURN(true);
 
     /*
-      We set-up one record per partition and each record has 2 bytes in
-      front where the partition id is written. This is used by ordered
-      index_read.
+      The inputs get their partition when the scan is set up, since it
+      may be restricted to a range of the used partitions.
       We also set-up a reference to the first record for temporary use in
       setting up the scan.
     */
-    char *ptr= (char*) m_ordered_rec_buffer;
-    uint16 i= 0;
-    do
-    {
-      if (bitmap_is_set(&m_part_info->used_partitions, i))
-      {
-        int2store(ptr, i);
-        ptr+= m_rec_length + PARTITION_BYTES_IN_POS;
-      }
-    } while (++i < m_tot_parts);
-    m_start_key.key= (const uchar*)ptr;
-    /* Initialize priority queue, initialized to reading forward. */
-    if (init_queue(&m_queue, used_parts, (uint) PARTITION_BYTES_IN_POS,
-                   0, key_rec_cmp, (void*)m_curr_key_info))
+    m_merge_inputs= (PARTITION_MERGE_INPUT*) m_ordered_rec_buffer;
+    m_merge_tree= (uint*) (m_merge_inputs + used_parts);
+    uchar *ptr= (uchar*) (m_merge_tree + used_parts);
+    for (i= 0; i < used_parts; i++)
     {
-      my_free(m_ordered_rec_buffer, MYF(0));
-      m_ordered_rec_buffer= NULL;
-      DBUG_RETURN(true);
+      m_merge_inputs[i].rows= ptr;
+      ptr+= m_merge_max_rows * m_merge_row_length;
     }
+    m_merge_no_inputs= 0;
+    m_start_key.key= (const uchar*)ptr;
   }
   DBUG_RETURN(false);
 }
@@ -4104,9 +4747,12 @@ void ha_partition::destroy_record_priority_queue()
   DBUG_ENTER("ha_partition::destroy_record_priority_queue");
   if (m_ordered_rec_buffer)
   {
-    delete_queue(&m_queue);
     my_free(m_ordered_rec_buffer, MYF(0));
     m_ordered_rec_buffer= NULL;
+    m_merge_inputs= NULL;
+    m_merge_tree= NULL;
+    m_merge_no_inputs= 0;
+    m_merge_read_ahead= FALSE;
   }
   DBUG_VOID_RETURN;
 }
@@ -4136,6 +4782,8 @@ int ha_partition::index_init(uint inx, bool sorted)
   DBUG_ENTER("ha_partition::index_init");
 
   DBUG_PRINT("info", ("inx %u sorted %u", inx, sorted));
+  if ((error= lock_pending_partitions(TRUE)))
+    DBUG_RETURN(error);
   active_index= inx;
   m_part_spec.start_part= NO_CURRENT_PART_ID;
   m_start_key.length= 0;
@@ -4523,6 +5171,8 @@ int ha_partition::index_read_idx_map(uchar *buf, uint index,
     {
       if (bitmap_is_set(&(m_part_info->used_partitions), part))
       {
+        if ((error= lock_if_pending(part)))
+          break;
         error= m_file[part]->index_read_idx_map(buf, index, key,
                                                 keypart_map, find_flag);
         if (error != HA_ERR_KEY_NOT_FOUND &&
@@ -4960,33 +5610,34 @@ int ha_partition::handle_unordered_scan_next_partition(uchar * buf)
     the flag ordered set to FALSE. Thus most direct index_read and all
     index_first and index_last.
 
-    We implement ordering by keeping one record plus a key buffer for each
-    partition. Every time a new entry is requested we will fetch a new
-    entry from the partition that is currently not filled with an entry.
-    Then the entry is put into its proper sort position.
+    We implement ordering by merging the partitions through a loser tree
+    with one input per partition. Every time a new entry is requested we
+    fetch the next entry of the input that delivered the last one, and
+    replay the matches on the path from its leaf to the root. An input
+    holds a batch of rows read ahead from its partition, and a normalized
+    prefix of the first key part of its current row, so that most matches
+    are decided without calling key_rec_cmp.
 
-    Returning a record is done by getting the top record, copying the
-    record to the request buffer and setting the partition as empty on
-    entries.
+    Returning a record is done by getting the top record and copying the
+    record to the request buffer.
 */
 
 int ha_partition::handle_ordered_index_scan(uchar *buf, bool reverse_order)
 {
   uint i;
   uint j= 0;
-  bool found= FALSE;
-  uchar *part_rec_buf_ptr= m_ordered_rec_buffer;
   DBUG_ENTER("ha_partition::handle_ordered_index_scan");
 
   m_top_entry= NO_CURRENT_PART_ID;
-  queue_remove_all(&m_queue);
+  m_merge_no_inputs= 0;
 
   DBUG_PRINT("info", ("m_part_spec.start_part %d", m_part_spec.start_part));
   for (i= m_part_spec.start_part; i <= m_part_spec.end_part; i++)
   {
     if (!(bitmap_is_set(&(m_part_info->used_partitions), i)))
       continue;
-    uchar *rec_buf_ptr= part_rec_buf_ptr + PARTITION_BYTES_IN_POS;
+    PARTITION_MERGE_INPUT *input= m_merge_inputs + j;
+    uchar *rec_buf_ptr= input->rows + m_ref_length;
     int error;
     handler *file= m_file[i];
 
@@ -5029,28 +5680,35 @@ int ha_partition::handle_ordered_index_scan(uchar *buf, bool reverse_order)
     }
     if (!error)
     {
-      found= TRUE;
       /*
-        Initialize queue without order first, simply insert
+        The first batch is a single row, so that a LIMIT over many
+        partitions does not read ahead in each of them.
       */
-      queue_element(&m_queue, j++)= part_rec_buf_ptr;
+      input->part_id= i;
+      input->cur_row= 0;
+      input->no_rows= 1;
+      input->batch_rows= min(2, m_merge_max_rows);
+      input->end_of_part= FALSE;
+      input->empty= FALSE;
+      if (m_merge_read_ahead)
+        merge_input_position(input, input->rows);
+      merge_input_set_row(input);
+      j++;
     }
     else if (error != HA_ERR_KEY_NOT_FOUND && error != HA_ERR_END_OF_FILE)
     {
       DBUG_RETURN(error);
     }
-    part_rec_buf_ptr+= m_rec_length + PARTITION_BYTES_IN_POS;
   }
-  if (found)
+  if (j)
   {
     /*
       We found at least one partition with data, now sort all entries and
       after that read the first entry and copy it to the buffer to return in.
     */
-    queue_set_max_at_top(&m_queue, reverse_order);
-    queue_set_cmp_arg(&m_queue, (void*)m_curr_key_info);
-    m_queue.elements= j;
-    queue_fix(&m_queue);
+    m_merge_reverse= reverse_order;
+    m_merge_no_inputs= j;
+    merge_tree_build();
     return_top_record(buf);
     table->status= 0;
     DBUG_PRINT("info", ("Record returned from partition %d", m_top_entry));
@@ -5073,14 +5731,258 @@ int ha_partition::handle_ordered_index_scan(uchar *buf, bool reverse_order)
 
 void ha_partition::return_top_record(uchar *buf)
 {
-  uint part_id;
-  uchar *key_buffer= queue_top(&m_queue);
-  uchar *rec_buffer= key_buffer + PARTITION_BYTES_IN_POS;
+  PARTITION_MERGE_INPUT *input= m_merge_inputs + m_merge_tree[0];
+  uchar *rec_buffer= merge_input_row(input, input->cur_row) + m_ref_length;
 
-  part_id= uint2korr(key_buffer);
   memcpy(buf, rec_buffer, m_rec_length);
-  m_last_part= part_id;
-  m_top_entry= part_id;
+  m_last_part= input->part_id;
+  m_top_entry= input->part_id;
+}
+
+
+/*
+  Store the position of a row read into a merge input
+
+  SYNOPSIS
+    merge_input_position()
+    input                    Input the row was read into
+    row                      Row just read from the partition
+
+  DESCRIPTION
+    Used when rows are read ahead, since the underlying handler is then
+    not positioned on the row that ha_partition::position() is called
+    for.
+*/
+
+void ha_partition::merge_input_position(PARTITION_MERGE_INPUT *input,
+                                        uchar *row)
+{
+  handler *file= m_file[input->part_id];
+
+  file->position(row + m_ref_length);
+  int2store(row, input->part_id);
+  memcpy(row + PARTITION_BYTES_IN_POS, file->ref, file->ref_length);
+  bzero(row + PARTITION_BYTES_IN_POS + file->ref_length,
+        m_ref_length - PARTITION_BYTES_IN_POS - file->ref_length);
+}
+
+
+/*
+  Prepare the current row of a merge input
+
+  SYNOPSIS
+    merge_input_set_row()
+    input                    Input that got a new current row
+
+  DESCRIPTION
+    Computes the normalized key prefix of the row. The prefix is the sort
+    string of the first key part, preceded by a NULL indicator for nullable
+    fields, read as a big endian number. Rows with different prefixes
+    compare as their prefixes; rows with equal prefixes are compared with
+    key_rec_cmp.
+*/
+
+void ha_partition::merge_input_set_row(PARTITION_MERGE_INPUT *input)
+{
+  uchar *row= merge_input_row(input, input->cur_row);
+  Field *field= m_merge_prefix_field;
+  DBUG_ENTER("ha_partition::merge_input_set_row");
+
+  input->key_prefix= 0;
+  if (field)
+  {
+    uchar buff[1 + 8 + 7], *to= buff;
+    my_ptrdiff_t diff= (row + m_ref_length) - table->record[0];
+    uint length= min(field->sort_length(), 8);
+
+    bzero(buff, sizeof(buff));
+    if (field->real_maybe_null())
+    {
+      if (field->is_null_in_record_with_offset(diff))
+        goto end;
+      *to++= 1;
+    }
+    field->move_field_offset(diff);
+    field->sort_string(to, length);
+    field->move_field_offset(-diff);
+end:
+    input->key_prefix= mi_uint8korr(buff);
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Move a merge input to its next row
+
+  SYNOPSIS
+    merge_input_next()
+    input                    Input that delivered the last row
+    next_same                Called from index_next_same
+    prev                     Read backwards
+
+  RETURN VALUE
+    HA_ERR_END_OF_FILE       No more rows in the partition
+    0                        Success
+    other                    Error code
+
+  DESCRIPTION
+    Returns the next row read ahead, or reads a new batch of rows from
+    the partition. The batch doubles at each read up to m_merge_max_rows,
+    and the position of each row is stored with it.
+*/
+
+int ha_partition::merge_input_next(PARTITION_MERGE_INPUT *input,
+                                   bool next_same, bool prev)
+{
+  handler *file= m_file[input->part_id];
+  uint rows;
+  int error= 0;
+  DBUG_ENTER("ha_partition::merge_input_next");
+
+  if (++input->cur_row < input->no_rows)
+  {
+    merge_input_set_row(input);
+    DBUG_RETURN(0);
+  }
+  if (input->end_of_part)
+    DBUG_RETURN(HA_ERR_END_OF_FILE);
+
+  for (rows= 0; rows < input->batch_rows; rows++)
+  {
+    uchar *row= merge_input_row(input, rows);
+    uchar *rec_buf= row + m_ref_length;
+
+    if (prev)
+      error= file->index_prev(rec_buf);
+    else if (m_index_scan_type == partition_read_range)
+    {
+      error= file->read_range_next();
+      memcpy(rec_buf, table->record[0], m_rec_length);
+    }
+    else if (!next_same)
+      error= file->index_next(rec_buf);
+    else
+      error= file->index_next_same(rec_buf, m_start_key.key,
+                                   m_start_key.length);
+    if (error)
+      break;
+    if (m_merge_read_ahead)
+      merge_input_position(input, row);
+  }
+  if (error)
+  {
+    if (error != HA_ERR_END_OF_FILE || !rows)
+      DBUG_RETURN(error);
+    input->end_of_part= TRUE;
+  }
+  input->cur_row= 0;
+  input->no_rows= rows;
+  input->batch_rows= min(input->batch_rows * 2, m_merge_max_rows);
+  merge_input_set_row(input);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Check if the current row of one merge input is returned before another
+
+  SYNOPSIS
+    merge_input_before()
+    first                    Number of first input
+    second                   Number of second input
+
+  RETURN VALUE
+    TRUE                     first wins the match
+    FALSE                    second wins the match
+
+  DESCRIPTION
+    Empty inputs lose against all others, and equal rows are returned
+    in partition order.
+*/
+
+bool ha_partition::merge_input_before(uint first, uint second)
+{
+  PARTITION_MERGE_INPUT *a= m_merge_inputs + first;
+  PARTITION_MERGE_INPUT *b= m_merge_inputs + second;
+  int cmp;
+
+  if (a->empty || b->empty)
+    return b->empty && (!a->empty || first < second);
+  if (a->key_prefix != b->key_prefix)
+    cmp= a->key_prefix < b->key_prefix ? -1 : 1;
+  else if (!(cmp= key_rec_cmp((void*) m_curr_key_info,
+                              merge_input_row(a, a->cur_row) + m_ref_length,
+                              merge_input_row(b, b->cur_row) + m_ref_length)))
+    return first < second;
+  return m_merge_reverse ? cmp > 0 : cmp < 0;
+}
+
+
+/*
+  Play the initial matches of the loser tree
+
+  SYNOPSIS
+    merge_tree_build()
+
+  DESCRIPTION
+    The inputs are entered one by one from their leaf. The first player to
+    reach an internal node waits there for the winner of the other subtree,
+    the loser of the match stays in the node and the winner goes on.
+*/
+
+void ha_partition::merge_tree_build()
+{
+  uint n= m_merge_no_inputs;
+  uint i, node;
+  DBUG_ENTER("ha_partition::merge_tree_build");
+
+  for (node= 1; node < n; node++)
+    m_merge_tree[node]= NO_CURRENT_PART_ID;
+  for (i= 0; i < n; i++)
+  {
+    uint winner= i;
+    for (node= (n + i) / 2; node > 0; node/= 2)
+    {
+      if (m_merge_tree[node] == NO_CURRENT_PART_ID)
+      {
+        m_merge_tree[node]= winner;
+        winner= NO_CURRENT_PART_ID;
+        break;
+      }
+      if (merge_input_before(m_merge_tree[node], winner))
+        swap_variables(uint, m_merge_tree[node], winner);
+    }
+    if (winner != NO_CURRENT_PART_ID)
+      m_merge_tree[0]= winner;
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Replay the matches of an input that got a new current row
+
+  SYNOPSIS
+    merge_tree_replay()
+    input_no                 Input that was at the top of the tree
+
+  DESCRIPTION
+    Only the matches on the path from the leaf of the input to the root
+    are played again, one comparison per level.
+*/
+
+void ha_partition::merge_tree_replay(uint input_no)
+{
+  uint winner= input_no;
+  uint node;
+
+  for (node= (m_merge_no_inputs + input_no) / 2; node > 0; node/= 2)
+  {
+    if (merge_input_before(m_merge_tree[node], winner))
+      swap_variables(uint, m_merge_tree[node], winner);
+  }
+  m_merge_tree[0]= winner;
 }
 
 
@@ -5101,40 +6003,24 @@ void ha_partition::return_top_record(uchar *buf)
 int ha_partition::handle_ordered_next(uchar *buf, bool is_next_same)
 {
   int error;
-  uint part_id= m_top_entry;
-  uchar *rec_buf= queue_top(&m_queue) + PARTITION_BYTES_IN_POS;
-  handler *file= m_file[part_id];
+  uint input_no= m_merge_tree[0];
+  PARTITION_MERGE_INPUT *input= m_merge_inputs + input_no;
   DBUG_ENTER("ha_partition::handle_ordered_next");
-  
-  if (m_index_scan_type == partition_read_range)
-  {
-    error= file->read_range_next();
-    memcpy(rec_buf, table->record[0], m_rec_length);
-  }
-  else if (!is_next_same)
-    error= file->index_next(rec_buf);
-  else
-    error= file->index_next_same(rec_buf, m_start_key.key,
-				 m_start_key.length);
-  if (error)
+
+  if (input->empty)
+    DBUG_RETURN(HA_ERR_END_OF_FILE);
+  if ((error= merge_input_next(input, is_next_same, FALSE)))
   {
-    if (error == HA_ERR_END_OF_FILE)
-    {
-      /* Return next buffered row */
-      queue_remove(&m_queue, (uint) 0);
-      if (m_queue.elements)
-      {
-         DBUG_PRINT("info", ("Record returned from partition %u (2)",
-                     m_top_entry));
-         return_top_record(buf);
-         table->status= 0;
-         error= 0;
-      }
-    }
-    DBUG_RETURN(error);
+    if (error != HA_ERR_END_OF_FILE)
+      DBUG_RETURN(error);
+    /* Return next buffered row */
+    input->empty= TRUE;
   }
-  queue_replaced(&m_queue);
+  merge_tree_replay(input_no);
+  if (m_merge_inputs[m_merge_tree[0]].empty)
+    DBUG_RETURN(HA_ERR_END_OF_FILE);
   return_top_record(buf);
+  table->status= 0;
   DBUG_PRINT("info", ("Record returned from partition %u", m_top_entry));
   DBUG_RETURN(0);
 }
@@ -5156,29 +6042,23 @@ int ha_partition::handle_ordered_next(uchar *buf, bool is_next_same)
 int ha_partition::handle_ordered_prev(uchar *buf)
 {
   int error;
-  uint part_id= m_top_entry;
-  uchar *rec_buf= queue_top(&m_queue) + PARTITION_BYTES_IN_POS;
-  handler *file= m_file[part_id];
+  uint input_no= m_merge_tree[0];
+  PARTITION_MERGE_INPUT *input= m_merge_inputs + input_no;
   DBUG_ENTER("ha_partition::handle_ordered_prev");
 
-  if ((error= file->index_prev(rec_buf)))
+  if (input->empty)
+    DBUG_RETURN(HA_ERR_END_OF_FILE);
+  if ((error= merge_input_next(input, FALSE, TRUE)))
   {
-    if (error == HA_ERR_END_OF_FILE)
-    {
-      queue_remove(&m_queue, (uint) 0);
-      if (m_queue.elements)
-      {
-	return_top_record(buf);
-	DBUG_PRINT("info", ("Record returned from partition %d (2)",
-			    m_top_entry));
-        error= 0;
-        table->status= 0;
-      }
-    }
-    DBUG_RETURN(error);
+    if (error != HA_ERR_END_OF_FILE)
+      DBUG_RETURN(error);
+    input->empty= TRUE;
   }
-  queue_replaced(&m_queue);
+  merge_tree_replay(input_no);
+  if (m_merge_inputs[m_merge_tree[0]].empty)
+    DBUG_RETURN(HA_ERR_END_OF_FILE);
   return_top_record(buf);
+  table->status= 0;
   DBUG_PRINT("info", ("Record returned from partition %d", m_top_entry));
   DBUG_RETURN(0);
 }
@@ -6783,6 +7663,12 @@ void ha_partition::get_auto_increment(ulonglong offset, ulonglong increment,
     ulonglong first_value_part, max_first_value;
     handler **file= m_file;
     first_value_part= max_first_value= *first_value;
+    /* The value is read from the index of each partition */
+    if (lock_pending_partitions(FALSE))
+    {
+      *first_value= ~(ulonglong)(0);
+      DBUG_VOID_RETURN;
+    }
     /* Must lock and find highest value among all partitions. */
     lock_auto_increment();
     do
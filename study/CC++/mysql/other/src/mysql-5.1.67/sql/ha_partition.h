@@ -67,6 +67,29 @@ typedef struct st_ha_data_partition
 /* offset to the engines array */
 #define PAR_ENGINES_OFFSET 12
 
+class Partition_scan;
+struct st_partition_scan_worker;
+
+/* Max rows read ahead from each partition in an ordered index scan */
+#define PARTITION_MERGE_MAX_ROWS 16
+
+/*
+  One input of the merge done by an ordered index scan: the rows read
+  ahead from one partition and the normalized key prefix of its current
+  row. Each row is stored as [position m_ref_length][record].
+*/
+typedef struct st_partition_merge_input
+{
+  uchar *rows;                          // Rows read from the partition
+  ulonglong key_prefix;                 // Key prefix of current row
+  uint part_id;                         // Partition read from
+  uint cur_row;                         // Current row in rows
+  uint no_rows;                         // Rows in rows
+  uint batch_rows;                      // Rows to read at next refill
+  bool end_of_part;                     // Partition has no more rows
+  bool empty;                           // No current row
+} PARTITION_MERGE_INPUT;
+
 class ha_partition :public handler
 {
 private:
@@ -94,6 +117,17 @@ private:
   partition_info *m_part_info;          // local reference to partition
   Field **m_part_field_array;           // Part field array locally to save acc
   uchar *m_ordered_rec_buffer;          // Row and key buffer for ord. idx scan
+  PARTITION_MERGE_INPUT *m_merge_inputs; // One input per used partition
+  /*
+    Loser tree over the inputs of an ordered index scan. Entry 0 is the
+    input holding the next row to return, entries 1..n-1 are the losers
+    of the internal nodes, and input i is the leaf at position n+i.
+  */
+  uint *m_merge_tree;
+  uint m_merge_no_inputs;               // Inputs in m_merge_tree
+  uint m_merge_max_rows;                // Rows read ahead per input
+  uint m_merge_row_length;              // Length of a row in an input
+  Field *m_merge_prefix_field;          // Field of key_prefix, or NULL
   /*
     Current index.
     When used in key_rec_cmp: If clustered pk, index compare
@@ -103,7 +137,6 @@ private:
   */
   KEY *m_curr_key_info[3];              // Current index
   uchar *m_rec0;                        // table->record[0]
-  QUEUE m_queue;                        // Prio queue used by sorted read
   /*
     Since the partition handler is a handler on top of other handlers, it
     is necessary to keep information about what the underlying handler
@@ -144,6 +177,8 @@ private:
   bool m_create_handler;                 // Handler used to create table
   bool m_is_sub_partitioned;             // Is subpartitioned
   bool m_ordered_scan_ongoing;
+  bool m_merge_reverse;                 // Ordered scan returns max first
+  bool m_merge_read_ahead;              // Inputs read more than one row
 
   /* 
     If set, this object was created with ha_partition::clone and doesn't
@@ -178,6 +213,8 @@ private:
   bool m_extra_prepare_for_update;
   /* Which partition has active cache */
   uint m_extra_cache_part_id;
+  /* Table scan reading the partitions in parallel, NULL if not running */
+  Partition_scan *m_parallel_scan;
 
   void init_handler_variables();
   /*
@@ -196,6 +233,15 @@ private:
   bool auto_increment_safe_stmt_log_lock;
   /** For optimizing ha_start_bulk_insert calls */
   MY_BITMAP m_bulk_insert_started;
+  /**
+    Partitions that got external_lock(m_lock_type) and partitions that
+    still need external_lock(m_lock_type), or start_stmt(m_stmt_lock_type)
+    if m_pending_start_stmt, before they are used in the statement.
+  */
+  MY_BITMAP m_locked_partitions;
+  MY_BITMAP m_pending_partitions;
+  thr_lock_type m_stmt_lock_type;
+  bool m_pending_start_stmt;
   ha_rows   m_bulk_inserted_rows;
   /** used for prediction of start_bulk_insert rows */
   enum_monotonicity_info m_part_func_monotonicity_info;
@@ -347,6 +393,17 @@ public:
     instead of external_lock
   */
   virtual int start_stmt(THD * thd, thr_lock_type lock_type);
+private:
+  bool lazy_external_lock(THD *thd);
+  int lock_partition(uint part_id);
+  int lock_pending_partitions(bool used_only);
+  /* Lock a partition before its first use in the statement */
+  int lock_if_pending(uint part_id)
+  {
+    return (bitmap_is_set(&m_pending_partitions, part_id) ?
+            lock_partition(part_id) : 0);
+  }
+public:
   /*
     Lock count is number of locked underlying handlers (I assume)
   */
@@ -528,6 +585,17 @@ private:
   int handle_ordered_next(uchar * buf, bool next_same);
   int handle_ordered_prev(uchar * buf);
   void return_top_record(uchar * buf);
+  uchar *merge_input_row(PARTITION_MERGE_INPUT *input, uint row_no)
+  {
+    return input->rows + row_no * m_merge_row_length;
+  }
+  void merge_input_position(PARTITION_MERGE_INPUT *input, uchar *row);
+  void merge_input_set_row(PARTITION_MERGE_INPUT *input);
+  int merge_input_next(PARTITION_MERGE_INPUT *input, bool next_same,
+                       bool prev);
+  bool merge_input_before(uint first, uint second);
+  void merge_tree_build();
+  void merge_tree_replay(uint input_no);
   void column_bitmaps_signal();
 public:
   /*
@@ -566,7 +634,11 @@ private:
   void late_extra_cache(uint partition_id);
   void late_extra_no_cache(uint partition_id);
   void prepare_extra_cache(uint cachesize);
+  bool start_parallel_scan(uint no_parts);
+  void end_parallel_scan();
+  int parallel_scan_next(uchar *buf);
 public:
+  void parallel_scan_worker(struct st_partition_scan_worker *worker);
 
   /*
     -------------------------------------------------------------------------
@@ -1210,6 +1210,31 @@ end:
   DBUG_RETURN(error);
 }
 
+/**
+  Calls the commit_ordered() method of the engines of a transaction
+  which has been written to the binary log.
+
+  @note
+    Called by the binary log in its commit order; see
+    handlerton::commit_ordered. The thread calling this need not be
+    the thread of the transaction.
+*/
+void ha_commit_ordered(THD *thd, bool all)
+{
+  THD_TRANS *trans= all ? &thd->transaction.all : &thd->transaction.stmt;
+  Ha_trx_info *ha_info= trans->ha_list;
+  DBUG_ENTER("ha_commit_ordered");
+#ifdef USING_TRANSACTIONS
+  for (; ha_info; ha_info= ha_info->next())
+  {
+    handlerton *ht= ha_info->ht();
+    if (ht->commit_ordered && ha_info->is_trx_read_write())
+      ht->commit_ordered(ht, thd, all);
+  }
+#endif /* USING_TRANSACTIONS */
+  DBUG_VOID_RETURN;
+}
+
 /**
   @note
   This function does not care about global read lock. A caller should.
@@ -4679,6 +4704,7 @@ int handler::ha_external_lock(THD *thd, int lock_type)
     taken a table lock), ha_release_auto_increment() was too.
   */
   DBUG_ASSERT(next_insert_id == 0);
+  status_var_increment(thd->status_var.ha_external_lock_count);
 
   /*
     We cache the table flags if the locking succeeded. Otherwise, we
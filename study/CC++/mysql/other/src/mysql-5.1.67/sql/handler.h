@@ -716,6 +716,20 @@ struct handlerton
                                  const char *name);
    uint32 license; /* Flag for Engine License */
    void *data; /* Location for engines to keep personal structures */
+   /*
+     Optional. Called for a transaction which has been written to the
+     binary log, after prepare() and before commit(), in the order in
+     which the transactions were written to the binary log. The calls are
+     serialized, and may be made from the thread of another transaction
+     in the same binlog group commit.
+
+     This is the place to make the transaction visible to other
+     transactions, so that the commit order in the engine is the same as
+     in the binary log. It must be fast and must not wait for disk i/o:
+     the slow part of the commit, like flushing the engine log, belongs
+     in commit(), which runs concurrently for the transactions of a group.
+   */
+   void (*commit_ordered)(handlerton *hton, THD *thd, bool all);
 };
 
 
@@ -730,6 +744,16 @@ struct handlerton
 #define HTON_TEMPORARY_NOT_SUPPORTED (1 << 6) //Having temporary tables not supported
 #define HTON_SUPPORT_LOG_TABLES      (1 << 7) //Engine supports log tables
 #define HTON_NO_PARTITION            (1 << 8) //You can not partition these tables
+/*
+  rnd_next() may be called on several handlers of the same table from
+  different threads at the same time, see ha_partition::rnd_init()
+*/
+#define HTON_PARALLEL_SCAN           (1 << 9)
+/*
+  external_lock() and start_stmt() may be deferred until rows are read or
+  written through the handler, see ha_partition::external_lock()
+*/
+#define HTON_LAZY_EXTERNAL_LOCK      (1 << 10)
 
 class Ha_trx_info;
 
@@ -2038,6 +2062,7 @@ int ha_release_temporary_latches(THD *thd);
 int ha_start_consistent_snapshot(THD *thd);
 int ha_commit_or_rollback_by_xid(XID *xid, bool commit);
 int ha_commit_one_phase(THD *thd, bool all);
+void ha_commit_ordered(THD *thd, bool all);
 int ha_rollback_trans(THD *thd, bool all);
 int ha_prepare(THD *thd);
 int ha_recover(HASH *commit_list);
@@ -617,6 +617,25 @@ bool Item_ident::remove_dependence_processor(uchar * arg)
 }
 
 
+/**
+  Add the item to the outer references of a subquery if it was resolved
+  in a select that encloses the subquery.
+
+  @param arg  pointer to OUTER_REFS
+
+  @return
+    TRUE on out of memory, FALSE otherwise
+*/
+
+bool Item_ident::collect_outer_ref_processor(uchar *arg)
+{
+  OUTER_REFS *outer_refs= (OUTER_REFS *) arg;
+  if (depended_from && depended_from->nest_level < outer_refs->nest_level)
+    return outer_refs->refs->push_back(this);
+  return FALSE;
+}
+
+
 /**
   Store the pointer to this item field into a list if not already there.
 
@@ -470,6 +470,19 @@ typedef Item* (Item::*Item_transformer) (uchar *arg);
 typedef void (*Cond_traverser) (const Item *item, void *arg);
 
 
+/*
+  Argument of collect_outer_ref_processor(): the nesting level of a
+  subquery and the list which gets the items of the subquery that refer
+  to enclosing selects.
+*/
+
+typedef struct st_outer_refs
+{
+  List<Item> *refs;
+  int nest_level;
+} OUTER_REFS;
+
+
 class Item {
   Item(const Item &);			/* Prevent use of these */
   void operator=(Item &);
@@ -901,6 +914,11 @@ public:
   virtual bool remove_fixed(uchar * arg) { fixed= 0; return 0; }
   virtual bool cleanup_processor(uchar *arg);
   virtual bool collect_item_field_processor(uchar * arg) { return 0; }
+  /*
+    Collect references to enclosing selects into OUTER_REFS. Returns TRUE
+    for items whose value may change while the references do not.
+  */
+  virtual bool collect_outer_ref_processor(uchar *arg) { return 0; }
   virtual bool find_item_in_field_list_processor(uchar *arg) { return 0; }
   virtual bool change_context_processor(uchar *context) { return 0; }
   virtual bool reset_query_id_processor(uchar *query_id_arg) { return 0; }
@@ -1410,6 +1428,7 @@ public:
   const char *full_name() const;
   void cleanup();
   bool remove_dependence_processor(uchar * arg);
+  bool collect_outer_ref_processor(uchar *arg);
   virtual void print(String *str, enum_query_type query_type);
   virtual bool change_context_processor(uchar *cntx)
     { context= (Name_resolution_context *)cntx; return FALSE; }
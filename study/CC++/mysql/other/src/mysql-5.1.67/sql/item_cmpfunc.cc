@@ -536,6 +536,243 @@ void Item_bool_func2::fix_length_and_dec()
 }
 
 
+/**
+  Find the column and the constant of a comparison which filter_batch()
+  may be able to evaluate.
+
+  @param[out] field_arg  Set to the number of the argument which is the
+                         column
+
+  @return the column, or NULL if the comparison is not of that form
+*/
+
+static Item_field *batch_column(Item_bool_func2 *func, Item **args,
+                                uint *field_arg)
+{
+  switch (func->functype()) {
+  case Item_func::EQ_FUNC:
+  case Item_func::NE_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+    break;
+  default:
+    return NULL;
+  }
+  if (args[0]->type() == Item::FIELD_ITEM && args[1]->const_item())
+    *field_arg= 0;
+  else if (args[1]->type() == Item::FIELD_ITEM && args[0]->const_item())
+    *field_arg= 1;
+  else
+    return NULL;
+  return (Item_field*) args[*field_arg];
+}
+
+
+/**
+  Tell whether filter_batch() can evaluate the comparison: it must
+  compare a column of table of an integer, double or CHAR type with a
+  constant, and do so the way the comparator would for the column's type.
+*/
+
+bool Item_bool_func2::batch_supported(TABLE *table)
+{
+  uint field_arg;
+  Item_field *field_item= batch_column(this, args, &field_arg);
+  if (!field_item || field_item->field->table != table)
+    return FALSE;
+  Field *field= field_item->field;
+  arg_cmp_func func= cmp.compare_func();
+
+#ifdef WORDS_BIGENDIAN
+  if (!table->s->db_low_byte_first)
+    return FALSE;
+#endif
+  switch (field->real_type()) {
+  case MYSQL_TYPE_LONGLONG:
+    if (((Field_num*) field)->unsigned_flag)
+      return FALSE;
+    /* fall through */
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+    return (func == &Arg_comparator::compare_int_signed ||
+            func == &Arg_comparator::compare_int_signed_unsigned ||
+            func == &Arg_comparator::compare_int_unsigned_signed ||
+            func == &Arg_comparator::compare_int_unsigned);
+  case MYSQL_TYPE_FLOAT:
+  case MYSQL_TYPE_DOUBLE:
+    return func == &Arg_comparator::compare_real;
+  case MYSQL_TYPE_STRING:
+    return ((func == &Arg_comparator::compare_string ||
+             func == &Arg_comparator::compare_binary_string) &&
+            field->charset() == cmp.cmp_collation.collation &&
+            !(table->in_use->variables.sql_mode &
+              MODE_PAD_CHAR_TO_FULL_LENGTH));
+  default:
+    return FALSE;
+  }
+}
+
+
+static inline longlong batch_int_value(const uchar *ptr,
+                                       enum_field_types type,
+                                       bool unsigned_flag)
+{
+  switch (type) {
+  case MYSQL_TYPE_TINY:
+    return unsigned_flag ? (longlong) *ptr : (longlong) (signed char) *ptr;
+  case MYSQL_TYPE_SHORT:
+    return unsigned_flag ? (longlong) uint2korr(ptr) : (longlong) sint2korr(ptr);
+  case MYSQL_TYPE_INT24:
+    return unsigned_flag ? (longlong) uint3korr(ptr) : (longlong) sint3korr(ptr);
+  case MYSQL_TYPE_LONG:
+    return unsigned_flag ? (longlong) uint4korr(ptr) : (longlong) sint4korr(ptr);
+  default:
+    return sint8korr(ptr);
+  }
+}
+
+
+/**
+  Evaluate the comparison on the selected rows of a block, reading the
+  column directly from the row images.  The constant is evaluated once
+  for the block.
+*/
+
+bool Item_bool_func2::filter_batch(ROW_BLOCK *block)
+{
+  /* Which results of comparing the column with the constant pass */
+  static const bool accept[6][3]=
+  {
+    /* <  =  > */
+    { 0, 1, 0 },                                /* EQ_FUNC */
+    { 1, 0, 1 },                                /* NE_FUNC */
+    { 1, 0, 0 },                                /* LT_FUNC */
+    { 1, 1, 0 },                                /* LE_FUNC */
+    { 0, 0, 1 },                                /* GT_FUNC */
+    { 0, 1, 1 }                                 /* GE_FUNC */
+  };
+  uint field_arg;
+  Field *field= batch_column(this, args, &field_arg)->field;
+  Item *value= args[1 - field_arg];
+  TABLE *table= field->table;
+  uint op;
+
+  switch (functype()) {
+  case EQ_FUNC: op= 0; break;
+  case NE_FUNC: op= 1; break;
+  case LT_FUNC: op= field_arg ? 4 : 2; break;
+  case LE_FUNC: op= field_arg ? 5 : 3; break;
+  case GT_FUNC: op= field_arg ? 2 : 4; break;
+  default:      op= field_arg ? 3 : 5; break;
+  }
+
+  const bool *pass= accept[op] + 1;
+  const uchar *rows= block->rows + (field->ptr - table->record[0]);
+  const uchar *null_ptr= (field->null_ptr ?
+                          block->rows + (field->null_ptr - table->record[0]) :
+                          NULL);
+  uchar null_bit= field->null_bit;
+  uint row_length= block->row_length;
+  uint16 *sel= block->selection;
+  uint count= block->selected, kept= 0;
+  enum_field_types type= field->real_type();
+  longlong int_value= 0;
+  double real_value= 0.0;
+  bool int_above_all= FALSE;
+  char buff[MAX_FIELD_WIDTH];
+  String tmp(buff, sizeof(buff), field->charset()), *str= NULL;
+
+  switch (type) {
+  case MYSQL_TYPE_FLOAT:
+  case MYSQL_TYPE_DOUBLE:
+    real_value= value->val_real();
+    break;
+  case MYSQL_TYPE_STRING:
+    str= value->val_str(&tmp);
+    break;
+  default:
+    int_value= value->val_int();
+    /* An unsigned constant above LONGLONG_MAX is above any column value */
+    int_above_all= value->unsigned_flag && int_value < 0;
+    break;
+  }
+  if (table->in_use->is_error())
+    return TRUE;
+  if (value->null_value)
+  {
+    if (!block->keep_nulls)
+      block->selected= 0;
+    return FALSE;
+  }
+
+  bool unsigned_flag= (type != MYSQL_TYPE_STRING &&
+                       ((Field_num*) field)->unsigned_flag);
+  CHARSET_INFO *cs= field->charset();
+  uint field_length= field->pack_length();
+  bool binary= cmp.compare_func() == &Arg_comparator::compare_binary_string;
+
+  for (uint i= 0; i < count; i++)
+  {
+    uint row= sel[i];
+    const uchar *ptr= rows + row * row_length;
+    int res;
+
+    if (null_ptr && (null_ptr[row * row_length] & null_bit))
+    {
+      if (block->keep_nulls)
+        sel[kept++]= row;
+      continue;
+    }
+    switch (type) {
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+    {
+      double val;
+      if (type == MYSQL_TYPE_FLOAT)
+      {
+        float fval;
+        float4get(fval, ptr);
+        val= (double) fval;
+      }
+      else
+        float8get(val, ptr);
+      res= val < real_value ? -1 : val == real_value ? 0 : 1;
+      break;
+    }
+    case MYSQL_TYPE_STRING:
+    {
+      uint length= cs->cset->lengthsp(cs, (const char*) ptr, field_length);
+      if (binary)
+      {
+        res= memcmp(ptr, str->ptr(), min(length, str->length()));
+        if (!res)
+          res= (int) (length - str->length());
+      }
+      else
+        res= cs->coll->strnncollsp(cs, ptr, length, (const uchar*) str->ptr(),
+                                   str->length(), 0);
+      res= res < 0 ? -1 : res > 0;
+      break;
+    }
+    default:
+    {
+      longlong val= batch_int_value(ptr, type, unsigned_flag);
+      res= (int_above_all || val < int_value) ? -1 : val == int_value ? 0 : 1;
+      break;
+    }
+    }
+    if (pass[res])
+      sel[kept++]= row;
+  }
+  block->selected= kept;
+  return FALSE;
+}
+
+
 int Arg_comparator::set_compare_func(Item_result_field *item, Item_result type)
 {
   owner= item;
@@ -899,6 +1136,7 @@ int Arg_comparator::set_cmp_func(Item_result_field *owner_arg,
   a= a1;
   b= a2;
   thd= current_thd;
+  kernel_field= 0;
 
   if ((cmp_type= can_compare_as_dates(*a, *b, &const_value)))
   {
@@ -933,6 +1171,8 @@ int Arg_comparator::set_cmp_func(Item_result_field *owner_arg,
     func= &Arg_comparator::compare_datetime;
     get_value_a_func= &get_datetime_value;
     get_value_b_func= &get_datetime_value;
+    if (const_value != (ulonglong)-1 && !is_nulls_eq)
+      set_field_kernel((longlong) const_value);
     return 0;
   }
   else if (type == STRING_RESULT && (*a)->field_type() == MYSQL_TYPE_TIME &&
@@ -962,7 +1202,189 @@ int Arg_comparator::set_cmp_func(Item_result_field *owner_arg,
 
   a= cache_converted_constant(thd, a, &a_cache, type);
   b= cache_converted_constant(thd, b, &b_cache, type);
-  return set_compare_func(owner_arg, type);
+  if (set_compare_func(owner_arg, type))
+    return 1;
+  set_field_kernel(0);
+  return 0;
+}
+
+
+/**
+  Replace the comparison function by a kernel which reads the column
+  straight from the record, when one argument is a column of an integer,
+  DATETIME, CHAR or VARCHAR type and the other is a literal.  The literal
+  is evaluated here, once.
+
+  @param date_value  The constant converted by can_compare_as_dates() when
+                     comparing as DATETIMEs
+*/
+
+void Arg_comparator::set_field_kernel(longlong date_value)
+{
+  Item *field_arg, *value;
+  arg_cmp_func kernel;
+
+  if (thd->lex->is_ps_or_view_context_analysis())
+    return;
+  if ((*a)->type() == Item::FIELD_ITEM)
+  {
+    field_arg= *a;
+    value= *b;
+    kernel_reversed= FALSE;
+  }
+  else if ((*b)->type() == Item::FIELD_ITEM)
+  {
+    field_arg= *b;
+    value= *a;
+    kernel_reversed= TRUE;
+  }
+  else
+    return;
+  Field *field= ((Item_field*) field_arg)->field;
+  enum_field_types type= field->real_type();
+
+  if (func == &Arg_comparator::compare_datetime)
+  {
+    /* The constant has been replaced by a cache of date_value */
+    if (type != MYSQL_TYPE_DATETIME)
+      return;
+#ifdef WORDS_BIGENDIAN
+    if (!field->table->s->db_low_byte_first)
+      return;
+#endif
+    kernel_int= date_value;
+    kernel= &Arg_comparator::compare_field_int<MYSQL_TYPE_DATETIME, false>;
+  }
+  else if (!value->basic_const_item() || value->type() == Item::PARAM_ITEM)
+    return;
+  else if (func == &Arg_comparator::compare_int_signed ||
+           func == &Arg_comparator::compare_int_signed_unsigned ||
+           func == &Arg_comparator::compare_int_unsigned_signed ||
+           func == &Arg_comparator::compare_int_unsigned)
+  {
+    bool is_unsigned;
+    switch (type) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+      is_unsigned= ((Field_num*) field)->unsigned_flag;
+      break;
+    default:
+      return;
+    }
+#ifdef WORDS_BIGENDIAN
+    if (!field->table->s->db_low_byte_first)
+      return;
+#endif
+    kernel_int= value->val_int();
+    /* Values above LONGLONG_MAX are left to the unsigned comparisons */
+    if (value->null_value || (value->unsigned_flag && kernel_int < 0) ||
+        (type == MYSQL_TYPE_LONGLONG && is_unsigned))
+      return;
+    switch (type) {
+    case MYSQL_TYPE_TINY:
+      kernel= (is_unsigned ?
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_TINY, true> :
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_TINY, false>);
+      break;
+    case MYSQL_TYPE_SHORT:
+      kernel= (is_unsigned ?
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_SHORT, true> :
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_SHORT, false>);
+      break;
+    case MYSQL_TYPE_INT24:
+      kernel= (is_unsigned ?
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_INT24, true> :
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_INT24, false>);
+      break;
+    case MYSQL_TYPE_LONG:
+      kernel= (is_unsigned ?
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_LONG, true> :
+               &Arg_comparator::compare_field_int<MYSQL_TYPE_LONG, false>);
+      break;
+    default:
+      kernel= &Arg_comparator::compare_field_int<MYSQL_TYPE_LONGLONG, false>;
+      break;
+    }
+  }
+  else if (func == &Arg_comparator::compare_string ||
+           func == &Arg_comparator::compare_binary_string)
+  {
+    bool binary= func == &Arg_comparator::compare_binary_string;
+    switch (type) {
+    case MYSQL_TYPE_STRING:
+      /* Field_string::val_str() pads the value in this mode */
+      if (thd->variables.sql_mode & MODE_PAD_CHAR_TO_FULL_LENGTH)
+        return;
+      kernel= (binary ? &Arg_comparator::compare_field_string<0, true> :
+               &Arg_comparator::compare_field_string<0, false>);
+      break;
+    case MYSQL_TYPE_VARCHAR:
+      if (((Field_varstring*) field)->length_bytes == 1)
+        kernel= (binary ? &Arg_comparator::compare_field_string<1, true> :
+                 &Arg_comparator::compare_field_string<1, false>);
+      else
+        kernel= (binary ? &Arg_comparator::compare_field_string<2, true> :
+                 &Arg_comparator::compare_field_string<2, false>);
+      break;
+    default:
+      return;
+    }
+    String *res= value->val_str(&value2);
+    if (!res ||
+        !(kernel_str= (const uchar*) thd->strmake(res->ptr(), res->length())))
+      return;
+    kernel_str_length= res->length();
+    kernel_cs= field->charset();
+  }
+  else
+    return;
+
+  kernel_a= *a;
+  kernel_b= *b;
+  kernel_field= field;
+  kernel_fallback= func;
+  func= kernel;
+}
+
+
+/**
+  Tell whether an argument of a field-constant kernel has been replaced
+  since it was set up, e.g. by equality propagation.
+*/
+
+inline bool Arg_comparator::kernel_args_changed()
+{
+  return (*a != kernel_a || *b != kernel_b ||
+          ((Item_field*) (kernel_reversed ? kernel_b : kernel_a))->field !=
+          kernel_field);
+}
+
+
+/**
+  Check the column for NULL and leave the result in the column item, as
+  its val_*() call in the general comparison functions would.  Callers
+  like NULLIF look at the null_value of the arguments after comparing.
+*/
+
+inline bool Arg_comparator::kernel_column_is_null()
+{
+  Item *column= kernel_reversed ? kernel_b : kernel_a;
+  return (column->null_value= kernel_field->is_null());
+}
+
+
+/**
+  Go back to the general comparison function for good and compare with it.
+*/
+
+int Arg_comparator::compare_fallback()
+{
+  func= kernel_fallback;
+  kernel_field= 0;
+  return (this->*func)();
 }
 
 
@@ -1275,6 +1697,104 @@ int Arg_comparator::compare_datetime()
 }
 
 
+/**
+  Compare an integer or DATETIME column with a constant like the
+  compare_int_*() and compare_datetime() functions do, reading the value
+  directly from the record.
+*/
+
+template <enum_field_types type, bool is_unsigned>
+int Arg_comparator::compare_field_int()
+{
+  if (kernel_args_changed())
+    return compare_fallback();
+  if (kernel_column_is_null())
+  {
+    if (set_null)
+      owner->null_value= 1;
+    return -1;
+  }
+  if (set_null)
+    owner->null_value= 0;
+  longlong val= batch_int_value(kernel_field->ptr, type, is_unsigned);
+  int res= val < kernel_int ? -1 : val > kernel_int;
+  return kernel_reversed ? -res : res;
+}
+
+
+/**
+  Compare a CHAR (length_bytes is 0) or VARCHAR column with a constant
+  like compare_string() or compare_binary_string() do, taking the value
+  from the record as the column's val_str() would.
+*/
+
+template <uint length_bytes, bool binary>
+int Arg_comparator::compare_field_string()
+{
+  if (kernel_args_changed())
+    return compare_fallback();
+  if (kernel_column_is_null())
+  {
+    if (set_null)
+      owner->null_value= 1;
+    return -1;
+  }
+  if (set_null)
+    owner->null_value= 0;
+
+  const uchar *ptr= kernel_field->ptr, *s, *t;
+  uint length, s_length, t_length;
+  if (length_bytes == 0)
+    length= kernel_cs->cset->lengthsp(kernel_cs, (const char*) ptr,
+                                      kernel_field->field_length);
+  else
+  {
+    length= length_bytes == 1 ? (uint) *ptr : uint2korr(ptr);
+    ptr+= length_bytes;
+  }
+  if (kernel_reversed)
+  {
+    s= kernel_str;
+    s_length= kernel_str_length;
+    t= ptr;
+    t_length= length;
+  }
+  else
+  {
+    s= ptr;
+    s_length= length;
+    t= kernel_str;
+    t_length= kernel_str_length;
+  }
+  if (binary)
+  {
+    int cmp= memcmp(s, t, min(s_length, t_length));
+    return cmp ? cmp : (int) (s_length - t_length);
+  }
+  CHARSET_INFO *cs= cmp_collation.collation;
+  return cs->coll->strnncollsp(cs, s, s_length, t, t_length, 0);
+}
+
+#ifdef HAVE_EXPLICIT_TEMPLATE_INSTANTIATION
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_TINY, true>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_TINY, false>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_SHORT, true>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_SHORT, false>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_INT24, true>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_INT24, false>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_LONG, true>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_LONG, false>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_LONGLONG, false>();
+template int Arg_comparator::compare_field_int<MYSQL_TYPE_DATETIME, false>();
+template int Arg_comparator::compare_field_string<0, true>();
+template int Arg_comparator::compare_field_string<0, false>();
+template int Arg_comparator::compare_field_string<1, true>();
+template int Arg_comparator::compare_field_string<1, false>();
+template int Arg_comparator::compare_field_string<2, true>();
+template int Arg_comparator::compare_field_string<2, false>();
+#endif
+
+
 int Arg_comparator::compare_string()
 {
   String *res1,*res2;
@@ -3350,12 +3870,51 @@ static int cmp_decimal(void *cmp_arg, my_decimal *a, my_decimal *b)
 }
 
 
+/**
+  Build the hash that find() uses instead of the binary search. Must be
+  called after sort(). If the type has no hash function or we are out of
+  memory, the vector stays binary searched.
+*/
+
+void in_vector::create_hash()
+{
+  if (!can_hash() || !used_count)
+    return;
+  for (hash_bits= 1; (1U << hash_bits) < used_count * 2; hash_bits++) ;
+  uint mask= (1U << hash_bits) - 1;
+  if (!(hash_slots= (uint*) sql_calloc((mask + 1) * sizeof(uint))))
+    return;
+  for (uint i= 0; i < used_count; i++)
+  {
+    if (i && !compare_elems(i, i - 1))
+      continue;                                 // Duplicate value
+    uint slot= hash_slot((uchar*) base + i * size);
+    while (hash_slots[slot])
+      slot= (slot + 1) & mask;
+    hash_slots[slot]= i + 1;
+  }
+}
+
+
 int in_vector::find(Item *item)
 {
   uchar *result=get_value(item);
   if (!result || !used_count)
     return 0;				// Null value
 
+  if (hash_slots)
+  {
+    uint mask= (1U << hash_bits) - 1;
+    for (uint slot= hash_slot(result); hash_slots[slot];
+         slot= (slot + 1) & mask)
+    {
+      if ((*compare)(collation, base + (hash_slots[slot] - 1) * size,
+                     result) == 0)
+        return 1;
+    }
+    return 0;
+  }
+
   uint start,end;
   start=0; end=used_count-1;
   while (start != end)
@@ -3415,6 +3974,15 @@ uchar *in_string::get_value(Item *item)
   return (uchar*) item->val_str(&tmp);
 }
 
+uint32 in_string::hash_value(const uchar *value)
+{
+  const String *str= (const String*) value;
+  ulong nr1= 1, nr2= 4;
+  collation->coll->hash_sort(collation, (const uchar*) str->ptr(),
+                             str->length(), &nr1, &nr2);
+  return (uint32) nr1;
+}
+
 in_row::in_row(uint elements, Item * item)
 {
   base= (char*) new cmp_item_row[count= elements];
@@ -3509,6 +4077,16 @@ uchar *in_double::get_value(Item *item)
   return (uchar*) &tmp;
 }
 
+uint32 in_double::hash_value(const uchar *value)
+{
+  double nr= *(const double*) value;
+  ulonglong bits;
+  if (nr == 0.0)
+    nr= 0.0;                                    // -0.0 is equal to 0.0
+  memcpy(&bits, &nr, sizeof(bits));
+  return (uint32) (bits ^ (bits >> 32));
+}
+
 
 in_decimal::in_decimal(uint elements)
   :in_vector(elements, sizeof(my_decimal),(qsort2_cmp) cmp_decimal, 0)
@@ -4016,7 +4594,11 @@ void Item_func_in::fix_length_and_dec()
           have_null= 1;
       }
       if ((array->used_count= j))
+      {
 	array->sort();
+        if (j >= IN_VECTOR_HASH_MIN_ELEMENTS)
+          array->create_hash();
+      }
     }
   }
   else
@@ -48,17 +48,33 @@ class Arg_comparator: public Sql_alloc
                                Item *warn_item, bool *is_null);
   longlong (*get_value_b_func)(THD *thd, Item ***item_arg, Item **cache_arg,
                                Item *warn_item, bool *is_null);
+  /*
+    State of the field-constant kernels: the arguments they were set up
+    for, the column, the constant and the general function to fall back to.
+  */
+  Item *kernel_a, *kernel_b;
+  Field *kernel_field;
+  CHARSET_INFO *kernel_cs;
+  longlong kernel_int;
+  const uchar *kernel_str;
+  uint kernel_str_length;
+  bool kernel_reversed;            // TRUE <=> the column is the b argument
+  arg_cmp_func kernel_fallback;
   bool try_year_cmp_func(Item_result type);
+  void set_field_kernel(longlong date_value);
+  bool kernel_args_changed();
+  bool kernel_column_is_null();
+  int compare_fallback();
 public:
   DTCollation cmp_collation;
   /* Allow owner function to use string buffers. */
   String value1, value2;
 
   Arg_comparator(): comparators(0), thd(0), a_cache(0), b_cache(0), set_null(TRUE),
-    get_value_a_func(0), get_value_b_func(0) {};
+    get_value_a_func(0), get_value_b_func(0), kernel_field(0) {};
   Arg_comparator(Item **a1, Item **a2): a(a1), b(a2), comparators(0), thd(0),
     a_cache(0), b_cache(0), set_null(TRUE),
-    get_value_a_func(0), get_value_b_func(0) {};
+    get_value_a_func(0), get_value_b_func(0), kernel_field(0) {};
 
   int set_compare_func(Item_result_field *owner, Item_result type);
   inline int set_compare_func(Item_result_field *owner_arg)
@@ -79,6 +95,9 @@ public:
                                       (*a2)->result_type()));
   }
   inline int compare() { return (this->*func)(); }
+  /* The general comparison function, also when a kernel replaces it */
+  arg_cmp_func compare_func() const
+  { return kernel_field ? kernel_fallback : func; }
 
   int compare_string();		 // compare args[0] & args[1]
   int compare_binary_string();	 // compare args[0] & args[1]
@@ -99,6 +118,9 @@ public:
   int compare_real_fixed();
   int compare_e_real_fixed();
   int compare_datetime();        // compare args[0] & args[1] as DATETIMEs
+  /* Kernels comparing a column in the record with a cached constant */
+  template <enum_field_types type, bool is_unsigned> int compare_field_int();
+  template <uint length_bytes, bool binary> int compare_field_string();
 
   static enum enum_date_cmp_type can_compare_as_dates(Item *a, Item *b,
                                                       ulonglong *const_val_arg);
@@ -375,6 +397,8 @@ public:
     Item_int_func::cleanup();
     cmp.cleanup();
   }
+  bool batch_supported(TABLE *table);
+  bool filter_batch(ROW_BLOCK *block);
 
   friend class  Arg_comparator;
 };
@@ -762,8 +786,21 @@ public:
 
 /* A vector of values of some type  */
 
+/* Lists with at least this many values are searched by hash in find() */
+#define IN_VECTOR_HASH_MIN_ELEMENTS 32
+
 class in_vector :public Sql_alloc
 {
+  /*
+    Open addressing hash over the sorted values: each slot holds the
+    position of a value + 1, or 0 if the slot is free.
+  */
+  uint *hash_slots;
+  uint hash_bits;
+  uint hash_slot(const uchar *value)
+  {
+    return ((uint32) hash_value(value) * 2654435761U) >> (32 - hash_bits);
+  }
 public:
   char *base;
   uint size;
@@ -771,10 +808,10 @@ public:
   CHARSET_INFO *collation;
   uint count;
   uint used_count;
-  in_vector() {}
+  in_vector() :hash_slots(0) {}
   in_vector(uint elements,uint element_length,qsort2_cmp cmp_func, 
   	    CHARSET_INFO *cmp_coll)
-    :base((char*) sql_calloc(elements*element_length)),
+    :hash_slots(0), base((char*) sql_calloc(elements*element_length)),
      size(element_length), compare(cmp_func), collation(cmp_coll),
      count(elements), used_count(elements) {}
   virtual ~in_vector() {}
@@ -784,7 +821,16 @@ public:
   {
     my_qsort2(base,used_count,size,compare,collation);
   }
+  void create_hash();
   int find(Item *item);
+
+  /*
+    Hash of an element or of a value returned by get_value(). Values that
+    compare as equal must have equal hashes. Vectors whose type has no
+    hash function return FALSE from can_hash() and are binary searched.
+  */
+  virtual bool can_hash() { return FALSE; }
+  virtual uint32 hash_value(const uchar *value) { return 0; }
   
   /* 
     Create an instance of Item_{type} (e.g. Item_decimal) constant object
@@ -827,6 +873,8 @@ public:
   { 
     return new Item_string(collation);
   }
+  bool can_hash() { return TRUE; }
+  uint32 hash_value(const uchar *value);
   void value_to_item(uint pos, Item *item)
   {    
     String *str=((String*) base)+pos;
@@ -869,6 +917,12 @@ public:
       ((packed_longlong*) base)[pos].unsigned_flag;
   }
   Item_result result_type() { return INT_RESULT; }
+  bool can_hash() { return TRUE; }
+  uint32 hash_value(const uchar *value)
+  {
+    ulonglong val= (ulonglong) ((packed_longlong*) value)->val;
+    return (uint32) (val ^ (val >> 32));
+  }
 
   friend int cmp_longlong(void *cmp_arg, packed_longlong *a,packed_longlong *b);
 };
@@ -914,6 +968,8 @@ public:
     ((Item_float*)item)->value= ((double*) base)[pos];
   }
   Item_result result_type() { return REAL_RESULT; }
+  bool can_hash() { return TRUE; }
+  uint32 hash_value(const uchar *value);
 };
 
 
@@ -478,6 +478,27 @@ bool Item_func::is_expensive_processor(uchar *arg)
 }
 
 
+/**
+  User variables, stored or user-defined functions and non-deterministic
+  functions like RAND() or SYSDATE() may return another value for the same
+  outer references, see Item_subselect::fix_fields().
+*/
+
+bool Item_func::collect_outer_ref_processor(uchar *arg)
+{
+  if (used_tables() & RAND_TABLE_BIT)
+    return TRUE;
+  switch (functype()) {
+  case GUSERVAR_FUNC:
+  case FUNC_SP:
+  case UDF_FUNC:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+
 my_decimal *Item_func::val_decimal(my_decimal *decimal_value)
 {
   DBUG_ASSERT(fixed);
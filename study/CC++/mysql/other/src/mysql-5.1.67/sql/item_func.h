@@ -182,7 +182,17 @@ public:
   void traverse_cond(Cond_traverser traverser,
                      void * arg, traverse_order order);
   bool is_expensive_processor(uchar *arg);
+  bool collect_outer_ref_processor(uchar *arg);
   virtual bool is_expensive() { return 0; }
+  /*
+    Evaluation as a condition on a block of rows of a table scan, see
+    ROW_BLOCK.  batch_supported() tells whether filter_batch() can
+    evaluate the function on the rows of table.  filter_batch() removes
+    the rows on which the function is not TRUE from the selection of the
+    block and returns TRUE on error.
+  */
+  virtual bool batch_supported(TABLE *table) { return FALSE; }
+  virtual bool filter_batch(ROW_BLOCK *block) { return FALSE; }
   inline double fix_result(double value)
   {
     if (isfinite(value))
@@ -1775,5 +1785,7 @@ public:
   void fix_length_and_dec()
   { max_length= 21; unsigned_flag=1; }
   bool check_partition_func_processor(uchar *int_arg) {return FALSE;}
+  /* Returns a new value on every call */
+  bool collect_outer_ref_processor(uchar *arg) { return TRUE; }
 };
 
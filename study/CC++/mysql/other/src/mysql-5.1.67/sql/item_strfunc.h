@@ -866,5 +866,7 @@ public:
   }
   const char *func_name() const{ return "uuid"; }
   String *val_str(String *);
+  /* Returns a new value on every call */
+  bool collect_outer_ref_processor(uchar *arg) { return TRUE; }
 };
 
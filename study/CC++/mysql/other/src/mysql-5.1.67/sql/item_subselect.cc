@@ -38,8 +38,9 @@ inline Item * and_items(Item* cond, Item *item)
 
 Item_subselect::Item_subselect():
   Item_result_field(), value_assigned(0), thd(0), substitution(0),
-  engine(0), old_engine(0), used_tables_cache(0), have_to_be_excluded(0),
-  const_item_cache(1), engine_changed(0), changed(0), is_correlated(FALSE)
+  engine(0), old_engine(0), used_tables_cache(0), memo(0), memo_allowed(0),
+  have_to_be_excluded(0), const_item_cache(1), engine_changed(0), changed(0),
+  is_correlated(FALSE)
 {
   with_subselect= 1;
   reset();
@@ -117,6 +118,8 @@ void Item_subselect::cleanup()
   }
   if (engine)
     engine->cleanup();
+  delete memo;
+  memo= 0;
   reset();
   value_assigned= 0;
   DBUG_VOID_RETURN;
@@ -127,6 +130,7 @@ void Item_singlerow_subselect::cleanup()
 {
   DBUG_ENTER("Item_singlerow_subselect::cleanup");
   value= 0; row= 0;
+  memo_value= 0;
   Item_subselect::cleanup();
   DBUG_VOID_RETURN;
 }
@@ -134,6 +138,7 @@ void Item_singlerow_subselect::cleanup()
 Item_subselect::~Item_subselect()
 {
   delete engine;
+  delete memo;
 }
 
 Item_subselect::trans_res
@@ -200,6 +205,7 @@ bool Item_subselect::fix_fields(THD *thd_param, Item **ref)
     if (uncacheable & UNCACHEABLE_RAND)
       used_tables_cache|= RAND_TABLE_BIT;
   }
+  memo_allowed= collect_outer_refs();
   fixed= 1;
 
 err:
@@ -265,6 +271,15 @@ bool Item_subselect::exec()
   */
   DBUG_EXECUTE_IF("subselect_exec_fail", return 1;);
 
+  if (memo_allowed)
+  {
+    bool found;
+    if (memo_lookup(&found))
+      return 1;
+    if (found)
+      return 0;
+  }
+
   res= engine->exec();
 
   if (engine_changed)
@@ -272,9 +287,169 @@ bool Item_subselect::exec()
     engine_changed= 0;
     return exec();
   }
+  if (memo && !res && !thd->is_error())
+    memo_insert();
   return (res);
 }
 
+
+static bool walk_join_list(List<TABLE_LIST> *join_list,
+                           Item_processor processor, uchar *arg)
+{
+  List_iterator_fast<TABLE_LIST> it(*join_list);
+  TABLE_LIST *table;
+
+  while ((table= it++))
+  {
+    if (table->on_expr && table->on_expr->walk(processor, FALSE, arg))
+      return TRUE;
+    if (table->nested_join &&
+        walk_join_list(&table->nested_join->join_list, processor, arg))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/**
+  Collect the items of the subquery which refer to enclosing selects into
+  outer_refs.
+
+  Only a correlated single select without subqueries or derived tables
+  of its own is considered, so that walking its clauses finds every
+  reference. The results of such a subquery depend only on the values of
+  the references, unless it uses user variables, stored or user-defined
+  functions, or set functions aggregated in an enclosing select.
+
+  @return TRUE if the results may be cached per value of outer_refs
+*/
+
+bool Item_subselect::collect_outer_refs()
+{
+  SELECT_LEX *select_lex= unit->first_select();
+  JOIN *join= select_lex->join;
+  OUTER_REFS arg;
+  ORDER *order;
+  Item *item;
+
+  outer_refs.empty();
+  if (!memo_supported() || unit->is_union() || !join ||
+      select_lex->first_inner_unit() ||
+      engine->uncacheable() != UNCACHEABLE_DEPENDENT)
+    return FALSE;
+
+  arg.refs= &outer_refs;
+  arg.nest_level= select_lex->nest_level;
+  List_iterator_fast<Item> li(select_lex->item_list);
+  while ((item= li++))
+  {
+    if (item->walk(&Item::collect_outer_ref_processor, FALSE, (uchar*) &arg))
+      return FALSE;
+  }
+  if (join->conds &&
+      join->conds->walk(&Item::collect_outer_ref_processor, FALSE,
+                        (uchar*) &arg))
+    return FALSE;
+  if (join->having &&
+      join->having->walk(&Item::collect_outer_ref_processor, FALSE,
+                         (uchar*) &arg))
+    return FALSE;
+  for (order= select_lex->order_list.first; order; order= order->next)
+  {
+    if ((*order->item)->walk(&Item::collect_outer_ref_processor, FALSE,
+                             (uchar*) &arg))
+      return FALSE;
+  }
+  for (order= select_lex->group_list.first; order; order= order->next)
+  {
+    if ((*order->item)->walk(&Item::collect_outer_ref_processor, FALSE,
+                             (uchar*) &arg))
+      return FALSE;
+  }
+  if (walk_join_list(select_lex->join_list, &Item::collect_outer_ref_processor,
+                     (uchar*) &arg))
+    return FALSE;
+  return !outer_refs.is_empty();
+}
+
+
+/**
+  Check whether the results of the subquery are cached in this execution.
+
+  Only SELECT statements without stored functions are considered, as in
+  others the tables read by the subquery may change during the statement.
+*/
+
+bool Item_subselect::use_memo()
+{
+  return (memo_allowed &&
+          (thd->variables.optimizer_switch &
+           OPTIMIZER_SWITCH_SUBQUERY_CACHE) &&
+          thd->lex->sql_command == SQLCOM_SELECT &&
+          !thd->lex->uses_stored_routines() &&
+          engine->uncacheable() == UNCACHEABLE_DEPENDENT);
+}
+
+
+/**
+  Look up the result for the current values of the outer references.
+
+  @param[out] found  TRUE if the result was set from the cache
+
+  @retval FALSE  OK
+  @retval TRUE   Error
+*/
+
+bool Item_subselect::memo_lookup(bool *found)
+{
+  const uchar *value;
+
+  *found= FALSE;
+  if (!memo)
+  {
+    if (!use_memo())
+    {
+      memo_allowed= FALSE;
+      return FALSE;
+    }
+    if (!(memo= new subselect_memo()) || memo->init(thd))
+      return TRUE;
+  }
+  if (memo->make_key(outer_refs))
+    return TRUE;
+  if ((value= memo->find()))
+  {
+    thd->status_var.subquery_cache_hit++;
+    *found= TRUE;
+    return memo_restore(value);
+  }
+  thd->status_var.subquery_cache_miss++;
+  return FALSE;
+}
+
+
+/**
+  Add the result of the execution that followed a failed lookup, or stop
+  caching if the lookups rarely hit.
+*/
+
+void Item_subselect::memo_insert()
+{
+  char buff[STRING_BUFFER_USUAL_SIZE];
+  String value(buff, sizeof(buff), &my_charset_bin);
+
+  if (memo->low_hit_rate())
+  {
+    delete memo;
+    memo= 0;
+    memo_allowed= FALSE;
+    return;
+  }
+  value.length(0);
+  memo_save(&value);
+  memo->insert(&value);
+}
+
 Item::Type Item_subselect::type() const
 {
   return SUBSELECT_ITEM;
@@ -330,7 +505,7 @@ void Item_subselect::print(String *str, enum_query_type query_type)
 
 
 Item_singlerow_subselect::Item_singlerow_subselect(st_select_lex *select_lex)
-  :Item_subselect(), value(0)
+  :Item_subselect(), value(0), memo_value(0)
 {
   DBUG_ENTER("Item_singlerow_subselect::Item_singlerow_subselect");
   init(select_lex, new select_singlerow_subselect(this));
@@ -2655,3 +2830,234 @@ bool subselect_uniquesubquery_engine::no_tables()
   /* returning value is correct, but this method should never be called */
   return 0;
 }
+
+
+/**
+  Append the value of an item to a key or a result of subselect_memo: a
+  NULL flag byte, followed for a non-NULL value by the longlong or double
+  or by the length and bytes of the decimal or string.
+
+  Equal values with different representations, like 1.0 and 1.00, get
+  different keys, which only costs a miss.
+*/
+
+static void memo_append_value(String *to, Item *item)
+{
+  char buff[MAX_FIELD_WIDTH];
+  String tmp(buff, sizeof(buff), &my_charset_bin), *res= NULL;
+  uchar length_buff[4];
+
+  switch (item->result_type()) {
+  case INT_RESULT:
+  {
+    longlong nr= item->val_int();
+    if (item->null_value)
+      break;
+    to->append('\1');
+    to->append((const char*) &nr, sizeof(nr));
+    return;
+  }
+  case REAL_RESULT:
+  {
+    double nr= item->val_real();
+    if (item->null_value)
+      break;
+    to->append('\1');
+    to->append((const char*) &nr, sizeof(nr));
+    return;
+  }
+  case DECIMAL_RESULT:
+  {
+    my_decimal decimal_value, *dec= item->val_decimal(&decimal_value);
+    if (item->null_value || !dec)
+      break;
+    my_decimal2string(E_DEC_FATAL_ERROR, dec, 0, 0, 0, &tmp);
+    res= &tmp;
+    break;
+  }
+  case STRING_RESULT:
+    res= item->val_str(&tmp);
+    if (item->null_value)
+      res= NULL;
+    break;
+  default:
+    DBUG_ASSERT(0);
+    break;
+  }
+  if (!res)
+  {
+    to->append('\0');
+    return;
+  }
+  to->append('\1');
+  int4store(length_buff, res->length());
+  to->append((const char*) length_buff, sizeof(length_buff));
+  to->append(res->ptr(), res->length());
+}
+
+
+bool Item_singlerow_subselect::memo_supported()
+{
+  return engine->cols() == 1;
+}
+
+
+void Item_singlerow_subselect::memo_save(String *to)
+{
+  if (!assigned())
+  {
+    to->append('\0');
+    return;
+  }
+  to->append('\1');
+  memo_append_value(to, value);
+}
+
+
+bool Item_singlerow_subselect::memo_restore(const uchar *from)
+{
+  if (!*from++)
+  {
+    reset();
+    assigned(0);
+    return FALSE;
+  }
+  if (!memo_value)
+  {
+    switch (value->result_type()) {
+    case INT_RESULT:
+      memo_value= new Item_int((longlong) 0);
+      break;
+    case REAL_RESULT:
+      memo_value= new Item_float(0.0, value->decimals);
+      break;
+    case DECIMAL_RESULT:
+      memo_value= new Item_decimal((longlong) 0, FALSE);
+      break;
+    default:
+      memo_value= new Item_string(value->collation.collation);
+      break;
+    }
+    if (!memo_value)
+      return TRUE;
+  }
+  if ((memo_value->null_value= !*from++))
+  {
+    store(0, memo_value);
+    assigned(1);
+    return FALSE;
+  }
+  switch (value->result_type()) {
+  case INT_RESULT:
+    memcpy(&((Item_int*) memo_value)->value, from, sizeof(longlong));
+    memo_value->unsigned_flag= value->unsigned_flag;
+    break;
+  case REAL_RESULT:
+    memcpy(&((Item_float*) memo_value)->value, from, sizeof(double));
+    break;
+  case DECIMAL_RESULT:
+  {
+    my_decimal decimal_value;
+    str2my_decimal(E_DEC_FATAL_ERROR, (const char*) from + 4, uint4korr(from),
+                   &my_charset_bin, &decimal_value);
+    ((Item_decimal*) memo_value)->set_decimal_value(&decimal_value);
+    break;
+  }
+  default:
+    memo_value->str_value.set((const char*) from + 4, uint4korr(from),
+                              value->collation.collation);
+    break;
+  }
+  store(0, memo_value);
+  assigned(1);
+  return FALSE;
+}
+
+
+/***************************************************************************
+  subselect_memo
+***************************************************************************/
+
+static uchar *subselect_memo_get_key(const uchar *entry, size_t *length,
+                                     my_bool not_used __attribute__((unused)))
+{
+  *length= ((SUBSELECT_MEMO_ENTRY*) entry)->key_length;
+  return (uchar*) entry + ALIGN_SIZE(sizeof(SUBSELECT_MEMO_ENTRY));
+}
+
+
+bool subselect_memo::init(THD *thd)
+{
+  max_memory= (size_t) min(thd->variables.tmp_table_size,
+                           thd->variables.max_heap_table_size);
+  key.set_charset(&my_charset_bin);
+  return hash_init(&hash, &my_charset_bin, 64, 0, 0,
+                   subselect_memo_get_key, 0, 0);
+}
+
+
+subselect_memo::~subselect_memo()
+{
+  if (hash_inited(&hash))
+    hash_free(&hash);
+  free_root(&mem_root, MYF(0));
+}
+
+
+/**
+  Make the key of the next lookup from the values of the outer references.
+
+  @return TRUE if evaluating the references failed
+*/
+
+bool subselect_memo::make_key(List<Item> &refs)
+{
+  List_iterator_fast<Item> it(refs);
+  Item *item;
+
+  key.length(0);
+  while ((item= it++))
+    memo_append_value(&key, item);
+  return current_thd->is_error();
+}
+
+
+/**
+  @return the value of the entry with the current key, or NULL
+*/
+
+const uchar *subselect_memo::find()
+{
+  uchar *entry;
+
+  lookups++;
+  if (!(entry= hash_search(&hash, (const uchar*) key.ptr(), key.length())))
+    return NULL;
+  hits++;
+  return (entry + ALIGN_SIZE(sizeof(SUBSELECT_MEMO_ENTRY)) +
+          ((SUBSELECT_MEMO_ENTRY*) entry)->key_length);
+}
+
+
+/**
+  Add an entry with the current key, unless the cache is full.
+*/
+
+void subselect_memo::insert(String *value)
+{
+  size_t length= (ALIGN_SIZE(sizeof(SUBSELECT_MEMO_ENTRY)) + key.length() +
+                  value->length());
+  SUBSELECT_MEMO_ENTRY *entry;
+  uchar *pos;
+
+  if (memory_used + length + HASH_OVERHEAD > max_memory ||
+      !(entry= (SUBSELECT_MEMO_ENTRY*) alloc_root(&mem_root, length)))
+    return;
+  entry->key_length= key.length();
+  entry->value_length= value->length();
+  pos= (uchar*) entry + ALIGN_SIZE(sizeof(SUBSELECT_MEMO_ENTRY));
+  memcpy(pos, key.ptr(), key.length());
+  memcpy(pos + key.length(), value->ptr(), value->length());
+  if (!my_hash_insert(&hash, (uchar*) entry))
+    memory_used+= length + HASH_OVERHEAD;
+}
@@ -26,6 +26,7 @@ class st_select_lex_unit;
 class JOIN;
 class select_subselect;
 class subselect_engine;
+class subselect_memo;
 class Item_bool_func2;
 
 /* base class for subselects */
@@ -50,11 +51,27 @@ protected:
   uint max_columns;
   /* where subquery is placed */
   enum_parsing_place parsing_place;
+  /* items of the subquery which refer to enclosing selects */
+  List<Item> outer_refs;
+  /* results per value of outer_refs, see subselect_memo */
+  subselect_memo *memo;
+  /* TRUE <=> results may be cached in memo, set by fix_fields() */
+  bool memo_allowed;
   /* work with 'substitution' */
   bool have_to_be_excluded;
   /* cache of constant state */
   bool const_item_cache;
 
+  bool collect_outer_refs();
+  bool memo_lookup(bool *found);
+  void memo_insert();
+  /* TRUE if memo_save() and memo_restore() are implemented */
+  virtual bool memo_supported() { return FALSE; }
+  /* Append the result of the last execution to value */
+  virtual void memo_save(String *value) {}
+  /* Set the result from what memo_save() wrote, TRUE on error */
+  virtual bool memo_restore(const uchar *value) { return FALSE; }
+
 public:
   /* changed engine indicator */
   bool engine_changed;
@@ -120,6 +137,7 @@ public:
   */
   bool is_evaluated() const;
   bool is_uncacheable() const;
+  bool use_memo();
 
   /*
     Used by max/min subquery to initialize value presence registration
@@ -153,9 +171,16 @@ class Item_singlerow_subselect :public Item_subselect
 {
 protected:
   Item_cache *value, **row;
+  /* constant that memo_restore() stores into value */
+  Item *memo_value;
+
+  bool memo_supported();
+  void memo_save(String *to);
+  bool memo_restore(const uchar *from);
 public:
   Item_singlerow_subselect(st_select_lex *select_lex);
-  Item_singlerow_subselect() :Item_subselect(), value(0), row (0) {}
+  Item_singlerow_subselect()
+    :Item_subselect(), value(0), row (0), memo_value(0) {}
 
   void cleanup();
   subs_type substype() { return SINGLEROW_SUBS; }
@@ -220,6 +245,10 @@ class Item_exists_subselect :public Item_subselect
 protected:
   bool value; /* value of this item (boolean: exists/not-exists) */
 
+  bool memo_supported() { return TRUE; }
+  void memo_save(String *to) { to->append(value ? '\1' : '\0'); }
+  bool memo_restore(const uchar *from) { value= *from; return FALSE; }
+
 public:
   Item_exists_subselect(st_select_lex *select_lex);
   Item_exists_subselect(): Item_subselect() {}
@@ -272,6 +301,9 @@ protected:
   bool was_null;
   bool abort_on_null;
   bool transformed;
+
+  /* The injected left_expr is not an outer reference */
+  bool memo_supported() { return FALSE; }
 public:
   /* Used to trigger on/off conditions that were pushed down to subselect */
   bool *pushed_cond_guards;
@@ -584,3 +616,43 @@ inline bool Item_subselect::is_uncacheable() const
 }
 
 
+
+
+/*
+  Results of a correlated subquery per value of its references to
+  enclosing selects, kept for one execution of the statement.
+
+  The key of an entry is the values of Item_subselect::outer_refs as
+  written by make_key(), the value is what Item_subselect::memo_save()
+  wrote. No entries are added once they use min(tmp_table_size,
+  max_heap_table_size) bytes.
+*/
+
+typedef struct st_subselect_memo_entry
+{
+  uint key_length;
+  uint value_length;
+} SUBSELECT_MEMO_ENTRY;
+
+
+class subselect_memo: public Sql_alloc
+{
+  MEM_ROOT mem_root;                    /* entries */
+  HASH hash;
+  String key;                           /* key of the last lookup */
+  size_t memory_used, max_memory;
+  ulong hits, lookups;
+public:
+  subselect_memo() :memory_used(0), hits(0), lookups(0)
+  {
+    init_sql_alloc(&mem_root, 8192, 0);
+    hash_clear(&hash);
+  }
+  ~subselect_memo();
+  bool init(THD *thd);
+  bool make_key(List<Item> &refs);
+  const uchar *find();
+  void insert(String *value);
+  /* TRUE when so few lookups hit that the cache costs more than it saves */
+  bool low_hit_rate() const { return lookups >= 1024 && hits < lookups / 8; }
+};
@@ -1013,9 +1013,13 @@ bool Item_sum_distinct::setup(THD *thd)
     in.  Then the tree is dumped to the temporary file. We can use
     simple_raw_key_cmp because the table contains numbers only; decimals
     are converted to binary representation as well.
+    Keys can then also be kept in a hash table, except for doubles: walk()
+    over a hash table visits them in insertion order and a different order
+    of addition could change the sum.
   */
   tree= new Unique(simple_raw_key_cmp, &tree_key_length, tree_key_length,
-                   thd->variables.max_heap_table_size);
+                   thd->variables.max_heap_table_size,
+                   table_field_type != MYSQL_TYPE_DOUBLE);
 
   is_evaluated= FALSE;
   DBUG_RETURN(tree == 0);
@@ -2431,11 +2435,11 @@ bool Item_sum_count_distinct::setup(THD *thd)
   table->file->extra(HA_EXTRA_NO_ROWS);		// Don't update rows
   table->no_rows=1;
 
-  if (table->s->db_type() == heap_hton)
+  if (table->s->db_type() == heap_hton && !table->s->blob_fields)
   {
     /*
-      No blobs, otherwise it would have been MyISAM: set up a compare
-      function and its arguments to use with Unique.
+      No blobs: set up a compare function and its arguments to use with
+      Unique.
     */
     qsort_cmp2 compare_key;
     void* cmp_arg;
@@ -2491,7 +2495,7 @@ bool Item_sum_count_distinct::setup(THD *thd)
     }
     DBUG_ASSERT(tree == 0);
     tree= new Unique(compare_key, cmp_arg, tree_key_length,
-                     thd->variables.max_heap_table_size);
+                     thd->variables.max_heap_table_size, all_binary);
     /*
       The only time tree_key_length could be 0 is if someone does
       count(distinct) on a char(0) field - stupid thing to do,
@@ -2553,7 +2557,9 @@ bool Item_sum_count_distinct::add()
     return tree->unique_add(table->record[0] + table->s->null_bytes);
   }
   if ((error= table->file->ha_write_row(table->record[0])) &&
-      table->file->is_fatal_error(error, HA_CHECK_DUP))
+      table->file->is_fatal_error(error, HA_CHECK_DUP) &&
+      create_myisam_from_heap(table->in_use, table, tmp_table_param,
+                              error, 1))
     return TRUE;
   return FALSE;
 }
@@ -360,6 +360,12 @@ public:
   virtual Field *create_tmp_field(bool group, TABLE *table,
                                   uint convert_blob_length);
   bool walk(Item_processor processor, bool walk_subquery, uchar *argument);
+  /* A set function aggregated in an enclosing select changes per group */
+  bool collect_outer_ref_processor(uchar *arg)
+  {
+    int level= ((OUTER_REFS *) arg)->nest_level;
+    return nest_level >= level && aggr_level < level;
+  }
   bool init_sum_func_check(THD *thd);
   bool check_sum_func(THD *thd, Item **ref);
   bool register_sum_func(THD *thd, Item **ref);
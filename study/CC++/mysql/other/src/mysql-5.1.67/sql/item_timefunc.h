@@ -631,6 +631,11 @@ public:
     Item_func_now::update_used_tables();
     used_tables_cache|= RAND_TABLE_BIT;
   }
+  /*
+    The RAND_TABLE_BIT above is only set once the subquery cache has
+    looked at the outer references
+  */
+  bool collect_outer_ref_processor(uchar *arg) { return TRUE; }
 };
 
 
@@ -155,7 +155,7 @@ class binlog_trx_data {
 public:
   binlog_trx_data()
     : at_least_one_stmt_committed(0), incident(FALSE), m_pending(0),
-    before_stmt_pos(MY_OFF_T_UNDEF)
+    before_stmt_pos(MY_OFF_T_UNDEF), commit_pos(MY_OFF_T_UNDEF)
   {
     trans_log.end_of_file= max_binlog_cache_size;
   }
@@ -258,6 +258,12 @@ public:
     Binlog position before the start of the current statement.
   */
   my_off_t before_stmt_pos;
+
+  /*
+    Binlog position after the last transaction written by a group
+    commit, for mysql_bin_log_commit_pos().
+  */
+  my_off_t commit_pos;
 };
 
 handlerton *binlog_hton;
@@ -4918,11 +4924,35 @@ bool MYSQL_BIN_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event,
                           bool incident)
 {
   DBUG_ENTER("MYSQL_BIN_LOG::write(THD *, IO_CACHE *, Log_event *)");
-  VOID(pthread_mutex_lock(&LOCK_log));
 
   /* NULL would represent nothing to replicate after ROLLBACK */
   DBUG_ASSERT(commit_event != NULL);
 
+  /*
+    A transaction ending with an Xid event is committed by two-phase
+    commit: write it as part of a group commit, which also commits it
+    in the engines in binlog order.
+  */
+  if (commit_event->get_type_code() == XID_EVENT)
+  {
+    /*
+      Log "BEGIN" at the beginning of every transaction.  The event is
+      created here, as the leader of the group commit may be another
+      thread. Its artificial log_pos 0 is adjusted when it is written.
+    */
+    Query_log_event qinfo(thd, STRING_WITH_LEN("BEGIN"), TRUE, TRUE, 0);
+    group_commit_entry entry;
+
+    entry.thd= thd;
+    entry.cache= cache;
+    entry.begin_event= &qinfo;
+    entry.end_event= commit_event;
+    entry.incident= incident;
+    DBUG_RETURN(write_transaction_to_binlog(&entry));
+  }
+
+  VOID(pthread_mutex_lock(&LOCK_log));
+
   DBUG_ASSERT(is_open());
   if (likely(is_open()))                       // Should always be true
   {
@@ -5013,6 +5043,267 @@ err:
 }
 
 
+/**
+  Write a transaction to the binary log as part of a group commit.
+
+  The entry is queued; the first thread to find the queue empty becomes
+  the leader of the group and does the work for all the queued entries,
+  the others wait until the leader has marked their entry done.
+
+  @return
+    TRUE on error
+*/
+
+bool MYSQL_BIN_LOG::write_transaction_to_binlog(group_commit_entry *entry)
+{
+  group_commit_entry *orig_queue;
+  DBUG_ENTER("MYSQL_BIN_LOG::write_transaction_to_binlog");
+
+  entry->done= FALSE;
+  entry->error= FALSE;
+
+  pthread_mutex_lock(&LOCK_group_commit);
+  orig_queue= group_commit_queue;
+  entry->next= orig_queue;
+  group_commit_queue= entry;
+
+  if (orig_queue != NULL)
+  {
+    /* A leader is already waiting for LOCK_log; it will take us along */
+    const char *old_msg;
+    old_msg= entry->thd->enter_cond(&COND_group_commit, &LOCK_group_commit,
+                                    "Waiting for binlog group commit");
+    while (!entry->done)
+      pthread_cond_wait(&COND_group_commit, &LOCK_group_commit);
+    entry->thd->exit_cond(old_msg);       // Unlocks LOCK_group_commit
+  }
+  else
+  {
+    pthread_mutex_unlock(&LOCK_group_commit);
+    trx_group_commit_leader(entry);
+  }
+
+  DBUG_RETURN(entry->error);
+}
+
+
+/**
+  Do the binlog group commit as the leader of a group.
+
+  Takes the whole queue under LOCK_log: all the transactions which queued
+  up while the previous group was being written. They are written in
+  queue order with one flush and sync of the binary log, and then
+  committed in the engines in the same order under LOCK_commit_ordered.
+  LOCK_log is released before that, so that the next group can already
+  be written.
+
+  If a transaction cannot be written, what was written of it is cut off
+  the binary log. The transactions before it are flushed and committed,
+  it and the ones after it fail and are rolled back.
+*/
+
+void MYSQL_BIN_LOG::trx_group_commit_leader(group_commit_entry *leader)
+{
+  group_commit_entry *queue= NULL, *current, *next;
+  group_commit_entry *failed= NULL;             // First entry not committed
+  ulong n_entries= 0, n_written= 0;
+  DBUG_ENTER("MYSQL_BIN_LOG::trx_group_commit_leader");
+
+  VOID(pthread_mutex_lock(&LOCK_log));
+
+  pthread_mutex_lock(&LOCK_group_commit);
+  current= group_commit_queue;
+  group_commit_queue= NULL;
+  pthread_mutex_unlock(&LOCK_group_commit);
+
+  /* The queue is newest first: reverse it to the commit order */
+  while (current)
+  {
+    next= current->next;
+    current->next= queue;
+    queue= current;
+    current= next;
+    n_entries++;
+  }
+  DBUG_ASSERT(queue == leader);
+
+  DBUG_ASSERT(is_open());
+  if (likely(is_open()))                       // Should always be true
+  {
+    for (current= queue; current; current= current->next)
+    {
+      my_off_t entry_pos= my_b_tell(&log_file);
+      if (write_transaction(current))
+      {
+        failed= current;
+        /* If it stays in the log, the whole group fails */
+        if (truncate_log(entry_pos))
+          n_written= 0;
+        break;
+      }
+      n_written++;
+    }
+
+    if (n_written && flush_and_sync())
+      n_written= 0;
+    DBUG_EXECUTE_IF("half_binlogged_transaction", DBUG_SUICIDE(););
+
+    if (n_written < n_entries)
+    {
+      if (!n_written)
+        failed= queue;
+      if (!write_error)
+      {
+        write_error= 1;
+        sql_print_error(ER(ER_ERROR_ON_WRITE), name, errno);
+      }
+    }
+    if (n_written)
+    {
+      signal_update();
+
+      /*
+        Binlog cannot be rotated while there are prepared xids in it:
+        see the comment in new_file(). They are decreased in ::unlog().
+      */
+      pthread_mutex_lock(&LOCK_prep_xids);
+      prepared_xids+= n_written;
+      pthread_mutex_unlock(&LOCK_prep_xids);
+
+      binlog_group_commits++;
+      binlog_commits+= n_written;
+    }
+  }
+  else
+    failed= queue;
+
+  /*
+    Commit the group in the engines in binlog order. We take
+    LOCK_commit_ordered before releasing LOCK_log, so that the next group
+    cannot commit in the engines before this one.
+  */
+  pthread_mutex_lock(&LOCK_commit_ordered);
+  VOID(pthread_mutex_unlock(&LOCK_log));
+
+  for (current= queue; current != failed; current= current->next)
+  {
+    current->error= FALSE;
+    /*
+      Only real transactions are written with an Xid: either the
+      normal transaction, or a statement in autocommit mode.
+    */
+    ha_commit_ordered(current->thd,
+                      current->thd->transaction.all.ha_list != NULL);
+  }
+  for (; current; current= current->next)
+    current->error= TRUE;
+
+  pthread_mutex_unlock(&LOCK_commit_ordered);
+
+  /* Wake up the rest of the group */
+  pthread_mutex_lock(&LOCK_group_commit);
+  for (current= queue; current; current= next)
+  {
+    /* current may go away as soon as done is set */
+    next= current->next;
+    current->done= TRUE;
+  }
+  pthread_cond_broadcast(&COND_group_commit);
+  pthread_mutex_unlock(&LOCK_group_commit);
+
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Write one transaction of a group commit to the binary log.
+
+  @note
+    LOCK_log must be held. The binary log is not flushed here.
+
+  @return
+    TRUE on error
+*/
+
+bool MYSQL_BIN_LOG::write_transaction(group_commit_entry *entry)
+{
+  binlog_trx_data *trx_data=
+    (binlog_trx_data*) thd_get_ha_data(entry->thd, binlog_hton);
+  IO_CACHE *cache= entry->cache;
+
+  safe_mutex_assert_owner(&LOCK_log);
+
+  /*
+    We only bother to write to the binary log if there is anything
+    to write.
+  */
+  if (my_b_tell(cache) > 0)
+  {
+    if (entry->begin_event->write(&log_file))
+      return TRUE;
+
+    DBUG_EXECUTE_IF("crash_before_writing_xid",
+                    {
+                      if ((write_error= write_cache(cache, false, true)))
+                        DBUG_PRINT("info", ("error writing binlog cache: %d",
+                                             write_error));
+                      DBUG_PRINT("info", ("crashing before writing xid"));
+                      DBUG_SUICIDE();
+                    });
+
+    if ((write_error= write_cache(cache, false, false)))
+      return TRUE;
+
+    if (entry->end_event->write(&log_file))
+      return TRUE;
+
+    if (entry->incident && write_incident(entry->thd, FALSE))
+      return TRUE;
+
+    if (cache->error)                           // Error on read
+    {
+      sql_print_error(ER(ER_ERROR_ON_READ), cache->file_name, errno);
+      write_error= 1;                           // Don't give more errors
+      return TRUE;
+    }
+  }
+
+  /* The engines record this position at commit_ordered() */
+  trx_data->commit_pos= my_b_tell(&log_file);
+  return FALSE;
+}
+
+
+/**
+  Cut the binary log back to a position.
+
+  Used to remove a transaction that was only partly written. What is
+  still in the cache is dropped, what was written to the file already
+  is truncated.
+
+  @note
+    LOCK_log must be held.
+
+  @return
+    TRUE on error
+*/
+
+bool MYSQL_BIN_LOG::truncate_log(my_off_t pos)
+{
+  bool on_disk= pos < log_file.pos_in_file;
+  safe_mutex_assert_owner(&LOCK_log);
+
+  if (reinit_io_cache(&log_file, WRITE_CACHE, pos, 0, on_disk) ||
+      (on_disk && my_chsize(log_file.file, pos, 0, MYF(MY_WME))))
+  {
+    sql_print_error("Could not remove a partly written transaction from "
+                    "the binary log '%s' (errno %d)", log_file_name, my_errno);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+
 /**
   Wait until we get a signal that the binary log has been updated.
 
@@ -5902,6 +6193,10 @@ int TC_LOG_BINLOG::open(const char *opt_name)
 
   pthread_mutex_init(&LOCK_prep_xids, MY_MUTEX_INIT_FAST);
   pthread_cond_init (&COND_prep_xids, 0);
+  pthread_mutex_init(&LOCK_group_commit, MY_MUTEX_INIT_FAST);
+  pthread_cond_init (&COND_group_commit, 0);
+  pthread_mutex_init(&LOCK_commit_ordered, MY_MUTEX_INIT_FAST);
+  group_commit_queue= NULL;
 
   if (!my_b_inited(&index_file))
   {
@@ -5983,11 +6278,14 @@ void TC_LOG_BINLOG::close()
   DBUG_ASSERT(prepared_xids==0);
   pthread_mutex_destroy(&LOCK_prep_xids);
   pthread_cond_destroy (&COND_prep_xids);
+  DBUG_ASSERT(group_commit_queue == NULL);
+  pthread_mutex_destroy(&LOCK_group_commit);
+  pthread_cond_destroy (&COND_group_commit);
+  pthread_mutex_destroy(&LOCK_commit_ordered);
 }
 
 /**
-  @todo
-  group commit
+  Write the transaction to the binary log, as a part of a group commit.
 
   @retval
     0    error
@@ -6086,6 +6384,25 @@ ulonglong mysql_bin_log_file_pos(void)
 {
   return (ulonglong) mysql_bin_log.get_log_file()->pos_in_file;
 }
+/**
+  Get the binlog position of a transaction in a group commit.
+  Only valid while handlerton::commit_ordered() is called for it: the
+  binlog cannot be rotated then.
+  @param thd        the thread of the transaction
+  @param out_file   the name of the binlog file
+  @return byte offset of the end of the transaction in the binlog
+*/
+extern "C"
+ulonglong mysql_bin_log_commit_pos(THD *thd, const char **out_file)
+{
+  binlog_trx_data *trx_data=
+    (binlog_trx_data*) thd_get_ha_data(thd, binlog_hton);
+
+  *out_file= mysql_bin_log.get_log_fname();
+  if (trx_data && trx_data->commit_pos != MY_OFF_T_UNDEF)
+    return (ulonglong) trx_data->commit_pos;
+  return mysql_bin_log_file_pos();
+}
 #endif /* INNODB_COMPATIBILITY_HOOKS */
 
 
@@ -247,6 +247,31 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   pthread_mutex_t LOCK_prep_xids;
   pthread_cond_t  COND_prep_xids;
   pthread_cond_t update_cond;
+  /*
+    Binlog group commit. A transaction which is written to the binary
+    log with an Xid event queues itself in group_commit_queue. The thread
+    which finds the queue empty becomes the leader: it takes LOCK_log,
+    writes all the transactions queued by then with a single flush and
+    sync, commits them in the engines (handlerton::commit_ordered) in the
+    same order, and wakes up the other threads of the group.
+  */
+  struct group_commit_entry
+  {
+    group_commit_entry *next;
+    THD *thd;
+    IO_CACHE *cache;
+    Log_event *begin_event;
+    Log_event *end_event;
+    bool incident;
+    bool done;                          // set when the leader is done
+    bool error;
+  };
+  /* protects group_commit_queue and group_commit_entry::done */
+  pthread_mutex_t LOCK_group_commit;
+  pthread_cond_t  COND_group_commit;
+  /* taken before LOCK_log is released, to keep the commit order */
+  pthread_mutex_t LOCK_commit_ordered;
+  group_commit_entry *group_commit_queue;   // newest first
   ulonglong bytes_written;
   IO_CACHE index_file;
   char index_file_name[FN_REFLEN];
@@ -285,6 +310,10 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   bool no_auto_events;
 
   int write_to_file(IO_CACHE *cache);
+  bool write_transaction_to_binlog(group_commit_entry *entry);
+  bool write_transaction(group_commit_entry *entry);
+  bool truncate_log(my_off_t pos);
+  void trx_group_commit_leader(group_commit_entry *leader);
   /*
     This is used to start writing to a new log file. The difference from
     new_file() is locking. new_file_without_locking() does not acquire
@@ -578,13 +578,21 @@ template <class T> bool valid_buffer_range(T jump,
 #define OPTIMIZER_SWITCH_INDEX_MERGE_UNION 2
 #define OPTIMIZER_SWITCH_INDEX_MERGE_SORT_UNION 4
 #define OPTIMIZER_SWITCH_INDEX_MERGE_INTERSECT 8
-#define OPTIMIZER_SWITCH_LAST 16
+#define OPTIMIZER_SWITCH_HASH_GROUP_BY 16
+#define OPTIMIZER_SWITCH_SUBQUERY_CACHE 32
+#define OPTIMIZER_SWITCH_SCAN_BATCH_FILTER 64
+#define OPTIMIZER_SWITCH_DEFERRED_ROW_FETCH 128
+#define OPTIMIZER_SWITCH_LAST 256
 
 /* The following must be kept in sync with optimizer_switch_str in mysqld.cc */
 #define OPTIMIZER_SWITCH_DEFAULT (OPTIMIZER_SWITCH_INDEX_MERGE | \
                                   OPTIMIZER_SWITCH_INDEX_MERGE_UNION | \
                                   OPTIMIZER_SWITCH_INDEX_MERGE_SORT_UNION | \
-                                  OPTIMIZER_SWITCH_INDEX_MERGE_INTERSECT)
+                                  OPTIMIZER_SWITCH_INDEX_MERGE_INTERSECT | \
+                                  OPTIMIZER_SWITCH_HASH_GROUP_BY | \
+                                  OPTIMIZER_SWITCH_SUBQUERY_CACHE | \
+                                  OPTIMIZER_SWITCH_SCAN_BATCH_FILTER | \
+                                  OPTIMIZER_SWITCH_DEFERRED_ROW_FETCH)
 
 
 /*
@@ -776,6 +784,7 @@ typedef my_bool (*qc_engine_callback)(THD *thd, char *table_key,
 #include "protocol.h"
 #include "sql_udf.h"
 #include "sql_profile.h"
+#include "opt_trace.h"
 #include "sql_partition.h"
 
 class user_var_entry;
@@ -1964,6 +1973,7 @@ extern ulonglong keybuff_size;
 extern ulonglong thd_startup_options;
 extern ulong thread_id;
 extern ulong binlog_cache_use, binlog_cache_disk_use;
+extern ulong binlog_commits, binlog_group_commits;
 extern ulong aborted_threads,aborted_connects;
 extern ulong delayed_insert_timeout;
 extern ulong delayed_insert_limit, delayed_queue_size;
@@ -2270,6 +2280,7 @@ void init_read_record(READ_RECORD *info, THD *thd, TABLE *reg_form,
 void init_read_record_idx(READ_RECORD *info, THD *thd, TABLE *table, 
                           bool print_error, uint idx);
 void end_read_record(READ_RECORD *info);
+bool init_read_record_block(READ_RECORD *info, ROW_BLOCK *block);
 ha_rows filesort(THD *thd, TABLE *form,struct st_sort_field *sortorder,
 		 uint s_length, SQL_SELECT *select,
 		 ha_rows max_rows, bool sort_positions,
@@ -345,7 +345,8 @@ TYPELIB sql_mode_typelib= { array_elements(sql_mode_names)-1,"",
 static const char *optimizer_switch_names[]=
 {
   "index_merge","index_merge_union","index_merge_sort_union", 
-  "index_merge_intersection", "default", NullS
+  "index_merge_intersection", "hash_group_by", "subquery_cache",
+  "scan_batch_filter", "deferred_row_fetch", "default", NullS
 };
 /* Corresponding defines are named OPTIMIZER_SWITCH_XXX */
 static const unsigned int optimizer_switch_names_len[]=
@@ -354,6 +355,10 @@ static const unsigned int optimizer_switch_names_len[]=
   sizeof("index_merge_union") - 1,
   sizeof("index_merge_sort_union") - 1,
   sizeof("index_merge_intersection") - 1,
+  sizeof("hash_group_by") - 1,
+  sizeof("subquery_cache") - 1,
+  sizeof("scan_batch_filter") - 1,
+  sizeof("deferred_row_fetch") - 1,
   sizeof("default") - 1
 };
 TYPELIB optimizer_switch_typelib= { array_elements(optimizer_switch_names)-1,"",
@@ -433,7 +438,11 @@ static const char *sql_mode_str= "OFF";
 /* Text representation for OPTIMIZER_SWITCH_DEFAULT */
 static const char *optimizer_switch_str="index_merge=on,index_merge_union=on,"
                                         "index_merge_sort_union=on,"
-                                        "index_merge_intersection=on";
+                                        "index_merge_intersection=on,"
+                                        "hash_group_by=on,"
+                                        "subquery_cache=on,"
+                                        "scan_batch_filter=on,"
+                                        "deferred_row_fetch=on";
 static char *mysqld_user, *mysqld_chroot, *log_error_file_ptr;
 static char *opt_init_slave, *language_ptr, *opt_init_connect;
 static char *default_character_set_name;
@@ -585,6 +594,7 @@ ulong delayed_insert_threads, delayed_insert_writes, delayed_rows_in_use;
 ulong delayed_insert_errors,flush_time;
 ulong specialflag=0;
 ulong binlog_cache_use= 0, binlog_cache_disk_use= 0;
+ulong binlog_commits= 0, binlog_group_commits= 0;
 ulong max_connections, max_connect_errors;
 /*
   Maximum length of parameter value which can be set through
@@ -5635,6 +5645,8 @@ enum options_mysqld
   OPT_OPTIMIZER_SEARCH_DEPTH,
   OPT_OPTIMIZER_PRUNE_LEVEL,
   OPT_OPTIMIZER_SWITCH,
+  OPT_OPTIMIZER_TRACE_MAX_MEM_SIZE,
+  OPT_PARTITION_SCAN_THREADS,
   OPT_UPDATABLE_VIEWS_WITH_LIMIT,
   OPT_SP_AUTOMATIC_PRIVILEGES,
   OPT_MAX_SP_RECURSION_DEPTH,
@@ -6915,10 +6927,25 @@ thread is in the relay logs.",
    0, GET_ULONG, OPT_ARG, MAX_TABLES+1, 0, MAX_TABLES+2, 0, 1, 0},
   {"optimizer_switch", OPT_OPTIMIZER_SWITCH,
    "optimizer_switch=option=val[,option=val...], where option={index_merge, "
-   "index_merge_union, index_merge_sort_union, index_merge_intersection} and "
-   "val={on, off, default}.",
+   "index_merge_union, index_merge_sort_union, index_merge_intersection, "
+   "hash_group_by, subquery_cache, scan_batch_filter, deferred_row_fetch} "
+   "and val={on, off, default}.",
    &optimizer_switch_str, &optimizer_switch_str, 0, GET_STR, REQUIRED_ARG,
    /*OPTIMIZER_SWITCH_DEFAULT*/0, 0, 0, 0, 0, 0},
+  {"optimizer_trace_max_mem_size", OPT_OPTIMIZER_TRACE_MAX_MEM_SIZE,
+   "Maximum size in bytes of the optimizer trace of a statement. What "
+   "does not fit is only counted.",
+   &global_system_variables.optimizer_trace_max_mem_size,
+   &max_system_variables.optimizer_trace_max_mem_size,
+   0, GET_ULONG, REQUIRED_ARG, 16384, 0, ULONG_MAX, 0, 1, 0},
+  {"partition_scan_threads", OPT_PARTITION_SCAN_THREADS,
+   "Number of threads that read the partitions of a partitioned table in "
+   "parallel during a read-only table scan. 0 or 1 means that the "
+   "partitions are read one after another by the thread running the "
+   "query.",
+   &global_system_variables.partition_scan_threads,
+   &max_system_variables.partition_scan_threads,
+   0, GET_ULONG, REQUIRED_ARG, 0, 0, 64, 0, 1, 0},
   {"plugin_dir", OPT_PLUGIN_DIR,
    "Directory for plugins.",
    &opt_plugin_dir_ptr, &opt_plugin_dir_ptr, 0,
@@ -7512,6 +7539,8 @@ SHOW_VAR status_vars[]= {
   {"Aborted_connects",         (char*) &aborted_connects,       SHOW_LONG},
   {"Binlog_cache_disk_use",    (char*) &binlog_cache_disk_use,  SHOW_LONG},
   {"Binlog_cache_use",         (char*) &binlog_cache_use,       SHOW_LONG},
+  {"Binlog_commits",           (char*) &binlog_commits,         SHOW_LONG},
+  {"Binlog_group_commits",     (char*) &binlog_group_commits,   SHOW_LONG},
   {"Bytes_received",           (char*) offsetof(STATUS_VAR, bytes_received), SHOW_LONGLONG_STATUS},
   {"Bytes_sent",               (char*) offsetof(STATUS_VAR, bytes_sent), SHOW_LONGLONG_STATUS},
   {"Com",                      (char*) com_status_vars, SHOW_ARRAY},
@@ -7527,6 +7556,7 @@ SHOW_VAR status_vars[]= {
   {"Handler_commit",           (char*) offsetof(STATUS_VAR, ha_commit_count), SHOW_LONG_STATUS},
   {"Handler_delete",           (char*) offsetof(STATUS_VAR, ha_delete_count), SHOW_LONG_STATUS},
   {"Handler_discover",         (char*) offsetof(STATUS_VAR, ha_discover_count), SHOW_LONG_STATUS},
+  {"Handler_external_lock",    (char*) offsetof(STATUS_VAR, ha_external_lock_count), SHOW_LONG_STATUS},
   {"Handler_prepare",          (char*) offsetof(STATUS_VAR, ha_prepare_count),  SHOW_LONG_STATUS},
   {"Handler_read_first",       (char*) offsetof(STATUS_VAR, ha_read_first_count), SHOW_LONG_STATUS},
   {"Handler_read_key",         (char*) offsetof(STATUS_VAR, ha_read_key_count), SHOW_LONG_STATUS},
@@ -7577,6 +7607,7 @@ SHOW_VAR status_vars[]= {
   {"Select_range",             (char*) offsetof(STATUS_VAR, select_range_count), SHOW_LONG_STATUS},
   {"Select_range_check",       (char*) offsetof(STATUS_VAR, select_range_check_count), SHOW_LONG_STATUS},
   {"Select_scan",	       (char*) offsetof(STATUS_VAR, select_scan_count), SHOW_LONG_STATUS},
+  {"Select_scan_batch_filtered", (char*) offsetof(STATUS_VAR, select_scan_batch_filtered), SHOW_LONG_STATUS},
   {"Slave_open_temp_tables",   (char*) &slave_open_temp_tables, SHOW_LONG},
 #ifdef HAVE_REPLICATION
   {"Slave_retried_transactions",(char*) &show_slave_retried_trans, SHOW_FUNC},
@@ -7613,6 +7644,8 @@ SHOW_VAR status_vars[]= {
   {"Ssl_verify_mode",          (char*) &show_ssl_get_verify_mode, SHOW_FUNC},
   {"Ssl_version",              (char*) &show_ssl_get_version, SHOW_FUNC},
 #endif /* HAVE_OPENSSL */
+  {"Subquery_cache_hit",       (char*) offsetof(STATUS_VAR, subquery_cache_hit), SHOW_LONG_STATUS},
+  {"Subquery_cache_miss",      (char*) offsetof(STATUS_VAR, subquery_cache_miss), SHOW_LONG_STATUS},
   {"Table_locks_immediate",    (char*) &locks_immediate,        SHOW_LONG},
   {"Table_locks_waited",       (char*) &locks_waited,           SHOW_LONG},
 #ifdef HAVE_MMAP
@@ -7624,6 +7657,7 @@ SHOW_VAR status_vars[]= {
   {"Threads_connected",        (char*) &thread_count,           SHOW_INT},
   {"Threads_created",	       (char*) &thread_created,		SHOW_LONG_NOFLUSH},
   {"Threads_running",          (char*) &thread_running,         SHOW_INT},
+  {"Tmp_table_conversions",    (char*) offsetof(STATUS_VAR, tmp_table_conversions), SHOW_LONG_STATUS},
   {"Uptime",                   (char*) &show_starttime,         SHOW_FUNC},
 #ifdef COMMUNITY_SERVER
   {"Uptime_since_flush_status",(char*) &show_flushstatustime,   SHOW_FUNC},
@@ -7748,6 +7782,7 @@ static int mysql_init_variables(void)
   delayed_insert_errors= thread_created= 0;
   specialflag= 0;
   binlog_cache_use=  binlog_cache_disk_use= 0;
+  binlog_commits= binlog_group_commits= 0;
   max_used_connections= slow_launch_threads = 0;
   mysqld_user= mysqld_chroot= opt_init_file= opt_bin_logname = 0;
   prepared_stmt_count= 0;
@@ -1255,7 +1255,7 @@ QUICK_ROR_INTERSECT_SELECT::QUICK_ROR_INTERSECT_SELECT(THD *thd_param,
                                                        bool retrieve_full_rows,
                                                        MEM_ROOT *parent_alloc)
   : cpk_quick(NULL), thd(thd_param), need_to_fetch_row(retrieve_full_rows),
-    scans_inited(FALSE)
+    scans_inited(FALSE), batches(NULL)
 {
   index= MAX_KEY;
   head= table;
@@ -1454,8 +1454,32 @@ int QUICK_ROR_INTERSECT_SELECT::reset()
   scans_inited= TRUE;
   List_iterator_fast<QUICK_RANGE_SELECT> it(quick_selects);
   QUICK_RANGE_SELECT *quick;
-  while ((quick= it++))
+  if (need_to_fetch_row && !batches)
+  {
+    ROR_ROWID_BATCH **batch;
+    /* Full rows are fetched only by a top-level quick select */
+    DBUG_ASSERT(alloc.block_size);
+    if (!(batch= (ROR_ROWID_BATCH**)
+          alloc_root(&alloc, sizeof(ROR_ROWID_BATCH*) *
+                             quick_selects.elements)))
+      DBUG_RETURN(1);
+    for (uint i= 0; (quick= it++); i++)
+    {
+      if (!(batch[i]= new (&alloc) ROR_ROWID_BATCH(quick, head->file)) ||
+          batch[i]->init(&alloc))
+        DBUG_RETURN(1);
+    }
+    /* Filtering one scan is enough to filter the intersection */
+    batch[0]->filter= cpk_quick;
+    batches= batch;
+    it.rewind();
+  }
+  for (uint i= 0; (quick= it++); i++)
+  {
     quick->reset();
+    if (batches)
+      batches[i]->reset();
+  }
   DBUG_RETURN(0);
 }
 
@@ -1495,7 +1519,7 @@ QUICK_ROR_INTERSECT_SELECT::~QUICK_ROR_INTERSECT_SELECT()
 
 QUICK_ROR_UNION_SELECT::QUICK_ROR_UNION_SELECT(THD *thd_param,
                                                TABLE *table)
-  : thd(thd_param), scans_inited(FALSE)
+  : thd(thd_param), batches(NULL), scans_inited(FALSE)
 {
   index= MAX_KEY;
   head= table;
@@ -1541,15 +1565,15 @@ int QUICK_ROR_UNION_SELECT::init()
   SYNPOSIS
     QUICK_ROR_UNION_SELECT::queue_cmp()
       arg   Pointer to QUICK_ROR_UNION_SELECT
-      val1  First merged select
-      val2  Second merged select
+      val1  Rowid buffer of first merged select
+      val2  Rowid buffer of second merged select
 */
 
 int QUICK_ROR_UNION_SELECT::queue_cmp(void *arg, uchar *val1, uchar *val2)
 {
   QUICK_ROR_UNION_SELECT *self= (QUICK_ROR_UNION_SELECT*)arg;
-  return self->head->file->cmp_ref(((QUICK_SELECT_I*)val1)->last_rowid,
-                                   ((QUICK_SELECT_I*)val2)->last_rowid);
+  return self->head->file->cmp_ref(((ROR_ROWID_BATCH*)val1)->cur,
+                                   ((ROR_ROWID_BATCH*)val2)->cur);
 }
 
 
@@ -1572,31 +1596,39 @@ int QUICK_ROR_UNION_SELECT::reset()
   if (!scans_inited)
   {
     List_iterator_fast<QUICK_SELECT_I> it(quick_selects);
-    while ((quick= it++))
+    ROR_ROWID_BATCH **batch;
+    if (!(batch= (ROR_ROWID_BATCH**)
+          alloc_root(&alloc, sizeof(ROR_ROWID_BATCH*) *
+                             quick_selects.elements)))
+      DBUG_RETURN(1);
+    for (uint i= 0; (quick= it++); i++)
     {
-      if (quick->init_ror_merged_scan(FALSE))
+      if (quick->init_ror_merged_scan(FALSE) ||
+          !(batch[i]= new (&alloc) ROR_ROWID_BATCH(quick, head->file)) ||
+          batch[i]->init(&alloc))
         DBUG_RETURN(1);
     }
+    batches= batch;
     scans_inited= TRUE;
   }
   queue_remove_all(&queue);
   /*
-    Initialize scans for merged quick selects and put all merged quick
-    selects into the queue.
+    Initialize scans for merged quick selects, read the first rowids of
+    each and put their buffers into the queue.
   */
   List_iterator_fast<QUICK_SELECT_I> it(quick_selects);
-  while ((quick= it++))
+  for (uint i= 0; (quick= it++); i++)
   {
     if (quick->reset())
       DBUG_RETURN(1);
-    if ((error= quick->get_next()))
+    batches[i]->reset();
+    if ((error= batches[i]->fill()))
     {
       if (error == HA_ERR_END_OF_FILE)
         continue;
       DBUG_RETURN(error);
     }
-    quick->save_last_pos();
-    queue_insert(&queue, (uchar*)quick);
+    queue_insert(&queue, (uchar*) batches[i]);
   }
 
   if (head->file->ha_rnd_init(1))
@@ -1627,6 +1659,110 @@ QUICK_ROR_UNION_SELECT::~QUICK_ROR_UNION_SELECT()
 }
 
 
+/*
+  Allocate the rowid buffer.
+  SYNOPSIS
+    ROR_ROWID_BATCH::init()
+      alloc  Memory pool of the merging quick select
+
+  RETURN
+    FALSE  OK
+    TRUE   Out of memory
+*/
+
+bool ROR_ROWID_BATCH::init(MEM_ROOT *alloc)
+{
+  if (!(rowids= (uchar*) alloc_root(alloc,
+                                    ROR_ROWID_BATCH_SIZE * rowid_length)))
+    return TRUE;
+  reset();
+  return FALSE;
+}
+
+
+/*
+  Read the next rowids of the merged scan into the buffer.
+  SYNOPSIS
+    ROR_ROWID_BATCH::fill()
+
+  RETURN
+    0                   OK, cur points to the first of the read rowids
+    HA_ERR_END_OF_FILE  The scan has no more rows
+    other               Error code
+*/
+
+int ROR_ROWID_BATCH::fill()
+{
+  uchar *buff_end= rowids + ROR_ROWID_BATCH_SIZE * rowid_length;
+  int error;
+  cur= end= rowids;
+  while (!eof && end != buff_end)
+  {
+    if ((error= quick->get_next()))
+    {
+      if (error != HA_ERR_END_OF_FILE)
+        return error;
+      eof= TRUE;
+      break;
+    }
+    if (filter && !filter->row_in_ranges())
+      continue;
+    quick->save_last_pos();
+    memcpy(end, quick->last_rowid, rowid_length);
+    end+= rowid_length;
+  }
+  return cur == end ? HA_ERR_END_OF_FILE : 0;
+}
+
+
+/*
+  Skip the rowids that are less than the given one.
+  SYNOPSIS
+    ROR_ROWID_BATCH::skip_to()
+      rowid  Rowid to skip to
+      cmp    OUT Result of comparison of the new current rowid with rowid
+
+  NOTES
+    Rowids in the buffer are sorted, so the buffer is skipped as a whole if
+    its last rowid is less than rowid, and binary searched otherwise.
+
+  RETURN
+    0                   OK
+    HA_ERR_END_OF_FILE  The scan has no more rows >= rowid
+    other               Error code
+*/
+
+int ROR_ROWID_BATCH::skip_to(const uchar *rowid, int *cmp)
+{
+  int error;
+  uint low, high;
+  for (;;)
+  {
+    if (cur == end && (error= fill()))
+      return error;
+    if ((*cmp= file->cmp_ref(cur, rowid)) >= 0)
+      return 0;
+    if (file->cmp_ref(end - rowid_length, rowid) >= 0)
+      break;
+    cur= end;
+  }
+  /* The first rowid is less than rowid and the last one is not */
+  low= 1;
+  high= (uint) ((end - cur) / rowid_length) - 1;
+  while (low < high)
+  {
+    uint mid= (low + high) / 2;
+    if (file->cmp_ref(cur + mid * rowid_length, rowid) < 0)
+      low= mid + 1;
+    else
+      high= mid;
+  }
+  cur+= low * rowid_length;
+  *cmp= file->cmp_ref(cur, rowid);
+  return 0;
+}
+
+
 QUICK_RANGE::QUICK_RANGE()
   :min_key(0),max_key(0),min_length(0),max_length(0),
    flag(NO_MIN_RANGE | NO_MAX_RANGE),
@@ -2129,6 +2265,56 @@ static int fill_used_fields_bitmap(PARAM *param)
 }
 
 
+/*
+  Write the indexes of the table that the range optimizer may use to the
+  optimizer trace.
+*/
+
+static void trace_potential_range_indexes(Opt_trace_context *trace,
+                                          TABLE *table, key_map *keys_to_use)
+{
+  Opt_trace_array trace_idx(trace, "potential_range_indexes");
+  if (!trace_idx.is_started())
+    return;
+  for (uint idx= 0; idx < table->s->keys; idx++)
+  {
+    Opt_trace_object trace_idx_details(trace);
+    trace_idx_details.add("index", table->key_info[idx].name);
+    if (!keys_to_use->is_set(idx))
+      trace_idx_details.add("usable", false).add("cause", "not_applicable");
+    else if (table->key_info[idx].flags & HA_FULLTEXT)
+      trace_idx_details.add("usable", false).add("cause", "fulltext");
+    else
+      trace_idx_details.add("usable", true);
+  }
+}
+
+
+/*
+  Write the quick select chosen by the range optimizer to the optimizer
+  trace.
+*/
+
+static void trace_quick_summary(Opt_trace_context *trace,
+                                QUICK_SELECT_I *quick, ha_rows records,
+                                double cost)
+{
+  static const char *type_names[]=
+  {
+    "range", "index_merge", "range", "fulltext",
+    "index_roworder_intersect", "index_roworder_union", "index_group"
+  };
+  Opt_trace_object trace_summary(trace, "chosen_range_access_summary");
+  if (!trace_summary.is_started())
+    return;
+  String key_names, used_lengths;
+  quick->add_keys_and_lengths(&key_names, &used_lengths);
+  trace_summary.add("access_type", type_names[quick->get_type()]).
+    add("index", key_names.c_ptr_safe()).add("rows", records).
+    add("cost", cost);
+}
+
+
 /*
   Test if a key can be used in different ranges
 
@@ -2201,6 +2387,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
 {
   uint idx;
   double scan_time;
+  Opt_trace_context * const trace= &thd->opt_trace;
   DBUG_ENTER("SQL_SELECT::test_quick_select");
   DBUG_PRINT("enter",("keys_to_use: %lu  prev_tables: %lu  const_tables: %lu",
 		      (ulong) keys_to_use.to_ulonglong(), (ulong) prev_tables,
@@ -2219,10 +2406,20 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
   read_time= (double) head->file->scan_time() + scan_time + 1.1;
   if (head->force_index)
     scan_time= read_time= DBL_MAX;
+
+  Opt_trace_object trace_range(trace, "range_analysis");
+  {
+    Opt_trace_object trace_scan(trace, "table_scan");
+    trace_scan.add("rows", head->file->stats.records).add("cost", read_time);
+  }
+
   if (limit < records)
     read_time= (double) records + scan_time + 1; // Force to use index
   else if (read_time <= 2.0 && !force_quick_range)
+  {
+    trace_range.add("chosen", false).add("cause", "table_scan_is_cheap");
     DBUG_RETURN(0);				/* No need for quick select */
+  }
 
   DBUG_PRINT("info",("Time to scan table: %g", read_time));
 
@@ -2274,6 +2471,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
       Make an array with description of all key parts of all table keys.
       This is used in get_mm_parts function.
     */
+    trace_potential_range_indexes(trace, head, &keys_to_use);
     key_info= head->key_info;
     for (idx=0 ; idx < head->s->keys ; idx++, key_info++)
     {
@@ -2313,8 +2511,16 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
                              (double) records / TIME_FOR_COMPARE);
       DBUG_PRINT("info",  ("'all'+'using index' scan will be using key %d, "
                            "read time %g", key_for_use, key_read_time));
+      Opt_trace_object trace_cov(trace, "best_covering_index_scan");
+      trace_cov.add("index", head->key_info[key_for_use].name).
+        add("cost", key_read_time);
       if (key_read_time < read_time)
+      {
         read_time= key_read_time;
+        trace_cov.add("chosen", true);
+      }
+      else
+        trace_cov.add("chosen", false).add("cause", "cost");
     }
 
     TABLE_READ_PLAN *best_trp= NULL;
@@ -2327,6 +2533,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
       {
         if (tree->type == SEL_TREE::IMPOSSIBLE)
         {
+          trace_range.add("impossible_range", true);
           records=0L;                      /* Return -1 from this function. */
           read_time= (double) HA_POS_ERROR;
           goto free_mem;
@@ -2367,6 +2574,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
         TRP_RANGE         *range_trp;
         TRP_ROR_INTERSECT *rori_trp;
         bool can_build_covering= FALSE;
+        Opt_trace_object trace_range_alt(trace, "analyzing_range_alternatives");
 
         /* Get best 'range' plan and prepare data for making other plans */
         if ((range_trp= get_key_scans_params(&param, tree, FALSE, TRUE,
@@ -2388,6 +2596,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
             Get best non-covering ROR-intersection plan and prepare data for
             building covering ROR-intersection.
           */
+          Opt_trace_object trace_ror(trace, "analyzing_roworder_intersect");
           if ((rori_trp= get_best_ror_intersect(&param, tree, best_read_time,
                                                 &can_build_covering)))
           {
@@ -2401,7 +2610,11 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
                 (rori_trp= get_best_covering_ror_intersect(&param, tree,
                                                            best_read_time)))
               best_trp= rori_trp;
+            trace_ror.add("rows", best_trp->records).
+              add("cost", best_trp->read_cost).add("chosen", true);
           }
+          else
+            trace_ror.add("chosen", false);
         }
       }
       else
@@ -2415,15 +2628,26 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
           DBUG_PRINT("info",("No range reads possible,"
                              " trying to construct index_merge"));
           List_iterator_fast<SEL_IMERGE> it(tree->merges);
+          Opt_trace_array trace_idx_merge(trace, "analyzing_index_merge");
           while ((imerge= it++))
           {
+            Opt_trace_object trace_imerge(trace);
             new_conj_trp= get_best_disjunct_quick(&param, imerge, best_read_time);
             if (new_conj_trp)
+            {
               set_if_smaller(param.table->quick_condition_rows, 
                              new_conj_trp->records);
+              trace_imerge.add("rows", new_conj_trp->records).
+                add("cost", new_conj_trp->read_cost);
+            }
             if (!best_conj_trp || (new_conj_trp && new_conj_trp->read_cost <
                                    best_conj_trp->read_cost))
+            {
               best_conj_trp= new_conj_trp;
+              trace_imerge.add("chosen", new_conj_trp != NULL);
+            }
+            else
+              trace_imerge.add("chosen", false);
           }
           if (best_conj_trp)
             best_trp= best_conj_trp;
@@ -2442,6 +2666,8 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
         delete quick;
         quick= NULL;
       }
+      else
+        trace_quick_summary(trace, quick, records, best_trp->read_cost);
     }
 
   free_mem:
@@ -3620,6 +3846,23 @@ double get_sweep_read_cost(const PARAM *param, ha_rows records)
 }
 
 
+/*
+  Check if rowids of the handler are equal only when they are byte-identical,
+  so that Unique can keep them in a hash table.
+
+  NOTES
+    Rowids built from the primary key are compared with the key collation.
+    The partition handler hides HA_PRIMARY_KEY_REQUIRED_FOR_POSITION of the
+    underlying handler, so assume the worst for it.
+*/
+
+static bool rowids_are_binary(handler *file)
+{
+  return !(file->ha_table_flags() & HA_PRIMARY_KEY_REQUIRED_FOR_POSITION) &&
+         file->ht->db_type != DB_TYPE_PARTITION_DB;
+}
+
+
 /*
   Get best plan for a SEL_IMERGE disjunctive expression.
   SYNOPSIS
@@ -3708,6 +3951,7 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
   double roru_index_costs;
   ha_rows roru_total_records;
   double roru_intersect_part= 1.0;
+  Opt_trace_context * const trace= &param->thd->opt_trace;
   DBUG_ENTER("get_best_disjunct_quick");
   DBUG_PRINT("info", ("Full table scan cost: %g", read_time));
 
@@ -3720,10 +3964,12 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
     analyze possibility of ROR scans. Also calculate some values needed by
     other parts of the code.
   */
+  Opt_trace_array trace_merge(trace, "indexes_to_merge");
   for (ptree= imerge->trees, cur_child= range_scans;
        ptree != imerge->trees_next;
        ptree++, cur_child++)
   {
+    Opt_trace_object trace_disjunct(trace);
     DBUG_EXECUTE("info", print_sel_tree(param, *ptree, &(*ptree)->keys_map,
                                         "tree in SEL_IMERGE"););
     if (!(*cur_child= get_key_scans_params(param, *ptree, TRUE, FALSE, read_time)))
@@ -3802,7 +4048,8 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
   unique_calc_buff_size=
     Unique::get_cost_calc_buff_size((ulong)non_cpk_scan_records,
                                     param->table->file->ref_length,
-                                    param->thd->variables.sortbuff_size);
+                                    param->thd->variables.sortbuff_size,
+                                    rowids_are_binary(param->table->file));
   if (param->imerge_cost_buff_size < unique_calc_buff_size)
   {
     if (!(param->imerge_cost_buff= (uint*)alloc_root(param->mem_root,
@@ -3814,7 +4061,8 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
   imerge_cost +=
     Unique::get_use_cost(param->imerge_cost_buff, (uint)non_cpk_scan_records,
                          param->table->file->ref_length,
-                         param->thd->variables.sortbuff_size);
+                         param->thd->variables.sortbuff_size,
+                         rowids_are_binary(param->table->file));
   DBUG_PRINT("info",("index_merge total cost: %g (wanted: less then %g)",
                      imerge_cost, read_time));
   if (imerge_cost < read_time)
@@ -4836,6 +5084,7 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
   ha_rows UNINIT_VAR(best_records);              /* protected by key_to_read */
   TRP_RANGE* read_plan= NULL;
   bool pk_is_clustered= param->table->file->primary_key_is_clustered();
+  Opt_trace_context * const trace= &param->thd->opt_trace;
   DBUG_ENTER("get_key_scans_params");
   /*
     Note that there may be trees that have type SEL_TREE::KEY but contain no
@@ -4846,6 +5095,7 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
                                       "tree scans"););
   tree->ror_scans_map.clear_all();
   tree->n_ror_scans= 0;
+  Opt_trace_array trace_idx(trace, "range_scan_alternatives");
   for (idx= 0,key=tree->keys, end=key+param->keys;
        key != end ;
        key++,idx++)
@@ -4855,6 +5105,8 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
     if (*key)
     {
       uint keynr= param->real_keynr[idx];
+      Opt_trace_object trace_alt(trace);
+      trace_alt.add("index", param->table->key_info[keynr].name);
       if ((*key)->type == SEL_ARG::MAYBE_KEY ||
           (*key)->maybe_flag)
         param->needed_reg->set_bit(keynr);
@@ -4896,13 +5148,19 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
       DBUG_PRINT("info",("key %s: found_read_time: %g (cur. read_time: %g)",
                          param->table->key_info[keynr].name, found_read_time,
                          read_time));
+      trace_alt.add("rowid_ordered", (bool) param->is_ror_scan).
+        add("index_only", read_index_only).
+        add("rows", found_records).add("cost", found_read_time);
 
       if (read_time > found_read_time && found_records != HA_POS_ERROR)
       {
+        trace_alt.add("chosen", true);
         read_time=    found_read_time;
         best_records= found_records;
         key_to_read=  key;
       }
+      else
+        trace_alt.add("chosen", false).add("cause", "cost");
 
     }
   }
@@ -5066,6 +5324,216 @@ static SEL_TREE *get_ne_mm_tree(RANGE_OPT_PARAM *param, Item_func *cond_func,
 }
    
 
+static int cmp_sel_arg_min(void *arg, SEL_ARG **a, SEL_ARG **b)
+{
+  return (*a)->cmp_min_to_min(*b);
+}
+
+
+/*
+  Link sorted, disjoint intervals into a balanced red-black tree
+
+  SYNOPSIS
+    build_rb_tree()
+      elements    intervals in key order
+      count       number of intervals
+      depth       depth of the subtree root in the whole tree
+      red_depth   depth of the last, possibly incomplete, level
+      parent      parent of the subtree root
+
+  DESCRIPTION
+    The middle interval becomes the root of each subtree, so all levels
+    but the last one are full. Nodes on the last level are red and all
+    others are black, which gives every path the same black height.
+    The next/prev list is not touched.
+
+  RETURN
+    Root of the subtree
+*/
+
+static SEL_ARG *build_rb_tree(SEL_ARG **elements, uint count, uint depth,
+                              uint red_depth, SEL_ARG *parent)
+{
+  if (!count)
+    return &null_element;
+  uint mid= count / 2;
+  SEL_ARG *root= elements[mid];
+  root->parent= parent;
+  root->color= depth == red_depth ? SEL_ARG::RED : SEL_ARG::BLACK;
+  root->left= build_rb_tree(elements, mid, depth + 1, red_depth, root);
+  root->right= build_rb_tree(elements + mid + 1, count - mid - 1, depth + 1,
+                             red_depth, root);
+  return root;
+}
+
+
+/*
+  Build a SEL_TREE for "t.key IN (c1, c2, ...)" with constant c{i}
+
+  SYNOPSIS
+    get_in_list_mm_tree()
+      param       PARAM from SQL_SELECT::test_quick_select
+      func        item for the predicate, func->array holds the values
+      field       field in the predicate
+      fallback    OUT TRUE <=> the tree must be built as the OR of the
+                  trees for "t.key = c{i}" instead
+
+  DESCRIPTION
+    Building the tree as "(t.key = c1) OR (t.key = c2) OR ..." costs a
+    SEL_TREE and a key_or() per value, which dominates the range analysis
+    of long lists. Here we get the interval of every distinct value from
+    the sorted array and link the intervals of each key into a balanced
+    tree in one go. Lists of more than SEL_ARG::MAX_SEL_ARGS values, which
+    would give a key more intervals than that, are left to the OR of the
+    trees.
+
+  RETURN
+    Pointer to the built tree
+    0  if no range can be used
+*/
+
+static SEL_TREE *get_in_list_mm_tree(RANGE_OPT_PARAM *param,
+                                     Item_func_in *func, Field *field,
+                                     bool *fallback)
+{
+  in_vector *array= func->array;
+  KEY_PART *key_parts[MAX_KEY];
+  SEL_ARG *leaves[MAX_KEY];
+  SEL_ARG **points;
+  uint n_points[MAX_KEY];
+  bool usable[MAX_KEY];
+  uint parts= 0, i, j;
+  DBUG_ENTER("get_in_list_mm_tree");
+
+  *fallback= FALSE;
+  if (field->table != param->table)
+    DBUG_RETURN(0);
+  for (KEY_PART *key_part= param->key_parts; key_part != param->key_parts_end;
+       key_part++)
+  {
+    if (!field->eq(key_part->field))
+      continue;
+    if (parts && key_parts[parts - 1]->key == key_part->key)
+    {
+      /* The field is in several parts of the key, let key_or() merge them */
+      *fallback= TRUE;
+      DBUG_RETURN(0);
+    }
+    usable[parts]= TRUE;
+    n_points[parts]= 0;
+    key_parts[parts++]= key_part;
+  }
+  if (!parts)
+    DBUG_RETURN(0);
+  if (array->used_count > SEL_ARG::MAX_SEL_ARGS)
+  {
+    *fallback= TRUE;
+    DBUG_RETURN(0);
+  }
+
+  /* See the comment about value_item for NOT IN in get_func_mm_tree() */
+  MEM_ROOT *tmp_root= param->mem_root;
+  param->thd->mem_root= param->old_root;
+  Item *value_item= array->create_item();
+  param->thd->mem_root= tmp_root;
+  if (!value_item ||
+      !(points= (SEL_ARG**) alloc_root(param->mem_root, sizeof(SEL_ARG*) *
+                                       array->used_count * parts)))
+    DBUG_RETURN(0);
+
+  for (i= 0; i < array->used_count; i++)
+  {
+    if (i && !array->compare_elems(i, i - 1))
+      continue;                                 // Duplicate value
+    array->value_to_item(i, value_item);
+    bool impossible= FALSE;
+    for (j= 0; j < parts && !impossible; j++)
+    {
+      if (!usable[j])
+        continue;
+      SEL_ARG *leaf= get_mm_leaf(param, func, key_parts[j]->field,
+                                 key_parts[j], Item_func::EQ_FUNC,
+                                 value_item);
+      if (param->thd->is_fatal_error)
+        DBUG_RETURN(0);                         // out of memory
+      if (leaf && leaf->type == SEL_ARG::IMPOSSIBLE)
+        impossible= TRUE;                       // No row has this value
+      else if (leaf && leaf->type != SEL_ARG::KEY_RANGE)
+      {
+        *fallback= TRUE;
+        DBUG_RETURN(0);
+      }
+      leaves[j]= leaf;
+    }
+    if (impossible)
+      continue;
+    for (j= 0; j < parts; j++)
+    {
+      if (!usable[j])
+        continue;
+      if (!leaves[j])
+        usable[j]= FALSE;                       // The key can't be used
+      else
+        points[j * array->used_count + n_points[j]++]= leaves[j];
+    }
+  }
+
+  SEL_TREE *tree= 0;
+  for (j= 0; j < parts; j++)
+  {
+    if (!usable[j])
+      continue;
+    if (!tree && !(tree= new SEL_TREE()))
+      DBUG_RETURN(0);                           // OOM
+    uint count= n_points[j], distinct= 1;
+    if (!count)
+    {
+      tree->type= SEL_TREE::IMPOSSIBLE;         // All values are impossible
+      DBUG_RETURN(tree);
+    }
+    SEL_ARG **key_points= points + j * array->used_count;
+    my_qsort2(key_points, count, sizeof(SEL_ARG*),
+              (qsort2_cmp) cmp_sel_arg_min, NULL);
+    uint8 maybe_flag= key_points[0]->maybe_flag;
+    for (i= 1; i < count; i++)
+    {
+      SEL_ARG *last= key_points[distinct - 1];
+      maybe_flag|= key_points[i]->maybe_flag;
+      if (key_points[i]->is_same(last))
+        continue;                     // Values that are equal in the key
+      if (last->cmp_max_to_min(key_points[i]) >= 0)
+      {
+        *fallback= TRUE;              // Overlapping intervals
+        DBUG_RETURN(0);
+      }
+      key_points[distinct++]= key_points[i];
+    }
+
+    SEL_ARG *prev= 0;
+    for (i= 0; i < distinct; i++)
+    {
+      key_points[i]->part= (uchar) key_parts[j]->part;
+      key_points[i]->prev= prev;
+      key_points[i]->next= 0;
+      if (prev)
+        prev->next= key_points[i];
+      prev= key_points[i];
+    }
+    uint red_depth= 0;
+    while ((2U << red_depth) <= distinct + 1)
+      red_depth++;
+    SEL_ARG *root= build_rb_tree(key_points, distinct, 0, red_depth, 0);
+    root->use_count= 1;
+    root->elements= distinct;
+    root->maybe_flag= maybe_flag;
+    test_rb_tree(root, root->parent);
+    tree->keys[key_parts[j]->key]= root;
+    tree->keys_map.set_bit(key_parts[j]->key);
+  }
+  DBUG_RETURN(tree);
+}
+
+
 /*
   Build a SEL_TREE for a simple predicate
  
@@ -5271,6 +5739,18 @@ static SEL_TREE *get_func_mm_tree(RANGE_OPT_PARAM *param, Item_func *cond_func,
     }
     else
     {    
+      /*
+        The elements of the array can be passed to get_mm_leaf() instead
+        of the arguments if they are items of the same result type.
+      */
+      if (func->array && func->array->result_type() != ROW_RESULT &&
+          func->array->result_type() == func->arguments()[1]->result_type())
+      {
+        bool fallback;
+        tree= get_in_list_mm_tree(param, func, field, &fallback);
+        if (!fallback)
+          break;
+      }
       tree= get_mm_parts(param, cond_func, field, Item_func::EQ_FUNC,
                          func->arguments()[1], cmp_type);
       if (tree)
@@ -8184,7 +8664,8 @@ int QUICK_INDEX_MERGE_SELECT::read_keys_and_merge()
 
     unique= new Unique(refpos_order_cmp, (void *)file,
                        file->ref_length,
-                       thd->variables.sortbuff_size);
+                       thd->variables.sortbuff_size,
+                       rowids_are_binary(file));
   }
   else
     unique->reset();
@@ -8311,6 +8792,9 @@ int QUICK_ROR_INTERSECT_SELECT::get_next()
   uint last_rowid_count=0;
   DBUG_ENTER("QUICK_ROR_INTERSECT_SELECT::get_next");
 
+  if (batches)
+    DBUG_RETURN(get_next_batched());
+
   do
   {
     /* Get a rowid for first quick and save it as a 'candidate' */
@@ -8375,6 +8859,67 @@ int QUICK_ROR_INTERSECT_SELECT::get_next()
 }
 
 
+/*
+  Retrieve next record, intersecting buffered rowids of the merged scans.
+  SYNOPSIS
+     QUICK_ROR_INTERSECT_SELECT::get_next_batched()
+
+  NOTES
+    This does the same as get_next(), but the merged scans are read into
+    ROR_ROWID_BATCHes and only the rowids of the first scan are filtered by
+    cpk_quick.
+
+  RETURN
+   0     - Ok
+   other - Error code if any error occurred.
+*/
+
+int QUICK_ROR_INTERSECT_SELECT::get_next_batched()
+{
+  ROR_ROWID_BATCH *batch;
+  uint n_batches= quick_selects.elements;
+  uint i, last_rowid_count;
+  int error, cmp;
+  DBUG_ENTER("QUICK_ROR_INTERSECT_SELECT::get_next_batched");
+
+  do
+  {
+    /* Get a rowid from the first scan and save it as a 'candidate' */
+    batch= batches[0];
+    if (batch->cur == batch->end && (error= batch->fill()))
+      DBUG_RETURN(error);
+    memcpy(last_rowid, batch->cur, head->file->ref_length);
+    batch->cur+= batch->rowid_length;
+    last_rowid_count= 1;
+
+    for (i= 0; last_rowid_count < n_batches; )
+    {
+      if (++i == n_batches)
+        i= 0;
+      batch= batches[i];
+      if ((error= batch->skip_to(last_rowid, &cmp)))
+        DBUG_RETURN(error);
+      if (cmp > 0)
+      {
+        /* Found a row with ref > cur_ref. Make it a new 'candidate' */
+        memcpy(last_rowid, batch->cur, head->file->ref_length);
+        last_rowid_count= 1;
+      }
+      else
+      {
+        /* current 'candidate' row confirmed by this select */
+        last_rowid_count++;
+      }
+      batch->cur+= batch->rowid_length;
+    }
+
+    /* We get here if we got the same row ref in all scans. */
+    error= head->file->rnd_pos(head->record[0], last_rowid);
+  } while (error == HA_ERR_RECORD_DELETED);
+  DBUG_RETURN(error);
+}
+
+
 /*
   Retrieve next record.
   SYNOPSIS
@@ -8382,7 +8927,7 @@ int QUICK_ROR_INTERSECT_SELECT::get_next()
 
   NOTES
     Enter/exit invariant:
-    For each quick select in the queue a {key,rowid} tuple has been
+    For each rowid buffer in the queue the current rowid has been
     retrieved but the corresponding row hasn't been passed to output.
 
   RETURN
@@ -8393,7 +8938,7 @@ int QUICK_ROR_INTERSECT_SELECT::get_next()
 int QUICK_ROR_UNION_SELECT::get_next()
 {
   int error, dup_row;
-  QUICK_SELECT_I *quick;
+  ROR_ROWID_BATCH *batch;
   uchar *tmp;
   DBUG_ENTER("QUICK_ROR_UNION_SELECT::get_next");
 
@@ -8405,21 +8950,19 @@ int QUICK_ROR_UNION_SELECT::get_next()
         DBUG_RETURN(HA_ERR_END_OF_FILE);
       /* Ok, we have a queue with >= 1 scans */
 
-      quick= (QUICK_SELECT_I*)queue_top(&queue);
-      memcpy(cur_rowid, quick->last_rowid, rowid_length);
+      batch= (ROR_ROWID_BATCH*)queue_top(&queue);
+      memcpy(cur_rowid, batch->cur, rowid_length);
 
       /* put into queue rowid from the same stream as top element */
-      if ((error= quick->get_next()))
+      batch->cur+= rowid_length;
+      if (batch->cur == batch->end && (error= batch->fill()))
       {
         if (error != HA_ERR_END_OF_FILE)
           DBUG_RETURN(error);
         queue_remove(&queue, 0);
       }
       else
-      {
-        quick->save_last_pos();
         queue_replaced(&queue);
-      }
 
       if (!have_prev_rowid)
       {
@@ -8435,7 +8978,7 @@ int QUICK_ROR_UNION_SELECT::get_next()
     cur_rowid= prev_rowid;
     prev_rowid= tmp;
 
-    error= head->file->rnd_pos(quick->record, prev_rowid);
+    error= head->file->rnd_pos(head->record[0], prev_rowid);
   } while (error == HA_ERR_RECORD_DELETED);
   DBUG_RETURN(error);
 }
@@ -9307,18 +9850,31 @@ get_best_group_min_max(PARAM *param, SEL_TREE *tree)
   ORDER *tmp_group;
   Item *item;
   Item_field *item_field;
+  Opt_trace_context * const trace= &thd->opt_trace;
   DBUG_ENTER("get_best_group_min_max");
 
   /* Perform few 'cheap' tests whether this access method is applicable. */
   if (!join)
     DBUG_RETURN(NULL);        /* This is not a select statement. */
-  if ((join->tables != 1) ||  /* The query must reference one table. */
-      ((!join->group_list) && /* Neither GROUP BY nor a DISTINCT query. */
+  Opt_trace_object trace_group(trace, "group_index_range");
+  if (join->tables != 1)      /* The query must reference one table. */
+  {
+    trace_group.add("chosen", false).add("cause", "not_single_table");
+    DBUG_RETURN(NULL);
+  }
+  if (((!join->group_list) && /* Neither GROUP BY nor a DISTINCT query. */
        (!join->select_distinct)) ||
       (join->select_lex->olap == ROLLUP_TYPE)) /* Check (B3) for ROLLUP */
+  {
+    trace_group.add("chosen", false).
+      add("cause", "not_group_by_or_distinct");
     DBUG_RETURN(NULL);
+  }
   if (table->s->keys == 0)        /* There are no indexes to use. */
+  {
+    trace_group.add("chosen", false).add("cause", "no_index");
     DBUG_RETURN(NULL);
+  }
 
   /* Analyze the query in more detail. */
   List_iterator<Item> select_items_it(join->fields_list);
@@ -9337,7 +9893,11 @@ get_best_group_min_max(PARAM *param, SEL_TREE *tree)
       else if (min_max_item->sum_func() == Item_sum::MAX_FUNC)
         have_max= TRUE;
       else
+      {
+        trace_group.add("chosen", false).
+          add("cause", "not_applicable_aggregate_function");
         DBUG_RETURN(NULL);
+      }
 
       /* The argument of MIN/MAX. */
       Item *expr= min_max_item->get_arg(0)->real_item();
@@ -9377,6 +9937,7 @@ get_best_group_min_max(PARAM *param, SEL_TREE *tree)
   */
   KEY *cur_index_info= table->key_info;
   KEY *cur_index_info_end= cur_index_info + table->s->keys;
+  Opt_trace_array trace_indexes(trace, "potential_group_range_indexes");
   /* Cost-related variables for the best index so far. */
   double best_read_cost= DBL_MAX;
   ha_rows best_records= 0;
@@ -9407,6 +9968,9 @@ get_best_group_min_max(PARAM *param, SEL_TREE *tree)
     uint cur_key_infix_len= 0;
     uchar cur_key_infix[MAX_KEY_LENGTH];
     uint cur_used_key_parts;
+    bool cur_index_usable= FALSE;
+    Opt_trace_object trace_idx(trace);
+    trace_idx.add("index", cur_index_info->name);
     
     /* Check (B1) - if current index is covering. */
     if (!table->covering_keys.is_set(cur_index))
@@ -9631,6 +10195,9 @@ get_best_group_min_max(PARAM *param, SEL_TREE *tree)
                        cur_group_key_parts, tree, cur_index_tree,
                        cur_quick_prefix_records, have_min, have_max,
                        &cur_read_cost, &cur_records);
+    cur_index_usable= TRUE;
+    trace_idx.add("usable", true).add("rows", cur_records).
+      add("cost", cur_read_cost);
     /*
       If cur_read_cost is lower than best_read_cost use cur_index.
       Do not compare doubles directly because they may have different
@@ -9653,17 +10220,26 @@ get_best_group_min_max(PARAM *param, SEL_TREE *tree)
       used_key_parts= cur_used_key_parts;
     }
 
-  next_index:;
+  next_index:
+    if (!cur_index_usable)
+      trace_idx.add("usable", false);
   }
+  trace_indexes.end();
   if (!index_info) /* No usable index found. */
+  {
+    trace_group.add("chosen", false).add("cause", "no_usable_index");
     DBUG_RETURN(NULL);
+  }
 
   /* Check (SA3) for the where clause. */
   if (join->conds && min_max_arg_item &&
       !check_group_min_max_predicates(join->conds, min_max_arg_item,
                                       (index_info->flags & HA_SPATIAL) ?
                                       Field::itMBR : Field::itRAW))
+  {
+    trace_group.add("chosen", false).add("cause", "unsupported_predicate");
     DBUG_RETURN(NULL);
+  }
 
   /* The query passes all tests, so construct a new TRP object. */
   read_plan= new (param->mem_root)
@@ -9681,6 +10257,8 @@ get_best_group_min_max(PARAM *param, SEL_TREE *tree)
 
     read_plan->read_cost= best_read_cost;
     read_plan->records=   best_records;
+    trace_group.add("index", index_info->name).add("rows", best_records).
+      add("cost", best_read_cost);
 
     DBUG_PRINT("info",
                ("Returning group min/max plan: cost: %g, records: %lu",
@@ -392,6 +392,7 @@ protected:
   friend class QUICK_INDEX_MERGE_SELECT;
   friend class QUICK_ROR_INTERSECT_SELECT;
   friend class QUICK_GROUP_MIN_MAX_SELECT;
+  friend class ROR_ROWID_BATCH;
 
   DYNAMIC_ARRAY ranges;     /* ordered array of range ptrs */
   QUICK_RANGE **cur_range;  /* current element in ranges  */
@@ -543,6 +544,40 @@ public:
 };
 
 
+/*
+  Rowids read ahead from one of the scans merged by a ROR index_merge.
+
+  The merged scans are read ROR_ROWID_BATCH_SIZE rowids at a time, so
+  that the handler calls of different scans do not interleave row by row,
+  and the rowids are merged in memory.
+*/
+
+#define ROR_ROWID_BATCH_SIZE 256
+
+class ROR_ROWID_BATCH : public Sql_alloc
+{
+public:
+  QUICK_SELECT_I *quick;      /* Scan the rowids are read from */
+  QUICK_RANGE_SELECT *filter; /* If set, skip rows outside of its ranges */
+  handler *file;              /* Handler used to compare rowids */
+  uint rowid_length;
+  uchar *rowids;              /* Buffer for ROR_ROWID_BATCH_SIZE rowids */
+  uchar *cur;                 /* Current rowid */
+  uchar *end;                 /* End of rowids read into the buffer */
+  bool eof;                   /* TRUE <=> quick has no more rows */
+
+  ROR_ROWID_BATCH(QUICK_SELECT_I *quick_arg, handler *file_arg)
+    :quick(quick_arg), filter(NULL), file(file_arg),
+     rowid_length(file_arg->ref_length), rowids(NULL), cur(NULL), end(NULL),
+     eof(FALSE)
+  {}
+  bool init(MEM_ROOT *alloc);
+  int fill();
+  int skip_to(const uchar *rowid, int *cmp);
+  void reset() { cur= end= rowids; eof= FALSE; }
+};
+
+
 /*
   Rowid-Ordered Retrieval (ROR) index intersection quick select.
   This quick select produces intersection of row sequences returned
@@ -601,6 +636,14 @@ public:
   bool need_to_fetch_row; /* if true, do retrieve full table records. */
   /* in top-level quick select, true if merged scans where initialized */
   bool scans_inited; 
+  /*
+    Rowid buffers of quick_selects, used if need_to_fetch_row is set. If
+    the rows are not fetched the fields read by the merged scans are
+    returned, so the scans must stay on the current row.
+  */
+  ROR_ROWID_BATCH **batches;
+private:
+  int get_next_batched();
 };
 
 
@@ -640,7 +683,7 @@ public:
 
   List<QUICK_SELECT_I> quick_selects; /* Merged quick selects */
 
-  QUEUE queue;    /* Priority queue for merge operation */
+  QUEUE queue;    /* Priority queue of ROR_ROWID_BATCHes for merge operation */
   MEM_ROOT alloc; /* Memory pool for this and merged quick selects data. */
 
   THD *thd;             /* current thread */
@@ -648,6 +691,7 @@ public:
   uchar *prev_rowid;     /* rowid of last row returned by get_next() */
   bool have_prev_rowid; /* true if prev_rowid has valid data */
   uint rowid_length;    /* table rowid length */
+  ROR_ROWID_BATCH **batches; /* Rowid buffers of quick_selects */
 private:
   static int queue_cmp(void *arg, uchar *val1, uchar *val2);
   bool scans_inited; 
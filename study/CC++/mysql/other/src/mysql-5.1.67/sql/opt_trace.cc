@@ -0,0 +1,295 @@
+/* Copyright (c) 2000, 2012, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/**
+  @file
+
+  Optimizer trace: writing of the JSON text and
+  INFORMATION_SCHEMA.OPTIMIZER_TRACE.
+*/
+
+#include "mysql_priv.h"
+
+
+/**
+  Start tracing the current statement of thd if it should be traced.
+
+  Only statements which run the optimizer are traced, and not those
+  which read INFORMATION_SCHEMA.OPTIMIZER_TRACE, as that would replace
+  the trace being read.  Statements executed while a trace is started,
+  e.g. those of a stored routine, are traced as part of it.
+
+  @return TRUE if the trace was started by this call; the caller must
+          then call end() when the statement is done
+*/
+
+bool Opt_trace_context::start(THD *thd)
+{
+  LEX *lex= thd->lex;
+  DBUG_ENTER("Opt_trace_context::start");
+
+  if (started || !thd->variables.optimizer_trace)
+    DBUG_RETURN(FALSE);
+
+  switch (lex->sql_command) {
+  case SQLCOM_SELECT:
+  case SQLCOM_INSERT:
+  case SQLCOM_INSERT_SELECT:
+  case SQLCOM_REPLACE:
+  case SQLCOM_REPLACE_SELECT:
+  case SQLCOM_UPDATE:
+  case SQLCOM_UPDATE_MULTI:
+  case SQLCOM_DELETE:
+  case SQLCOM_DELETE_MULTI:
+  case SQLCOM_CALL:
+    break;
+  default:
+    DBUG_RETURN(FALSE);
+  }
+
+  ST_SCHEMA_TABLE *trace_table= get_schema_table(SCH_OPTIMIZER_TRACE);
+  for (TABLE_LIST *table= lex->query_tables; table; table= table->next_global)
+  {
+    if (table->schema_table == trace_table)
+      DBUG_RETURN(FALSE);
+  }
+
+  max_mem_size= thd->variables.optimizer_trace_max_mem_size;
+  missing_bytes= 0;
+  need_comma= FALSE;
+  trace.length(0);
+  stack.length(0);
+  query.copy(thd->query(), thd->query_length(), thd->charset());
+  started= TRUE;
+
+  begin_struct(NULL, '{');
+  begin_struct("steps", '[');
+  DBUG_RETURN(TRUE);
+}
+
+
+void Opt_trace_context::end()
+{
+  DBUG_ASSERT(started && !disabled);
+  while (stack.length())
+    end_struct();
+  started= FALSE;
+}
+
+
+/**
+  Append to the trace, or only count the bytes once the trace has
+  reached optimizer_trace_max_mem_size.
+*/
+
+void Opt_trace_context::append(const char *str, size_t length)
+{
+  if (missing_bytes || trace.length() + length > max_mem_size)
+    missing_bytes+= length;
+  else
+    trace.append(str, (uint32) length);
+}
+
+
+void Opt_trace_context::append_escaped(const char *str, size_t length)
+{
+  const char *end= str + length;
+  const char *from= str;
+
+  for (; str < end; str++)
+  {
+    const char *escape;
+    char buff[8];
+    uchar c= (uchar) *str;
+
+    if (c == '"')
+      escape= "\\\"";
+    else if (c == '\\')
+      escape= "\\\\";
+    else if (c == '\n')
+      escape= "\\n";
+    else if (c == '\t')
+      escape= "\\t";
+    else if (c < 0x20)
+    {
+      sprintf(buff, "\\u%04x", (uint) c);
+      escape= buff;
+    }
+    else
+      continue;
+    append(from, str - from);
+    append(escape, strlen(escape));
+    from= str + 1;
+  }
+  append(from, str - from);
+}
+
+
+void Opt_trace_context::append_indent()
+{
+  uint spaces= 2 * stack.length();
+  append("\n", 1);
+  while (spaces)
+  {
+    static const char blanks[]= "                ";
+    uint length= min(spaces, (uint) sizeof(blanks) - 1);
+    append(blanks, length);
+    spaces-= length;
+  }
+}
+
+
+/**
+  Write what precedes a value: the separator, the indentation and the
+  key.  A keyed value inside an array is wrapped in an object of its own,
+  so that callers need not know what they are nested in.
+*/
+
+void Opt_trace_context::begin_value(const char *key)
+{
+  if (need_comma)
+    append(",", 1);
+  if (stack.length())
+    append_indent();
+  if (key && stack.length() && stack[stack.length() - 1] == '[')
+  {
+    append("{", 1);
+    stack.append('w');
+    append_indent();
+  }
+  if (key)
+  {
+    append("\"", 1);
+    append_escaped(key, strlen(key));
+    append("\": ", 3);
+  }
+}
+
+
+void Opt_trace_context::begin_struct(const char *key, char bracket)
+{
+  begin_value(key);
+  append(&bracket, 1);
+  stack.append(bracket);
+  need_comma= FALSE;
+}
+
+
+void Opt_trace_context::end_struct()
+{
+  DBUG_ASSERT(stack.length());
+  char bracket= stack[stack.length() - 1];
+  stack.length(stack.length() - 1);
+  append_indent();
+  append(bracket == '[' ? "]" : "}", 1);
+  need_comma= TRUE;
+  if (stack.length() && stack[stack.length() - 1] == 'w')
+    end_struct();
+}
+
+
+void Opt_trace_context::add(const char *key, const char *value,
+                            size_t length, bool quote)
+{
+  begin_value(key);
+  if (quote)
+  {
+    append("\"", 1);
+    append_escaped(value, length);
+    append("\"", 1);
+  }
+  else
+    append(value, length);
+  need_comma= TRUE;
+  if (stack.length() && stack[stack.length() - 1] == 'w')
+  {
+    stack.length(stack.length() - 1);
+    append_indent();
+    append("}", 1);
+  }
+}
+
+
+Opt_trace_struct &Opt_trace_struct::add(const char *key, longlong value)
+{
+  if (ctx)
+  {
+    char buff[22];
+    char *end= longlong10_to_str(value, buff, -10);
+    ctx->add(key, buff, end - buff, FALSE);
+  }
+  return *this;
+}
+
+
+Opt_trace_struct &Opt_trace_struct::add(const char *key, ulonglong value)
+{
+  if (ctx)
+  {
+    char buff[22];
+    char *end= longlong10_to_str((longlong) value, buff, 10);
+    ctx->add(key, buff, end - buff, FALSE);
+  }
+  return *this;
+}
+
+
+Opt_trace_struct &Opt_trace_struct::add(const char *key, double value)
+{
+  if (ctx)
+  {
+    char buff[FLOATING_POINT_BUFFER];
+    uint length= (uint) sprintf(buff, "%.6g", value);
+    ctx->add(key, buff, length, FALSE);
+  }
+  return *this;
+}
+
+
+/*****************************************************************************
+  INFORMATION_SCHEMA.OPTIMIZER_TRACE
+*****************************************************************************/
+
+ST_FIELD_INFO optimizer_trace_info[]=
+{
+  {"QUERY", 65535, MYSQL_TYPE_STRING, 0, 0, "", SKIP_OPEN_TABLE},
+  {"TRACE", 65535, MYSQL_TYPE_STRING, 0, 0, "", SKIP_OPEN_TABLE},
+  {"MISSING_BYTES_BEYOND_MAX_MEM_SIZE", 20, MYSQL_TYPE_LONGLONG, 0, 0, "",
+   SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+
+/**
+  Show the trace of the last traced statement of the session.
+*/
+
+int fill_optimizer_trace_info(THD *thd, TABLE_LIST *tables, Item *cond)
+{
+  TABLE *table= tables->table;
+  Opt_trace_context *ctx= &thd->opt_trace;
+  DBUG_ENTER("fill_optimizer_trace_info");
+
+  if (!ctx->get_trace()->length())
+    DBUG_RETURN(0);
+
+  restore_record(table, s->default_values);
+  table->field[0]->store(ctx->get_query()->ptr(), ctx->get_query()->length(),
+                         ctx->get_query()->charset());
+  table->field[1]->store(ctx->get_trace()->ptr(), ctx->get_trace()->length(),
+                         system_charset_info);
+  table->field[2]->store((longlong) ctx->get_missing_bytes(), TRUE);
+  DBUG_RETURN(schema_table_store_record(thd, table));
+}
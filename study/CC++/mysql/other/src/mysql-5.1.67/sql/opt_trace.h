@@ -0,0 +1,201 @@
+/* Copyright (c) 2000, 2012, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef OPT_TRACE_INCLUDED
+#define OPT_TRACE_INCLUDED
+
+/**
+  @file
+
+  Optimizer trace.
+
+  When the session variable optimizer_trace is set, the decisions taken
+  by the range optimizer and by the join order search of a statement are
+  recorded as JSON text.  The trace of the last traced statement is
+  kept in the THD and can be read from INFORMATION_SCHEMA.OPTIMIZER_TRACE.
+  Its size is limited by optimizer_trace_max_mem_size; what does not fit
+  is counted but not kept.
+
+  The optimizer writes the trace through Opt_trace_object and
+  Opt_trace_array, which open a JSON object or array in their
+  constructor and close it in their destructor:
+
+  @code
+    Opt_trace_context * const trace= &thd->opt_trace;
+    Opt_trace_object trace_table(trace);
+    trace_table.add("table", table->alias).add("rows", records);
+  @endcode
+
+  When the statement is not traced all of them are no-ops.
+*/
+
+class THD;
+struct TABLE_LIST;
+
+extern ST_FIELD_INFO optimizer_trace_info[];
+int fill_optimizer_trace_info(THD *thd, TABLE_LIST *tables, Item *cond);
+
+
+/**
+  The trace of one statement and the state needed to write it.
+*/
+
+class Opt_trace_context
+{
+public:
+  Opt_trace_context() :max_mem_size(0), missing_bytes(0), disabled(0),
+                       started(FALSE), need_comma(FALSE) {}
+
+  bool start(THD *thd);
+  void end();
+
+  /** TRUE if what is written now goes into the trace */
+  bool is_started() const { return started && !disabled; }
+
+  /**
+    Stop tracing for a while, e.g. during execution where the range
+    optimizer may be called for every row.  Calls nest.
+  */
+  void disable() { disabled++; }
+  void enable()  { disabled--; }
+
+  void begin_struct(const char *key, char bracket);
+  void end_struct();
+  void add(const char *key, const char *value, size_t length, bool quote);
+
+  const String *get_query() const { return &query; }
+  const String *get_trace() const { return &trace; }
+  ulonglong get_missing_bytes() const { return missing_bytes; }
+
+private:
+  void begin_value(const char *key);
+  void append(const char *str, size_t length);
+  void append_escaped(const char *str, size_t length);
+  void append_indent();
+
+  String query;                         /* Text of the traced statement */
+  String trace;                         /* The JSON text so far */
+  /*
+    One character per open struct: '{' or '[', or 'w' below a '{' which
+    was opened only to give a key to a value added inside an array.
+  */
+  String stack;
+  ulong max_mem_size;
+  ulonglong missing_bytes;
+  uint disabled;
+  bool started;
+  bool need_comma;
+};
+
+
+/**
+  A JSON object or array in the trace.  The destructor closes it, so the
+  struct must not outlive the function which opened it.
+*/
+
+class Opt_trace_struct
+{
+protected:
+  Opt_trace_struct(Opt_trace_context *ctx_arg, const char *key,
+                   char bracket)
+    :ctx(ctx_arg->is_started() ? ctx_arg : NULL)
+  {
+    if (ctx)
+      ctx->begin_struct(key, bracket);
+  }
+  ~Opt_trace_struct()
+  {
+    if (ctx)
+      ctx->end_struct();
+  }
+
+public:
+  Opt_trace_struct &add(const char *key, const char *value)
+  {
+    if (ctx)
+      ctx->add(key, value, strlen(value), TRUE);
+    return *this;
+  }
+  Opt_trace_struct &add(const char *key, bool value)
+  {
+    if (ctx)
+      ctx->add(key, value ? "true" : "false", value ? 4 : 5, FALSE);
+    return *this;
+  }
+  Opt_trace_struct &add(const char *key, int value)
+  { return add(key, (longlong) value); }
+  Opt_trace_struct &add(const char *key, uint value)
+  { return add(key, (ulonglong) value); }
+  Opt_trace_struct &add(const char *key, ulong value)
+  { return add(key, (ulonglong) value); }
+  Opt_trace_struct &add(const char *key, longlong value);
+  Opt_trace_struct &add(const char *key, ulonglong value);
+  Opt_trace_struct &add(const char *key, double value);
+  /** Adds a string element to an array */
+  Opt_trace_struct &add(const char *value)
+  { return add((const char *) NULL, value); }
+
+  bool is_started() const { return ctx != NULL; }
+
+  /** Close the struct before it goes out of scope */
+  void end()
+  {
+    if (ctx)
+      ctx->end_struct();
+    ctx= NULL;
+  }
+
+private:
+  Opt_trace_context *ctx;
+};
+
+
+class Opt_trace_object :public Opt_trace_struct
+{
+public:
+  /** An object which is the value of "key" in the enclosing object */
+  Opt_trace_object(Opt_trace_context *ctx_arg, const char *key)
+    :Opt_trace_struct(ctx_arg, key, '{') {}
+  /** An object which is an element of the enclosing array */
+  Opt_trace_object(Opt_trace_context *ctx_arg)
+    :Opt_trace_struct(ctx_arg, NULL, '{') {}
+};
+
+
+class Opt_trace_array :public Opt_trace_struct
+{
+public:
+  Opt_trace_array(Opt_trace_context *ctx_arg, const char *key)
+    :Opt_trace_struct(ctx_arg, key, '[') {}
+  Opt_trace_array(Opt_trace_context *ctx_arg)
+    :Opt_trace_struct(ctx_arg, NULL, '[') {}
+};
+
+
+/**
+  Keeps the trace disabled while in scope.
+*/
+
+class Opt_trace_disable
+{
+public:
+  Opt_trace_disable(Opt_trace_context *ctx_arg) :ctx(ctx_arg)
+  { ctx->disable(); }
+  ~Opt_trace_disable() { ctx->enable(); }
+private:
+  Opt_trace_context *ctx;
+};
+
+#endif /* OPT_TRACE_INCLUDED */
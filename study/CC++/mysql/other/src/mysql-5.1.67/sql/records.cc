@@ -24,9 +24,11 @@
 */
 
 #include "mysql_priv.h"
+#include "sql_sort.h"
 
 static int rr_quick(READ_RECORD *info);
 int rr_sequential(READ_RECORD *info);
+static int rr_sequential_block(READ_RECORD *info);
 static int rr_from_tempfile(READ_RECORD *info);
 static int rr_unpack_from_tempfile(READ_RECORD *info);
 static int rr_unpack_from_buffer(READ_RECORD *info);
@@ -255,8 +257,11 @@ void init_read_record(READ_RECORD *info,THD *thd, TABLE *table,
     DBUG_PRINT("info",("using record_pointers"));
     table->file->ha_rnd_init(0);
     info->cache_pos=table->sort.record_pointers;
-    info->cache_end=info->cache_pos+ 
-                    table->sort.found_records*info->ref_length;
+    if (table->sort.addon_field && table->sort.using_packed_addons)
+      info->cache_end= info->cache_pos+table->sort.record_pointers_length;
+    else
+      info->cache_end=info->cache_pos+ 
+                      table->sort.found_records*info->ref_length;
     info->read_record= (table->sort.addon_field ?
                         rr_unpack_from_buffer : rr_from_pointers);
   }
@@ -409,6 +414,112 @@ int rr_sequential(READ_RECORD *info)
 }
 
 
+/**
+  Make a table scan set up by init_read_record() read its rows by blocks
+  with rr_sequential_block().  The buffers of the block are allocated on
+  the first scan and kept for the next ones.
+
+  @retval FALSE  ok
+  @retval TRUE   out of memory; the rows are then read one by one
+*/
+
+bool init_read_record_block(READ_RECORD *info, ROW_BLOCK *block)
+{
+  DBUG_ASSERT(info->read_record == rr_sequential);
+  if (!block->rows &&
+      (!(block->rows= (uchar*) info->thd->alloc(block->max_rows *
+                                                block->row_length)) ||
+       !(block->selection= (uint16*) info->thd->alloc(block->max_rows *
+                                                      sizeof(uint16)))))
+  {
+    block->rows= 0;
+    return TRUE;
+  }
+  block->row_count= block->selected= block->next= 0;
+  block->last_row= -1;
+  block->error= 0;
+  block->rejected= 0;
+  info->row_block= block;
+  info->read_record= rr_sequential_block;
+  return FALSE;
+}
+
+
+/**
+  Fill the block with the next rows of the scan and filter it with the
+  conditions of the block.
+
+  @retval 0  ok; block->error tells if the scan ended
+  @retval 1  error evaluating a condition
+*/
+
+static int fill_row_block(READ_RECORD *info, ROW_BLOCK *block)
+{
+  uint row_count= 0;
+  while (row_count < block->max_rows)
+  {
+    int tmp= info->file->rnd_next(info->record);
+    if (tmp)
+    {
+      /* See rr_sequential() */
+      if (!info->thd->killed && tmp == HA_ERR_RECORD_DELETED)
+        continue;
+      block->error= rr_handle_error(info, tmp);
+      break;
+    }
+    memcpy(block->rows + row_count * block->row_length, info->record,
+           block->row_length);
+    block->selection[row_count]= (uint16) row_count;
+    row_count++;
+  }
+  block->row_count= block->selected= row_count;
+  block->next= 0;
+  block->last_row= -1;
+
+  for (uint i= 0; i < block->cond_count && block->selected; i++)
+  {
+    if (block->conds[i]->filter_batch(block))
+      return 1;
+  }
+  info->thd->status_var.select_scan_batch_filtered+=
+    row_count - block->selected;
+  return 0;
+}
+
+
+/**
+  Read a table scan by blocks of rows, see ROW_BLOCK.  The rows of a
+  block which pass its conditions are returned one by one in record[0];
+  block->rejected counts those skipped for the caller.
+*/
+
+static int rr_sequential_block(READ_RECORD *info)
+{
+  ROW_BLOCK *block= info->row_block;
+  for (;;)
+  {
+    if (block->next < block->selected)
+    {
+      uint row= block->selection[block->next++];
+      block->rejected+= (int) row - block->last_row - 1;
+      block->last_row= row;
+      memcpy(info->record, block->rows + row * block->row_length,
+             block->row_length);
+      info->table->status= 0;
+      return 0;
+    }
+    /* The rows after the last one returned were rejected */
+    block->rejected+= (int) block->row_count - block->last_row - 1;
+    block->row_count= 0;
+    block->last_row= -1;
+    if (block->error)
+      return block->error;
+    if (fill_row_block(info, block))
+      return 1;
+  }
+}
+
+
 static int rr_from_tempfile(READ_RECORD *info)
 {
   int tmp;
@@ -447,9 +558,20 @@ static int rr_from_tempfile(READ_RECORD *info)
 
 static int rr_unpack_from_tempfile(READ_RECORD *info)
 {
-  if (my_b_read(info->io_cache, info->rec_buf, info->ref_length))
-    return -1;
   TABLE *table= info->table;
+  if (table->sort.using_packed_addons)
+  {
+    /* Read the length first, then the rest of the record */
+    uint length;
+    if (my_b_read(info->io_cache, info->rec_buf, SORT_ADDON_LENGTH_BYTES))
+      return -1;
+    length= uint4korr(info->rec_buf);
+    if (my_b_read(info->io_cache, info->rec_buf + SORT_ADDON_LENGTH_BYTES,
+                  length - SORT_ADDON_LENGTH_BYTES))
+      return -1;
+  }
+  else if (my_b_read(info->io_cache, info->rec_buf, info->ref_length))
+    return -1;
   (*table->sort.unpack)(table->sort.addon_field, info->rec_buf);
 
   return 0;
@@ -502,7 +624,8 @@ static int rr_unpack_from_buffer(READ_RECORD *info)
     return -1;                      /* End of buffer */
   TABLE *table= info->table;
   (*table->sort.unpack)(table->sort.addon_field, info->cache_pos);
-  info->cache_pos+= info->ref_length;
+  info->cache_pos+= (table->sort.using_packed_addons ?
+                     uint4korr(info->cache_pos) : info->ref_length);
 
   return 0;
 }
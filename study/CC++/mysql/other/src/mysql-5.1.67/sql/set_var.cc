@@ -259,6 +259,8 @@ static sys_var_event_scheduler sys_event_scheduler(&vars, "event_scheduler");
 
 static sys_var_long_ptr	sys_expire_logs_days(&vars, "expire_logs_days",
 					     &expire_logs_days);
+static sys_var_thd_bool	sys_explain_analyze(&vars, "explain_analyze",
+					    &SV::explain_analyze);
 static sys_var_bool_ptr	sys_flush(&vars, "flush", &myisam_flush);
 static sys_var_long_ptr	sys_flush_time(&vars, "flush_time", &flush_time);
 static sys_var_str      sys_ft_boolean_syntax(&vars, "ft_boolean_syntax",
@@ -485,6 +487,12 @@ static sys_var_thd_ulong        sys_optimizer_search_depth(&vars, "optimizer_sea
                                                    &SV::optimizer_search_depth);
 static sys_var_thd_optimizer_switch   sys_optimizer_switch(&vars, "optimizer_switch",
                                      &SV::optimizer_switch);
+static sys_var_thd_bool         sys_optimizer_trace(&vars, "optimizer_trace",
+                                                    &SV::optimizer_trace);
+static sys_var_thd_ulong        sys_optimizer_trace_max_mem_size(&vars, "optimizer_trace_max_mem_size",
+                                                   &SV::optimizer_trace_max_mem_size);
+static sys_var_thd_ulong        sys_partition_scan_threads(&vars, "partition_scan_threads",
+                                                   &SV::partition_scan_threads);
 static sys_var_const            sys_pid_file(&vars, "pid_file",
                                              OPT_GLOBAL, SHOW_CHAR,
                                              (uchar*) pidfile_name);
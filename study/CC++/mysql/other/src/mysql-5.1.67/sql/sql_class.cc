@@ -1527,6 +1527,18 @@ int THD::send_explain_fields(select_result *result)
     item->maybe_null=1;
   }
   item->maybe_null= 1;
+  if (lex->explain_analyze)
+  {
+    field_list.push_back(item= new Item_return_int("r_loops", 10,
+                                                   MYSQL_TYPE_LONGLONG));
+    item->maybe_null= 1;
+    field_list.push_back(item= new Item_float("r_rows", 0.1234, 2, 10));
+    item->maybe_null= 1;
+    field_list.push_back(item= new Item_float("r_filtered", 0.1234, 2, 4));
+    item->maybe_null= 1;
+    field_list.push_back(item= new Item_float("r_time_ms", 0.1234, 3, 10));
+    item->maybe_null= 1;
+  }
   field_list.push_back(new Item_empty_string("Extra", 255, cs));
   return (result->send_fields(field_list,
                               Protocol::SEND_NUM_ROWS | Protocol::SEND_EOF));
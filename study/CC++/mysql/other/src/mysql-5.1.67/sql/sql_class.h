@@ -328,6 +328,8 @@ struct system_variables
   ulong optimizer_search_depth;
   /* A bitmap for switching optimizations on/off */
   ulong optimizer_switch;
+  ulong optimizer_trace_max_mem_size;
+  ulong partition_scan_threads;
   ulong preload_buff_size;
   ulong profiling_history_size;
   ulong query_cache_type;
@@ -372,6 +374,10 @@ struct system_variables
   my_bool old_mode;
   my_bool query_cache_wlock_invalidate;
   my_bool engine_condition_pushdown;
+  /* EXPLAIN executes the statement and shows what it did */
+  my_bool explain_analyze;
+  /* Trace the optimizer decisions into I_S.OPTIMIZER_TRACE */
+  my_bool optimizer_trace;
   my_bool keep_files_on_create;
   my_bool ndb_force_send;
   my_bool ndb_use_copying_alter_table;
@@ -419,6 +425,7 @@ typedef struct system_status_var
   ulong com_stat[(uint) SQLCOM_END];
   ulong created_tmp_disk_tables;
   ulong created_tmp_tables;
+  ulong tmp_table_conversions;
   ulong ha_commit_count;
   ulong ha_delete_count;
   ulong ha_read_first_count;
@@ -433,6 +440,7 @@ typedef struct system_status_var
   ulong ha_write_count;
   ulong ha_prepare_count;
   ulong ha_discover_count;
+  ulong ha_external_lock_count;
   ulong ha_savepoint_count;
   ulong ha_savepoint_rollback_count;
 
@@ -453,11 +461,14 @@ typedef struct system_status_var
   ulong select_range_count;
   ulong select_range_check_count;
   ulong select_scan_count;
+  ulong select_scan_batch_filtered;
   ulong long_query_count;
   ulong filesort_merge_passes;
   ulong filesort_range_count;
   ulong filesort_rows;
   ulong filesort_scan_count;
+  ulong subquery_cache_hit;
+  ulong subquery_cache_miss;
   /* Prepared statements and binary protocol */
   ulong com_stmt_prepare;
   ulong com_stmt_reprepare;
@@ -1763,6 +1774,7 @@ public:
 #if defined(ENABLED_PROFILING) && defined(COMMUNITY_SERVER)
   PROFILING  profiling;
 #endif
+  Opt_trace_context opt_trace;
 
   /*
     Id of current query. Statement can be reused to execute several queries
@@ -2950,16 +2962,33 @@ class Unique :public Sql_alloc
   uchar *record_pointers;
   bool flush();
   uint size;
+  /*
+    If 'hashed' is set the keys are kept in an open addressing hash table
+    instead of the tree: hash_keys holds the keys in insertion order and
+    hash_slots the 1-based positions of the keys in hash_keys (0 = free).
+  */
+  bool hashed;
+  uchar *hash_keys;
+  uint32 *hash_slots;
+  ulong hash_count, hash_alloced, hash_mask;
+  bool hash_add(uchar *key);
+  bool hash_grow();
+  ulong hash_find(uchar *key, ulong hash_nr);
+  void hash_sort();
 
 public:
   ulong elements;
   Unique(qsort_cmp2 comp_func, void *comp_func_fixed_arg,
-	 uint size_arg, ulonglong max_in_memory_size_arg);
+	 uint size_arg, ulonglong max_in_memory_size_arg,
+         bool hashed_arg= FALSE);
   ~Unique();
-  ulong elements_in_tree() { return tree.elements_in_tree; }
+  ulong elements_in_tree()
+  { return hashed ? hash_count : tree.elements_in_tree; }
   inline bool unique_add(void *ptr)
   {
     DBUG_ENTER("unique_add");
+    if (hashed)
+      DBUG_RETURN(hash_add((uchar*) ptr));
     DBUG_PRINT("info", ("tree %u - %lu", tree.elements_in_tree, max_elements));
     if (tree.elements_in_tree > max_elements && flush())
       DBUG_RETURN(1);
@@ -2968,12 +2997,22 @@ public:
 
   bool get(TABLE *table);
   static double get_use_cost(uint *buffer, uint nkeys, uint key_size, 
-                             ulonglong max_in_memory_size);
+                             ulonglong max_in_memory_size, bool hashed);
+  inline static ulong get_max_elements(uint key_size,
+                                       ulonglong max_in_memory_size,
+                                       bool hashed)
+  {
+    /* A hash table is at most half full, see Unique::hash_grow() */
+    return (ulong) (max_in_memory_size /
+                    (hashed ? key_size + 2 * sizeof(uint32) :
+                     ALIGN_SIZE(sizeof(TREE_ELEMENT)+key_size)));
+  }
   inline static int get_cost_calc_buff_size(ulong nkeys, uint key_size, 
-                                            ulonglong max_in_memory_size)
+                                            ulonglong max_in_memory_size,
+                                            bool hashed)
   {
     register ulonglong max_elems_in_tree=
-      (1 + max_in_memory_size / ALIGN_SIZE(sizeof(TREE_ELEMENT)+key_size));
+      1 + get_max_elements(key_size, max_in_memory_size, hashed);
     return (int) (sizeof(uint)*(1 + nkeys/max_elems_in_tree));
   }
 
@@ -484,6 +484,7 @@ class THD;
 class select_result;
 class JOIN;
 class select_union;
+class select_explain_analyze;
 class Procedure;
 class st_select_lex_unit: public st_select_lex_node {
 protected:
@@ -1722,6 +1723,8 @@ typedef struct st_lex : public Query_tables_list
   */
   uint table_count;
   uint8 describe;
+  /* Set while EXPLAIN executes the statement for explain_analyze */
+  select_explain_analyze *explain_analyze;
   /*
     A flag that indicates what kinds of derived tables are present in the
     query (0 if no derived tables, otherwise a combination of flags
@@ -17,6 +17,7 @@
 
 #define MYSQL_LEX 1
 #include "mysql_priv.h"
+#include "sql_select.h"
 #include "sql_repl.h"
 #include "rpl_filter.h"
 #include "repl_failsafe.h"
@@ -2100,6 +2101,7 @@ mysql_execute_command(THD *thd)
   /* have table map for update for multi-update statement (BUG#37051) */
   bool have_table_map_for_update= FALSE;
 #endif
+  bool opt_trace_started= FALSE;
   /* Saved variable value */
   DBUG_ENTER("mysql_execute_command");
 #ifdef WITH_PARTITION_STORAGE_ENGINE
@@ -2272,6 +2274,8 @@ mysql_execute_command(THD *thd)
   status_var_increment(thd->status_var.com_stat[lex->sql_command]);
 
   DBUG_ASSERT(thd->transaction.stmt.modified_non_trans_table == FALSE);
+
+  opt_trace_started= thd->opt_trace.start(thd);
   
   switch (lex->sql_command) {
 
@@ -5150,6 +5154,8 @@ error:
   res= TRUE;
 
 finish:
+  if (opt_trace_started)
+    thd->opt_trace.end();
   if (need_start_waiting)
   {
     /*
@@ -5174,7 +5180,26 @@ static bool execute_sqlcom_select(THD *thd, TABLE_LIST *all_tables)
       param->select_limit=
         new Item_int((ulonglong) thd->variables.select_limit);
   }
-  if (!(res= open_and_lock_tables(thd, all_tables)))
+  if (lex->describe && thd->variables.explain_analyze)
+  {
+    /*
+      Run the statement as a SELECT, see select_explain_analyze. The
+      EXPLAIN flags are restored when it is done.
+    */
+    if (!(lex->explain_analyze= new select_explain_analyze(lex->describe)))
+      return 1;                                 /* purecov: inspected */
+    lex->describe= 0;
+    lex->select_lex.options&= ~SELECT_DESCRIBE;
+  }
+  if (!(res= open_and_lock_tables(thd, all_tables)) &&
+      lex->explain_analyze)
+    res= handle_select(thd, lex, lex->explain_analyze, 0);
+  if (lex->explain_analyze)
+  {
+    lex->describe= lex->explain_analyze->describe;
+    lex->select_lex.options|= SELECT_DESCRIBE;
+  }
+  if (!res)
   {
     if (lex->describe)
     {
@@ -5187,7 +5212,10 @@ static bool execute_sqlcom_select(THD *thd, TABLE_LIST *all_tables)
       if (!(result= new select_send()))
         return 1;                               /* purecov: inspected */
       thd->send_explain_fields(result);
-      res= mysql_explain_union(thd, &thd->lex->unit, result);
+      if (lex->explain_analyze)
+        res= lex->explain_analyze->send_explain(result);
+      else
+        res= mysql_explain_union(thd, &thd->lex->unit, result);
       if (lex->describe & DESCRIBE_EXTENDED)
       {
         char buff[1024];
@@ -5214,6 +5242,7 @@ static bool execute_sqlcom_select(THD *thd, TABLE_LIST *all_tables)
         delete result;
     }
   }
+  lex->explain_analyze= 0;
   return res;
 }
 
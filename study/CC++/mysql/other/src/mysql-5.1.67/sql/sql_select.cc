@@ -142,6 +142,8 @@ end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
+static enum_nested_loop_state
 end_write_group(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 
 static int test_if_group_changed(List<Cached_item> &list);
@@ -178,6 +180,8 @@ static bool list_contains_unique_index(TABLE *table,
                           bool (*find_func) (Field *, void *), void *data);
 static bool find_field_in_item_list (Field *field, void *data);
 static bool find_field_in_order_list (Field *field, void *data);
+static bool test_if_deferred_row_fetch(JOIN_TAB *tab, ORDER *order,
+                                       uint *key, bool *reverse);
 static int create_sort_index(THD *thd, JOIN *join, ORDER *order,
 			     ha_rows filesort_limit, ha_rows select_limit,
                              bool is_order_by);
@@ -226,6 +230,16 @@ static bool init_sum_functions(Item_sum **func, Item_sum **end);
 static bool update_sum_func(Item_sum **func);
 static void select_describe(JOIN *join, bool need_tmp_table,bool need_order,
 			    bool distinct, const char *message=NullS);
+static bool send_explain_row(JOIN *join, List<Item> &item_list);
+static void save_analyze_plan(JOIN *join);
+static void analyze_attach(JOIN *join);
+static void analyze_detach(JOIN *join);
+static void analyze_tmp_table(SELECT_ANALYZE *analyze, TABLE *table,
+                              ulonglong start_time);
+static int analyze_read_first(JOIN_TAB *tab, Read_record_func read_first);
+static int analyze_read_record(READ_RECORD *info);
+static enum_nested_loop_state
+analyze_next_select(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static Item *remove_additional_cond(Item* conds);
 static void add_group_and_distinct_keys(JOIN *join, JOIN_TAB *join_tab);
 static bool test_if_ref(Item_field *left_item,Item *right_item);
@@ -832,6 +846,10 @@ JOIN::optimize()
     DBUG_RETURN(0);
   optimized= 1;
 
+  Opt_trace_object trace_optimize(&thd->opt_trace, "join_optimization");
+  trace_optimize.add("select#", select_lex->select_number);
+  Opt_trace_array trace_steps(&thd->opt_trace, "steps");
+
   thd_proc_info(thd, "optimizing");
   row_limit= ((select_distinct || order || group_list) ? HA_POS_ERROR :
 	      unit->select_limit_cnt);
@@ -1532,6 +1550,9 @@ JOIN::optimize()
     error= 0;
     DBUG_RETURN(0);
   }
+  /* This is the plan EXPLAIN shows */
+  if (thd->lex->explain_analyze)
+    save_analyze_plan(this);
   having= 0;
 
   /*
@@ -1692,6 +1713,7 @@ JOIN::reinit()
                                     ULL(0));
 
   first_record= 0;
+  skipped_rows= 0;
 
   if (exec_tmp_table1)
   {
@@ -1802,6 +1824,8 @@ JOIN::exec()
     columns_list= &procedure_fields_list;
   }
   (void) result->prepare2(); // Currently, this cannot fail.
+  if (thd->lex->explain_analyze && !analyze)
+    save_analyze_plan(this);
 
   if (!tables_list && (tables || !select_lex->with_sum_func))
   {                                           // Only test of functions
@@ -1876,6 +1900,7 @@ JOIN::exec()
 
   if (select_options & SELECT_DESCRIBE)
   {
+    bool deferred_reverse;
     /*
       Check if we managed to optimize ORDER BY away and don't use temporary
       table to resolve ORDER BY: in that case, we only may need to do
@@ -1891,6 +1916,14 @@ JOIN::exec()
       simple_order= simple_group;
       skip_sort_order= 0;
     }
+    if (order && !need_tmp && const_tables != tables &&
+        test_if_deferred_row_fetch(&join_tab[const_tables], order,
+                                   &join_tab[const_tables].index,
+                                   &deferred_reverse))
+    {
+      join_tab[const_tables].deferred_row_fetch= TRUE;
+      order= 0;
+    }
     if (order && 
         (order != group_list || !(select_options & SELECT_BIG_RESULT)) &&
 	(const_tables == tables ||
@@ -1912,6 +1945,7 @@ JOIN::exec()
   List<Item> *curr_all_fields= &all_fields;
   List<Item> *curr_fields_list= &fields_list;
   TABLE *curr_tmp_table= 0;
+  ulonglong start_time= 0;
   /*
     Initialize examined rows here because the values from all join parts
     must be accumulated in examined_row_count. Hence every join
@@ -1942,6 +1976,8 @@ JOIN::exec()
       curr_join->join_tab[curr_join->const_tables].sorted= 0;
 
     Procedure *save_proc= curr_join->procedure;
+    if (analyze)
+      start_time= my_getsystime();
     tmp_error= do_select(curr_join, (List<Item> *) 0, curr_tmp_table, 0);
     curr_join->procedure= save_proc;
     if (tmp_error)
@@ -1949,6 +1985,8 @@ JOIN::exec()
       error= tmp_error;
       DBUG_VOID_RETURN;
     }
+    if (analyze)
+      analyze_tmp_table(analyze, curr_tmp_table, start_time);
     curr_tmp_table->file->info(HA_STATUS_VARIABLE);
     
     if (curr_join->having)
@@ -2108,6 +2146,8 @@ JOIN::exec()
       if (!curr_join->sort_and_group &&
           curr_join->const_tables != curr_join->tables)
         curr_join->join_tab[curr_join->const_tables].sorted= 0;
+      if (analyze)
+        start_time= my_getsystime();
       if (setup_sum_funcs(curr_join->thd, curr_join->sum_funcs) ||
 	  (tmp_error= do_select(curr_join, (List<Item> *) 0, curr_tmp_table,
 				0)))
@@ -2115,6 +2155,8 @@ JOIN::exec()
 	error= tmp_error;
 	DBUG_VOID_RETURN;
       }
+      if (analyze)
+        analyze_tmp_table(analyze, curr_tmp_table, start_time);
       end_read_record(&curr_join->join_tab->read_record);
       curr_join->const_tables= curr_join->tables; // Mark free for cleanup()
       curr_join->join_tab[0].table= 0;           // Table is freed
@@ -2660,6 +2702,7 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables_arg, COND *conds,
   table_map outer_join=0;
   SARGABLE_PARAM *sargables= 0;
   JOIN_TAB *stat_vector[MAX_TABLES+1];
+  Opt_trace_context * const trace= &join->thd->opt_trace;
   DBUG_ENTER("make_join_statistics");
 
   table_count=join->tables;
@@ -3012,10 +3055,13 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables_arg, COND *conds,
 
   for (s=stat ; s < stat_end ; s++)
   {
+    Opt_trace_object trace_table(trace, "rows_estimation");
+    trace_table.add("table", s->table->alias);
     if (s->type == JT_SYSTEM || s->type == JT_CONST)
     {
       /* Only one matching row */
       s->found_records=s->records=s->read_time=1; s->worst_seeks=1.0;
+      trace_table.add("rows", 1).add("cause", "const_table");
       continue;
     }
     /* Approximate found rows and time to read them */
@@ -3081,6 +3127,7 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables_arg, COND *conds,
       }
       delete select;
     }
+    trace_table.add("rows", s->found_records);
   }
 
   join->join_tab=stat;
@@ -4294,8 +4341,12 @@ best_access_path(JOIN      *join,
   table_map best_ref_depends_map= 0;
   double tmp;
   ha_rows rec;
+  Opt_trace_context * const trace= &thd->opt_trace;
   DBUG_ENTER("best_access_path");
 
+  Opt_trace_object trace_wrapper(trace, "best_access_path");
+  Opt_trace_array trace_paths(trace, "considered_access_paths");
+
   if (s->keyuse)
   {                                            /* Use key if possible */
     TABLE *table= s->table;
@@ -4369,6 +4420,10 @@ best_access_path(JOIN      *join,
       if (!found_part && !ft_key)
         continue;                               // Nothing usable found
 
+      Opt_trace_object trace_access_idx(trace);
+      trace_access_idx.add("access_type", ft_key ? "fulltext" : "ref").
+        add("index", keyinfo->name);
+
       if (rec < MATCHING_ROWS_IN_OTHER_TABLE)
         rec= MATCHING_ROWS_IN_OTHER_TABLE;      // Fix for small tables
 
@@ -4639,11 +4694,17 @@ best_access_path(JOIN      *join,
               tmp= record_count*min(tmp,s->worst_seeks);
           }
           else
-            tmp= best_time;                    // Do nothing
+          {
+            /* The first key part is not bound */
+            trace_access_idx.add("usable", false);
+            continue;
+          }
         }
       } /* not ft_key */
+      trace_access_idx.add("rows", records).add("cost", tmp);
       if (tmp < best_time - records/(double) TIME_FOR_COMPARE)
       {
+        trace_access_idx.add("chosen", true);
         best_time= tmp + records/(double) TIME_FOR_COMPARE;
         best= tmp;
         best_records= records;
@@ -4651,6 +4712,8 @@ best_access_path(JOIN      *join,
         best_max_key_part= max_key_part;
         best_ref_depends_map= found_ref;
       }
+      else
+        trace_access_idx.add("chosen", false);
     }
     records= best_records;
   }
@@ -4691,6 +4754,7 @@ best_access_path(JOIN      *join,
       !(s->table->force_index && best_key && !s->quick))                 // (4)
   {                                             // Check full join
     ha_rows rnd_records= s->found_records;
+    Opt_trace_object trace_access_scan(trace);
     /*
       If there is a filtering condition on the table (i.e. ref analyzer found
       at least one "table.keyXpartY= exprZ", where exprZ refers only to tables
@@ -4767,6 +4831,8 @@ best_access_path(JOIN      *join,
       as record_count * rnd_records / TIME_FOR_COMPARE. This cost plus
       tmp give us total cost of using TABLE SCAN
     */
+    trace_access_scan.add("access_type", s->quick ? "range" : "scan").
+      add("rows", rnd_records).add("cost", tmp);
     if (best == DBL_MAX ||
         (tmp  + record_count/(double) TIME_FOR_COMPARE*rnd_records <
          best + record_count/(double) TIME_FOR_COMPARE*records))
@@ -4775,12 +4841,15 @@ best_access_path(JOIN      *join,
         If the table has a range (s->quick is set) make_join_select()
         will ensure that this will be used
       */
+      trace_access_scan.add("chosen", true);
       best= tmp;
       records= rows2double(rnd_records);
       best_key= 0;
       /* range/index_merge/ALL/index access method are "independent", so: */
       best_ref_depends_map= 0;
     }
+    else
+      trace_access_scan.add("chosen", false);
   }
 
   /* Update the cost information for the current partial plan */
@@ -4844,7 +4913,9 @@ choose_plan(JOIN *join, table_map join_tables)
   my_qsort(join->best_ref + join->const_tables,
            join->tables - join->const_tables, sizeof(JOIN_TAB*),
            straight_join ? join_tab_cmp_straight : join_tab_cmp);
-  
+
+  Opt_trace_array trace_plan(&join->thd->opt_trace,
+                             "considered_execution_plans");
   if (straight_join)
   {
     optimize_straight_join(join, join_tables);
@@ -5028,6 +5099,8 @@ optimize_straight_join(JOIN *join, table_map join_tables)
  
   for (JOIN_TAB **pos= join->best_ref + idx ; (s= *pos) ; pos++)
   {
+    Opt_trace_object trace_table(&join->thd->opt_trace);
+    trace_table.add("table", s->table->alias);
     /* Find the best access method from 's' to the current partial plan */
     best_access_path(join, s, join->thd, join_tables, idx,
                      record_count, read_time);
@@ -5218,6 +5291,21 @@ greedy_search(JOIN      *join,
 }
 
 
+/**
+  Write the tables of the partial plan of length idx to the optimizer
+  trace.
+*/
+
+static void trace_plan_prefix(JOIN *join, uint idx)
+{
+  Opt_trace_array trace_prefix(&join->thd->opt_trace, "plan_prefix");
+  if (!trace_prefix.is_started())
+    return;
+  for (uint i= join->const_tables; i < idx; i++)
+    trace_prefix.add(join->positions[i].table->table->alias);
+}
+
+
 /**
   Find a good, possibly optimal, query execution plan (QEP) by a possibly
   exhaustive search.
@@ -5347,6 +5435,7 @@ best_extension_by_limited_search(JOIN      *join,
   DBUG_ENTER("best_extension_by_limited_search");
 
   THD *thd= join->thd;
+  Opt_trace_context * const trace= &thd->opt_trace;
   if (thd->killed)  // Abort
     DBUG_RETURN(TRUE);
 
@@ -5372,6 +5461,9 @@ best_extension_by_limited_search(JOIN      *join,
         (!idx || !check_interleaving_with_nj(s)))
     {
       double current_record_count, current_read_time;
+      Opt_trace_object trace_one_table(trace);
+      trace_plan_prefix(join, idx);
+      trace_one_table.add("table", s->table->alias);
 
       /* Find the best access method from 's' to the current partial plan */
       best_access_path(join, s, thd, remaining_tables, idx,
@@ -5379,11 +5471,14 @@ best_extension_by_limited_search(JOIN      *join,
       /* Compute the cost of extending the plan with 's' */
       current_record_count= record_count * join->positions[idx].records_read;
       current_read_time=    read_time + join->positions[idx].read_time;
+      trace_one_table.add("cost_for_plan", current_read_time).
+        add("rows_for_plan", current_record_count);
 
       /* Expand only partial plans with lower cost than the best QEP so far */
       if ((current_read_time +
            current_record_count / (double) TIME_FOR_COMPARE) >= join->best_read)
       {
+        trace_one_table.add("pruned_by_cost", true);
         DBUG_EXECUTE("opt", print_plan(join, idx+1,
                                        current_record_count,
                                        read_time,
@@ -5418,6 +5513,7 @@ best_extension_by_limited_search(JOIN      *join,
         }
         else
         {
+          trace_one_table.add("pruned_by_heuristic", true);
           DBUG_EXECUTE("opt", print_plan(join, idx+1,
                                          current_record_count,
                                          read_time,
@@ -5430,6 +5526,7 @@ best_extension_by_limited_search(JOIN      *join,
 
       if ( (search_depth > 1) && (remaining_tables & ~real_table_bit) )
       { /* Recursively expand the current partial plan */
+        Opt_trace_array trace_rest(trace, "rest_of_plan");
         swap_variables(JOIN_TAB*, join->best_ref[idx], *pos);
         if (best_extension_by_limited_search(join,
                                              remaining_tables & ~real_table_bit,
@@ -5452,12 +5549,16 @@ best_extension_by_limited_search(JOIN      *join,
             join->positions[join->const_tables].table->table)
           /* We have to make a temp table */
           current_read_time+= current_record_count;
+        trace_one_table.add("total_cost", current_read_time);
         if ((search_depth == 1) || (current_read_time < join->best_read))
         {
+          trace_one_table.add("chosen", true);
           memcpy((uchar*) join->best_positions, (uchar*) join->positions,
                  sizeof(POSITION) * (idx + 1));
           join->best_read= current_read_time - 0.001;
         }
+        else
+          trace_one_table.add("chosen", false);
         DBUG_EXECUTE("opt", print_plan(join, idx+1,
                                        current_record_count,
                                        read_time,
@@ -5824,6 +5925,7 @@ static bool create_ref_for_key(JOIN *join, JOIN_TAB *j, KEYUSE *org_keyuse,
   j->ref.key_err=1;
   j->ref.has_record= FALSE;
   j->ref.null_rejecting= 0;
+  j->ref.const_key_parts= 0;
   j->ref.use_count= 0;
   keyuse=org_keyuse;
 
@@ -5865,6 +5967,9 @@ static bool create_ref_for_key(JOIN *join, JOIN_TAB *j, KEYUSE *org_keyuse,
 	if (thd->is_fatal_error)
 	  DBUG_RETURN(TRUE);
 	tmp.copy();
+        /* EXPLAIN with explain_analyze shows it in the "ref" column */
+        if (thd->lex->explain_analyze)
+          j->ref.const_key_parts|= (key_part_map) 1 << i;
       }
       else
 	*ref_key++= get_store_key(thd,
@@ -6037,6 +6142,9 @@ JOIN::make_simple_join(JOIN *parent, TABLE *temp_table)
   join_tab->read_first_record= join_init_read_record;
   join_tab->join= this;
   join_tab->ref.key_parts= 0;
+  join_tab->analyze= 0;
+  join_tab->row_block= 0;
+  join_tab->deferred_row_fetch= 0;
   bzero((char*) &join_tab->read_record,sizeof(join_tab->read_record));
   temp_table->status=0;
   temp_table->null_row=0;
@@ -6493,6 +6601,9 @@ make_join_select(JOIN *join,SQL_SELECT *select,COND *cond)
 	       join->best_positions[i].records_read &&
 	       !(join->select_options & OPTION_FOUND_ROWS)))
 	  {
+	    Opt_trace_object trace_recheck(&thd->opt_trace,
+	                                   "rechecking_range_access");
+	    trace_recheck.add("table", tab->table->alias);
 	    /* Join with outer join condition */
 	    COND *orig_cond=sel->cond;
 	    sel->cond= and_conds(sel->cond, *tab->on_expr_ref);
@@ -6727,6 +6838,84 @@ pick_table_access_method(JOIN_TAB *tab)
 }
 
 
+/**
+  Set up a scan of the first non-const table to read its rows by blocks
+  and to evaluate the leading conjuncts of its select_cond which
+  Item_func::filter_batch() supports on a block at a time, see ROW_BLOCK.
+
+  Reading ahead must not lock rows or read rows that a LIMIT would not
+  read, and the rows are returned from copies, so the scan must not
+  need the position of the handler or BLOBs.
+
+  @return the block, or NULL if the rows are to be read one by one
+*/
+
+static ROW_BLOCK *make_row_block(JOIN *join, JOIN_TAB *tab)
+{
+  THD *thd= join->thd;
+  TABLE *table= tab->table;
+  COND *cond= tab->select_cond;
+  thr_lock_type lock_type= table->reginfo.lock_type;
+  Item *single[1];
+  Item **items= single;
+  uint item_count= 1;
+  uint max_rows;
+  ROW_BLOCK *block;
+
+  if (!cond || tab->first_inner ||
+      !(thd->variables.optimizer_switch & OPTIMIZER_SWITCH_SCAN_BATCH_FILTER) ||
+      thd->lex->sql_command != SQLCOM_SELECT ||
+      join->unit->select_limit_cnt != HA_POS_ERROR ||
+      table->s->blob_fields ||
+      lock_type > TL_READ_NO_INSERT ||
+      lock_type == TL_READ_WITH_SHARED_LOCKS)
+    return NULL;
+  max_rows= min(ROW_BLOCK_MAX_ROWS, ROW_BLOCK_SIZE / table->s->reclength);
+  if (max_rows < ROW_BLOCK_MIN_ROWS)
+    return NULL;
+
+  single[0]= cond;
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List<Item> *args= ((Item_cond*) cond)->argument_list();
+    List_iterator_fast<Item> it(*args);
+    Item *item;
+    if (!(items= (Item**) thd->alloc(sizeof(Item*) * args->elements)))
+      return NULL;
+    for (item_count= 0; (item= it++); item_count++)
+      items[item_count]= item;
+  }
+
+  /*
+    Only leading conjuncts are taken, so that rows rejected by the block
+    would not have reached the others in select_cond either.
+  */
+  uint count;
+  for (count= 0; count < item_count; count++)
+  {
+    if (items[count]->type() != Item::FUNC_ITEM ||
+        !((Item_func*) items[count])->batch_supported(table))
+      break;
+  }
+  if (!count || !(block= (ROW_BLOCK*) thd->calloc(sizeof(ROW_BLOCK))) ||
+      !(block->conds= (Item_func**) thd->alloc(sizeof(Item_func*) * count)))
+    return NULL;
+  for (uint i= 0; i < count; i++)
+    block->conds[i]= (Item_func*) items[i];
+  block->cond_count= count;
+  block->whole_cond= count == item_count;
+  /*
+    AND goes on to the next conjunct if one is NULL, so a NULL must be
+    left to select_cond when it has more conjuncts.
+  */
+  block->keep_nulls= !block->whole_cond;
+  block->row_length= table->s->reclength;
+  block->max_rows= max_rows;
+  return block;
+}
+
+
 static void
 make_join_readinfo(JOIN *join, ulonglong options)
 {
@@ -6862,6 +7051,9 @@ make_join_readinfo(JOIN *join, ulonglong options)
 	    tab->type=JT_NEXT;		// Read with index_first / index_next
 	  }
 	}
+        if (tab->type == JT_ALL && i == join->const_tables &&
+            !(options & SELECT_DESCRIBE))
+          tab->row_block= make_row_block(join, tab);
       }
       break;
     case JT_FT:
@@ -10309,10 +10501,13 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   *blob_field= 0;				// End marker
   share->fields= field_count;
 
-  /* If result table is small; use a heap */
+  /*
+    If result table is small; use a heap. BLOB data and unique constraints
+    are handled there too; the table is converted to MyISAM when it grows
+    beyond tmp_table_size.
+  */
   /* future: storage engine selection can be made dynamic? */
-  if (blob_count || using_unique_constraint ||
-      (select_options & (OPTION_BIG_TABLES | SELECT_SMALL_RESULT)) ==
+  if ((select_options & (OPTION_BIG_TABLES | SELECT_SMALL_RESULT)) ==
       OPTION_BIG_TABLES || (select_options & TMP_TABLE_FORCE_MYISAM))
   {
     share->db_plugin= ha_lock_engine(0, myisam_hton);
@@ -10560,10 +10755,12 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
           cur_group->buff++;                        // Pointer to field data
 	  group_buff++;                         // Skipp null flag
 	}
-        /* In GROUP BY 'a' and 'a ' are equal for VARCHAR fields */
-        key_part_info->key_part_flag|= HA_END_SPACE_ARE_EQUAL;
 	group_buff+= cur_group->field->pack_length();
       }
+      else if (maybe_null)
+        keyinfo->flags|= HA_NULL_ARE_EQUAL;     // As in a unique constraint
+      /* In GROUP BY 'a' and 'a ' are equal for VARCHAR fields */
+      key_part_info->key_part_flag= HA_END_SPACE_ARE_EQUAL;
       keyinfo->key_length+=  key_part_info->length;
     }
   }
@@ -10995,6 +11192,7 @@ bool create_myisam_from_heap(THD *thd, TABLE *table, TMP_TABLE_PARAM *param,
 
   save_proc_info=thd->proc_info;
   thd_proc_info(thd, "converting HEAP to MyISAM");
+  status_var_increment(thd->status_var.tmp_table_conversions);
 
   if (create_myisam_tmp_table(&new_table, param,
 			      thd->lex->select_lex.options | thd->options))
@@ -11101,7 +11299,7 @@ Next_select_func setup_end_select_func(JOIN *join)
     if (table->group && tmp_tbl->sum_func_count && 
         !tmp_tbl->precomputed_group_by)
     {
-      if (table->s->keys)
+      if (table->s->keys && !table->s->uniques)
       {
 	DBUG_PRINT("info",("Using end_update"));
 	end_select=end_update;
@@ -11173,6 +11371,7 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
   int rc= 0;
   enum_nested_loop_state error= NESTED_LOOP_OK;
   JOIN_TAB *join_tab= NULL;
+  Group_hash group_hash;
   DBUG_ENTER("do_select");
   
   join->procedure=procedure;
@@ -11184,18 +11383,38 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
     VOID(table->file->extra(HA_EXTRA_WRITE_CACHE));
     empty_record(table);
     if (table->group && join->tmp_table_param.sum_func_count &&
-        table->s->keys && !table->file->inited)
+        table->s->keys && !table->s->uniques && !table->file->inited)
       table->file->ha_index_init(0, 0);
   }
   /* Set up select_end */
   Next_select_func end_select= setup_end_select_func(join);
+  /*
+    Collect the groups in a hash table rather than looking up each row in
+    the HEAP table. BLOBs are not copied out of the row buffers, so tables
+    with BLOBs use the table.
+  */
+  if (end_select == end_update &&
+      table->s->db_type() == heap_hton && !table->s->blob_fields &&
+      (join->thd->variables.optimizer_switch &
+       OPTIMIZER_SWITCH_HASH_GROUP_BY) &&
+      !group_hash.init(join->tmp_table_param.group_length,
+                       table->s->reclength,
+                       (size_t) min(join->thd->variables.tmp_table_size,
+                                    join->thd->variables.max_heap_table_size)))
+  {
+    DBUG_PRINT("info",("Using end_hash_update"));
+    join->group_hash= &group_hash;
+    end_select= end_hash_update;
+  }
   if (join->tables)
   {
     join->join_tab[join->tables-1].next_select= end_select;
 
     join_tab=join->join_tab+join->const_tables;
   }
-  join->send_records=0;
+  if (join->analyze)
+    analyze_attach(join);
+  join->send_records= join->skipped_rows;
   if (join->tables == join->const_tables)
   {
     /*
@@ -11233,6 +11452,8 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
     if (error == NESTED_LOOP_QUERY_LIMIT)
       error= NESTED_LOOP_OK;                    /* select_limit used */
   }
+  if (join->analyze)
+    analyze_detach(join);
   if (error == NESTED_LOOP_NO_MORE_ROWS)
     error= NESTED_LOOP_OK;
 
@@ -11270,6 +11491,7 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
     if (new_errno)
       table->file->print_error(new_errno,MYF(0));
   }
+  join->group_hash= 0;
 #ifndef DBUG_OFF
   if (rc)
   {
@@ -11504,7 +11726,17 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
   ha_rows found_records=join->found_records;
   COND *select_cond= join_tab->select_cond;
   bool select_cond_result= TRUE;
+  ROW_BLOCK *block= join_tab->read_record.row_block;
 
+  if (block)
+  {
+    /* Account for the rows which the block filtered out */
+    join->examined_rows+= block->rejected;
+    join->thd->row_count+= (ulong) block->rejected;
+    block->rejected= 0;
+    if (block->whole_cond)
+      select_cond= 0;
+  }
   if (error > 0 || (join->thd->is_error()))     // Fatal error
     return NESTED_LOOP_ERROR;
   if (error < 0)
@@ -11713,7 +11945,9 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
     }
   }
  /* read through all records */
-  if ((error=join_init_read_record(join_tab)))
+  if ((error= (join_tab->analyze ?
+               analyze_read_first(join_tab, join_init_read_record) :
+               join_init_read_record(join_tab))))
   {
     reset_cache_write(&join_tab->cache);
     return error < 0 ? NESTED_LOOP_NO_MORE_ROWS: NESTED_LOOP_ERROR;
@@ -12186,6 +12420,8 @@ int init_read_record_seq(JOIN_TAB *tab)
 static int
 test_if_quick_select(JOIN_TAB *tab)
 {
+  /* Called for every row: keep it out of the optimizer trace */
+  Opt_trace_disable trace_disabled(&tab->join->thd->opt_trace);
   delete tab->select->quick;
   tab->select->quick=0;
   return tab->select->test_quick_select(tab->join->thd, tab->keys,
@@ -12200,6 +12436,10 @@ join_init_read_record(JOIN_TAB *tab)
     return 1;
   init_read_record(&tab->read_record, tab->join->thd, tab->table,
 		   tab->select,1,1, FALSE);
+  /* explain_analyze counts the rows as the access method returns them */
+  if (tab->row_block && !tab->analyze &&
+      tab->read_record.read_record == rr_sequential)
+    init_read_record_block(&tab->read_record, tab->row_block);
   return (*tab->read_record.read_record)(&tab->read_record);
 }
 
@@ -12361,6 +12601,31 @@ join_read_next_same_or_null(READ_RECORD *info)
    All return values except NESTED_LOOP_OK abort the nested loop.
 *****************************************************************************/
 
+/**
+  The end_select function of a running do_select(). EXPLAIN with
+  explain_analyze wraps it, see analyze_attach().
+*/
+
+static Next_select_func get_end_select(JOIN *join)
+{
+  JOIN_TAB *last= join->join_tab + join->tables - 1;
+  return (last->next_select == analyze_next_select ?
+          last->analyze->next_select : last->next_select);
+}
+
+
+/** Change the end_select function of a running do_select() */
+
+static void set_end_select(JOIN *join, Next_select_func end_select)
+{
+  JOIN_TAB *last= join->join_tab + join->tables - 1;
+  if (last->next_select == analyze_next_select)
+    last->analyze->next_select= end_select;
+  else
+    last->next_select= end_select;
+}
+
+
 /* ARGSUSED */
 static enum_nested_loop_state
 end_send(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
@@ -12620,8 +12885,7 @@ end:
 /** Group by searching after group record and updating it if possible. */
 
 static enum_nested_loop_state
-end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
-	   bool end_of_records)
+end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
 {
   TABLE *table=join->tmp_table;
   ORDER   *group;
@@ -12657,6 +12921,19 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
     if ((error=table->file->ha_update_row(table->record[1],
                                           table->record[0])))
     {
+      if (error == HA_ERR_RECORD_FILE_FULL)
+      {
+        /*
+          A BLOB of a HEAP table grew beyond tmp_table_size. The old row
+          is kept; update the group again in the MyISAM table.
+        */
+        if (create_myisam_from_heap(join->thd, table, &join->tmp_table_param,
+                                    error, 1))
+          DBUG_RETURN(NESTED_LOOP_ERROR);        // Not a table_is_full error
+        table->file->ha_index_init(0, 0);
+        set_end_select(join, end_unique_update);
+        DBUG_RETURN(end_unique_update(join, join_tab, end_of_records));
+      }
       table->file->print_error(error,MYF(0));	/* purecov: inspected */
       DBUG_RETURN(NESTED_LOOP_ERROR);            /* purecov: inspected */
     }
@@ -12686,9 +12963,239 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
       DBUG_RETURN(NESTED_LOOP_ERROR);            // Not a table_is_full error
     /* Change method to update rows */
     table->file->ha_index_init(0, 0);
-    join->join_tab[join->tables-1].next_select=end_unique_update;
+    set_end_select(join, end_unique_update);
+  }
+  join->send_records++;
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
+/** Hash value of the group key in TMP_TABLE_PARAM::group_buff. */
+
+static ulong group_key_hash(ORDER *group)
+{
+  ulong nr= 1, nr2= 4;
+  for (; group ; group= group->next)
+    group->field->hash(&nr, &nr2);
+  return nr;
+}
+
+
+/**
+  Compare two group keys in the TMP_TABLE_PARAM::group_buff format.
+
+  @return 0 if the keys are equal
+*/
+
+static int group_key_cmp(ORDER *group, const uchar *key_buff,
+                         const uchar *other)
+{
+  for (; group ; group= group->next)
+  {
+    uint offset= (uint) ((uchar*) group->buff - key_buff);
+    if ((*group->item)->maybe_null)
+    {
+      if (key_buff[offset-1] != other[offset-1])
+        return 1;
+      if (key_buff[offset-1])
+        continue;                               // Both are NULL
+    }
+    if (group->field->cmp(key_buff + offset, other + offset))
+      return 1;
+  }
+  return 0;
+}
+
+
+bool Group_hash::init(uint key_length_arg, uint reclength_arg,
+                      size_t max_memory_arg)
+{
+  key_length= key_length_arg;
+  reclength= reclength_arg;
+  max_memory= max_memory_arg;
+  return resize(256);
+}
+
+
+bool Group_hash::resize(ulong size)
+{
+  GROUP_HASH_ENTRY **new_slots, *entry;
+  if (!(new_slots= (GROUP_HASH_ENTRY**) my_malloc(size * sizeof(*slots),
+                                                  MYF(MY_WME | MY_ZEROFILL))))
+    return TRUE;
+  for (entry= first ; entry ; entry= entry->next)
+  {
+    ulong i;
+    for (i= entry->hash_value & (size - 1) ; new_slots[i] ;
+         i= (i + 1) & (size - 1))
+    {}
+    new_slots[i]= entry;
+  }
+  my_free((uchar*) slots, MYF(MY_ALLOW_ZERO_PTR));
+  slots= new_slots;
+  slot_mask= size - 1;
+  return FALSE;
+}
+
+
+/** Forget all groups, but keep the memory for the next ones. */
+
+void Group_hash::reset()
+{
+  bzero((char*) slots, (slot_mask + 1) * sizeof(*slots));
+  free_root(&mem_root, MYF(MY_MARK_BLOCKS_FREE));
+  first= 0;
+  last= &first;
+  records= 0;
+}
+
+
+GROUP_HASH_ENTRY *Group_hash::find(ORDER *group, const uchar *key_buff,
+                                   ulong hash_value)
+{
+  GROUP_HASH_ENTRY *entry;
+  for (ulong i= hash_value & slot_mask ; (entry= slots[i]) ;
+       i= (i + 1) & slot_mask)
+  {
+    if (entry->hash_value == hash_value &&
+        !group_key_cmp(group, key_buff, key(entry)))
+      return entry;
+  }
+  return 0;
+}
+
+
+/** Add a group that find() did not find. Returns 0 if out of memory. */
+
+GROUP_HASH_ENTRY *Group_hash::insert(const uchar *key_buff,
+                                     const uchar *record_buff,
+                                     ulong hash_value)
+{
+  GROUP_HASH_ENTRY *entry;
+  ulong i;
+
+  if ((records + 1) * 2 > slot_mask + 1 && resize((slot_mask + 1) * 2))
+    return 0;
+  if (!(entry= (GROUP_HASH_ENTRY*)
+        alloc_root(&mem_root, ALIGN_SIZE(sizeof(GROUP_HASH_ENTRY)) +
+                   ALIGN_SIZE(key_length) + reclength)))
+    return 0;
+  entry->next= 0;
+  entry->hash_value= hash_value;
+  memcpy(key(entry), key_buff, key_length);
+  memcpy(record(entry), record_buff, reclength);
+  *last= entry;
+  last= &entry->next;
+  for (i= hash_value & slot_mask ; slots[i] ; i= (i + 1) & slot_mask)
+  {}
+  slots[i]= entry;
+  records++;
+  return entry;
+}
+
+
+/**
+  Write the groups collected by end_hash_update() to the temporary table.
+  The table is converted to MyISAM if it gets full, as in end_update().
+*/
+
+static bool flush_group_hash(JOIN *join)
+{
+  TABLE *table= join->tmp_table;
+  Group_hash *hash= join->group_hash;
+  GROUP_HASH_ENTRY *entry;
+  int error;
+
+  for (entry= hash->first_entry() ; entry ; entry= entry->next)
+  {
+    memcpy(table->record[0], hash->record(entry), table->s->reclength);
+    if ((error= table->file->ha_write_row(table->record[0])))
+    {
+      if (create_myisam_from_heap(join->thd, table, &join->tmp_table_param,
+                                  error, 0))
+        return TRUE;                            // Not a table_is_full error
+      table->file->ha_index_init(0, 0);
+      if (join->tables)
+        set_end_select(join, end_unique_update);
+    }
+  }
+  hash->reset();
+  return FALSE;
+}
+
+
+/**
+  Group by in a hash table of groups, see Group_hash.
+
+  This does the same as end_update() without a handler call per row. The
+  groups are written to the temporary table at end of records. If they use
+  more memory than an in-memory temporary table may, they are written to
+  the temporary table right away and end_update() does the rest.
+*/
+
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
+                bool end_of_records)
+{
+  TABLE *table= join->tmp_table;
+  Group_hash *hash= join->group_hash;
+  GROUP_HASH_ENTRY *entry;
+  ORDER *group;
+  ulong hash_value;
+  DBUG_ENTER("end_hash_update");
+
+  if (end_of_records)
+    DBUG_RETURN(flush_group_hash(join) ? NESTED_LOOP_ERROR : NESTED_LOOP_OK);
+  if (join->thd->killed)			// Aborted by user
+  {
+    join->thd->send_kill_message();
+    DBUG_RETURN(NESTED_LOOP_KILLED);             /* purecov: inspected */
+  }
+
+  join->found_records++;
+  copy_fields(&join->tmp_table_param);		// Groups are copied twice.
+  /* Make a key of group index */
+  for (group=table->group ; group ; group=group->next)
+  {
+    Item *item= *group->item;
+    item->save_org_in_field(group->field);
+    /* Store in the used key if the field was 0 */
+    if (item->maybe_null)
+      group->buff[-1]= (char) group->field->is_null();
+  }
+  hash_value= group_key_hash(table->group);
+  if ((entry= hash->find(table->group, join->tmp_table_param.group_buff,
+                         hash_value)))
+  {						/* Update old record */
+    memcpy(table->record[0], hash->record(entry), table->s->reclength);
+    update_tmptable_sum_func(join->sum_funcs,table);
+    memcpy(hash->record(entry), table->record[0], table->s->reclength);
+    DBUG_RETURN(NESTED_LOOP_OK);
+  }
+
+  /* Copy null bits from group key to table, see end_update() */
+  KEY_PART_INFO *key_part;
+  for (group=table->group,key_part=table->key_info[0].key_part;
+       group ;
+       group=group->next,key_part++)
+  {
+    if (key_part->null_bit)
+      memcpy(table->record[0]+key_part->offset, group->buff, 1);
   }
+  init_tmptable_sum_functions(join->sum_funcs);
+  if (copy_funcs(join->tmp_table_param.items_to_copy, join->thd))
+    DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+  if (!hash->insert(join->tmp_table_param.group_buff, table->record[0],
+                    hash_value))
+    DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
   join->send_records++;
+  if (hash->is_full())
+  {
+    if (flush_group_hash(join))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    if (join->tables && get_end_select(join) == end_hash_update)
+      set_end_select(join, end_update);
+  }
   DBUG_RETURN(NESTED_LOOP_OK);
 }
 
@@ -12696,8 +13203,7 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 /** Like end_update, but this is done with unique constraints instead of keys.  */
 
 static enum_nested_loop_state
-end_unique_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
-		  bool end_of_records)
+end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
 {
   TABLE *table=join->tmp_table;
   int	  error;
@@ -12718,6 +13224,17 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 
   if (!(error=table->file->ha_write_row(table->record[0])))
     join->send_records++;			// New group
+  else if (error == HA_ERR_RECORD_FILE_FULL)
+  {
+    /*
+      A HEAP table only gets full on a new group; a duplicate is found
+      before any space is needed.
+    */
+    if (create_myisam_from_heap(join->thd, table, &join->tmp_table_param,
+                                error, 0))
+      DBUG_RETURN(NESTED_LOOP_ERROR);            // Not a table_is_full error
+    join->send_records++;
+  }
   else
   {
     if ((int) table->file->get_dup_key(error) < 0)
@@ -12735,6 +13252,14 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
     if ((error=table->file->ha_update_row(table->record[1],
                                           table->record[0])))
     {
+      if (error == HA_ERR_RECORD_FILE_FULL)
+      {
+        /* A BLOB grew, see end_update() */
+        if (create_myisam_from_heap(join->thd, table, &join->tmp_table_param,
+                                    error, 1))
+          DBUG_RETURN(NESTED_LOOP_ERROR);        // Not a table_is_full error
+        DBUG_RETURN(end_unique_update(join, join_tab, end_of_records));
+      }
       table->file->print_error(error,MYF(0));	/* purecov: inspected */
       DBUG_RETURN(NESTED_LOOP_ERROR);            /* purecov: inspected */
     }
@@ -13928,63 +14453,369 @@ use_filesort:
 }
 
 
-/*
-  If not selecting by given key, create an index how records should be read
-
-  SYNOPSIS
-   create_sort_index()
-     thd		Thread handler
-     tab		Table to sort (in join structure)
-     order		How table should be sorted
-     filesort_limit	Max number of rows that needs to be sorted
-     select_limit	Max number of rows in final output
-		        Used to decide if we should use index or not
-     is_order_by        true if we are sorting on ORDER BY, false if GROUP BY
-                        Used to decide if we should use index or not     
+/**
+  Test if ORDER BY ... LIMIT can be resolved by a deferred row fetch.
 
+  Reading the rows in index order, most of the rows read may be skipped
+  by the LIMIT offset or the condition. If the index gives the order and
+  holds all the columns of the condition, these rows can be found with
+  an index only scan, and only the rows sent fetched from the table by
+  their position, see deferred_row_fetch(). This is done if it is cheaper
+  than the access method of the table, that a filesort is added to, and
+  than reading all the rows by the index.
 
-  IMPLEMENTATION
-   - If there is an index that can be used, 'tab' is modified to use
-     this index.
-   - If no index, create with filesort() an index file that can be used to
-     retrieve rows in order (should be done with 'read_record').
-     The sorted data is stored in tab->table and will be freed when calling
-     free_io_cache(tab->table).
+  @param tab           First non-const table
+  @param order         ORDER BY list
+  @param[out] key      Index to scan
+  @param[out] reverse  Set if the index is scanned backwards
 
-  RETURN VALUES
-    0		ok
-    -1		Some fatal error
-    1		No records
+  @retval
+    TRUE   Read the rows by a deferred row fetch
+  @retval
+    FALSE  Sort as usual
 */
 
-static int
-create_sort_index(THD *thd, JOIN *join, ORDER *order,
-		  ha_rows filesort_limit, ha_rows select_limit,
-                  bool is_order_by)
+static bool
+test_if_deferred_row_fetch(JOIN_TAB *tab, ORDER *order, uint *key,
+                           bool *reverse)
 {
-  uint length= 0;
-  ha_rows examined_rows;
-  TABLE *table;
-  SQL_SELECT *select;
-  JOIN_TAB *tab;
-  DBUG_ENTER("create_sort_index");
+  JOIN *join= tab->join;
+  THD *thd= join->thd;
+  TABLE *table= tab->table;
+  SQL_SELECT *select= tab->select;
+  QUICK_SELECT_I *quick= select ? select->quick : 0;
+  SELECT_LEX_UNIT *unit= join->unit;
+  thr_lock_type lock_type= table->reginfo.lock_type;
+  ha_rows table_records, scan_rows, fetch_rows;
+  double best_time;
+  key_map usable_keys;
+  int best_key= -1;
+  int best_direction= 0;
+  DBUG_ENTER("test_if_deferred_row_fetch");
+
+  if (!(thd->variables.optimizer_switch &
+        OPTIMIZER_SWITCH_DEFERRED_ROW_FETCH) ||
+      thd->lex->sql_command != SQLCOM_SELECT ||
+      unit != &thd->lex->unit || unit->is_union() ||
+      join->tables != join->const_tables + 1 ||
+      order != join->order || join->group_list || join->select_distinct ||
+      join->select_lex->with_sum_func || join->select_lex->having ||
+      join->tmp_having || join->procedure ||
+      (join->select_options & OPTION_FOUND_ROWS) ||
+      unit->select_limit_cnt == HA_POS_ERROR ||
+      unit->offset_limit_cnt == HA_POS_ERROR ||
+      unit->select_limit_cnt <= unit->offset_limit_cnt ||
+      table->s->tmp_table != NO_TMP_TABLE ||
+      tab->type != JT_ALL || tab->first_inner ||
+      (quick && quick->get_type() != QUICK_SELECT_I::QS_TYPE_RANGE) ||
+      join->select_lex->first_inner_unit() ||
+      lock_type > TL_READ_NO_INSERT ||
+      lock_type == TL_READ_WITH_SHARED_LOCKS)
+    DBUG_RETURN(FALSE);
 
-  if (join->tables == join->const_tables)
-    DBUG_RETURN(0);				// One row, no need to sort
-  tab=    join->join_tab + join->const_tables;
-  table=  tab->table;
-  select= tab->select;
+  table_records= table->file->stats.records;
+  fetch_rows= unit->select_limit_cnt - unit->offset_limit_cnt;
+  if (unit->select_limit_cnt >= table_records ||
+      fetch_rows * table->file->ref_length > thd->variables.sortbuff_size)
+    DBUG_RETURN(FALSE);
 
   /*
-    When there is SQL_BIG_RESULT do not sort using index for GROUP BY,
-    and thus force sorting on disk unless a group min-max optimization
-    is going to be used as it is applied now only for one table queries
-    with covering indexes.
+    An index only scan that is not already covering, in the order of
+    ORDER BY, and with all the columns of the condition and of the
+    position of a row.
   */
-  if ((order != join->group_list || 
-       !(join->select_options & SELECT_BIG_RESULT) ||
-       (select && select->quick &&
-        select->quick->get_type() == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)) &&
+  usable_keys= table->keys_in_use_for_order_by;
+  usable_keys.intersect(table->keys_in_use_for_query);
+  usable_keys.intersect(table->s->keys_for_keyread);
+  usable_keys.subtract(table->covering_keys);
+  if (table->s->primary_key != MAX_KEY &&
+      table->file->primary_key_is_clustered())
+    usable_keys.clear_bit(table->s->primary_key);
+  for (ORDER *ord= order; ord; ord= ord->next)
+  {
+    Item *item= (*ord->item)->real_item();
+    if (item->type() != Item::FIELD_ITEM ||
+        ((Item_field*) item)->field->table != table)
+      DBUG_RETURN(FALSE);
+    usable_keys.intersect(((Item_field*) item)->field->part_of_sortkey);
+  }
+  if (usable_keys.is_clear_all())
+    DBUG_RETURN(FALSE);
+
+  {
+    MY_BITMAP *save_read_set= table->read_set;
+    bitmap_clear_all(&table->tmp_set);
+    table->read_set= &table->tmp_set;
+    if (tab->select_cond)
+      tab->select_cond->walk(&Item::register_field_in_read_map, 1,
+                             (uchar*) table);
+    table->prepare_for_position();
+    table->read_set= save_read_set;
+  }
+  for (Field **field= table->field; *field; field++)
+  {
+    if (bitmap_is_set(&table->tmp_set, (*field)->field_index))
+      usable_keys.intersect((*field)->part_of_key);
+  }
+  if (usable_keys.is_clear_all())
+    DBUG_RETURN(FALSE);
+
+  /* Rows to scan to find the rows sent, as in test_if_skip_sort_order() */
+  if (quick)
+    scan_rows= min(unit->select_limit_cnt, quick->records);
+  else if (unit->select_limit_cnt > table->quick_condition_rows)
+    scan_rows= table_records;
+  else
+    scan_rows= (ha_rows) (unit->select_limit_cnt * (double) table_records /
+                          table->quick_condition_rows);
+
+  best_time= join->best_positions[join->const_tables].read_time;
+  for (uint nr= 0; nr < table->s->keys; nr++)
+  {
+    KEY *keyinfo= table->key_info + nr;
+    uint used_key_parts;
+    uint keys_per_block;
+    int direction;
+    double rec_per_key, index_scan_time, read_time;
+
+    if (!usable_keys.is_set(nr) ||
+        !(direction= test_if_order_by_key(order, table, nr, &used_key_parts)))
+      continue;
+    /* The range is only read forwards */
+    if (quick ? (quick->index != nr || direction < 0) :
+        (direction < 0 &&
+         !(table->file->index_flags(nr, 0, 1) & HA_READ_PREV)))
+      continue;
+
+    rec_per_key= keyinfo->rec_per_key[keyinfo->key_parts-1];
+    set_if_bigger(rec_per_key, 1);
+    index_scan_time= scan_rows/rec_per_key *
+                     min(rec_per_key, table->file->scan_time());
+    keys_per_block= table->file->stats.block_size/2/
+                    (keyinfo->key_length+table->file->ref_length)+1;
+    read_time= (double) (scan_rows+keys_per_block-1)/keys_per_block +
+               rows2double(fetch_rows);
+    if (read_time < best_time && read_time < index_scan_time)
+    {
+      best_time= read_time;
+      best_key= nr;
+      best_direction= direction;
+    }
+  }
+  if (best_key < 0)
+    DBUG_RETURN(FALSE);
+  *key= best_key;
+  *reverse= best_direction < 0;
+  DBUG_PRINT("info", ("key: %d  reverse: %d  cost: %g",
+                      best_key, (int) *reverse, best_time));
+  DBUG_RETURN(TRUE);
+}
+
+
+/**
+  Read the rows of ORDER BY ... LIMIT by a deferred row fetch.
+
+  The index is read in order with an index only scan, or the range of the
+  quick select on it. The rows that match the condition are skipped up to
+  the LIMIT offset, and the positions of the rows after them are saved in
+  table->sort.record_pointers. read_record then fetches these rows from
+  the table, as after a filesort.
+
+  @param join     Join
+  @param tab      Table to read
+  @param key      Index to scan
+  @param reverse  Scan the index backwards
+
+  @retval
+    0   ok
+  @retval
+    -1  Error
+*/
+
+static int
+deferred_row_fetch(JOIN *join, JOIN_TAB *tab, uint key, bool reverse)
+{
+  THD *thd= join->thd;
+  TABLE *table= tab->table;
+  handler *file= table->file;
+  SQL_SELECT *select= tab->select;
+  QUICK_SELECT_I *quick= select ? select->quick : 0;
+  COND *cond= tab->select_cond;
+  SELECT_LEX_UNIT *unit= join->unit;
+  MY_BITMAP *save_read_set= table->read_set;
+  MY_BITMAP *save_write_set= table->write_set;
+  ha_rows offset= unit->offset_limit_cnt;
+  ha_rows limit= unit->select_limit_cnt - offset;
+  ha_rows skipped= 0, found= 0, examined= 0;
+  ha_rows allocated= min(limit, 64);
+  uint ref_length= file->ref_length;
+  uchar *pointers;
+  int error;
+  DBUG_ENTER("deferred_row_fetch");
+
+  free_io_cache(table);
+  filesort_free_buffers(table, TRUE);
+  if (!(pointers= (uchar*) my_malloc(allocated * ref_length, MYF(MY_WME))))
+    DBUG_RETURN(-1);                            /* purecov: inspected */
+
+  /* Read only the columns of the condition and of the position */
+  bitmap_clear_all(&table->tmp_set);
+  table->read_set= &table->tmp_set;
+  if (cond)
+    cond->walk(&Item::register_field_in_read_map, 1, (uchar*) table);
+  table->prepare_for_position();
+  table->column_bitmaps_set(&table->tmp_set, &table->tmp_set);
+  table->set_keyread(TRUE);
+  table->status= 0;
+
+  if (quick)
+  {
+    if (!(error= quick->reset()))
+      error= quick->get_next();
+  }
+  else if (!(error= file->ha_index_init(key, 1)))
+    error= (reverse ? file->index_last(table->record[0]) :
+            file->index_first(table->record[0]));
+  while (!error)
+  {
+    if (thd->killed)
+    {
+      thd->send_kill_message();
+      error= -1;
+      break;
+    }
+    examined++;
+    if (!cond || cond->val_int())
+    {
+      if (skipped < offset)
+        skipped++;
+      else
+      {
+        if (found == allocated)
+        {
+          allocated= min(limit, allocated * 2);
+          if (!(pointers= (uchar*) my_realloc(pointers,
+                                              allocated * ref_length,
+                                              MYF(MY_WME |
+                                                  MY_FREE_ON_ERROR))))
+          {
+            error= -1;                          /* purecov: inspected */
+            break;
+          }
+        }
+        file->position(table->record[0]);
+        memcpy(pointers + found * ref_length, file->ref, ref_length);
+        if (++found == limit)
+          break;
+      }
+    }
+    if (thd->is_error())
+    {
+      error= -1;
+      break;
+    }
+    if (quick)
+      error= quick->get_next();
+    else
+      error= (reverse ? file->index_prev(table->record[0]) :
+              file->index_next(table->record[0]));
+  }
+
+  file->ha_index_or_rnd_end();
+  table->set_keyread(FALSE);
+  table->column_bitmaps_set(save_read_set, save_write_set);
+  if (error && error != HA_ERR_END_OF_FILE)
+  {
+    if (error > 0)
+      file->print_error(error, MYF(0));
+    my_free(pointers, MYF(MY_ALLOW_ZERO_PTR));
+    DBUG_RETURN(-1);
+  }
+
+  table->sort.record_pointers= pointers;
+  table->sort.found_records= found;
+  unit->offset_limit_cnt-= skipped;
+  join->skipped_rows= skipped;
+  if (select)
+  {
+    select->cleanup();
+    tab->select= 0;
+    table->quick_keys.clear_all();  // as far as we cleanup select->quick
+  }
+  tab->records= found;
+  tab->select_cond= 0;
+  tab->type= JT_ALL;				// Read with normal read_record
+  tab->read_first_record= join_init_read_record;
+  join->examined_rows+= examined;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  If not selecting by given key, create an index how records should be read
+
+  SYNOPSIS
+   create_sort_index()
+     thd		Thread handler
+     tab		Table to sort (in join structure)
+     order		How table should be sorted
+     filesort_limit	Max number of rows that needs to be sorted
+     select_limit	Max number of rows in final output
+		        Used to decide if we should use index or not
+     is_order_by        true if we are sorting on ORDER BY, false if GROUP BY
+                        Used to decide if we should use index or not     
+
+
+  IMPLEMENTATION
+   - If there is an index that can be used, 'tab' is modified to use
+     this index.
+   - If no index, create with filesort() an index file that can be used to
+     retrieve rows in order (should be done with 'read_record').
+     The sorted data is stored in tab->table and will be freed when calling
+     free_io_cache(tab->table).
+
+  RETURN VALUES
+    0		ok
+    -1		Some fatal error
+    1		No records
+*/
+
+static int
+create_sort_index(THD *thd, JOIN *join, ORDER *order,
+		  ha_rows filesort_limit, ha_rows select_limit,
+                  bool is_order_by)
+{
+  uint length= 0;
+  ha_rows examined_rows;
+  TABLE *table;
+  SQL_SELECT *select;
+  JOIN_TAB *tab;
+  ulonglong start_time= 0;
+  uint deferred_key;
+  bool deferred_reverse;
+  DBUG_ENTER("create_sort_index");
+
+  if (join->tables == join->const_tables)
+    DBUG_RETURN(0);				// One row, no need to sort
+  tab=    join->join_tab + join->const_tables;
+  table=  tab->table;
+  select= tab->select;
+
+  if (test_if_deferred_row_fetch(tab, order, &deferred_key,
+                                 &deferred_reverse))
+    DBUG_RETURN(deferred_row_fetch(join, tab, deferred_key,
+                                   deferred_reverse));
+
+  /*
+    When there is SQL_BIG_RESULT do not sort using index for GROUP BY,
+    and thus force sorting on disk unless a group min-max optimization
+    is going to be used as it is applied now only for one table queries
+    with covering indexes.
+  */
+  if ((order != join->group_list || 
+       !(join->select_options & SELECT_BIG_RESULT) ||
+       (select && select->quick &&
+        select->quick->get_type() == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)) &&
       test_if_skip_sort_order(tab,order,select_limit,0, 
                               is_order_by ?  &table->keys_in_use_for_order_by :
                               &table->keys_in_use_for_group_by))
@@ -14036,9 +14867,17 @@ create_sort_index(THD *thd, JOIN *join, ORDER *order,
 
   if (table->s->tmp_table)
     table->file->info(HA_STATUS_VARIABLE);	// Get record count
+  if (join->analyze)
+    start_time= my_getsystime();
   table->sort.found_records=filesort(thd, table,join->sortorder, length,
                                      select, filesort_limit, 0,
                                      &examined_rows);
+  if (join->analyze && table->sort.found_records != HA_POS_ERROR)
+  {
+    join->analyze->sort_loops++;
+    join->analyze->sort_rows+= table->sort.found_records;
+    join->analyze->sort_time+= my_getsystime() - start_time;
+  }
   tab->records= table->sort.found_records;	// For SQL_CALC_ROWS
   if (select)
   {
@@ -14185,8 +15024,8 @@ remove_duplicates(JOIN *join, TABLE *entry,List<Item> &fields, Item *having)
 
   free_io_cache(entry);				// Safety
   entry->file->info(HA_STATUS_VARIABLE);
-  if (entry->s->db_type() == heap_hton ||
-      (!entry->s->blob_fields &&
+  if (!entry->s->blob_fields &&
+      (entry->s->db_type() == heap_hton ||
        ((ALIGN_SIZE(reclength) + HASH_OVERHEAD) * entry->file->stats.records <
 	thd->variables.sortbuff_size)))
     error=remove_dup_with_hash_index(join->thd, entry,
@@ -16544,17 +17383,19 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
   List<Item> field_list;
   List<Item> item_list;
   THD *thd=join->thd;
-  select_result *result=join->result;
   Item *item_null= new Item_null();
   CHARSET_INFO *cs= system_charset_info;
   int quick_type;
+  enum join_type type;
   DBUG_ENTER("select_describe");
   DBUG_PRINT("info", ("Select 0x%lx, type %s, message %s",
 		      (ulong)join->select_lex, join->select_lex->type,
 		      message ? message : "NULL"));
   /* Don't log this into the slow query log */
   thd->server_status&= ~(SERVER_QUERY_NO_INDEX_USED | SERVER_QUERY_NO_GOOD_INDEX_USED);
-  join->unit->offset_limit_cnt= 0;
+  /* With explain_analyze the select is executed afterwards */
+  if (!join->analyze)
+    join->unit->offset_limit_cnt= 0;
 
   /* 
     NOTE: the number/types of items pushed into item_list must be in sync with
@@ -16574,7 +17415,7 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
       item_list.push_back(item_null);
   
     item_list.push_back(new Item_string(message,strlen(message),cs));
-    if (result->send_data(item_list))
+    if (send_explain_row(join, item_list))
       join->error= 1;
   }
   else if (join->select_lex == join->unit->fake_select_lex)
@@ -16644,7 +17485,7 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
     else
       item_list.push_back(new Item_string("", 0, cs));
 
-    if (result->send_data(item_list))
+    if (send_explain_row(join, item_list))
       join->error= 1;
   }
   else
@@ -16669,6 +17510,7 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
       tmp3.length(0);
 
       quick_type= -1;
+      type= tab->type;
       item_list.empty();
       /* id */
       item_list.push_back(new Item_uint((uint32)
@@ -16677,16 +17519,18 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
       item_list.push_back(new Item_string(join->select_lex->type,
 					  strlen(join->select_lex->type),
 					  cs));
-      if (tab->type == JT_ALL && tab->select && tab->select->quick)
+      if (type == JT_ALL && tab->select && tab->select->quick)
       {
         quick_type= tab->select->quick->get_type();
         if ((quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_MERGE) ||
             (quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT) ||
             (quick_type == QUICK_SELECT_I::QS_TYPE_ROR_UNION))
-          tab->type = JT_INDEX_MERGE;
+          type= JT_INDEX_MERGE;
         else
-	  tab->type = JT_RANGE;
+	  type= JT_RANGE;
       }
+      else if (tab->deferred_row_fetch)
+        type= JT_NEXT;
       /* table */
       if (table->derived_select_number)
       {
@@ -16723,8 +17567,8 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
 #endif
       }
       /* "type" column */
-      item_list.push_back(new Item_string(join_type_str[tab->type],
-					  strlen(join_type_str[tab->type]),
+      item_list.push_back(new Item_string(join_type_str[type],
+					  strlen(join_type_str[type]),
 					  cs));
       /* Build "possible_keys" value and add it to item_list */
       if (!tab->keys.is_clear_all())
@@ -16759,16 +17603,23 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
                 keylen_str_buf;
         item_list.push_back(new Item_string(keylen_str_buf, length,
                                             system_charset_info));
-	for (store_key **ref=tab->ref.key_copy ; *ref ; ref++)
+	store_key **ref=tab->ref.key_copy;
+	for (uint part= 0 ; part < tab->ref.key_parts ; part++)
 	{
+	  const char *name;
+	  if (tab->ref.const_key_parts & ((key_part_map) 1 << part))
+	    name= "const";                      // Copied in create_ref_for_key
+	  else if (*ref)
+	    name= (*ref++)->name();
+	  else
+	    break;
 	  if (tmp2.length())
 	    tmp2.append(',');
-	  tmp2.append((*ref)->name(), strlen((*ref)->name()),
-		      system_charset_info);
+	  tmp2.append(name, strlen(name), system_charset_info);
 	}
 	item_list.push_back(new Item_string(tmp2.ptr(),tmp2.length(),cs));
       }
-      else if (tab->type == JT_NEXT)
+      else if (type== JT_NEXT)
       {
 	KEY *key_info=table->key_info+ tab->index;
         register uint length;
@@ -16834,7 +17685,7 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
         ha_rows examined_rows;
         if (tab->select && tab->select->quick)
           examined_rows= tab->select->quick->records;
-        else if (tab->type == JT_NEXT || tab->type == JT_ALL)
+        else if (type== JT_NEXT || type== JT_ALL)
         {
           if (tab->limit)
             examined_rows= tab->limit;
@@ -16863,7 +17714,7 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
 
       /* Build "Extra" field and add it to item_list. */
       my_bool key_read=table->key_read;
-      if ((tab->type == JT_NEXT || tab->type == JT_CONST) &&
+      if ((type== JT_NEXT || type== JT_CONST) &&
           table->covering_keys.is_set(tab->index))
 	key_read=1;
       if (quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT &&
@@ -16965,6 +17816,8 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
 	  need_order=0;
 	  extra.append(STRING_WITH_LEN("; Using filesort"));
 	}
+        if (tab->deferred_row_fetch)
+          extra.append(STRING_WITH_LEN("; Using deferred row fetch"));
 	if (distinct & test_all_bits(used_tables, thd->lex->used_tables))
 	  extra.append(STRING_WITH_LEN("; Distinct"));
 
@@ -16978,6 +17831,8 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
         }
         if (i > 0 && tab[-1].next_select == sub_select_cache)
           extra.append(STRING_WITH_LEN("; Using join buffer"));
+        if (i == 0 && join->unit->item && join->unit->item->use_memo())
+          extra.append(STRING_WITH_LEN("; Using subquery cache"));
         
         /* Skip initial "; "*/
         const char *str= extra.ptr();
@@ -16991,21 +17846,57 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
       }
       // For next iteration
       used_tables|=table->map;
-      if (result->send_data(item_list))
+      if (send_explain_row(join, item_list))
 	join->error= 1;
     }
   }
+  /* With explain_analyze the inner selects save their own rows */
+  if (join->analyze)
+    DBUG_VOID_RETURN;
   for (SELECT_LEX_UNIT *unit= join->select_lex->first_inner_unit();
        unit;
        unit= unit->next_unit())
   {
-    if (mysql_explain_union(thd, unit, result))
+    if (mysql_explain_union(thd, unit, join->result))
       DBUG_VOID_RETURN;
   }
   DBUG_VOID_RETURN;
 }
 
 
+/**
+  Set the "select_type" column of EXPLAIN for a select.
+*/
+
+static void set_explain_type(THD *thd, SELECT_LEX *sl)
+{
+  SELECT_LEX_UNIT *unit= sl->master_unit();
+  SELECT_LEX *first= unit->first_select();
+  // drop UNCACHEABLE_EXPLAIN, because it is for internal usage only
+  uint8 uncacheable= (sl->uncacheable & ~UNCACHEABLE_EXPLAIN);
+
+  if (sl == unit->fake_select_lex)
+  {
+    sl->type= "UNION RESULT";
+    return;
+  }
+  sl->type= (((&thd->lex->select_lex)==sl)?
+             (sl->first_inner_unit() || sl->next_select() ? 
+              "PRIMARY" : "SIMPLE"):
+             ((sl == first)?
+              ((sl->linkage == DERIVED_TABLE_TYPE) ?
+               "DERIVED":
+               ((uncacheable & UNCACHEABLE_DEPENDENT) ?
+                "DEPENDENT SUBQUERY":
+                (uncacheable?"UNCACHEABLE SUBQUERY":
+                 "SUBQUERY"))):
+              ((uncacheable & UNCACHEABLE_DEPENDENT) ?
+               "DEPENDENT UNION":
+               uncacheable?"UNCACHEABLE UNION":
+               "UNION")));
+}
+
+
 bool mysql_explain_union(THD *thd, SELECT_LEX_UNIT *unit, select_result *result)
 {
   DBUG_ENTER("mysql_explain_union");
@@ -17016,22 +17907,7 @@ bool mysql_explain_union(THD *thd, SELECT_LEX_UNIT *unit, select_result *result)
        sl;
        sl= sl->next_select())
   {
-    // drop UNCACHEABLE_EXPLAIN, because it is for internal usage only
-    uint8 uncacheable= (sl->uncacheable & ~UNCACHEABLE_EXPLAIN);
-    sl->type= (((&thd->lex->select_lex)==sl)?
-	       (sl->first_inner_unit() || sl->next_select() ? 
-		"PRIMARY" : "SIMPLE"):
-	       ((sl == first)?
-		((sl->linkage == DERIVED_TABLE_TYPE) ?
-		 "DERIVED":
-		 ((uncacheable & UNCACHEABLE_DEPENDENT) ?
-		  "DEPENDENT SUBQUERY":
-		  (uncacheable?"UNCACHEABLE SUBQUERY":
-		   "SUBQUERY"))):
-		((uncacheable & UNCACHEABLE_DEPENDENT) ?
-		 "DEPENDENT UNION":
-		 uncacheable?"UNCACHEABLE UNION":
-		 "UNION")));
+    set_explain_type(thd, sl);
     sl->options|= SELECT_DESCRIBE;
   }
   if (unit->is_union())
@@ -17064,6 +17940,506 @@ bool mysql_explain_union(THD *thd, SELECT_LEX_UNIT *unit, select_result *result)
 }
 
 
+/****************************************************************************
+  EXPLAIN with explain_analyze
+
+  The statement is executed, and each select saves the rows EXPLAIN would
+  send for it, see save_analyze_plan(). While do_select() runs, the access
+  functions of its JOIN_TABs are wrapped to count the loops, the rows read,
+  the rows that passed select_cond and the time spent reading. Nothing of
+  this is done for other statements. select_explain_analyze::send_explain()
+  then sends the saved rows with the statistics next to the estimates.
+****************************************************************************/
+
+/**
+  Copy an EXPLAIN row for select_explain_analyze, as select_describe()
+  builds some of its items on buffers on the stack.
+*/
+
+static bool save_explain_row(THD *thd, SELECT_ANALYZE *analyze,
+                             List<Item> &item_list)
+{
+  List_iterator_fast<Item> it(item_list);
+  List<Item> *row;
+  Item *item;
+  char buff[MAX_FIELD_WIDTH];
+  String buffer(buff, sizeof(buff), system_charset_info);
+
+  if (!(row= new List<Item>))
+    return TRUE;
+  while ((item= it++))
+  {
+    Item *copy;
+    String *res;
+    if (item->type() == Item::NULL_ITEM)
+      copy= new Item_null();
+    else if (item->result_type() == INT_RESULT)
+      copy= new Item_int(item->val_int(), item->max_length);
+    else if (item->result_type() == REAL_RESULT)
+      copy= new Item_float(item->val_real(), item->decimals);
+    else
+    {
+      res= item->val_str(&buffer);
+      copy= new Item_string(thd->strmake(res->ptr(), res->length()),
+                            res->length(), res->charset());
+    }
+    if (!copy || row->push_back(copy))
+      return TRUE;
+  }
+  return analyze->rows.push_back(row);
+}
+
+
+/**
+  Send an EXPLAIN row, or save it for EXPLAIN with explain_analyze.
+*/
+
+static bool send_explain_row(JOIN *join, List<Item> &item_list)
+{
+  if (join->analyze)
+    return save_explain_row(join->thd, join->analyze, item_list);
+  return join->result->send_data(item_list);
+}
+
+
+/**
+  Save the EXPLAIN rows of a select for EXPLAIN with explain_analyze.
+
+  JOIN::optimize() calls this where it stops for EXPLAIN, and JOIN::exec()
+  for a select that EXPLAIN shows with a message. The rows are the same
+  as with EXPLAIN, except that an index test_if_skip_sort_order() may
+  still switch to for ORDER BY is not shown: that would change the plan
+  the statement is executed with.
+*/
+
+static void save_analyze_plan(JOIN *join)
+{
+  THD *thd= join->thd;
+  LEX *lex= thd->lex;
+  uint8 save_describe= lex->describe;
+  SELECT_ANALYZE *analyze;
+  DBUG_ENTER("save_analyze_plan");
+
+  if (!(analyze= lex->explain_analyze->get_select(join->select_lex)))
+    DBUG_VOID_RETURN;
+  join->analyze= analyze;
+  if (join->tmp_join)
+    join->tmp_join->analyze= analyze;
+  if (analyze->rows.elements)
+  {
+    /* A new JOIN for the same select: keep counting */
+    if (analyze->tabs && analyze->tables == join->tables)
+      analyze->join_tab= join->join_tab;
+    DBUG_VOID_RETURN;
+  }
+
+  set_explain_type(thd, join->select_lex);
+  lex->describe= lex->explain_analyze->describe;
+  if (!join->tables_list &&
+      (join->tables || !join->select_lex->with_sum_func))
+    select_describe(join, FALSE, FALSE, FALSE,
+                    (join->zero_result_cause ? join->zero_result_cause :
+                     "No tables used"));
+  else if (join->zero_result_cause)
+    select_describe(join, FALSE, FALSE, FALSE, join->zero_result_cause);
+  else
+  {
+    /* As in the EXPLAIN branch of JOIN::exec(), but without changes */
+    ORDER *order= join->order;
+    bool simple_order= join->simple_order;
+    bool skip_sort_order= join->skip_sort_order;
+    JOIN_TAB *first_tab= join->join_tab + join->const_tables;
+    uint deferred_key;
+    bool deferred_reverse;
+    if (!order && !join->no_order && (!skip_sort_order || !join->need_tmp))
+    {
+      order= join->group_list;
+      simple_order= join->simple_group;
+      skip_sort_order= 0;
+    }
+    if (order && !join->need_tmp && join->const_tables != join->tables &&
+        test_if_deferred_row_fetch(first_tab, order, &deferred_key,
+                                   &deferred_reverse))
+    {
+      /* Only shown: create_sort_index() makes the same choice */
+      first_tab->deferred_row_fetch= TRUE;
+      first_tab->index= deferred_key;
+      order= 0;
+    }
+    if (order &&
+        (order != join->group_list ||
+         !(join->select_options & SELECT_BIG_RESULT)) &&
+        (join->const_tables == join->tables ||
+         ((simple_order || skip_sort_order) &&
+          test_if_skip_sort_order(&join->join_tab[join->const_tables], order,
+                                  join->select_limit, 1,
+                                  &join->join_tab[join->const_tables].table->
+                                    keys_in_use_for_query))))
+      order= 0;
+    if (join->tables &&
+        !(analyze->tabs= (JOIN_TAB_ANALYZE*)
+          thd->calloc(sizeof(JOIN_TAB_ANALYZE) * join->tables)))
+      goto end;
+    analyze->join_tab= join->join_tab;
+    analyze->tables= join->tables;
+    analyze->const_tables= join->const_tables;
+    select_describe(join, join->need_tmp, order != 0 && !skip_sort_order,
+                    join->select_distinct,
+                    !join->tables ? "No tables used" : NullS);
+    if (join->const_tables != join->tables)
+      first_tab->deferred_row_fetch= FALSE;
+  }
+end:
+  lex->describe= save_describe;
+  DBUG_VOID_RETURN;
+}
+
+
+static int analyze_read_first(JOIN_TAB *tab, Read_record_func read_first)
+{
+  JOIN_TAB_ANALYZE *analyze= tab->analyze;
+  ulonglong start_time= my_getsystime();
+  int error= (*read_first)(tab);
+  analyze->read_time+= my_getsystime() - start_time;
+  analyze->loops++;
+  if (!error)
+    analyze->rows_read++;
+  /* The access method may have set up a new read function */
+  if (tab->read_record.read_record != analyze_read_record &&
+      tab->read_record.read_record)
+  {
+    analyze->read_record= tab->read_record.read_record;
+    tab->read_record.read_record= analyze_read_record;
+  }
+  tab->read_record.join_tab= tab;               // For analyze_read_record()
+  return error;
+}
+
+
+static int analyze_read_first_record(JOIN_TAB *tab)
+{
+  return analyze_read_first(tab, tab->analyze->read_first_record);
+}
+
+
+static int analyze_read_record(READ_RECORD *info)
+{
+  JOIN_TAB_ANALYZE *analyze= info->join_tab->analyze;
+  ulonglong start_time= my_getsystime();
+  int error= (*analyze->read_record)(info);
+  analyze->read_time+= my_getsystime() - start_time;
+  if (!error)
+    analyze->rows_read++;
+  return error;
+}
+
+
+/**
+  Count a row that passed the select_cond of the JOIN_TAB before join_tab.
+*/
+
+static enum_nested_loop_state
+analyze_next_select(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
+{
+  JOIN_TAB_ANALYZE *analyze= join_tab[-1].analyze;
+  if (!end_of_records)
+    analyze->rows_passed++;
+  return (*analyze->next_select)(join, join_tab, end_of_records);
+}
+
+
+/**
+  Wrap the access functions of the JOIN_TABs for do_select(), which
+  calls analyze_detach() when it is done.
+*/
+
+static void analyze_attach(JOIN *join)
+{
+  SELECT_ANALYZE *analyze= join->analyze;
+
+  /* Nothing to count when a temporary table is read */
+  if (!analyze->tabs || join->join_tab != analyze->join_tab)
+    return;
+  for (uint i= join->const_tables; i < join->tables; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    JOIN_TAB_ANALYZE *tab_analyze= analyze->tabs + i;
+    tab->analyze= tab_analyze;
+    tab_analyze->read_first_record= tab->read_first_record;
+    tab->read_first_record= analyze_read_first_record;
+    tab_analyze->next_select= tab->next_select;
+    tab->next_select= analyze_next_select;
+  }
+}
+
+
+static void analyze_detach(JOIN *join)
+{
+  SELECT_ANALYZE *analyze= join->analyze;
+
+  if (!analyze->tabs || join->join_tab != analyze->join_tab)
+    return;
+  for (uint i= join->const_tables; i < join->tables; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    JOIN_TAB_ANALYZE *tab_analyze= analyze->tabs + i;
+    if (tab->read_first_record == analyze_read_first_record)
+      tab->read_first_record= tab_analyze->read_first_record;
+    if (tab->read_record.read_record == analyze_read_record)
+      tab->read_record.read_record= tab_analyze->read_record;
+    if (tab->next_select == analyze_next_select)
+      tab->next_select= tab_analyze->next_select;
+    tab->analyze= 0;
+  }
+}
+
+
+/**
+  Count the rows written to a temporary table since start_time. The time
+  includes reading the tables the rows come from.
+*/
+
+static void analyze_tmp_table(SELECT_ANALYZE *analyze, TABLE *table,
+                              ulonglong start_time)
+{
+  analyze->tmp_time+= my_getsystime() - start_time;
+  analyze->tmp_loops++;
+  table->file->info(HA_STATUS_VARIABLE);
+  analyze->tmp_rows+= table->file->stats.records;
+  if (table->s->db_type() != heap_hton)
+    analyze->tmp_on_disk= TRUE;
+}
+
+
+static void append_analyze_stat(String *str, const char *name, double value,
+                                uint decimals)
+{
+  char buff[FLOATING_POINT_BUFFER];
+  String num(buff, sizeof(buff), system_charset_info);
+  num.set_real(value, decimals, system_charset_info);
+  str->append(name);
+  str->append('=');
+  str->append(num);
+}
+
+
+/**
+  Add the statistics of filesort and of the temporary tables of a select
+  to its Extra column.
+*/
+
+static Item *analyze_extra(THD *thd, Item *extra, SELECT_ANALYZE *analyze)
+{
+  String tmp, *res= extra->val_str(&tmp);
+  String str;
+  char *pos;
+
+  str.copy(*res);
+  if (analyze->tmp_loops)
+  {
+    if (str.length())
+      str.append(STRING_WITH_LEN("; "));
+    str.append(STRING_WITH_LEN("Temporary table: "));
+    append_analyze_stat(&str, "r_loops", (double) analyze->tmp_loops, 0);
+    str.append(STRING_WITH_LEN(", "));
+    append_analyze_stat(&str, "r_rows", (double) analyze->tmp_rows, 0);
+    str.append(STRING_WITH_LEN(", "));
+    append_analyze_stat(&str, "r_time_ms", analyze->tmp_time / 10000.0, 3);
+    if (analyze->tmp_on_disk)
+      str.append(STRING_WITH_LEN(", on disk"));
+  }
+  if (analyze->sort_loops)
+  {
+    if (str.length())
+      str.append(STRING_WITH_LEN("; "));
+    str.append(STRING_WITH_LEN("Filesort: "));
+    append_analyze_stat(&str, "r_loops", (double) analyze->sort_loops, 0);
+    str.append(STRING_WITH_LEN(", "));
+    append_analyze_stat(&str, "r_rows", (double) analyze->sort_rows, 0);
+    str.append(STRING_WITH_LEN(", "));
+    append_analyze_stat(&str, "r_time_ms", analyze->sort_time / 10000.0, 3);
+  }
+  if (!(pos= thd->strmake(str.ptr(), str.length())))
+    return 0;
+  return new Item_string(pos, str.length(), system_charset_info);
+}
+
+
+/**
+  Evaluate a row of the statement and drop it.
+*/
+
+bool select_explain_analyze::send_data(List<Item> &items)
+{
+  List_iterator_fast<Item> li(items);
+  char buff[MAX_FIELD_WIDTH];
+  String buffer(buff, sizeof(buff), &my_charset_bin);
+  Item *item;
+
+  if (unit->offset_limit_cnt)
+  {						// using limit offset,count
+    unit->offset_limit_cnt--;
+    return 0;
+  }
+  while ((item= li++))
+  {
+    (void) item->val_str(&buffer);
+    buffer.set(buff, sizeof(buff), &my_charset_bin);
+  }
+  thd->sent_row_count++;
+  return thd->is_error();
+}
+
+
+SELECT_ANALYZE *select_explain_analyze::find_select(SELECT_LEX *select_lex)
+{
+  List_iterator_fast<SELECT_ANALYZE> it(selects);
+  SELECT_ANALYZE *analyze;
+  while ((analyze= it++))
+  {
+    if (analyze->select_lex == select_lex)
+      return analyze;
+  }
+  return 0;
+}
+
+
+SELECT_ANALYZE *select_explain_analyze::get_select(SELECT_LEX *select_lex)
+{
+  SELECT_ANALYZE *analyze;
+  if ((analyze= find_select(select_lex)))
+    return analyze;
+  if (!(analyze= (SELECT_ANALYZE*) thd->calloc(sizeof(SELECT_ANALYZE))))
+    return 0;
+  analyze->select_lex= select_lex;
+  analyze->rows.empty();
+  if (selects.push_back(analyze))
+    return 0;
+  return analyze;
+}
+
+
+bool select_explain_analyze::send_explain(select_result *result)
+{
+  List<Item> field_list;
+  if (result->prepare(field_list, &thd->lex->unit))
+    return TRUE;
+  /* What is left of OFFSET if the statement returned fewer rows */
+  thd->lex->unit.offset_limit_cnt= 0;
+  return send_unit(&thd->lex->unit, result);
+}
+
+
+/** Send the rows of the selects of a unit, in the order of EXPLAIN */
+
+bool select_explain_analyze::send_unit(SELECT_LEX_UNIT *unit,
+                                       select_result *result)
+{
+  for (SELECT_LEX *sl= unit->first_select(); sl; sl= sl->next_select())
+  {
+    if (send_select(sl, result))
+      return TRUE;
+  }
+  if (unit->is_union() && send_select(unit->fake_select_lex, result))
+    return TRUE;
+  return FALSE;
+}
+
+
+/**
+  Send the rows of a select with the statistics, followed by the rows of
+  the selects nested in it.
+*/
+
+bool select_explain_analyze::send_select(SELECT_LEX *sl,
+                                         select_result *result)
+{
+  SELECT_ANALYZE *analyze= find_select(sl);
+  CHARSET_INFO *cs= system_charset_info;
+  Item *item_null= new Item_null();
+  List<Item> item_list;
+
+  if (!analyze)
+  {
+    /* Not executed, the optimizer has no plan for it */
+    set_explain_type(thd, sl);
+    if (sl == sl->master_unit()->fake_select_lex)
+      item_list.push_back(item_null);
+    else
+      item_list.push_back(new Item_uint((uint32) sl->select_number));
+    item_list.push_back(new Item_string(sl->type, strlen(sl->type), cs));
+    for (uint i= 0 ; i < 7 + 4; i++)
+      item_list.push_back(item_null);
+    if (describe & DESCRIBE_PARTITIONS)
+      item_list.push_back(item_null);
+    if (describe & DESCRIBE_EXTENDED)
+      item_list.push_back(item_null);
+    item_list.push_back(new Item_string(STRING_WITH_LEN("Not executed"), cs));
+    if (result->send_data(item_list))
+      return TRUE;
+  }
+  else
+  {
+    List_iterator_fast<List<Item> > rows(analyze->rows);
+    List<Item> *row;
+    for (uint i= 0; (row= rows++); i++)
+    {
+      List_iterator_fast<Item> it(*row);
+      Item *extra;
+      item_list.empty();
+      for (uint j= 1; j < row->elements; j++)
+        item_list.push_back(it++);
+      extra= it++;
+
+      if (analyze->tabs && i >= analyze->const_tables && i < analyze->tables)
+      {
+        JOIN_TAB_ANALYZE *tab= analyze->tabs + i;
+        item_list.push_back(new Item_int((longlong) tab->loops,
+                                         MY_INT64_NUM_DECIMAL_DIGITS));
+        if (tab->loops)
+        {
+          item_list.push_back(new Item_float((double) tab->rows_read /
+                                             tab->loops, 2));
+          if (tab->rows_read)
+            item_list.push_back(new Item_float(100.0 * tab->rows_passed /
+                                               tab->rows_read, 2));
+          else
+            item_list.push_back(item_null);
+          item_list.push_back(new Item_float(tab->read_time / 10000.0, 3));
+        }
+        else
+        {
+          for (uint j= 0; j < 3; j++)
+            item_list.push_back(item_null);
+        }
+      }
+      else
+      {
+        for (uint j= 0; j < 4; j++)
+          item_list.push_back(item_null);
+      }
+
+      /* Filesort and temporary tables go with the first row, as in Extra */
+      if (i == 0 && (analyze->sort_loops || analyze->tmp_loops) &&
+          !(extra= analyze_extra(thd, extra, analyze)))
+        return TRUE;
+      item_list.push_back(extra);
+      if (result->send_data(item_list))
+        return TRUE;
+    }
+  }
+
+  for (SELECT_LEX_UNIT *unit= sl->first_inner_unit();
+       unit;
+       unit= unit->next_unit())
+  {
+    if (send_unit(unit, result))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
 /**
   Print joins from the FROM clause.
 
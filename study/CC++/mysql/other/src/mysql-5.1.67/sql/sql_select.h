@@ -84,6 +84,12 @@ typedef struct st_table_ref
     rows will be produced if items[i] IS NULL (see add_not_null_conds())
   */
   key_part_map  null_rejecting;
+  /**
+    (const_key_parts & (1<<i)) means key part i was copied into key_buff
+    once as a constant and has no store_key in key_copy. Set only for
+    EXPLAIN with explain_analyze, which shows "const" for it.
+  */
+  key_part_map  const_key_parts;
   table_map	depend_map;		  ///< Table depends on these tables.
   /* null byte position in the key_buf. Used for REF_OR_NULL optimization */
   uchar          *null_ref_key;
@@ -120,6 +126,59 @@ typedef struct st_join_cache {
 } JOIN_CACHE;
 
 
+/**
+  Hash table of the groups of a GROUP BY that is done into a temporary
+  table, see end_hash_update(). Each entry holds a copy of the group key
+  and of the temporary table record with the aggregate values. The entries
+  are also chained in insertion order, so that the groups reach the
+  temporary table in the same order as with end_update().
+*/
+
+typedef struct st_group_hash_entry
+{
+  struct st_group_hash_entry *next;     /**< next group in insertion order */
+  ulong hash_value;
+} GROUP_HASH_ENTRY;
+
+
+class Group_hash
+{
+  MEM_ROOT mem_root;                    /**< entries */
+  GROUP_HASH_ENTRY **slots;             /**< open addressing, linear probing */
+  GROUP_HASH_ENTRY *first, **last;
+  ulong slot_mask, records;
+  uint key_length, reclength;
+  size_t max_memory;
+  bool resize(ulong size);
+public:
+  Group_hash() :slots(0), first(0), last(&first), slot_mask(0), records(0)
+  { init_sql_alloc(&mem_root, 8192, 0); }
+  ~Group_hash()
+  {
+    free_root(&mem_root, MYF(0));
+    my_free((uchar*) slots, MYF(MY_ALLOW_ZERO_PTR));
+  }
+  bool init(uint key_length_arg, uint reclength_arg, size_t max_memory_arg);
+  void reset();
+  GROUP_HASH_ENTRY *find(ORDER *group, const uchar *key_buff,
+                         ulong hash_value);
+  GROUP_HASH_ENTRY *insert(const uchar *key_buff, const uchar *record_buff,
+                           ulong hash_value);
+  GROUP_HASH_ENTRY *first_entry() { return first; }
+  uchar *key(GROUP_HASH_ENTRY *entry)
+  { return (uchar*) entry + ALIGN_SIZE(sizeof(GROUP_HASH_ENTRY)); }
+  uchar *record(GROUP_HASH_ENTRY *entry)
+  { return key(entry) + ALIGN_SIZE(key_length); }
+  /** TRUE if the groups use more memory than an in-memory tmp table may */
+  bool is_full() const
+  {
+    return (records * (ALIGN_SIZE(sizeof(GROUP_HASH_ENTRY)) +
+                       ALIGN_SIZE(key_length) + ALIGN_SIZE(reclength)) +
+            (slot_mask + 1) * sizeof(*slots)) > max_memory;
+  }
+};
+
+
 /*
   The structs which holds the join connections and join states
 */
@@ -148,6 +207,31 @@ typedef enum_nested_loop_state
 typedef int (*Read_record_func)(struct st_join_table *tab);
 Next_select_func setup_end_select_func(JOIN *join);
 
+/**
+  Execution statistics of a JOIN_TAB for EXPLAIN with explain_analyze.
+
+  They are counted by wrappers around the access functions of the JOIN_TAB,
+  which are installed by do_select() only while such a statement runs, so
+  that other statements do not pay for them.
+*/
+
+typedef struct st_join_tab_analyze
+{
+  ulonglong loops;              /**< read_first_record() calls */
+  ulonglong rows_read;          /**< rows returned by the access method */
+  ulonglong rows_passed;        /**< rows that passed select_cond */
+  ulonglong read_time;          /**< time spent reading, my_getsystime() units */
+  /* The wrapped functions */
+  Read_record_func read_first_record;
+  READ_RECORD::Read_func read_record;
+  Next_select_func next_select;
+} JOIN_TAB_ANALYZE;
+
+
+/* Limits of the blocks of rows of a table scan, see ROW_BLOCK */
+#define ROW_BLOCK_SIZE (64*1024)
+#define ROW_BLOCK_MAX_ROWS 256
+#define ROW_BLOCK_MIN_ROWS 16
 
 typedef struct st_join_table {
   st_join_table() {}                          /* Remove gcc warning */
@@ -221,6 +305,12 @@ typedef struct st_join_table {
   JOIN		*join;
   /** Bitmap of nested joins this table is part of */
   nested_join_map embedding_map;
+  /** Set while the wrappers of EXPLAIN with explain_analyze are installed */
+  JOIN_TAB_ANALYZE *analyze;
+  /** Set if a table scan is to read and filter its rows by blocks */
+  ROW_BLOCK *row_block;
+  /** Set for EXPLAIN if ORDER BY ... LIMIT reads rows by deferred fetch */
+  bool deferred_row_fetch;
 
   void cleanup();
   inline bool is_using_loose_index_scan()
@@ -278,6 +368,51 @@ typedef struct st_rollup
 } ROLLUP;
 
 
+/**
+  EXPLAIN with explain_analyze: the EXPLAIN rows and the execution statistics
+  of one select. The rows are saved by select_describe() when the select is
+  first executed, and the statistics are added when they are sent.
+*/
+
+typedef struct st_select_analyze
+{
+  SELECT_LEX *select_lex;
+  List<List<Item> > rows;
+  JOIN_TAB *join_tab;           /**< the JOIN_TABs the statistics are for */
+  JOIN_TAB_ANALYZE *tabs;       /**< 0 if the select has a message row */
+  uint tables, const_tables;
+  ulonglong sort_loops, sort_rows, sort_time;   /**< filesort() */
+  ulonglong tmp_loops, tmp_rows, tmp_time;      /**< temporary tables */
+  bool tmp_on_disk;
+} SELECT_ANALYZE;
+
+
+/**
+  Result of a statement run by EXPLAIN with explain_analyze.
+
+  The statement is executed as a SELECT whose rows are evaluated and
+  dropped. send_explain() then sends the EXPLAIN rows saved by the
+  selects, in the order of EXPLAIN, with the statistics next to the
+  estimates.
+*/
+
+class select_explain_analyze :public select_result
+{
+  List<SELECT_ANALYZE> selects;
+  SELECT_ANALYZE *find_select(SELECT_LEX *select_lex);
+  bool send_unit(SELECT_LEX_UNIT *unit, select_result *result);
+  bool send_select(SELECT_LEX *sl, select_result *result);
+public:
+  uint8 describe;                       /**< DESCRIBE_* of the statement */
+  select_explain_analyze(uint8 describe_arg) :describe(describe_arg) {}
+  bool send_fields(List<Item> &list, uint flags) { return FALSE; }
+  bool send_data(List<Item> &items);
+  bool send_eof() { return FALSE; }
+  SELECT_ANALYZE *get_select(SELECT_LEX *select_lex);
+  bool send_explain(select_result *result);
+};
+
+
 class JOIN :public Sql_alloc
 {
   JOIN(const JOIN &rhs);                        /**< not implemented */
@@ -309,6 +444,11 @@ public:
   */
   table_map outer_join;
   ha_rows  send_records,found_records,examined_rows,row_limit, select_limit;
+  /**
+    Rows of the LIMIT offset that deferred_row_fetch() skipped. send_records
+    starts from it, so that FOUND_ROWS() counts them.
+  */
+  ha_rows  skipped_rows;
   /**
     Used to fetch no more than given amount of rows per one
     fetch operation of server side cursor.
@@ -344,6 +484,10 @@ public:
   ulonglong  select_options;
   select_result *result;
   TMP_TABLE_PARAM tmp_table_param;
+  /** Groups of end_hash_update(); only set while do_select() runs */
+  Group_hash *group_hash;
+  /** Statistics of EXPLAIN with explain_analyze, 0 otherwise */
+  SELECT_ANALYZE *analyze;
   MYSQL_LOCK *lock;
   /// unit structure (with global parameters) for this select
   SELECT_LEX_UNIT *unit;
@@ -470,6 +614,7 @@ public:
     do_send_rows= 1;
     resume_nested_loop= FALSE;
     send_records= 0;
+    skipped_rows= 0;
     found_records= 0;
     fetch_limit= HA_POS_ERROR;
     examined_rows= 0;
@@ -510,6 +655,8 @@ public:
     bzero((char*) &keyuse,sizeof(keyuse));
     tmp_table_param.init();
     tmp_table_param.end_write_records= HA_POS_ERROR;
+    group_hash= 0;
+    analyze= 0;
     rollup.state= ROLLUP::STATE_NONE;
 
     no_const_tables= FALSE;
@@ -19,10 +19,15 @@
 #define MERGEBUFF2		15
 
 /*
-   The structure SORT_ADDON_FIELD describes a fixed layout
+   The structure SORT_ADDON_FIELD describes the layout
    for field values appended to sorted values in records to be sorted
    in the sort buffer.
-   Only fixed layout is supported now.
+   Two layouts are supported. In the fixed layout every field gets
+   its maximal packed length, so all records have the same size.
+   In the packed layout (used when some of the fields are CHAR/VARCHAR)
+   the appended part starts with a SORT_ADDON_LENGTH_BYTES long length
+   prefix and the field values follow each other without gaps; only
+   the offset of the first field is then meaningful.
    Null bit maps for the appended values is placed before the values 
    themselves. Offsets are from the last sorted field, that is from the
    record referefence, which is still last component of sorted records.
@@ -34,6 +39,8 @@
    the callback function 'unpack_addon_fields'.
 */
 
+#define SORT_ADDON_LENGTH_BYTES 4
+
 typedef struct st_sort_addon_field {  /* Sort addon packed field */
   Field *field;          /* Original field */
   uint   offset;         /* Offset from the last sorted field */
@@ -63,11 +70,13 @@ typedef struct st_sort_param {
   uint addon_length;        /* Length of added packed fields */
   uint res_length;          /* Length of records in final sorted file/buffer */
   uint keys;				/* Max keys / buffer */
+  size_t sort_buffer_size;  /* Bytes in the sort_keys buffer */
   ha_rows max_rows,examined_rows;
   TABLE *sort_form;			/* For quicker make_sortkey */
   SORT_FIELD *local_sortorder;
   SORT_FIELD *end;
   SORT_ADDON_FIELD *addon_field; /* Descriptors for companion fields */
+  bool using_packed_addons; /* Records have variable length addon parts */
   uchar *unique_buff;
   bool not_killable;
   char* tmp_buffer;
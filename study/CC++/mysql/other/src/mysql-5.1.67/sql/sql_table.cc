@@ -5227,29 +5227,45 @@ bool mysql_create_like_schema_frm(THD* thd, TABLE_LIST* schema_table,
   bool tmp_table= (create_info->options & HA_LEX_CREATE_TMP_TABLE);
   uint keys= schema_table->table->s->keys;
   uint db_options= 0;
+  handler *file= schema_table->table->file;
+  bool error= 1;
   DBUG_ENTER("mysql_create_like_schema_frm");
 
   bzero((char*) &local_create_info, sizeof(local_create_info));
   local_create_info.db_type= schema_table->table->s->db_type();
+  /*
+    A schema table with BLOBs is a HEAP table, but a HEAP table created
+    by a user cannot have BLOBs; make the copy a MyISAM table instead.
+  */
+  if (local_create_info.db_type == heap_hton &&
+      schema_table->table->s->blob_fields)
+  {
+    local_create_info.db_type= myisam_hton;
+    if (!(file= get_new_handler(schema_table->table->s, thd->mem_root,
+                                myisam_hton)))
+      DBUG_RETURN(1);
+  }
   local_create_info.row_type= schema_table->table->s->row_type;
   local_create_info.default_table_charset=default_charset_info;
   alter_info.flags= (ALTER_CHANGE_COLUMN | ALTER_RECREATE);
   schema_table->table->use_all_columns();
   if (mysql_prepare_alter_table(thd, schema_table->table,
                                 &local_create_info, &alter_info))
-    DBUG_RETURN(1);
+    goto end;
   if (mysql_prepare_create_table(thd, &local_create_info, &alter_info,
-                                 tmp_table, &db_options,
-                                 schema_table->table->file,
+                                 tmp_table, &db_options, file,
                                  &schema_table->table->s->key_info, &keys, 0))
-    DBUG_RETURN(1);
+    goto end;
   local_create_info.max_rows= 0;
   if (mysql_create_frm(thd, dst_path, NullS, NullS,
                        &local_create_info, alter_info.create_list,
-                       keys, schema_table->table->s->key_info,
-                       schema_table->table->file))
-    DBUG_RETURN(1);
-  DBUG_RETURN(0);
+                       keys, schema_table->table->s->key_info, file))
+    goto end;
+  error= 0;
+end:
+  if (file != schema_table->table->file)
+    delete file;
+  DBUG_RETURN(error);
 }
 
 
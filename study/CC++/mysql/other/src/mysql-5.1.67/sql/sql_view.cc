@@ -1263,7 +1263,8 @@ bool mysql_make_view(THD *thd, File_parser *parser, TABLE_LIST *table,
       Skip this step if we are opening view for prelocking only.
     */
     if (!table->prelocking_placeholder &&
-        (old_lex->sql_command == SQLCOM_SELECT && old_lex->describe))
+        (old_lex->sql_command == SQLCOM_SELECT &&
+         (old_lex->describe || old_lex->explain_analyze)))
     {
       /*
         The user we run EXPLAIN as (either the connected user who issued
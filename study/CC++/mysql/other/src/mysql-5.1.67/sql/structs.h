@@ -121,10 +121,32 @@ typedef struct st_reginfo {		/* Extra info about reg */
 class SQL_SELECT;
 class THD;
 class handler;
+class Item_func;
 struct st_join_table;
 
 void rr_unlock_row(st_join_table *tab);
 
+/*
+  Rows of a table scan which are read ahead into a block, so that simple
+  conditions on them can be evaluated for the whole block at once by
+  Item_func::filter_batch() before the rows are returned one by one.
+*/
+
+typedef struct st_row_block
+{
+  Item_func **conds;                    /* Conditions evaluated by block */
+  uint cond_count;
+  bool whole_cond;                      /* conds are all of select_cond */
+  bool keep_nulls;                      /* Leave NULL results to select_cond */
+  uchar *rows;                          /* max_rows copies of record[0] */
+  uint16 *selection;                    /* Numbers of the rows not rejected */
+  uint row_length, max_rows;
+  uint row_count, selected, next;       /* next: position in selection */
+  int last_row;                         /* Last row returned, or -1 */
+  int error;                            /* What ended the last fill, or 0 */
+  ha_rows rejected;                     /* Since the last row returned */
+} ROW_BLOCK;
+
 struct READ_RECORD {			/* Parameter to read_record */
   typedef int (*Read_func)(READ_RECORD*);
   typedef void (*Unlock_row_func)(st_join_table *);
@@ -144,6 +166,8 @@ struct READ_RECORD {			/* Parameter to read_record */
   uchar *rec_buf;                /* to read field values  after filesort */
   uchar	*cache,*cache_pos,*cache_end,*read_positions;
   IO_CACHE *io_cache;
+  ROW_BLOCK *row_block;
+  struct st_join_table *join_tab;	/* Set by EXPLAIN with explain_analyze */
   bool print_error, ignore_not_found_rows;
 };
 
@@ -165,6 +165,8 @@ typedef struct st_filesort_info
   struct st_sort_addon_field *addon_field;     /* Pointer to the fields info */
   void    (*unpack)(struct st_sort_addon_field *, uchar *); /* To unpack back */
   uchar     *record_pointers;    /* If sorted in memory */
+  size_t    record_pointers_length; /* Bytes in record_pointers if packed */
+  bool      using_packed_addons; /* Addon fields are length-prefixed */
   ha_rows   found_records;      /* How many records in sort */
 } FILESORT_INFO;
 
@@ -956,6 +958,7 @@ enum enum_schema_tables
   SCH_GLOBAL_VARIABLES,
   SCH_KEY_COLUMN_USAGE,
   SCH_OPEN_TABLES,
+  SCH_OPTIMIZER_TRACE,
   SCH_PARTITIONS,
   SCH_PLUGINS,
   SCH_PROCESSLIST,
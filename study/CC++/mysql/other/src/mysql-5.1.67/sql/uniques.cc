@@ -31,6 +31,11 @@
 
   The unique entries will be returned in sort order, to ensure that we do the
   deletes in disk order.
+
+  If the comparison function only treats byte-identical keys as equal, the
+  caller can ask for a hash table to be used instead of the tree. Keys are
+  then only sorted when the table is written to disk or when get() returns
+  them; walk() over a table that fits in memory does not sort at all.
 */
 
 #include "mysql_priv.h"
@@ -56,19 +61,24 @@ int unique_write_to_ptrs(uchar* key, element_count count, Unique *unique)
 }
 
 Unique::Unique(qsort_cmp2 comp_func, void * comp_func_fixed_arg,
-	       uint size_arg, ulonglong max_in_memory_size_arg)
-  :max_in_memory_size(max_in_memory_size_arg), size(size_arg), elements(0)
+	       uint size_arg, ulonglong max_in_memory_size_arg,
+               bool hashed_arg)
+  :max_in_memory_size(max_in_memory_size_arg), size(size_arg),
+   hashed(hashed_arg && size_arg), hash_keys(0), hash_slots(0),
+   hash_count(0), hash_alloced(0), hash_mask(0), elements(0)
 {
   my_b_clear(&file);
   init_tree(&tree, (ulong) (max_in_memory_size / 16), 0, size, comp_func, 0,
             NULL, comp_func_fixed_arg);
   /* If the following fail's the next add will also fail */
   my_init_dynamic_array(&file_ptrs, sizeof(BUFFPEK), 16, 16);
-  /*
-    If you change the following, change it in get_max_elements function, too.
-  */
-  max_elements= (ulong) (max_in_memory_size /
-                         ALIGN_SIZE(sizeof(TREE_ELEMENT)+size));
+  max_elements= get_max_elements(size, max_in_memory_size, hashed);
+  if (hashed)
+  {
+    /* Positions in hash_slots are 1-based uint32 */
+    set_if_bigger(max_elements, 1);
+    set_if_smaller(max_elements, UINT_MAX32 - 1);
+  }
   VOID(open_cached_file(&file, mysql_tmpdir,TEMP_PREFIX, DISK_BUFFER_SIZE,
 		   MYF(MY_WME)));
 }
@@ -225,6 +235,7 @@ static double get_merge_many_buffs_cost(uint *buffer,
       nkeys     #of elements in Unique
       key_size  size of each elements in bytes
       max_in_memory_size amount of memory Unique will be allowed to use
+      hashed    TRUE if Unique will keep the elements in a hash table
 
   RETURN
     Cost in disk seeks.
@@ -249,6 +260,15 @@ static double get_merge_many_buffs_cost(uint *buffer,
 
       Approximate value of log2(N!) is calculated by log2_n_fact function.
 
+      With a hash table each Unique::put costs one hash lookup, which we
+      count as one comparison. Each table is sorted once, either when it is
+      written to disk or when Unique::get returns it, which gives
+
+      n_compares = N + log2(N!)
+
+      for a table of N elements. More elements fit into the same memory
+      than into a tree, so fewer sequences have to be merged.
+
     2. Cost of merging.
       If only one tree is created by Unique no merging will be necessary.
       Otherwise, we model execution of merge_many_buff function and count
@@ -262,23 +282,32 @@ static double get_merge_many_buffs_cost(uint *buffer,
 */
 
 double Unique::get_use_cost(uint *buffer, uint nkeys, uint key_size,
-                            ulonglong max_in_memory_size)
+                            ulonglong max_in_memory_size, bool hashed)
 {
   ulong max_elements_in_tree;
   ulong last_tree_elems;
   int   n_full_trees; /* number of trees in unique - 1 */
   double result;
 
-  max_elements_in_tree= ((ulong) max_in_memory_size /
-                         ALIGN_SIZE(sizeof(TREE_ELEMENT)+key_size));
+  max_elements_in_tree= get_max_elements(key_size, max_in_memory_size, hashed);
 
   n_full_trees=    nkeys / max_elements_in_tree;
   last_tree_elems= nkeys % max_elements_in_tree;
 
   /* Calculate cost of creating trees */
-  result= 2*log2_n_fact(last_tree_elems + 1.0);
-  if (n_full_trees)
-    result+= n_full_trees * log2_n_fact(max_elements_in_tree + 1.0);
+  if (hashed)
+  {
+    result= last_tree_elems + log2_n_fact(last_tree_elems + 1.0);
+    if (n_full_trees)
+      result+= n_full_trees * (max_elements_in_tree +
+                               log2_n_fact(max_elements_in_tree + 1.0));
+  }
+  else
+  {
+    result= 2*log2_n_fact(last_tree_elems + 1.0);
+    if (n_full_trees)
+      result+= n_full_trees * log2_n_fact(max_elements_in_tree + 1.0);
+  }
   result /= TIME_FOR_COMPARE_ROWID;
 
   DBUG_PRINT("info",("unique trees sizes: %u=%u*%lu + %lu", nkeys,
@@ -319,6 +348,102 @@ Unique::~Unique()
   close_cached_file(&file);
   delete_tree(&tree);
   delete_dynamic(&file_ptrs);
+  x_free(hash_keys);
+  x_free(hash_slots);
+}
+
+
+/*
+  Find the slot of key in the hash table
+
+  RETURN
+    Slot holding the key, or the free slot where the key should be put
+*/
+
+ulong Unique::hash_find(uchar *key, ulong hash_nr)
+{
+  ulong idx= hash_nr & hash_mask;
+  uint32 pos;
+  while ((pos= hash_slots[idx]) &&
+         memcmp(hash_keys + (pos - 1) * (size_t) size, key, size))
+    idx= (idx + 1) & hash_mask;
+  return idx;
+}
+
+
+/*
+  Make room for twice as many keys (but at most max_elements)
+
+  NOTES
+    The table has at least two slots per key, so a probe sequence always
+    ends on a free slot.
+*/
+
+bool Unique::hash_grow()
+{
+  ulong new_alloced= hash_alloced ? hash_alloced * 2 : 16;
+  ulong n_slots= 1;
+  uchar *keys;
+  uint32 *slots;
+  set_if_smaller(new_alloced, max_elements);
+  while (n_slots < new_alloced * 2)
+    n_slots<<= 1;
+
+  if (!(keys= (uchar*) my_realloc(hash_keys, new_alloced * (size_t) size,
+                                  MYF(MY_ALLOW_ZERO_PTR))))
+    return 1;
+  hash_keys= keys;
+  if (!(slots= (uint32*) my_malloc(n_slots * sizeof(uint32),
+                                   MYF(MY_ZEROFILL))))
+    return 1;
+  x_free(hash_slots);
+  hash_slots= slots;
+  hash_mask= n_slots - 1;
+  hash_alloced= new_alloced;
+
+  for (ulong i= 0; i < hash_count; i++)
+  {
+    uchar *key= hash_keys + i * (size_t) size;
+    ulong nr1= 1, nr2= 4;
+    my_charset_bin.coll->hash_sort(&my_charset_bin, key, size, &nr1, &nr2);
+    hash_slots[hash_find(key, nr1)]= (uint32) (i + 1);
+  }
+  return 0;
+}
+
+
+bool Unique::hash_add(uchar *key)
+{
+  ulong nr1= 1, nr2= 4;
+  ulong idx= 0;
+  my_charset_bin.coll->hash_sort(&my_charset_bin, key, size, &nr1, &nr2);
+  if (hash_alloced)
+  {
+    idx= hash_find(key, nr1);
+    if (hash_slots[idx])
+      return 0;                                 /* Duplicate */
+  }
+  if (hash_count == hash_alloced)
+  {
+    if (hash_count < max_elements ? hash_grow() : flush())
+      return 1;
+    idx= hash_find(key, nr1);
+  }
+  memcpy(hash_keys + hash_count * (size_t) size, key, size);
+  hash_slots[idx]= (uint32) ++hash_count;
+  return 0;
+}
+
+
+/*
+  Sort the keys in hash_keys. This invalidates hash_slots, so the table
+  must be cleared before more keys are added.
+*/
+
+void Unique::hash_sort()
+{
+  my_qsort2(hash_keys, hash_count, size, (qsort2_cmp) tree.compare,
+            tree.custom_arg);
 }
 
 
@@ -326,6 +451,22 @@ Unique::~Unique()
 bool Unique::flush()
 {
   BUFFPEK file_ptr;
+  if (hashed)
+  {
+    elements+= hash_count;
+    file_ptr.count= hash_count;
+    file_ptr.file_pos= my_b_tell(&file);
+    hash_sort();
+    if (my_b_write(&file, hash_keys, hash_count * (size_t) size) ||
+        insert_dynamic(&file_ptrs, (uchar*) &file_ptr))
+      return 1;
+    if (hash_count)
+    {
+      hash_count= 0;
+      bzero(hash_slots, (hash_mask + 1) * sizeof(uint32));
+    }
+    return 0;
+  }
   elements+= tree.elements_in_tree;
   file_ptr.count=tree.elements_in_tree;
   file_ptr.file_pos=my_b_tell(&file);
@@ -348,6 +489,11 @@ void
 Unique::reset()
 {
   reset_tree(&tree);
+  if (hash_count)
+  {
+    hash_count= 0;
+    bzero(hash_slots, (hash_mask + 1) * sizeof(uint32));
+  }
   /*
     If elements != 0, some trees were stored in the file (see how
     flush() works). Note, that we can not count on my_b_tell(&file) == 0
@@ -529,7 +675,8 @@ end:
 /*
   DESCRIPTION
     Walks consecutively through all unique elements:
-    if all elements are in memory, then it simply invokes 'tree_walk', else
+    if all elements are in memory, then it simply invokes 'tree_walk' (or
+    visits the hash table in insertion order), else
     all flushed trees are loaded to memory piece-by-piece, pieces are
     sorted, and action is called for each unique value.
     Note: so as merging resets file_ptrs state, this method can change
@@ -552,7 +699,17 @@ bool Unique::walk(tree_walk_action action, void *walk_action_arg)
   uchar *merge_buffer;
 
   if (elements == 0)                       /* the whole tree is in memory */
-    return tree_walk(&tree, action, walk_action_arg, left_root_right);
+  {
+    if (!hashed)
+      return tree_walk(&tree, action, walk_action_arg, left_root_right);
+    /* Nothing needs the keys in order here, visit them as they were added */
+    for (ulong i= 0; i < hash_count; i++)
+    {
+      if (action(hash_keys + i * (size_t) size, 1, walk_action_arg))
+        return 1;
+    }
+    return 0;
+  }
 
   /* flush current tree to the file to have some memory for merge buffer */
   if (flush())
@@ -578,16 +735,22 @@ bool Unique::walk(tree_walk_action action, void *walk_action_arg)
 bool Unique::get(TABLE *table)
 {
   SORTPARAM sort_param;
-  table->sort.found_records=elements+tree.elements_in_tree;
+  table->sort.found_records=elements+elements_in_tree();
 
   if (my_b_tell(&file) == 0)
   {
     /* Whole tree is in memory;  Don't use disk if you don't need to */
     if ((record_pointers=table->sort.record_pointers= (uchar*)
-	 my_malloc(size * tree.elements_in_tree, MYF(0))))
+	 my_malloc(size * elements_in_tree(), MYF(0))))
     {
-      (void) tree_walk(&tree, (tree_walk_action) unique_write_to_ptrs,
-		       this, left_root_right);
+      if (hashed)
+      {
+        hash_sort();
+        memcpy(record_pointers, hash_keys, hash_count * (size_t) size);
+      }
+      else
+        (void) tree_walk(&tree, (tree_walk_action) unique_write_to_ptrs,
+                         this, left_root_right);
       return 0;
     }
   }
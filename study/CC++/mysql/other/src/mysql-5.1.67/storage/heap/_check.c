@@ -176,8 +176,9 @@ static int check_one_rb_key(HP_INFO *info, uint keynr, ulong records,
   {
     do
     {
-      memcpy(&recpos, key + (*keydef->get_key_length)(keydef,key), sizeof(uchar*));
-      key_length= hp_rb_make_key(keydef, info->recbuf, recpos, 0);
+      memcpy(&recpos, key + (*keydef->get_key_length)(keydef,key) +
+             keydef->recno_length, sizeof(uchar*));
+      key_length= hp_rb_make_key(keydef, info->recbuf, recpos, 0, 0);
       if (ha_key_cmp(keydef->seg, (uchar*) info->recbuf, (uchar*) key,
 		     key_length, SEARCH_FIND | SEARCH_SAME, not_used))
       {
@@ -45,7 +45,8 @@ int heap_init(void *p)
   heap_hton->db_type=    DB_TYPE_HEAP;
   heap_hton->create=     heap_create_handler;
   heap_hton->panic=      heap_panic;
-  heap_hton->flags=      HTON_CAN_RECREATE;
+  heap_hton->flags=      HTON_CAN_RECREATE | HTON_PARALLEL_SCAN |
+                         HTON_LAZY_EXTERNAL_LOCK;
 
   return 0;
 }
@@ -118,6 +119,8 @@ int ha_heap::open(const char *name, int mode, uint test_if_locked)
   if (file)
   {
     /* Initialize variables for the opened table */
+    if (file->s->blobs)
+      ref_length= sizeof(ulong);                // Slot number, see heapdef.h
     set_keys_for_scanning();
     /*
       We cannot run update_key_stats() here because we do not have a
@@ -150,7 +153,8 @@ int ha_heap::close(void)
 
 handler *ha_heap::clone(const char *name, MEM_ROOT *mem_root)
 {
-  handler *new_handler= get_new_handler(table->s, mem_root, table->s->db_type());
+  /* Not table->s->db_type(), which is the partition engine for partitions */
+  handler *new_handler= get_new_handler(table->s, mem_root, ht);
   if (new_handler && !new_handler->ha_open(table, file->s->name, table->db_stat,
                                            HA_OPEN_IGNORE_IF_LOCKED))
     return new_handler;
@@ -358,15 +362,40 @@ int ha_heap::rnd_pos(uchar * buf, uchar *pos)
   int error;
   HEAP_PTR heap_position;
   ha_statistic_increment(&SSV::ha_read_rnd_count);
-  memcpy_fixed((char*) &heap_position, pos, sizeof(HEAP_PTR));
-  error=heap_rrnd(file, buf, heap_position);
+  if (file->s->blobs)
+    error=heap_rrnd_number(file, buf, (ulong) my_get_ptr(pos, ref_length));
+  else
+  {
+    memcpy_fixed((char*) &heap_position, pos, sizeof(HEAP_PTR));
+    error=heap_rrnd(file, buf, heap_position);
+  }
   table->status=error ? STATUS_NOT_FOUND: 0;
   return error;
 }
 
+int ha_heap::restart_rnd_next(uchar *buf, uchar *pos)
+{
+  /* Only a slot number tells where to continue the scan */
+  if (!file->s->blobs)
+    return handler::restart_rnd_next(buf, pos);
+  return rnd_pos(buf, pos);
+}
+
 void ha_heap::position(const uchar *record)
 {
-  *(HEAP_PTR*) ref= heap_position(file);	// Ref is aligned
+  uchar *pos= heap_position(file);
+  if (!file->s->blobs)
+  {
+    *(HEAP_PTR*) ref= pos;			// Ref is aligned
+    return;
+  }
+  /*
+    Store the slot number rather than the address, high byte first, so that
+    refs compare in insertion order. Filesort breaks ties on the ref.
+  */
+  my_store_ptr(ref, ref_length,
+               pos ? (my_off_t) heap_record_number(file, pos) :
+               ~(my_off_t) 0);
 }
 
 int ha_heap::info(uint flag)
@@ -383,6 +412,14 @@ int ha_heap::info(uint flag)
   stats.max_data_file_length= hp_info.max_records * hp_info.reclength;
   stats.delete_length=        hp_info.deleted * hp_info.reclength;
   stats.create_time=          (ulong) hp_info.create_time;
+  if ((flag & HA_STATUS_ERRKEY) && hp_info.dupp_key_pos)
+  {
+    if (file->s->blobs)
+      my_store_ptr(dup_ref, ref_length,
+                   (my_off_t) heap_record_number(file, hp_info.dupp_key_pos));
+    else
+      *(HEAP_PTR*) dup_ref= hp_info.dupp_key_pos;
+  }
   if (flag & HA_STATUS_AUTO)
     stats.auto_increment_value= hp_info.auto_increment;
   /*
@@ -605,10 +642,11 @@ int ha_heap::create(const char *name, TABLE *table_arg,
 		    HA_CREATE_INFO *create_info)
 {
   uint key, parts, mem_per_row= 0, keys= table_arg->s->keys;
-  uint auto_key= 0, auto_key_type= 0;
+  uint auto_key= 0, auto_key_type= 0, blob;
   ha_rows max_rows;
   HP_KEYDEF *keydef;
   HA_KEYSEG *seg;
+  HP_BLOBDEF *blobdef;
   int error;
   TABLE_SHARE *share= table_arg->s;
   bool found_real_auto_increment= 0;
@@ -617,10 +655,12 @@ int ha_heap::create(const char *name, TABLE *table_arg,
     parts+= table_arg->key_info[key].key_parts;
 
   if (!(keydef= (HP_KEYDEF*) my_malloc(keys * sizeof(HP_KEYDEF) +
-				       parts * sizeof(HA_KEYSEG),
+				       parts * sizeof(HA_KEYSEG) +
+				       share->blob_fields * sizeof(HP_BLOBDEF),
 				       MYF(MY_WME))))
     return my_errno;
   seg= my_reinterpret_cast(HA_KEYSEG*) (keydef + keys);
+  blobdef= my_reinterpret_cast(HP_BLOBDEF*) (seg + parts);
   for (key= 0; key < keys; key++)
   {
     KEY *pos= table_arg->key_info+key;
@@ -639,7 +679,8 @@ int ha_heap::create(const char *name, TABLE *table_arg,
       break;
     case HA_KEY_ALG_BTREE:
       keydef[key].algorithm= HA_KEY_ALG_BTREE;
-      mem_per_row+=sizeof(TREE_ELEMENT)+pos->key_length+sizeof(char*);
+      mem_per_row+=sizeof(TREE_ELEMENT)+pos->key_length+
+                   HP_RECNO_LENGTH(share->blob_fields)+sizeof(char*);
       break;
     default:
       DBUG_ASSERT(0); // cannot happen
@@ -668,6 +709,13 @@ int ha_heap::create(const char *name, TABLE *table_arg,
         seg->charset= &my_charset_bin;
       else
         seg->charset= field->charset();
+      if (field->flags & BLOB_FLAG)
+      {
+        /* Only in internal temporary tables: the whole BLOB is the key */
+        seg->flag|= HA_BLOB_PART;
+        seg->bit_start= ((Field_blob*) field)->pack_length_no_ptr();
+        seg->length= 0;
+      }
       if (field->null_ptr)
       {
 	seg->null_bit= field->null_bit;
@@ -691,7 +739,8 @@ int ha_heap::create(const char *name, TABLE *table_arg,
       }
     }
   }
-  mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
+  mem_per_row+= MY_ALIGN(HP_SLOT_LENGTH(share->reclength, share->blob_fields),
+                         sizeof(char*));
   max_rows = (ha_rows) (table_arg->in_use->variables.max_heap_table_size /
 			(ulonglong) mem_per_row);
   if (table_arg->found_next_number_field)
@@ -705,8 +754,22 @@ int ha_heap::create(const char *name, TABLE *table_arg,
   hp_create_info.auto_increment= (create_info->auto_increment_value ?
 				  create_info->auto_increment_value - 1 : 0);
   hp_create_info.max_table_size=current_thd->variables.max_heap_table_size;
+  if (internal_table)
+  {
+    /* Internal temporary tables are converted to MyISAM at tmp_table_size */
+    set_if_smaller(hp_create_info.max_table_size,
+                   current_thd->variables.tmp_table_size);
+  }
   hp_create_info.with_auto_increment= found_real_auto_increment;
   hp_create_info.internal_table= internal_table;
+  for (blob= 0; blob < share->blob_fields; blob++)
+  {
+    Field_blob *field= (Field_blob*) table_arg->field[share->blob_field[blob]];
+    blobdef[blob].offset= field->offset(table_arg->record[0]);
+    blobdef[blob].packlength= field->pack_length_no_ptr();
+  }
+  hp_create_info.blobdef= blobdef;
+  hp_create_info.blobs= share->blob_fields;
   max_rows = (ha_rows) (hp_create_info.max_table_size / mem_per_row);
   error= heap_create(name,
 		     keys, keydef, share->reclength,
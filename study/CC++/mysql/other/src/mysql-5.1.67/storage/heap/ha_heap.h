@@ -94,6 +94,7 @@ public:
   int rnd_init(bool scan);
   int rnd_next(uchar *buf);
   int rnd_pos(uchar * buf, uchar *pos);
+  int restart_rnd_next(uchar *buf, uchar *pos);
   void position(const uchar *record);
   int info(uint);
   int extra(enum ha_extra_function operation);
@@ -115,7 +116,7 @@ public:
 			     enum thr_lock_type lock_type);
   int cmp_ref(const uchar *ref1, const uchar *ref2)
   {
-    return memcmp(ref1, ref2, sizeof(HEAP_PTR));
+    return memcmp(ref1, ref2, ref_length);
   }
   bool check_if_incompatible_data(HA_CREATE_INFO *info, uint table_changes);
 private:
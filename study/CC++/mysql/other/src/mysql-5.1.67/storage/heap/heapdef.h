@@ -43,6 +43,28 @@ if (!(info->update & HA_STATE_AKTIV))\
 { my_errno=HA_ERR_NO_ACTIVE_RECORD; DBUG_RETURN(-1); }
 #define hp_find_hash(A,B) ((HASH_INFO*) hp_find_block((A),(B)))
 
+/*
+  In tables with BLOBs, which are internal temporary tables that used to be
+  MyISAM, a record slot holds the row, a "not deleted" byte and the number
+  of the slot. Slots are numbered in allocation order and keep their number
+  when reused, so the number is a stable position that sorts in insertion
+  order. Their BTREE keys are followed by the slot number, high byte first,
+  and the record pointer; only the slot number is compared, so rows with
+  equal keys are read in the order of their handler row references.
+  Other tables use the record address as position.
+*/
+#define HP_RECNO_LENGTH(blobs) ((blobs) ? sizeof(ulong) : 0)
+#define HP_RECNO_OFFSET(share) ((share)->reclength+1)
+#define HP_SLOT_LENGTH(reclength,blobs) \
+  ((reclength)+1+HP_RECNO_LENGTH(blobs))
+
+/*
+  Key flag of HASH keys with BLOB parts. These keys compare whole BLOBs and
+  are only searched by record, with hp_rec_hashnr() and hp_rec_key_cmp(),
+  to check unique constraints; they have no key image.
+*/
+#define HP_BLOB_KEY	((uint) 131072)
+
 	/* Find pos for record and update it in info->current_ptr */
 #define hp_find_record(info,pos) (info)->current_ptr= hp_find_block(&(info)->s->block,pos)
 
@@ -92,11 +114,16 @@ extern int hp_key_cmp(HP_KEYDEF *keydef,const uchar *rec,
 		      const uchar *key);
 extern void hp_make_key(HP_KEYDEF *keydef,uchar *key,const uchar *rec);
 extern uint hp_rb_make_key(HP_KEYDEF *keydef, uchar *key,
-			   const uchar *rec, uchar *recpos);
+			   const uchar *rec, uchar *recpos, ulong recno);
 extern uint hp_rb_key_length(HP_KEYDEF *keydef, const uchar *key);
 extern uint hp_rb_null_key_length(HP_KEYDEF *keydef, const uchar *key);
 extern uint hp_rb_var_key_length(HP_KEYDEF *keydef, const uchar *key);
 extern my_bool hp_if_null_in_key(HP_KEYDEF *keyinfo, const uchar *record);
+extern ulong hp_calc_blob_length(uint packlength, const uchar *pos);
+extern uchar *hp_alloc_blob(HP_SHARE *info, size_t length);
+extern void hp_free_blobs(HP_SHARE *info, const uchar *record,
+                          const uchar *keep, uint blobs);
+extern int hp_store_blobs(HP_SHARE *info, uchar *record, const uchar *old);
 extern int hp_close(register HP_INFO *info);
 extern void hp_clear(HP_SHARE *info);
 extern void hp_clear_keys(HP_SHARE *info);
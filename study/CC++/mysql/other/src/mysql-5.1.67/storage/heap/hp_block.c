@@ -150,3 +150,76 @@ uchar *hp_free_level(HP_BLOCK *block, uint level, HP_PTRS *pos, uchar *last_pos)
   }
   return next_ptr;			/* next memory position */
 }
+
+
+/*
+  Allocate space for BLOB data
+
+  SYNOPSIS
+    hp_alloc_blob()
+    info		Heap table share
+    length		Number of bytes wanted
+
+  NOTES
+    Every BLOB of a record has an allocation of its own, which is freed by
+    hp_free_blobs() when the record is deleted or the BLOB is changed. The
+    BLOB data is counted in data_length and limited by max_table_size like
+    the record blocks.
+
+  RETURN
+    0		Out of memory or table is full; my_errno is set
+    #		Pointer to 'length' bytes
+*/
+
+uchar *hp_alloc_blob(HP_SHARE *info, size_t length)
+{
+  uchar *pos;
+  DBUG_ENTER("hp_alloc_blob");
+
+  if (info->data_length + info->index_length + length >= info->max_table_size)
+  {
+    my_errno= HA_ERR_RECORD_FILE_FULL;
+    DBUG_RETURN(NULL);
+  }
+  if (!(pos= (uchar*) my_malloc(length, MYF(0))))
+  {
+    my_errno= ENOMEM;
+    DBUG_RETURN(NULL);
+  }
+  info->data_length+= length;
+  DBUG_RETURN(pos);
+}
+
+
+/*
+  Free the BLOB data of a record
+
+  SYNOPSIS
+    hp_free_blobs()
+    info		Heap table share
+    record		Record in the table
+    keep		Another version of the record or 0. BLOB data that
+			it still points to is not freed.
+    blobs		Number of BLOBs to free, counted from the first
+*/
+
+void hp_free_blobs(HP_SHARE *info, const uchar *record, const uchar *keep,
+                   uint blobs)
+{
+  HP_BLOBDEF *blob, *end;
+  for (blob= info->blobdef, end= blob + blobs; blob < end; blob++)
+  {
+    const uchar *pos= record + blob->offset;
+    ulong length= hp_calc_blob_length(blob->packlength, pos);
+    uchar *data;
+
+    if (!length ||
+        (keep && !memcmp(pos + blob->packlength,
+                         keep + blob->offset + blob->packlength,
+                         sizeof(char*))))
+      continue;
+    memcpy_fixed((uchar*) &data, pos + blob->packlength, sizeof(char*));
+    my_free(data, MYF(0));
+    info->data_length-= length;
+  }
+}
@@ -30,6 +30,16 @@ void hp_clear(HP_SHARE *info)
 {
   DBUG_ENTER("hp_clear");
 
+  if (info->blobs)
+  {
+    ulong i, slots= info->records + info->deleted;
+    for (i= 0; i < slots; i++)
+    {
+      uchar *pos= hp_find_block(&info->block, i);
+      if (pos[info->reclength])                 /* Not deleted */
+        hp_free_blobs(info, pos, (uchar*) 0, info->blobs);
+    }
+  }
   if (info->block.levels)
     VOID(hp_free_level(&info->block,info->block.levels,info->block.root,
 			(uchar*) 0));
@@ -100,8 +100,12 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
             keyinfo->flag|= HA_END_SPACE_KEY;
           keyinfo->flag|= HA_VAR_LENGTH_KEY;
           length+= 2;
-          /* Save number of bytes used to store length */
-          keyinfo->seg[j].bit_start= 2;
+          /*
+            Save number of bytes used to store length. For BLOB parts
+            bit_start is already the pack length of the BLOB.
+          */
+          if (!(keyinfo->seg[j].flag & HA_BLOB_PART))
+            keyinfo->seg[j].bit_start= 2;
           /*
             Make future comparison simpler by only having to check for
             one type
@@ -113,10 +117,20 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
 	}
         if (keyinfo->seg[j].flag & HA_END_SPACE_ARE_EQUAL)
           keyinfo->flag|= HA_END_SPACE_KEY;
+        if (keyinfo->seg[j].flag & HA_BLOB_PART)
+        {
+          if (keyinfo->algorithm == HA_KEY_ALG_BTREE)
+          {
+            my_errno= HA_WRONG_CREATE_OPTION;
+            goto err;
+          }
+          keyinfo->flag|= HP_BLOB_KEY;
+        }
       }
       keyinfo->length= length;
       length+= keyinfo->rb_tree.size_of_element + 
-	       ((keyinfo->algorithm == HA_KEY_ALG_BTREE) ? sizeof(uchar*) : 0);
+	       ((keyinfo->algorithm == HA_KEY_ALG_BTREE) ?
+                HP_RECNO_LENGTH(create_info->blobs) + sizeof(uchar*) : 0);
       if (length > max_length)
 	max_length= length;
       key_segs+= keyinfo->keysegs;
@@ -133,13 +147,15 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
     }
     if (!(share= (HP_SHARE*) my_malloc((uint) sizeof(HP_SHARE)+
 				       keys*sizeof(HP_KEYDEF)+
-				       key_segs*sizeof(HA_KEYSEG),
+				       key_segs*sizeof(HA_KEYSEG)+
+				       create_info->blobs*sizeof(HP_BLOBDEF),
 				       MYF(MY_ZEROFILL))))
       goto err;
     share->keydef= (HP_KEYDEF*) (share + 1);
     share->key_stat_version= 1;
     keyseg= (HA_KEYSEG*) (share->keydef + keys);
-    init_block(&share->block, reclength + 1, min_records, max_records);
+    init_block(&share->block, HP_SLOT_LENGTH(reclength, create_info->blobs),
+               min_records, max_records);
 	/* Fix keys */
     memcpy(share->keydef, keydef, (size_t) (sizeof(keydef[0]) * keys));
     for (i= 0, keyinfo= share->keydef; i < keys; i++, keyinfo++)
@@ -152,13 +168,16 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
       if (keydef[i].algorithm == HA_KEY_ALG_BTREE)
       {
 	/* additional HA_KEYTYPE_END keyseg */
+	keyinfo->recno_length= HP_RECNO_LENGTH(create_info->blobs);
 	keyseg->type=     HA_KEYTYPE_END;
-	keyseg->length=   sizeof(uchar*);
+	keyseg->length=   (keyinfo->recno_length ? keyinfo->recno_length :
+			   sizeof(uchar*));
 	keyseg->flag=     0;
 	keyseg->null_bit= 0;
 	keyseg++;
 
-	init_tree(&keyinfo->rb_tree, 0, 0, sizeof(uchar*),
+	init_tree(&keyinfo->rb_tree, 0, 0,
+		  keyinfo->recno_length + sizeof(uchar*),
 		  (qsort_cmp2)keys_compare, 1, NULL, NULL);
 	keyinfo->delete_key= hp_rb_delete_key;
 	keyinfo->write_key= hp_rb_write_key;
@@ -167,6 +186,7 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
       {
 	init_block(&keyinfo->block, sizeof(HASH_INFO), min_records,
 		   max_records);
+	keyinfo->recno_length= 0;
 	keyinfo->delete_key= hp_delete_key;
 	keyinfo->write_key= hp_write_key;
         keyinfo->hash_buckets= 0;
@@ -174,6 +194,10 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
       if ((keyinfo->flag & HA_AUTO_KEY) && create_info->with_auto_increment)
         share->auto_key= i + 1;
     }
+    share->blobdef= (HP_BLOBDEF*) keyseg;
+    share->blobs= create_info->blobs;
+    memcpy(share->blobdef, create_info->blobdef,
+           (size_t) (sizeof(HP_BLOBDEF) * create_info->blobs));
     share->min_records= min_records;
     share->max_records= max_records;
     share->max_table_size= create_info->max_table_size;
@@ -43,6 +43,8 @@ int heap_delete(HP_INFO *info, const uchar *record)
   }
 
   info->update=HA_STATE_DELETED;
+  if (share->blobs)
+    hp_free_blobs(share, pos, (uchar*) 0, share->blobs);
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
   pos[share->reclength]=0;		/* Record deleted */
@@ -75,7 +77,9 @@ int hp_rb_delete_key(HP_INFO *info, register HP_KEYDEF *keyinfo,
     info->last_pos= NULL; /* For heap_rnext/heap_rprev */
 
   custom_arg.keyseg= keyinfo->seg;
-  custom_arg.key_length= hp_rb_make_key(keyinfo, info->recbuf, record, recpos);
+  custom_arg.key_length= hp_rb_make_key(keyinfo, info->recbuf, record, recpos,
+                                        keyinfo->recno_length ?
+                                        heap_record_number(info, recpos) : 0);
   custom_arg.search_flag= SEARCH_SAME;
   old_allocated= keyinfo->rb_tree.allocated;
   res= tree_delete(&keyinfo->rb_tree, info->recbuf, custom_arg.key_length,
@@ -236,6 +236,29 @@ void hp_movelink(HASH_INFO *pos, HASH_INFO *next_link, HASH_INFO *newlink)
   return;
 }
 
+/*
+  Get the length of a BLOB from the 'packlength' bytes in front of its
+  data pointer
+*/
+
+ulong hp_calc_blob_length(uint packlength, const uchar *pos)
+{
+  switch (packlength) {
+  case 1:
+    return (ulong) *pos;
+  case 2:
+    return (ulong) uint2korr(pos);
+  case 3:
+    return (ulong) uint3korr(pos);
+  case 4:
+    return (ulong) uint4korr(pos);
+  default:
+    break;
+  }
+  return 0;					/* Impossible */
+}
+
+
 #ifndef NEW_HASH_FUNCTION
 
 	/* Calc hashvalue for a key */
@@ -245,6 +268,7 @@ ulong hp_hashnr(register HP_KEYDEF *keydef, register const uchar *key)
   /*register*/ 
   ulong nr=1, nr2=4;
   HA_KEYSEG *seg,*endseg;
+  DBUG_ASSERT(!(keydef->flag & HP_BLOB_KEY));	/* No key image */
 
   for (seg=keydef->seg,endseg=seg+keydef->keysegs ; seg < endseg ; seg++)
   {
@@ -322,7 +346,13 @@ ulong hp_rec_hashnr(register HP_KEYDEF *keydef, register const uchar *rec)
 	continue;
       }
     }
-    if (seg->type == HA_KEYTYPE_TEXT)
+    if (seg->flag & HA_BLOB_PART)
+    {
+      uint length= (uint) hp_calc_blob_length(seg->bit_start, pos);
+      memcpy_fixed((uchar*) &pos, pos + seg->bit_start, sizeof(char*));
+      seg->charset->coll->hash_sort(seg->charset, pos, length, &nr, &nr2);
+    }
+    else if (seg->type == HA_KEYTYPE_TEXT)
     {
       CHARSET_INFO *cs= seg->charset;
       uint char_length= seg->length;
@@ -389,6 +419,7 @@ ulong hp_hashnr(register HP_KEYDEF *keydef, register const uchar *key)
   */
   ulong nr= 1, nr2= 4;
   HA_KEYSEG *seg,*endseg;
+  DBUG_ASSERT(!(keydef->flag & HP_BLOB_KEY));	/* No key image */
 
   for (seg=keydef->seg,endseg=seg+keydef->keysegs ; seg < endseg ; seg++)
   {
@@ -451,7 +482,13 @@ ulong hp_rec_hashnr(register HP_KEYDEF *keydef, register const uchar *rec)
 	continue;
       }
     }
-    if (seg->type == HA_KEYTYPE_TEXT)
+    if (seg->flag & HA_BLOB_PART)
+    {
+      uint length= (uint) hp_calc_blob_length(seg->bit_start, pos);
+      memcpy_fixed((uchar*) &pos, pos + seg->bit_start, sizeof(char*));
+      seg->charset->coll->hash_sort(seg->charset, pos, length, &nr, &nr2);
+    }
+    else if (seg->type == HA_KEYTYPE_TEXT)
     {
       uint char_length= seg->length; /* TODO: fix to use my_charpos() */
       seg->charset->coll->hash_sort(seg->charset, pos, char_length,
@@ -516,7 +553,20 @@ int hp_rec_key_cmp(HP_KEYDEF *keydef, const uchar *rec1, const uchar *rec2,
       if (rec1[seg->null_pos] & seg->null_bit)
 	continue;
     }
-    if (seg->type == HA_KEYTYPE_TEXT)
+    if (seg->flag & HA_BLOB_PART)
+    {
+      /* Whole BLOBs are compared, end space is not significant */
+      const uchar *pos1= rec1 + seg->start;
+      const uchar *pos2= rec2 + seg->start;
+      uint length1= (uint) hp_calc_blob_length(seg->bit_start, pos1);
+      uint length2= (uint) hp_calc_blob_length(seg->bit_start, pos2);
+      memcpy_fixed((uchar*) &pos1, pos1 + seg->bit_start, sizeof(char*));
+      memcpy_fixed((uchar*) &pos2, pos2 + seg->bit_start, sizeof(char*));
+      if (seg->charset->coll->strnncollsp(seg->charset,
+                                          pos1, length1, pos2, length2, 0))
+        return 1;
+    }
+    else if (seg->type == HA_KEYTYPE_TEXT)
     {
       CHARSET_INFO *cs= seg->charset;
       uint char_length1;
@@ -591,6 +641,7 @@ int hp_rec_key_cmp(HP_KEYDEF *keydef, const uchar *rec1, const uchar *rec2,
 int hp_key_cmp(HP_KEYDEF *keydef, const uchar *rec, const uchar *key)
 {
   HA_KEYSEG *seg,*endseg;
+  DBUG_ASSERT(!(keydef->flag & HP_BLOB_KEY));	/* No key image */
 
   for (seg=keydef->seg,endseg=seg+keydef->keysegs ;
        seg < endseg ;
@@ -675,6 +726,7 @@ int hp_key_cmp(HP_KEYDEF *keydef, const uchar *rec, const uchar *key)
 void hp_make_key(HP_KEYDEF *keydef, uchar *key, const uchar *rec)
 {
   HA_KEYSEG *seg,*endseg;
+  DBUG_ASSERT(!(keydef->flag & HP_BLOB_KEY));	/* No key image */
 
   for (seg=keydef->seg,endseg=seg+keydef->keysegs ; seg < endseg ; seg++)
   {
@@ -705,7 +757,7 @@ void hp_make_key(HP_KEYDEF *keydef, uchar *key, const uchar *rec)
 
 
 uint hp_rb_make_key(HP_KEYDEF *keydef, uchar *key, 
-		    const uchar *rec, uchar *recpos)
+		    const uchar *rec, uchar *recpos, ulong recno)
 {
   uchar *start_key= key;
   HA_KEYSEG *seg, *endseg;
@@ -789,7 +841,9 @@ uint hp_rb_make_key(HP_KEYDEF *keydef, uchar *key,
     memcpy(key, rec + seg->start, (size_t) char_length);
     key+= seg->length;
   }
-  memcpy(key, &recpos, sizeof(uchar*));
+  if (keydef->recno_length)
+    my_store_ptr(key, keydef->recno_length, (my_off_t) recno);
+  memcpy(key + keydef->recno_length, &recpos, sizeof(uchar*));
   return (uint) (key - start_key);
 }
 
@@ -25,6 +25,17 @@ uchar *heap_position(HP_INFO *info)
 }
 
 
+/* Returns the slot number of the record at pos, see heap_rrnd_number() */
+
+ulong heap_record_number(HP_INFO *info, const uchar *pos)
+{
+  ulong recno;
+  DBUG_ASSERT(info->s->blobs);
+  memcpy(&recno, pos + HP_RECNO_OFFSET(info->s), sizeof(recno));
+  return recno;
+}
+
+
 #ifdef WANT_OLD_HEAP_VERSION
 
 /*
@@ -53,6 +64,7 @@ int heap_info(reg1 HP_INFO *info,reg2 HEAPINFO *x, int flag )
   x->index_length    = info->s->index_length;
   x->max_records     = info->s->max_records;
   x->errkey          = info->errkey;
+  x->dupp_key_pos    = info->dupp_key_pos;
   x->create_time     = info->s->create_time;
   if (flag & HA_STATUS_AUTO)
     x->auto_increment= info->s->auto_increment + 1;
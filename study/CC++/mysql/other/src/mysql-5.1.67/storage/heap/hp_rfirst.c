@@ -31,7 +31,8 @@ int heap_rfirst(HP_INFO *info, uchar *record, int inx)
     if ((pos = tree_search_edge(&keyinfo->rb_tree, info->parents,
                                 &info->last_pos, offsetof(TREE_ELEMENT, left))))
     {
-      memcpy(&pos, pos + (*keyinfo->get_key_length)(keyinfo, pos), 
+      memcpy(&pos, pos + (*keyinfo->get_key_length)(keyinfo, pos) +
+             keyinfo->recno_length, 
 	     sizeof(uchar*));
       info->current_ptr = pos;
       memcpy(record, pos, (size_t)share->reclength);
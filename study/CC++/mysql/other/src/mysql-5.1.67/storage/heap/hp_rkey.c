@@ -28,6 +28,10 @@ int heap_rkey(HP_INFO *info, uchar *record, int inx, const uchar *key,
   {
     DBUG_RETURN(my_errno= HA_ERR_WRONG_INDEX);
   }
+  if (keyinfo->flag & HP_BLOB_KEY)
+  {
+    DBUG_RETURN(my_errno= HA_ERR_WRONG_COMMAND);
+  }
   info->lastinx= inx;
   info->current_record= (ulong) ~0L;		/* For heap_rrnd() */
 
@@ -53,7 +57,8 @@ int heap_rkey(HP_INFO *info, uchar *record, int inx, const uchar *key,
       info->update= 0;
       DBUG_RETURN(my_errno= HA_ERR_KEY_NOT_FOUND);
     }
-    memcpy(&pos, pos + (*keyinfo->get_key_length)(keyinfo, pos), sizeof(uchar*));
+    memcpy(&pos, pos + (*keyinfo->get_key_length)(keyinfo, pos) +
+             keyinfo->recno_length, sizeof(uchar*));
     info->current_ptr= pos;
   }
   else
@@ -76,5 +81,10 @@ int heap_rkey(HP_INFO *info, uchar *record, int inx, const uchar *key,
 
 uchar* heap_find(HP_INFO *info, int inx, const uchar *key)
 {
+  if (info->s->keydef[inx].flag & HP_BLOB_KEY)
+  {
+    my_errno= HA_ERR_WRONG_COMMAND;
+    return 0;
+  }
   return hp_search(info, info->s->keydef + inx, key, 0);
 }
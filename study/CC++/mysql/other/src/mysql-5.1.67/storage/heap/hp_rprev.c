@@ -46,7 +46,8 @@ int heap_rprev(HP_INFO *info, uchar *record)
     }
     if (pos)
     {
-      memcpy(&pos, pos + (*keyinfo->get_key_length)(keyinfo, pos),
+      memcpy(&pos, pos + (*keyinfo->get_key_length)(keyinfo, pos) +
+             keyinfo->recno_length,
 	     sizeof(uchar*));
       info->current_ptr = pos;
     }
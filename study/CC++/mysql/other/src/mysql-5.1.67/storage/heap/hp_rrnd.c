@@ -49,6 +49,28 @@ int heap_rrnd(register HP_INFO *info, uchar *record, uchar *pos)
 } /* heap_rrnd */
 
 
+/*
+  Read a record by the slot number returned by heap_record_number()
+  A following heap_scan() continues with the next slot.
+  Returns the same values as heap_rrnd()
+*/
+
+int heap_rrnd_number(HP_INFO *info, uchar *record, ulong number)
+{
+  HP_SHARE *share=info->s;
+  ulong slots= share->records+share->deleted;
+  ulong next_block;
+
+  if (number >= slots)
+    return heap_rrnd(info, record, (uchar*) 0);
+  info->current_record= number;
+  next_block= number - number % share->block.records_in_block +
+              share->block.records_in_block;
+  info->next_block= min(next_block, slots);
+  return heap_rrnd(info, record, hp_find_block(&share->block, number));
+}
+
+
 #ifdef WANT_OLD_HEAP_VERSION
 
 /*
@@ -37,6 +37,10 @@ int heap_rsame(register HP_INFO *info, uchar *record, int inx)
     {
       DBUG_RETURN(my_errno=HA_ERR_WRONG_INDEX);
     }
+    else if (inx != -1 && (share->keydef[inx].flag & HP_BLOB_KEY))
+    {
+      DBUG_RETURN(my_errno=HA_ERR_WRONG_COMMAND);
+    }
     else if (inx != -1)
     {
       info->lastinx=inx;
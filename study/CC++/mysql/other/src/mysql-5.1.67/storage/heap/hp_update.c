@@ -47,6 +47,24 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
   }
 
   memcpy(pos,heap_new,(size_t) share->reclength);
+  if (share->blobs && hp_store_blobs(share, pos, old))
+  {
+    /* No room for the BLOB data; put back the old row and its keys */
+    int error= my_errno;
+    memcpy(pos, old, (size_t) share->reclength);
+    for (keydef= end - 1; keydef >= share->keydef; keydef--)
+    {
+      if (hp_rec_key_cmp(keydef, old, heap_new, 0) &&
+          ((*keydef->delete_key)(info, keydef, heap_new, pos, 0) ||
+           (*keydef->write_key)(info, keydef, old, pos)))
+        break;
+    }
+    if (++(share->records) == share->blength)
+      share->blength+= share->blength;
+    DBUG_RETURN(my_errno= error);
+  }
+  if (share->blobs)
+    hp_free_blobs(share, old, pos, share->blobs); /* Data that was replaced */
   if (++(share->records) == share->blength) share->blength+= share->blength;
 
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
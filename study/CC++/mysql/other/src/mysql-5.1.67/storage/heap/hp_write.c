@@ -29,6 +29,7 @@
 #define HIGHUSED 8
 
 static uchar *next_free_record_pos(HP_SHARE *info);
+static my_bool hp_find_dupp_key(HP_INFO *info, const uchar *record);
 static HASH_INFO *hp_find_free_hash(HP_SHARE *info, HP_BLOCK *block,
 				     ulong records);
 
@@ -45,7 +46,15 @@ int heap_write(HP_INFO *info, const uchar *record)
   }
 #endif
   if (!(pos=next_free_record_pos(share)))
+  {
+    /*
+      A duplicate does not need any space. Report it rather than a full
+      table, so that the caller can update the existing row instead.
+    */
+    if (my_errno == HA_ERR_RECORD_FILE_FULL && hp_find_dupp_key(info, record))
+      my_errno= HA_ERR_FOUND_DUPP_KEY;
     DBUG_RETURN(my_errno);
+  }
   share->changed=1;
 
   for (keydef = share->keydef, end = keydef + share->keys; keydef < end;
@@ -56,6 +65,12 @@ int heap_write(HP_INFO *info, const uchar *record)
   }
 
   memcpy(pos,record,(size_t) share->reclength);
+  if (share->blobs && hp_store_blobs(share, pos, (uchar*) 0))
+  {
+    /* All keys are written; remove them again */
+    keydef--;
+    goto err_keys;
+  }
   pos[share->reclength]=1;		/* Mark record as not deleted */
   if (++share->records == share->blength)
     share->blength+= share->blength;
@@ -83,6 +98,7 @@ err:
   {
     keydef--;
   }
+err_keys:
   while (keydef >= share->keydef)
   {
     if ((*keydef->delete_key)(info, keydef, record, pos, 0))
@@ -98,6 +114,50 @@ err:
   DBUG_RETURN(my_errno);
 } /* heap_write */
 
+/*
+  Copy the BLOB data of a record into the table
+
+  SYNOPSIS
+    hp_store_blobs()
+    info		Heap table share
+    record		Record in the table. Its BLOB pointers are changed
+			to point to the copies.
+    old			Previous version of the record or 0. BLOBs that
+			still point to the data of 'old' are not copied again.
+
+  RETURN
+    0			ok
+    #			Error number (HA_ERR_RECORD_FILE_FULL or ENOMEM)
+*/
+
+int hp_store_blobs(HP_SHARE *info, uchar *record, const uchar *old)
+{
+  HP_BLOBDEF *blob, *end;
+  DBUG_ENTER("hp_store_blobs");
+
+  for (blob= info->blobdef, end= blob + info->blobs; blob < end; blob++)
+  {
+    uchar *pos= record + blob->offset;
+    ulong length= hp_calc_blob_length(blob->packlength, pos);
+    uchar *data, *copy;
+
+    if (!length ||
+        (old && !memcmp(pos, old + blob->offset,
+                        blob->packlength + sizeof(char*))))
+      continue;
+    if (!(copy= hp_alloc_blob(info, (size_t) length)))
+    {
+      /* Free the copies of the BLOBs before this one */
+      hp_free_blobs(info, record, old, (uint) (blob - info->blobdef));
+      DBUG_RETURN(my_errno);
+    }
+    memcpy_fixed((uchar*) &data, pos + blob->packlength, sizeof(char*));
+    memcpy(copy, data, (size_t) length);
+    memcpy_fixed(pos + blob->packlength, (uchar*) &copy, sizeof(char*));
+  }
+  DBUG_RETURN(0);
+}
+
 /* 
   Write a key to rb_tree-index 
 */
@@ -109,7 +169,9 @@ int hp_rb_write_key(HP_INFO *info, HP_KEYDEF *keyinfo, const uchar *record,
   uint old_allocated;
 
   custom_arg.keyseg= keyinfo->seg;
-  custom_arg.key_length= hp_rb_make_key(keyinfo, info->recbuf, record, recpos);
+  custom_arg.key_length= hp_rb_make_key(keyinfo, info->recbuf, record, recpos,
+                                        keyinfo->recno_length ?
+                                        heap_record_number(info, recpos) : 0);
   if (keyinfo->flag & HA_NOSAME)
   {
     custom_arg.search_flag= SEARCH_FIND | SEARCH_UPDATE;
@@ -131,6 +193,51 @@ int hp_rb_write_key(HP_INFO *info, HP_KEYDEF *keyinfo, const uchar *record,
   return 0;
 }
 
+/*
+  Search the unique hash indexes for a record with the same key
+
+  SYNOPSIS
+    hp_find_dupp_key()
+    info		Heap table info
+    record		Record that is about to be written
+
+  RETURN
+    0			No duplicate
+    1			Duplicate found. info->errkey and info->dupp_key_pos
+			are set.
+*/
+
+static my_bool hp_find_dupp_key(HP_INFO *info, const uchar *record)
+{
+  HP_SHARE *share= info->s;
+  HP_KEYDEF *keydef, *end;
+  HASH_INFO *pos;
+
+  if (!share->records)
+    return 0;
+  for (keydef= share->keydef, end= keydef + share->keys; keydef < end;
+       keydef++)
+  {
+    if (keydef->algorithm != HA_KEY_ALG_HASH || !(keydef->flag & HA_NOSAME) ||
+        ((keydef->flag & HA_NULL_PART_KEY) &&
+         hp_if_null_in_key(keydef, record)))
+      continue;
+    pos= hp_find_hash(&keydef->block,
+                      hp_mask(hp_rec_hashnr(keydef, record), share->blength,
+                              share->records));
+    do
+    {
+      if (!hp_rec_key_cmp(keydef, record, pos->ptr_to_rec, 1))
+      {
+        info->errkey= (int) (keydef - share->keydef);
+        info->dupp_key_pos= pos->ptr_to_rec;
+        return 1;
+      }
+    } while ((pos= pos->next_key));
+  }
+  return 0;
+}
+
 	/* Find where to place new record */
 
 static uchar *next_free_record_pos(HP_SHARE *info)
@@ -138,6 +245,7 @@ static uchar *next_free_record_pos(HP_SHARE *info)
   int block_pos;
   uchar *pos;
   size_t length;
+  ulong recno;
   DBUG_ENTER("next_free_record_pos");
 
   if (info->del_link)
@@ -160,11 +268,15 @@ static uchar *next_free_record_pos(HP_SHARE *info)
       DBUG_RETURN(NULL);
     info->data_length+=length;
   }
-  DBUG_PRINT("exit",("Used new position: 0x%lx",
-		     (long) ((uchar*) info->block.level_info[0].last_blocks+
-                             block_pos * info->block.recbuffer)));
-  DBUG_RETURN((uchar*) info->block.level_info[0].last_blocks+
-	      block_pos*info->block.recbuffer);
+  pos= ((uchar*) info->block.level_info[0].last_blocks+
+        block_pos*info->block.recbuffer);
+  if (info->blobs)
+  {
+    recno= info->records;                       /* No deleted slots here */
+    memcpy(pos + HP_RECNO_OFFSET(info), &recno, sizeof(recno));
+  }
+  DBUG_PRINT("exit",("Used new position: 0x%lx", (long) pos));
+  DBUG_RETURN(pos);
 }
 
 
@@ -376,6 +488,7 @@ int hp_write_key(HP_INFO *info, HP_KEYDEF *keyinfo,
       {
 	if (! hp_rec_key_cmp(keyinfo, record, pos->ptr_to_rec, 1))
 	{
+	  info->dupp_key_pos= pos->ptr_to_rec;
 	  DBUG_RETURN(my_errno=HA_ERR_FOUND_DUPP_KEY);
 	}
       } while ((pos=pos->next_key));
@@ -284,7 +284,8 @@ btr_cur_search_to_nth_level(
 	btr_cur_t*	cursor, /* in/out: tree cursor; the cursor page is
 				s- or x-latched, but see also above! */
 	ulint		has_search_latch,/* in: info on the latch mode the
-				caller currently has on btr_search_latch:
+				caller currently has on the hash index
+				partition latch of index:
 				RW_S_LATCH, or 0 */
 	mtr_t*		mtr)	/* in: mtr */
 {
@@ -354,7 +355,7 @@ btr_cur_search_to_nth_level(
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_searches++;
 #endif
-	if (btr_search_latch.writer == RW_LOCK_NOT_LOCKED
+	if (btr_search_get_latch(index)->writer == RW_LOCK_NOT_LOCKED
 	    && latch_mode <= BTR_MODIFY_LEAF && info->last_hash_succ
 	    && !estimate
 #ifdef PAGE_CUR_LE_OR_EXTENDS
@@ -386,7 +387,7 @@ btr_cur_search_to_nth_level(
 
 	if (has_search_latch) {
 		/* Release possible search latch to obey latching order */
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(btr_search_get_latch(index));
 	}
 
 	/* Store the position of the tree latch we push to mtr so that we
@@ -598,7 +599,7 @@ retry_page_get:
 func_exit:
 	if (has_search_latch) {
 
-		rw_lock_s_lock(&btr_search_latch);
+		rw_lock_s_lock(btr_search_get_latch(index));
 	}
 }
 
@@ -1431,8 +1432,8 @@ btr_cur_parse_update_in_place(
 	ut_a((ibool)!!page_is_comp(page) == dict_table_is_comp(index->table));
 	rec = page + rec_offset;
 
-	/* We do not need to reserve btr_search_latch, as the page is only
-	being recovered, and there cannot be a hash index to it. */
+	/* We do not need to reserve the hash index latch, as the page is
+	only being recovered, and there cannot be a hash index to it. */
 
 	offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED, &heap);
 
@@ -1518,7 +1519,7 @@ btr_cur_update_in_place(
 			btr_search_update_hash_on_delete(cursor);
 		}
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(index));
 	}
 
 	if (!(flags & BTR_KEEP_SYS_FLAG)) {
@@ -1531,7 +1532,7 @@ btr_cur_update_in_place(
 	row_upd_rec_in_place(rec, offsets, update);
 
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(index));
 	}
 
 	btr_cur_update_in_place_log(flags, rec, index, update, trx, roll_ptr,
@@ -2145,8 +2146,8 @@ btr_cur_parse_del_mark_set_clust_rec(
 			}
 		}
 
-		/* We do not need to reserve btr_search_latch, as the page
-		is only being recovered, and there cannot be a hash index to
+		/* We do not need to reserve the hash index latch, as the
+		page is only being recovered, and there cannot be a hash index to
 		it. */
 
 		rec_set_deleted_flag(rec, page_is_comp(page), val);
@@ -2223,7 +2224,7 @@ btr_cur_del_mark_set_clust_rec(
 	block = buf_block_align(rec);
 
 	if (block->is_hashed) {
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(index));
 	}
 
 	rec_set_deleted_flag(rec, rec_offs_comp(offsets), val);
@@ -2235,7 +2236,7 @@ btr_cur_del_mark_set_clust_rec(
 	}
 
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(index));
 	}
 
 	btr_cur_del_mark_set_clust_rec_log(flags, rec, index, val, trx,
@@ -2311,8 +2312,8 @@ btr_cur_parse_del_mark_set_sec_rec(
 	if (page) {
 		rec = page + offset;
 
-		/* We do not need to reserve btr_search_latch, as the page
-		is only being recovered, and there cannot be a hash index to
+		/* We do not need to reserve the hash index latch, as the
+		page is only being recovered, and there cannot be a hash index to
 		it. */
 
 		rec_set_deleted_flag(rec, page_is_comp(page), val);
@@ -2361,14 +2362,14 @@ btr_cur_del_mark_set_sec_rec(
 	      == dict_table_is_comp(cursor->index->table));
 
 	if (block->is_hashed) {
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(cursor->index));
 	}
 
 	rec_set_deleted_flag(rec, page_is_comp(buf_block_get_frame(block)),
 			     val);
 
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(cursor->index));
 	}
 
 	btr_cur_del_mark_set_sec_rec_log(rec, val, mtr);
@@ -2387,8 +2388,8 @@ btr_cur_set_deleted_flag_for_ibuf(
 	ibool		val,	/* in: value to set */
 	mtr_t*		mtr)	/* in: mtr */
 {
-	/* We do not need to reserve btr_search_latch, as the page has just
-	been read to the buffer pool and there cannot be a hash index to it. */
+	/* We do not need to reserve the hash index latch, as the page has
+	just been read to the buffer pool and there cannot be a hash index to it. */
 
 	rec_set_deleted_flag(rec, page_is_comp(buf_frame_align(rec)), val);
 
@@ -27,25 +27,13 @@ ulint	btr_search_n_succ	= 0;
 ulint	btr_search_n_hash_fail	= 0;
 #endif /* UNIV_SEARCH_PERF_STAT */
 
-byte	btr_sea_pad1[64];	/* padding to prevent other memory update
-				hotspots from residing on the same memory
-				cache line as btr_search_latch */
-
-/* The latch protecting the adaptive search system: this latch protects the
-(1) positions of records on those pages where a hash index has been built.
+/* The adaptive search system. The latch of each partition protects the
+(1) positions of records on those pages where a hash index has been built
+for an index mapped to the partition.
 NOTE: It does not protect values of non-ordering fields within a record from
 being updated in-place! We can use fact (1) to perform unique searches to
 indexes. */
 
-rw_lock_t*	btr_search_latch_temp; /* We will allocate the latch from
-					dynamic memory to get it to the
-					same DRAM page as other hotspot
-					semaphores */
-
-byte	btr_sea_pad2[64];	/* padding to prevent other memory update
-				hotspots from residing on the same memory
-				cache line */
-
 btr_search_sys_t*	btr_search_sys;
 
 /* If the number of records on the page divided by this parameter
@@ -88,19 +76,24 @@ allocate a new node to the hash table, it will succeed. However, the check
 will not guarantee success. */
 static
 void
-btr_search_check_free_space_in_heap(void)
-/*=====================================*/
+btr_search_check_free_space_in_heap(
+/*================================*/
+	dict_index_t*	index)	/* in: index whose hash index partition
+				is checked */
 {
 	buf_frame_t*	frame;
 	hash_table_t*	table;
 	mem_heap_t*	heap;
+	rw_lock_t*	latch;
+
+	latch = btr_search_get_latch(index);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	table = btr_search_sys->hash_index;
+	table = btr_search_get_hash_index(index);
 
 	heap = table->heap;
 
@@ -111,7 +104,7 @@ btr_search_check_free_space_in_heap(void)
 	if (heap->free_block == NULL) {
 		frame = buf_frame_alloc();
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(latch);
 
 		if (heap->free_block == NULL) {
 			heap->free_block = frame;
@@ -119,7 +112,7 @@ btr_search_check_free_space_in_heap(void)
 			buf_frame_free(frame);
 		}
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 }
 
@@ -129,19 +122,31 @@ Creates and initializes the adaptive search system at a database start. */
 void
 btr_search_sys_create(
 /*==================*/
-	ulint	hash_size)	/* in: hash index hash table size */
+	ulint	hash_size,	/* in: hash index hash table size, split
+				evenly between the partitions */
+	ulint	n_parts)	/* in: number of hash index partitions */
 {
-	/* We allocate the search latch from dynamic memory:
-	see above at the global variable definition */
-
-	btr_search_latch_temp = mem_alloc(sizeof(rw_lock_t));
+	btr_search_part_t*	part;
+	ulint			i;
 
-	rw_lock_create(&btr_search_latch, SYNC_SEARCH_SYS);
+	ut_a(n_parts > 0);
 
 	btr_search_sys = mem_alloc(sizeof(btr_search_sys_t));
 
-	btr_search_sys->hash_index = ha_create(TRUE, hash_size, 0, 0);
+	btr_search_sys->n_parts = n_parts;
+	btr_search_sys->parts = mem_alloc(n_parts
+					  * sizeof(btr_search_part_t));
 
+	for (i = 0; i < n_parts; i++) {
+		part = btr_search_sys->parts + i;
+
+		rw_lock_create(&part->latch, SYNC_SEARCH_SYS);
+
+		part->hash_index = ha_create(TRUE, hash_size / n_parts + 1,
+					     0, 0);
+		part->n_hits = 0;
+		part->n_misses = 0;
+	}
 }
 
 /*********************************************************************
@@ -186,26 +191,30 @@ btr_search_info_create(
 }
 
 /*********************************************************************
-Returns the value of ref_count. The value is protected by
-btr_search_latch. */
+Returns the value of ref_count. The value is protected by the latch
+of the hash index partition of the index. */
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
 				/* out: ref_count value. */
-	btr_search_t*   info)	/* in: search info. */
+	btr_search_t*   info,	/* in: search info. */
+	dict_index_t*	index)	/* in: index of info */
 {
-	ulint ret;
+	ulint		ret;
+	rw_lock_t*	latch;
 
 	ut_ad(info);
 
+	latch = btr_search_get_latch(index);
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(latch);
 	ret = info->ref_count;
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 
 	return(ret);
 }
@@ -225,13 +234,13 @@ btr_search_info_update_hash(
 	ulint		n_unique;
 	int		cmp;
 
+	index = cursor->index;
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(btr_search_get_latch(index), RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(btr_search_get_latch(index), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	index = cursor->index;
-
 	if (index->type & DICT_IBUF) {
 		/* So many deletes are performed on an insert buffer tree
 		that we do not consider a hash index useful on it: */
@@ -346,8 +355,10 @@ btr_search_update_block_hash_info(
 				/* in: cursor */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(btr_search_get_latch(cursor->index),
+			   RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(btr_search_get_latch(cursor->index),
+			   RW_LOCK_EX));
 	ut_ad(rw_lock_own(&((buf_block_t*) block)->lock, RW_LOCK_SHARED)
 	      || rw_lock_own(&((buf_block_t*) block)->lock, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -431,7 +442,7 @@ btr_search_update_hash_ref(
 
 	ut_ad(cursor->flag == BTR_CUR_HASH_FAIL);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(rw_lock_own(btr_search_get_latch(cursor->index), RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 	      || rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -464,10 +475,12 @@ btr_search_update_hash_ref(
 			mem_heap_free(heap);
 		}
 #ifdef UNIV_SYNC_DEBUG
-		ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+		ut_ad(rw_lock_own(btr_search_get_latch(cursor->index),
+				  RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-		ha_insert_for_fold(btr_search_sys->hash_index, fold, rec);
+		ha_insert_for_fold(btr_search_get_hash_index(cursor->index),
+				   fold, rec);
 	}
 }
 
@@ -484,10 +497,13 @@ btr_search_info_update_slow(
 	ibool		build_index;
 	ulint*		params;
 	ulint*		params2;
+	rw_lock_t*	latch;
+
+	latch = btr_search_get_latch(cursor->index);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
 	block = buf_block_align(btr_cur_get_rec(cursor));
@@ -503,7 +519,7 @@ btr_search_info_update_slow(
 
 	if (build_index || (cursor->flag == BTR_CUR_HASH_FAIL)) {
 
-		btr_search_check_free_space_in_heap();
+		btr_search_check_free_space_in_heap(cursor->index);
 	}
 
 	if (cursor->flag == BTR_CUR_HASH_FAIL) {
@@ -513,11 +529,11 @@ btr_search_info_update_slow(
 		btr_search_n_hash_fail++;
 #endif /* UNIV_SEARCH_PERF_STAT */
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(latch);
 
 		btr_search_update_hash_ref(info, block, cursor);
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 
 	if (build_index) {
@@ -560,8 +576,8 @@ btr_search_check_guess(
 	btr_cur_t*	cursor,	/* in: guessed cursor position */
 	ibool		can_only_compare_to_cursor_rec,
 				/* in: if we do not have a latch on the page
-				of cursor, but only a latch on
-				btr_search_latch, then ONLY the columns
+				of cursor, but only a latch on the hash
+				index partition, then ONLY the columns
 				of the record UNDER the cursor are
 				protected, not the next or previous record
 				in the chain: we cannot look at the next or
@@ -717,10 +733,12 @@ btr_search_guess_on_hash(
 					to protect the record! */
 	btr_cur_t*	cursor,		/* out: tree cursor */
 	ulint		has_search_latch,/* in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on the hash index
+					partition latch of index:
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr)		/* in: mtr */
 {
+	btr_search_part_t*	part;
 	buf_block_t*	block;
 	rec_t*		rec;
 	page_t*		page;
@@ -770,14 +788,16 @@ btr_search_guess_on_hash(
 	cursor->fold = fold;
 	cursor->flag = BTR_CUR_HASH;
 
+	part = btr_search_get_part(index);
+
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_lock(&btr_search_latch);
+		rw_lock_s_lock(&part->latch);
 	}
 
-	ut_ad(btr_search_latch.writer != RW_LOCK_EX);
-	ut_ad(btr_search_latch.reader_count > 0);
+	ut_ad(part->latch.writer != RW_LOCK_EX);
+	ut_ad(part->latch.reader_count > 0);
 
-	rec = ha_search_and_get_data(btr_search_sys->hash_index, fold);
+	rec = ha_search_and_get_data(part->hash_index, fold);
 
 	if (UNIV_UNLIKELY(!rec)) {
 		goto failure_unlock;
@@ -795,7 +815,7 @@ btr_search_guess_on_hash(
 			goto failure_unlock;
 		}
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 		can_only_compare_to_cursor_rec = FALSE;
 
 #ifdef UNIV_SYNC_DEBUG
@@ -821,8 +841,8 @@ btr_search_guess_on_hash(
 
 	/* Check the validity of the guess within the page */
 
-	/* If we only have the latch on btr_search_latch, not on the
-	page, it only protects the columns of the record the cursor
+	/* If we only have the latch on the hash index partition, not on
+	the page, it only protects the columns of the record the cursor
 	is positioned on. We cannot look at the next of the previous
 	record to determine if our guess for the cursor position is
 	right. */
@@ -877,6 +897,7 @@ btr_search_guess_on_hash(
 	meanwhile! Thus it might not be a bug. */
 #endif
 	info->last_hash_succ = TRUE;
+	part->n_hits++;
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	btr_search_n_succ++;
@@ -890,17 +911,18 @@ btr_search_guess_on_hash(
 	/* Increment the page get statistics though we did not really
 	fix the page: for user info only */
 
-	buf_pool->n_page_gets++;
+	buf_pool_from_block(block)->n_page_gets++;
 
 	return(TRUE);
 
 	/*-------------------------------------------*/
 failure_unlock:
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 	}
 failure:
 	cursor->flag = BTR_CUR_HASH_FAIL;
+	part->n_misses++;
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_hash_fail++;
@@ -923,6 +945,7 @@ btr_search_drop_page_hash_index(
 	page_t*	page)	/* in: index page, s- or x-latched, or an index page
 			for which we know that block->buf_fix_count == 0 */
 {
+	btr_search_part_t*	part;
 	hash_table_t*	table;
 	buf_block_t*	block;
 	ulint		n_fields;
@@ -939,23 +962,40 @@ btr_search_drop_page_hash_index(
 	dict_index_t*	index;
 	ulint*		offsets;
 
+	block = buf_block_align(page);
+
+	/* The hash index of the page can only be built for the index
+	the page belongs to, and the page is latched or unfixed, so
+	block->index cannot change to another index under us: we can
+	peek it to find the partition before reserving its latch.
+	block->index is NULL if and only if the page is not hashed. */
+
+	index = block->index;
+
+	if (UNIV_LIKELY(!index)) {
+
+		return;
+	}
+
+	part = btr_search_get_part(index);
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 retry:
-	rw_lock_s_lock(&btr_search_latch);
-
-	block = buf_block_align(page);
+	rw_lock_s_lock(&part->latch);
 
 	if (UNIV_LIKELY(!block->is_hashed)) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 
 		return;
 	}
 
-	table = btr_search_sys->hash_index;
+	ut_a(block->index == index);
+
+	table = part->hash_index;
 
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
@@ -965,13 +1005,12 @@ retry:
 
 	n_fields = block->curr_n_fields;
 	n_bytes = block->curr_n_bytes;
-	index = block->index;
 
 	/* NOTE: The fields of block must not be accessed after
-	releasing btr_search_latch, as the index page might only
+	releasing the partition latch, as the index page might only
 	be s-latched! */
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(&part->latch);
 
 	ut_a(n_fields + n_bytes > 0);
 
@@ -1021,7 +1060,7 @@ next_rec:
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(&part->latch);
 
 	if (UNIV_UNLIKELY(!block->is_hashed)) {
 		/* Someone else has meanwhile dropped the hash index */
@@ -1037,7 +1076,7 @@ next_rec:
 		/* Someone else has meanwhile built a new hash index on the
 		page, with different parameters */
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 
 		mem_free(folds);
 		goto retry;
@@ -1064,11 +1103,11 @@ cleanup:
 			"InnoDB: the hash index to a page of %s,"
 			" still %lu hash nodes remain.\n",
 			index->name, (ulong) block->n_pointers);
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 
 		btr_search_validate();
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 	}
 
 	mem_free(folds);
@@ -1140,6 +1179,7 @@ btr_search_build_page_hash_index(
 	ibool		left_side)/* in: hash for searches from left side? */
 {
 	hash_table_t*	table;
+	rw_lock_t*	latch;
 	buf_block_t*	block;
 	rec_t*		rec;
 	rec_t*		next_rec;
@@ -1159,25 +1199,26 @@ btr_search_build_page_hash_index(
 	ut_ad(index);
 
 	block = buf_block_align(page);
-	table = btr_search_sys->hash_index;
+	table = btr_search_get_hash_index(index);
+	latch = btr_search_get_latch(index);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 	      || rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(latch);
 
 	if (block->is_hashed && ((block->curr_n_fields != n_fields)
 				 || (block->curr_n_bytes != n_bytes)
 				 || (block->curr_left_side != left_side))) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		btr_search_drop_page_hash_index(page);
 	} else {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 	}
 
 	n_recs = page_get_n_recs(page);
@@ -1272,9 +1313,9 @@ btr_search_build_page_hash_index(
 		fold = next_fold;
 	}
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(index);
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(latch);
 
 	if (block->is_hashed && ((block->curr_n_fields != n_fields)
 				 || (block->curr_n_bytes != n_bytes)
@@ -1305,7 +1346,7 @@ btr_search_build_page_hash_index(
 	}
 
 exit_func:
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(latch);
 
 	mem_free(folds);
 	mem_free(recs);
@@ -1336,9 +1377,11 @@ btr_search_move_or_delete_hash_entries(
 	ulint		n_fields;
 	ulint		n_bytes;
 	ibool		left_side;
+	rw_lock_t*	latch;
 
 	block = buf_block_align(page);
 	new_block = buf_block_align(new_page);
+	latch = btr_search_get_latch(index);
 	ut_a(page_is_comp(page) == page_is_comp(new_page));
 
 #ifdef UNIV_SYNC_DEBUG
@@ -1348,11 +1391,11 @@ btr_search_move_or_delete_hash_entries(
 	ut_a(!new_block->is_hashed || new_block->index == index);
 	ut_a(!block->is_hashed || block->index == index);
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(latch);
 
 	if (new_block->is_hashed) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		btr_search_drop_page_hash_index(page);
 
@@ -1369,7 +1412,7 @@ btr_search_move_or_delete_hash_entries(
 		new_block->n_bytes = block->curr_n_bytes;
 		new_block->left_side = left_side;
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		ut_a(n_fields + n_bytes > 0);
 
@@ -1383,7 +1426,7 @@ btr_search_move_or_delete_hash_entries(
 		return;
 	}
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 }
 
 /************************************************************************
@@ -1421,7 +1464,7 @@ btr_search_update_hash_on_delete(
 	ut_a(block->index == cursor->index);
 	ut_a(block->curr_n_fields + block->curr_n_bytes > 0);
 
-	table = btr_search_sys->hash_index;
+	table = btr_search_get_hash_index(cursor->index);
 
 	index_id = cursor->index->id;
 	fold = rec_fold(rec, rec_get_offsets(rec, cursor->index, offsets_,
@@ -1430,11 +1473,11 @@ btr_search_update_hash_on_delete(
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
 	}
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(btr_search_get_latch(cursor->index));
 
 	ha_search_and_delete_if_found(table, fold, rec);
 
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(btr_search_get_latch(cursor->index));
 }
 
 /************************************************************************
@@ -1449,6 +1492,7 @@ btr_search_update_hash_node_on_insert(
 				to the cursor */
 {
 	hash_table_t*	table;
+	rw_lock_t*	latch;
 	buf_block_t*	block;
 	rec_t*		rec;
 
@@ -1467,21 +1511,23 @@ btr_search_update_hash_node_on_insert(
 
 	ut_a(block->index == cursor->index);
 
-	rw_lock_x_lock(&btr_search_latch);
+	latch = btr_search_get_latch(cursor->index);
+
+	rw_lock_x_lock(latch);
 
 	if ((cursor->flag == BTR_CUR_HASH)
 	    && (cursor->n_fields == block->curr_n_fields)
 	    && (cursor->n_bytes == block->curr_n_bytes)
 	    && !block->curr_left_side) {
 
-		table = btr_search_sys->hash_index;
+		table = btr_search_get_hash_index(cursor->index);
 
 		ha_search_and_update_if_found(table, cursor->fold, rec,
 					      page_rec_get_next(rec));
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 
 		btr_search_update_hash_on_insert(cursor);
 	}
@@ -1499,6 +1545,7 @@ btr_search_update_hash_on_insert(
 				to the cursor */
 {
 	hash_table_t*	table;
+	rw_lock_t*	latch;
 	buf_block_t*	block;
 	rec_t*		rec;
 	rec_t*		ins_rec;
@@ -1516,9 +1563,10 @@ btr_search_update_hash_on_insert(
 	ulint*		offsets		= offsets_;
 	*offsets_ = (sizeof offsets_) / sizeof *offsets_;
 
-	table = btr_search_sys->hash_index;
+	table = btr_search_get_hash_index(cursor->index);
+	latch = btr_search_get_latch(cursor->index);
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(cursor->index);
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1562,7 +1610,7 @@ btr_search_update_hash_on_insert(
 	} else {
 		if (left_side) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 
@@ -1576,7 +1624,7 @@ btr_search_update_hash_on_insert(
 
 		if (!locked) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 		}
@@ -1594,7 +1642,7 @@ check_next_rec:
 		if (!left_side) {
 
 			if (!locked) {
-				rw_lock_x_lock(&btr_search_latch);
+				rw_lock_x_lock(latch);
 
 				locked = TRUE;
 			}
@@ -1609,7 +1657,7 @@ check_next_rec:
 
 		if (!locked) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 		}
@@ -1632,22 +1680,24 @@ function_exit:
 		mem_heap_free(heap);
 	}
 	if (locked) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 }
 
 /************************************************************************
-Validates the search system. */
-
+Validates a partition of the search system. */
+static
 ibool
-btr_search_validate(void)
+btr_search_validate_part(
 /*=====================*/
-				/* out: TRUE if ok */
+					/* out: TRUE if ok */
+	btr_search_part_t*	part,	/* in: hash index partition */
+	ulint*			n_page_dumps)/* in/out: number of pages
+					printed so far */
 {
 	buf_block_t*	block;
 	page_t*		page;
 	ha_node_t*	node;
-	ulint		n_page_dumps	= 0;
 	ibool		ok		= TRUE;
 	ulint		i;
 	ulint		cell_count;
@@ -1656,25 +1706,25 @@ btr_search_validate(void)
 	ulint*		offsets		= offsets_;
 
 	/* How many cells to check before temporarily releasing
-	btr_search_latch. */
+	the partition latch. */
 	ulint		chunk_size = 10000;
 
 	*offsets_ = (sizeof offsets_) / sizeof *offsets_;
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(&part->latch);
 
-	cell_count = hash_get_n_cells(btr_search_sys->hash_index);
+	cell_count = hash_get_n_cells(part->hash_index);
 
 	for (i = 0; i < cell_count; i++) {
-		/* We release btr_search_latch every once in a while to
+		/* We release the partition latch every once in a while to
 		give other queries a chance to run. */
 		if ((i != 0) && ((i % chunk_size) == 0)) {
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(&part->latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(&part->latch);
 		}
 
-		node = hash_get_nth_cell(btr_search_sys->hash_index, i)->node;
+		node = hash_get_nth_cell(part->hash_index, i)->node;
 
 		while (node != NULL) {
 			block = buf_block_align(node->data);
@@ -1726,9 +1776,9 @@ btr_search_validate(void)
 					(ulong) block->curr_n_bytes,
 					(ulong) block->curr_left_side);
 
-				if (n_page_dumps < 20) {
+				if (*n_page_dumps < 20) {
 					buf_page_print(page);
-					n_page_dumps++;
+					(*n_page_dumps)++;
 				}
 			}
 
@@ -1739,23 +1789,89 @@ btr_search_validate(void)
 	for (i = 0; i < cell_count; i += chunk_size) {
 		ulint end_index = ut_min(i + chunk_size - 1, cell_count - 1);
 
-		/* We release btr_search_latch every once in a while to
+		/* We release the partition latch every once in a while to
 		give other queries a chance to run. */
 		if (i != 0) {
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(&part->latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(&part->latch);
 		}
 
-		if (!ha_validate(btr_search_sys->hash_index, i, end_index)) {
+		if (!ha_validate(part->hash_index, i, end_index)) {
 			ok = FALSE;
 		}
 	}
 
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(&part->latch);
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
 	}
 
 	return(ok);
 }
+
+/************************************************************************
+Validates the search system. */
+
+ibool
+btr_search_validate(void)
+/*=====================*/
+				/* out: TRUE if ok */
+{
+	ulint	n_page_dumps	= 0;
+	ibool	ok		= TRUE;
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		if (!btr_search_validate_part(btr_search_sys->parts + i,
+					      &n_page_dumps)) {
+			ok = FALSE;
+		}
+	}
+
+	return(ok);
+}
+
+/************************************************************************
+Prints info of the adaptive hash index partitions. */
+
+void
+btr_search_print_info(
+/*==================*/
+	FILE*	file)	/* in: file where to print */
+{
+	btr_search_part_t*	part;
+	ulint			i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		part = btr_search_sys->parts + i;
+
+		fprintf(file, "Partition %lu: ", (ulong) i);
+		ha_print_info(file, part->hash_index);
+		fprintf(file, "Partition %lu: %lu hits, %lu misses\n",
+			(ulong) i, (ulong) part->n_hits,
+			(ulong) part->n_misses);
+	}
+}
+
+/************************************************************************
+Sums the hits and misses of the adaptive hash index partitions. */
+
+void
+btr_search_get_n_hits(
+/*==================*/
+	ulint*	n_hits,		/* out: searches which found the record
+				through the hash index */
+	ulint*	n_misses)	/* out: searches which tried the hash
+				index in vain */
+{
+	ulint	i;
+
+	*n_hits = 0;
+	*n_misses = 0;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		*n_hits += btr_search_sys->parts[i].n_hits;
+		*n_misses += btr_search_sys->parts[i].n_misses;
+	}
+}
@@ -86,6 +86,13 @@ create a separate mutex for the page hash table. On Pentium,
 accessing the hash table takes 2 microseconds, about half
 of the total buf_pool mutex hold time.
 
+The buffer pool can also be split into innodb_buffer_pool_instances
+instances. Each instance has its own mutex, page hash table, free, LRU and
+flush lists, and a file page is always cached in the instance
+buf_pool_get() computes from its address. A thread never holds the mutexes
+of two instances at the same time: functions which concern the whole
+buffer pool visit the instances one after another.
+
 		Control blocks
 		--------------
 
@@ -227,7 +234,12 @@ static const int WAIT_FOR_READ	= 20000;
 /* Number of attemtps made to read in a page in the buffer pool */
 static const ulint BUF_PAGE_READ_MAX_RETRIES = 100;
 
-buf_pool_t*	buf_pool = NULL; /* The buffer buf_pool of the database */
+buf_pool_t*	buf_pool_ptr = NULL;	/* The array of buffer pool
+					instances of the database */
+byte*		buf_pool_frame_zero = NULL;/* The first frame of the first
+					instance */
+byte*		buf_pool_high_end = NULL;/* Pointer to the end of the frames
+					of the last instance */
 
 #ifdef UNIV_DEBUG
 ulint		buf_dbg_counter	= 0; /* This is used to insert validation
@@ -291,6 +303,28 @@ buf_calc_page_old_checksum(
 	return(checksum);
 }
 
+/************************************************************************
+Calculates the CRC-32C checksum of a page, which innodb_checksum_algorithm
+crc32 stores to both checksum fields of the page. It covers the same bytes
+as buf_calc_page_new_checksum(). */
+
+ulint
+buf_calc_page_crc32(
+/*================*/
+			/* out: checksum */
+	byte*	page)	/* in: buffer page */
+{
+	ib_uint32_t	checksum;
+
+	checksum = ut_crc32c(page + FIL_PAGE_OFFSET,
+			     FIL_PAGE_FILE_FLUSH_LSN - FIL_PAGE_OFFSET)
+		^ ut_crc32c(page + FIL_PAGE_DATA,
+			    UNIV_PAGE_SIZE - FIL_PAGE_DATA
+			    - FIL_PAGE_END_LSN_OLD_CHKSUM);
+
+	return((ulint) checksum);
+}
+
 /************************************************************************
 Checks if a page is corrupt. */
 
@@ -354,12 +388,26 @@ buf_page_is_corrupted(
 	disabled. Otherwise, skip checksum calculation and return FALSE */
 
 	if (srv_use_checksums) {
-		old_checksum = buf_calc_page_old_checksum(read_buf);
+		checksum_field = mach_read_from_4(read_buf
+						  + FIL_PAGE_SPACE_OR_CHKSUM);
 
 		old_checksum_field = mach_read_from_4(
 			read_buf + UNIV_PAGE_SIZE
 			- FIL_PAGE_END_LSN_OLD_CHKSUM);
 
+		/* Pages written with innodb_checksum_algorithm=crc32 store
+		the CRC-32C to both fields. The other formulas are accepted
+		below whatever the current setting, so that the algorithm
+		can be changed on an existing database. */
+
+		if (checksum_field == old_checksum_field
+		    && checksum_field == buf_calc_page_crc32(read_buf)) {
+
+			return(FALSE);
+		}
+
+		old_checksum = buf_calc_page_old_checksum(read_buf);
+
 		/* There are 2 valid formulas for old_checksum_field:
 
 		1. Very old versions of InnoDB only stored 8 byte lsn to the
@@ -377,8 +425,6 @@ buf_page_is_corrupted(
 		}
 
 		checksum = buf_calc_page_new_checksum(read_buf);
-		checksum_field = mach_read_from_4(read_buf
-						  + FIL_PAGE_SPACE_OR_CHKSUM);
 
 		/* InnoDB versions < 4.0.14 and < 4.1.1 stored the space id
 		(always equal to 0), to FIL_PAGE_SPACE_SPACE_OR_CHKSUM */
@@ -404,6 +450,7 @@ buf_page_print(
 	dict_index_t*	index;
 	ulint		checksum;
 	ulint		old_checksum;
+	ulint		crc32_checksum;
 
 	ut_print_timestamp(stderr);
 	fprintf(stderr, "  InnoDB: Page dump in ascii and hex (%lu bytes):\n",
@@ -415,11 +462,13 @@ buf_page_print(
 		? buf_calc_page_new_checksum(read_buf) : BUF_NO_CHECKSUM_MAGIC;
 	old_checksum = srv_use_checksums
 		? buf_calc_page_old_checksum(read_buf) : BUF_NO_CHECKSUM_MAGIC;
+	crc32_checksum = srv_use_checksums
+		? buf_calc_page_crc32(read_buf) : BUF_NO_CHECKSUM_MAGIC;
 
 	ut_print_timestamp(stderr);
 	fprintf(stderr,
 		"  InnoDB: Page checksum %lu, prior-to-4.0.14-form"
-		" checksum %lu\n"
+		" checksum %lu, crc32 checksum %lu\n"
 		"InnoDB: stored checksum %lu, prior-to-4.0.14-form"
 		" stored checksum %lu\n"
 		"InnoDB: Page lsn %lu %lu, low 4 bytes of lsn"
@@ -428,6 +477,7 @@ buf_page_print(
 		"InnoDB: space id (if created with >= MySQL-4.1.1"
 		" and stored already) %lu\n",
 		(ulong) checksum, (ulong) old_checksum,
+		(ulong) crc32_checksum,
 		(ulong) mach_read_from_4(read_buf + FIL_PAGE_SPACE_OR_CHKSUM),
 		(ulong) mach_read_from_4(read_buf + UNIV_PAGE_SIZE
 					 - FIL_PAGE_END_LSN_OLD_CHKSUM),
@@ -556,137 +606,55 @@ buf_block_init(
 }
 
 /************************************************************************
-Creates the buffer pool. */
-
-buf_pool_t*
-buf_pool_init(
-/*==========*/
-				/* out, own: buf_pool object, NULL if not
-				enough memory or error */
-	ulint	max_size,	/* in: maximum size of the buf_pool in
-				blocks */
-	ulint	curr_size,	/* in: current size to use, must be <=
-				max_size, currently must be equal to
-				max_size */
-	ulint	n_frames)	/* in: number of frames; if AWE is used,
-				this is the size of the address space window
-				where physical memory pages are mapped; if
-				AWE is not used then this must be the same
-				as max_size */
+Initializes a buffer pool instance. The frames and the control blocks of
+all the instances are allocated in buf_pool_init(); an instance gets a
+consecutive part of them. */
+static
+void
+buf_pool_init_instance(
+/*===================*/
+	buf_pool_t*	buf_pool,	/* in: buffer pool instance */
+	ulint		index,		/* in: number of the instance */
+	byte*		frame_mem,	/* in: memory allocated for the frames
+					of all the instances */
+	byte*		frame_zero,	/* in: first frame of the instance */
+	buf_block_t*	blocks,		/* in: control blocks of the
+					instance */
+	buf_block_t**	blocks_of_frames,/* in: part of the blocks_of_frames
+					array of the instance */
+	os_awe_t*	awe_info,	/* in: AWE info array, or NULL */
+	ulint		size,		/* in: number of control blocks */
+	ulint		n_frames)	/* in: number of frames */
 {
 	byte*		frame;
 	ulint		i;
 	buf_block_t*	block;
 
-	ut_a(max_size == curr_size);
-	ut_a(srv_use_awe || n_frames == max_size);
-
-	if (n_frames > curr_size) {
-		fprintf(stderr,
-			"InnoDB: AWE: Error: you must specify in my.cnf"
-			" .._awe_mem_mb larger\n"
-			"InnoDB: than .._buffer_pool_size. Now the former"
-			" is %lu pages,\n"
-			"InnoDB: the latter %lu pages.\n",
-			(ulong) curr_size, (ulong) n_frames);
-
-		return(NULL);
-	}
-
-	buf_pool = mem_alloc(sizeof(buf_pool_t));
-
 	/* 1. Initialize general fields
 	---------------------------- */
 	mutex_create(&buf_pool->mutex, SYNC_BUF_POOL);
 
 	mutex_enter(&(buf_pool->mutex));
 
-	if (srv_use_awe) {
-		/*----------------------------------------*/
-		/* Allocate the virtual address space window, i.e., the
-		buffer pool frames */
-
-		buf_pool->frame_mem = os_awe_allocate_virtual_mem_window(
-			UNIV_PAGE_SIZE * (n_frames + 1));
-
-		/* Allocate the physical memory for AWE and the AWE info array
-		for buf_pool */
-
-		if ((curr_size % ((1024 * 1024) / UNIV_PAGE_SIZE)) != 0) {
+	buf_pool->frame_mem = frame_mem;
+	buf_pool->awe_info = awe_info;
+	buf_pool->blocks = blocks;
+	buf_pool->blocks_of_frames = blocks_of_frames;
 
-			fprintf(stderr,
-				"InnoDB: AWE: Error: physical memory must be"
-				" allocated in full megabytes.\n"
-				"InnoDB: Trying to allocate %lu"
-				" database pages.\n",
-				(ulong) curr_size);
-
-			return(NULL);
-		}
-
-		if (!os_awe_allocate_physical_mem(&(buf_pool->awe_info),
-						  curr_size
-						  / ((1024 * 1024)
-						     / UNIV_PAGE_SIZE))) {
-
-			return(NULL);
-		}
-		/*----------------------------------------*/
-	} else {
-		buf_pool->frame_mem = os_mem_alloc_large(
-			UNIV_PAGE_SIZE * (n_frames + 1), FALSE);
-	}
-
-	if (buf_pool->frame_mem == NULL) {
-
-		return(NULL);
-	}
-
-	buf_pool->blocks = ut_malloc(sizeof(buf_block_t) * max_size);
-
-	if (buf_pool->blocks == NULL) {
-
-		return(NULL);
-	}
-
-	buf_pool->max_size = max_size;
-	buf_pool->curr_size = curr_size;
+	buf_pool->max_size = size;
+	buf_pool->curr_size = size;
 
 	buf_pool->n_frames = n_frames;
 
-	/* Align pointer to the first frame */
-
-	frame = ut_align(buf_pool->frame_mem, UNIV_PAGE_SIZE);
-
-	buf_pool->frame_zero = frame;
-	buf_pool->high_end = frame + UNIV_PAGE_SIZE * n_frames;
-
-	if (srv_use_awe) {
-		/*----------------------------------------*/
-		/* Map an initial part of the allocated physical memory to
-		the window */
-
-		os_awe_map_physical_mem_to_window(buf_pool->frame_zero,
-						  n_frames
-						  * (UNIV_PAGE_SIZE
-						     / OS_AWE_X86_PAGE_SIZE),
-						  buf_pool->awe_info);
-		/*----------------------------------------*/
-	}
-
-	buf_pool->blocks_of_frames = ut_malloc(sizeof(void*) * n_frames);
-
-	if (buf_pool->blocks_of_frames == NULL) {
-
-		return(NULL);
-	}
+	buf_pool->frame_zero = frame_zero;
+	buf_pool->high_end = frame_zero + UNIV_PAGE_SIZE * n_frames;
 
 	/* Init block structs and assign frames for them; in the case of
 	AWE there are less frames than blocks. Then we assign the frames
-	to the first blocks (we already mapped the memory above). We also
+	to the first blocks (the memory is already mapped). We also
 	init the awe_info for every block. */
 
-	for (i = 0; i < max_size; i++) {
+	for (i = 0; i < size; i++) {
 
 		block = buf_pool_get_nth_block(buf_pool, i);
 
@@ -699,6 +667,8 @@ buf_pool_init(
 
 		buf_block_init(block, frame);
 
+		block->buf_pool_index = index;
+
 		if (srv_use_awe) {
 			/*----------------------------------------*/
 			block->awe_info = buf_pool->awe_info
@@ -707,7 +677,7 @@ buf_pool_init(
 		}
 	}
 
-	buf_pool->page_hash = hash_create(2 * max_size);
+	buf_pool->page_hash = hash_create(2 * size);
 
 	buf_pool->n_pend_reads = 0;
 
@@ -736,6 +706,7 @@ buf_pool_init(
 	}
 
 	buf_pool->LRU_flush_ended = 0;
+	buf_pool->page_cleaner_lsn = ut_dulint_zero;
 
 	buf_pool->ulint_clock = 1;
 	buf_pool->freed_page_clock = 0;
@@ -751,7 +722,7 @@ buf_pool_init(
 	/* Add control blocks to the free list */
 	UT_LIST_INIT(buf_pool->free);
 
-	for (i = 0; i < curr_size; i++) {
+	for (i = 0; i < size; i++) {
 
 		block = buf_pool_get_nth_block(buf_pool, i);
 
@@ -773,16 +744,156 @@ buf_pool_init(
 	}
 
 	mutex_exit(&(buf_pool->mutex));
+}
+
+/************************************************************************
+Creates the buffer pool: srv_buf_pool_instances instances among which the
+blocks are divided evenly. */
+
+buf_pool_t*
+buf_pool_init(
+/*==========*/
+				/* out, own: array of buffer pool
+				instances, NULL if not enough memory
+				or error */
+	ulint	max_size,	/* in: maximum size of the buf_pool in
+				blocks */
+	ulint	curr_size,	/* in: current size to use, must be <=
+				max_size, currently must be equal to
+				max_size */
+	ulint	n_frames)	/* in: number of frames; if AWE is used,
+				this is the size of the address space window
+				where physical memory pages are mapped; if
+				AWE is not used then this must be the same
+				as max_size */
+{
+	byte*		frame_mem;
+	buf_block_t*	blocks;
+	buf_block_t**	blocks_of_frames;
+	os_awe_t*	awe_info	= NULL;
+	ulint		n_instances	= srv_buf_pool_instances;
+	ulint		i;
+
+	ut_a(max_size == curr_size);
+	ut_a(srv_use_awe || n_frames == max_size);
+	ut_a(n_instances >= 1);
+	ut_a(!srv_use_awe || n_instances == 1);
+
+	if (n_frames > curr_size) {
+		fprintf(stderr,
+			"InnoDB: AWE: Error: you must specify in my.cnf"
+			" .._awe_mem_mb larger\n"
+			"InnoDB: than .._buffer_pool_size. Now the former"
+			" is %lu pages,\n"
+			"InnoDB: the latter %lu pages.\n",
+			(ulong) curr_size, (ulong) n_frames);
+
+		return(NULL);
+	}
+
+	if (srv_use_awe) {
+		/*----------------------------------------*/
+		/* Allocate the virtual address space window, i.e., the
+		buffer pool frames */
+
+		frame_mem = os_awe_allocate_virtual_mem_window(
+			UNIV_PAGE_SIZE * (n_frames + 1));
+
+		/* Allocate the physical memory for AWE and the AWE info array
+		for buf_pool */
+
+		if ((curr_size % ((1024 * 1024) / UNIV_PAGE_SIZE)) != 0) {
+
+			fprintf(stderr,
+				"InnoDB: AWE: Error: physical memory must be"
+				" allocated in full megabytes.\n"
+				"InnoDB: Trying to allocate %lu"
+				" database pages.\n",
+				(ulong) curr_size);
+
+			return(NULL);
+		}
+
+		if (!os_awe_allocate_physical_mem(&awe_info,
+						  curr_size
+						  / ((1024 * 1024)
+						     / UNIV_PAGE_SIZE))) {
+
+			return(NULL);
+		}
+		/*----------------------------------------*/
+	} else {
+		frame_mem = os_mem_alloc_large(
+			UNIV_PAGE_SIZE * (n_frames + 1), FALSE);
+	}
+
+	if (frame_mem == NULL) {
+
+		return(NULL);
+	}
+
+	blocks = ut_malloc(sizeof(buf_block_t) * max_size);
+
+	if (blocks == NULL) {
+
+		return(NULL);
+	}
+
+	blocks_of_frames = ut_malloc(sizeof(void*) * n_frames);
+
+	if (blocks_of_frames == NULL) {
+
+		return(NULL);
+	}
+
+	/* Align pointer to the first frame */
+
+	buf_pool_frame_zero = ut_align(frame_mem, UNIV_PAGE_SIZE);
+	buf_pool_high_end = buf_pool_frame_zero + UNIV_PAGE_SIZE * n_frames;
+
+	if (srv_use_awe) {
+		/*----------------------------------------*/
+		/* Map an initial part of the allocated physical memory to
+		the window */
+
+		os_awe_map_physical_mem_to_window(buf_pool_frame_zero,
+						  n_frames
+						  * (UNIV_PAGE_SIZE
+						     / OS_AWE_X86_PAGE_SIZE),
+						  awe_info);
+		/*----------------------------------------*/
+	}
+
+	buf_pool_ptr = mem_alloc(n_instances * sizeof(buf_pool_t));
+
+	/* Instance i gets the blocks and frames [first, first + size); the
+	frames of consecutive instances are consecutive, so that
+	buf_block_align() can find the block of any frame with the global
+	blocks_of_frames array */
+
+	for (i = 0; i < n_instances; i++) {
+		ulint	first	= max_size * i / n_instances;
+		ulint	size	= max_size * (i + 1) / n_instances - first;
+
+		buf_pool_init_instance(buf_pool_ptr + i, i, frame_mem,
+				       buf_pool_frame_zero
+				       + first * UNIV_PAGE_SIZE,
+				       blocks + first,
+				       blocks_of_frames + first,
+				       awe_info, size,
+				       srv_use_awe ? n_frames : size);
+	}
 
 	if (srv_use_adaptive_hash_indexes) {
 		btr_search_sys_create(curr_size * UNIV_PAGE_SIZE
-				      / sizeof(void*) / 64);
+				      / sizeof(void*) / 64,
+				      srv_n_adaptive_hash_parts);
 	} else {
 		/* Create only a small dummy system */
-		btr_search_sys_create(1000);
+		btr_search_sys_create(1000, 1);
 	}
 
-	return(buf_pool);
+	return(buf_pool_ptr);
 }
 
 /************************************************************************
@@ -799,10 +910,10 @@ buf_awe_map_page_to_frame(
 					add the block to the
 					awe_LRU_free_mapped list */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
 	buf_block_t*	bck;
 
 	ut_ad(mutex_own(&(buf_pool->mutex)));
-	ut_ad(block);
 
 	if (block->frame) {
 
@@ -875,15 +986,26 @@ buf_awe_map_page_to_frame(
 Allocates a buffer block. */
 UNIV_INLINE
 buf_block_t*
-buf_block_alloc(void)
-/*=================*/
+buf_block_alloc(
+/*============*/
 				/* out, own: the allocated block; also if AWE
 				is used it is guaranteed that the page is
 				mapped to a frame */
+	buf_pool_t*	buf_pool)/* in: buffer pool instance, or NULL to
+				take the instances in turn */
 {
+	static ulint	buf_pool_index;
 	buf_block_t*	block;
 
-	block = buf_LRU_get_free_block();
+	if (buf_pool == NULL) {
+		/* The races on buf_pool_index do no harm: any instance
+		will do */
+
+		buf_pool = buf_pool_from_array(buf_pool_index++
+					       % srv_buf_pool_instances);
+	}
+
+	block = buf_LRU_get_free_block(buf_pool);
 
 	return(block);
 }
@@ -897,6 +1019,8 @@ buf_block_make_young(
 /*=================*/
 	buf_block_t*	block)	/* in: block to make younger */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
 	ut_ad(!mutex_own(&(buf_pool->mutex)));
 
 	/* Note that we read freed_page_clock's without holding any mutex:
@@ -923,12 +1047,11 @@ buf_page_make_young(
 /*================*/
 	buf_frame_t*	frame)	/* in: buffer frame of a file page */
 {
-	buf_block_t*	block;
+	buf_block_t*	block	= buf_block_align(frame);
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
 
 	mutex_enter(&(buf_pool->mutex));
 
-	block = buf_block_align(frame);
-
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
 	buf_LRU_make_block_young(block);
@@ -944,6 +1067,8 @@ buf_block_free(
 /*===========*/
 	buf_block_t*	block)	/* in, own: block to be freed */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
 	mutex_enter(&(buf_pool->mutex));
 
 	mutex_enter(&block->mutex);
@@ -965,7 +1090,7 @@ buf_frame_alloc(void)
 /*=================*/
 				/* out: buffer frame */
 {
-	return(buf_block_alloc()->frame);
+	return(buf_block_alloc(NULL)->frame);
 }
 
 /*************************************************************************
@@ -993,11 +1118,12 @@ buf_page_peek_block(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	buf_block_t*	block;
 
 	mutex_enter_fast(&(buf_pool->mutex));
 
-	block = buf_page_hash_get(space, offset);
+	block = buf_page_hash_get(buf_pool, space, offset);
 
 	mutex_exit(&(buf_pool->mutex));
 
@@ -1017,12 +1143,13 @@ buf_page_peek_if_search_hashed(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	buf_block_t*	block;
 	ibool		is_hashed;
 
 	mutex_enter_fast(&(buf_pool->mutex));
 
-	block = buf_page_hash_get(space, offset);
+	block = buf_page_hash_get(buf_pool, space, offset);
 
 	if (!block) {
 		is_hashed = FALSE;
@@ -1070,11 +1197,12 @@ buf_page_set_file_page_was_freed(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	buf_block_t*	block;
 
 	mutex_enter_fast(&(buf_pool->mutex));
 
-	block = buf_page_hash_get(space, offset);
+	block = buf_page_hash_get(buf_pool, space, offset);
 
 	if (block) {
 		block->file_page_was_freed = TRUE;
@@ -1099,11 +1227,12 @@ buf_page_reset_file_page_was_freed(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	buf_block_t*	block;
 
 	mutex_enter_fast(&(buf_pool->mutex));
 
-	block = buf_page_hash_get(space, offset);
+	block = buf_page_hash_get(buf_pool, space, offset);
 
 	if (block) {
 		block->file_page_was_freed = FALSE;
@@ -1131,6 +1260,7 @@ buf_page_get_gen(
 	ulint		line,	/* in: line where called */
 	mtr_t*		mtr)	/* in: mini-transaction */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	buf_block_t*	block;
 	ibool		accessed;
 	ulint		fix_type;
@@ -1156,7 +1286,12 @@ loop:
 	if (guess) {
 		block = buf_block_align(guess);
 
-		if ((offset != block->offset) || (space != block->space)
+		/* The fields of a block of another instance are not
+		protected by the mutex we hold; such a block cannot contain
+		the page anyway */
+
+		if (buf_pool_from_block(block) != buf_pool
+		    || (offset != block->offset) || (space != block->space)
 		    || (block->state != BUF_BLOCK_FILE_PAGE)) {
 
 			block = NULL;
@@ -1164,7 +1299,7 @@ loop:
 	}
 
 	if (block == NULL) {
-		block = buf_page_hash_get(space, offset);
+		block = buf_page_hash_get(buf_pool, space, offset);
 	}
 
 	if (block == NULL) {
@@ -1496,7 +1631,7 @@ buf_page_optimistic_get_func(
 #ifdef UNIV_IBUF_DEBUG
 	ut_a(ibuf_count_get(block->space, block->offset) == 0);
 #endif
-	buf_pool->n_page_gets++;
+	buf_pool_from_block(block)->n_page_gets++;
 
 	return(TRUE);
 }
@@ -1599,7 +1734,7 @@ buf_page_get_known_nowait(
 	ut_a((mode == BUF_KEEP_OLD)
 	     || (ibuf_count_get(block->space, block->offset) == 0));
 #endif
-	buf_pool->n_page_gets++;
+	buf_pool_from_block(block)->n_page_gets++;
 
 	return(TRUE);
 }
@@ -1648,6 +1783,7 @@ static
 void
 buf_page_init(
 /*==========*/
+	buf_pool_t*	buf_pool,/* in: buffer pool instance of the page */
 	ulint		space,	/* in: space id */
 	ulint		offset,	/* in: offset of the page within space
 				in units of a page */
@@ -1656,6 +1792,7 @@ buf_page_init(
 
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 	ut_ad(mutex_own(&(block->mutex)));
+	ut_ad(buf_pool_from_block(block) == buf_pool);
 	ut_a(block->state != BUF_BLOCK_FILE_PAGE);
 
 	/* Set the state of the block */
@@ -1681,7 +1818,7 @@ buf_page_init(
 
 	/* Insert into the hash table of file pages */
 
-	if (buf_page_hash_get(space, offset)) {
+	if (buf_page_hash_get(buf_pool, space, offset)) {
 		fprintf(stderr,
 			"InnoDB: Error: page %lu %lu already found"
 			" in the hash table\n",
@@ -1741,11 +1878,10 @@ buf_page_init_for_read(
 				DISCARD + IMPORT */
 	ulint		offset)	/* in: page number */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	buf_block_t*	block;
 	mtr_t		mtr;
 
-	ut_ad(buf_pool);
-
 	*err = DB_SUCCESS;
 
 	if (mode == BUF_READ_IBUF_PAGES_ONLY) {
@@ -1766,7 +1902,7 @@ buf_page_init_for_read(
 		ut_ad(mode == BUF_READ_ANY_PAGE);
 	}
 
-	block = buf_block_alloc();
+	block = buf_block_alloc(buf_pool);
 
 	ut_a(block);
 
@@ -1779,7 +1915,7 @@ buf_page_init_for_read(
 	}
 
 	if (*err == DB_TABLESPACE_DELETED
-	    || NULL != buf_page_hash_get(space, offset)) {
+	    || NULL != buf_page_hash_get(buf_pool, space, offset)) {
 
 		/* The page belongs to a space which has been
 		deleted or is being deleted, or the page is
@@ -1800,7 +1936,7 @@ buf_page_init_for_read(
 
 	ut_ad(block);
 
-	buf_page_init(space, offset, block);
+	buf_page_init(buf_pool, space, offset, block);
 
 	/* The block must be put to the LRU list, to the old blocks */
 
@@ -1845,17 +1981,18 @@ buf_page_create(
 			a page */
 	mtr_t*	mtr)	/* in: mini-transaction handle */
 {
+	buf_pool_t*	buf_pool	= buf_pool_get(space, offset);
 	buf_frame_t*	frame;
 	buf_block_t*	block;
 	buf_block_t*	free_block	= NULL;
 
 	ut_ad(mtr);
 
-	free_block = buf_LRU_get_free_block();
+	free_block = buf_LRU_get_free_block(buf_pool);
 
 	mutex_enter(&(buf_pool->mutex));
 
-	block = buf_page_hash_get(space, offset);
+	block = buf_page_hash_get(buf_pool, space, offset);
 
 	if (block != NULL) {
 #ifdef UNIV_IBUF_DEBUG
@@ -1886,7 +2023,7 @@ buf_page_create(
 
 	mutex_enter(&block->mutex);
 
-	buf_page_init(space, offset, block);
+	buf_page_init(buf_pool, space, offset, block);
 
 	/* The block must be put to the LRU list */
 	buf_LRU_add_block(block, FALSE);
@@ -1912,7 +2049,7 @@ buf_page_create(
 	ibuf_merge_or_delete_for_page(NULL, space, offset, TRUE);
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(buf_pool);
 
 	frame = block->frame;
 
@@ -1950,10 +2087,9 @@ buf_page_io_complete(
 /*=================*/
 	buf_block_t*	block)	/* in: pointer to the block in question */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
 	ulint		io_type;
 
-	ut_ad(block);
-
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
 	/* We do not need protect block->io_fix here by block->mutex to read
@@ -2131,30 +2267,37 @@ void
 buf_pool_invalidate(void)
 /*=====================*/
 {
-	ibool	freed;
+	ibool		freed;
+	buf_pool_t*	buf_pool;
+	ulint		i;
 
 	ut_ad(buf_all_freed());
 
-	freed = TRUE;
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
 
-	while (freed) {
-		freed = buf_LRU_search_and_free_block(100);
-	}
+		freed = TRUE;
 
-	mutex_enter(&(buf_pool->mutex));
+		while (freed) {
+			freed = buf_LRU_search_and_free_block(buf_pool, 100);
+		}
 
-	ut_ad(UT_LIST_GET_LEN(buf_pool->LRU) == 0);
+		mutex_enter(&(buf_pool->mutex));
 
-	mutex_exit(&(buf_pool->mutex));
+		ut_ad(UT_LIST_GET_LEN(buf_pool->LRU) == 0);
+
+		mutex_exit(&(buf_pool->mutex));
+	}
 }
 
 #ifdef UNIV_DEBUG
 /*************************************************************************
-Validates the buffer buf_pool data structure. */
-
-ibool
-buf_validate(void)
-/*==============*/
+Validates a buffer pool instance. */
+static
+void
+buf_pool_validate_instance(
+/*=======================*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	ulint		i;
@@ -2166,8 +2309,6 @@ buf_validate(void)
 	ulint		n_free		= 0;
 	ulint		n_page		= 0;
 
-	ut_ad(buf_pool);
-
 	mutex_enter(&(buf_pool->mutex));
 
 	for (i = 0; i < buf_pool->curr_size; i++) {
@@ -2176,9 +2317,11 @@ buf_validate(void)
 
 		mutex_enter(&block->mutex);
 
+		ut_a(buf_pool_from_block(block) == buf_pool);
+
 		if (block->state == BUF_BLOCK_FILE_PAGE) {
 
-			ut_a(buf_page_hash_get(block->space,
+			ut_a(buf_page_hash_get(buf_pool, block->space,
 					       block->offset) == block);
 			n_page++;
 
@@ -2244,6 +2387,22 @@ buf_validate(void)
 	ut_a(buf_pool->n_flush[BUF_FLUSH_LRU] == n_lru_flush);
 
 	mutex_exit(&(buf_pool->mutex));
+}
+
+/*************************************************************************
+Validates the buffer buf_pool data structure. */
+
+ibool
+buf_validate(void)
+/*==============*/
+{
+	ulint	i;
+
+	ut_ad(buf_pool_ptr);
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_validate_instance(buf_pool_from_array(i));
+	}
 
 	ut_a(buf_LRU_validate());
 	ut_a(buf_flush_validate());
@@ -2252,11 +2411,12 @@ buf_validate(void)
 }
 
 /*************************************************************************
-Prints info of the buffer buf_pool data structure. */
-
+Prints info of a buffer pool instance. */
+static
 void
-buf_print(void)
-/*===========*/
+buf_print_instance(
+/*===============*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
 {
 	dulint*		index_ids;
 	ulint*		counts;
@@ -2268,8 +2428,6 @@ buf_print(void)
 	buf_frame_t*	frame;
 	dict_index_t*	index;
 
-	ut_ad(buf_pool);
-
 	size = buf_pool->curr_size;
 
 	index_ids = mem_alloc(sizeof(dulint) * size);
@@ -2278,13 +2436,14 @@ buf_print(void)
 	mutex_enter(&(buf_pool->mutex));
 
 	fprintf(stderr,
-		"buf_pool size %lu\n"
+		"buf_pool instance %lu size %lu\n"
 		"database pages %lu\n"
 		"free pages %lu\n"
 		"modified database pages %lu\n"
 		"n pending reads %lu\n"
 		"n pending flush LRU %lu list %lu single page %lu\n"
 		"pages read %lu, created %lu, written %lu\n",
+		(ulong) (buf_pool - buf_pool_ptr),
 		(ulong) size,
 		(ulong) UT_LIST_GET_LEN(buf_pool->LRU),
 		(ulong) UT_LIST_GET_LEN(buf_pool->free),
@@ -2348,6 +2507,22 @@ buf_print(void)
 
 	mem_free(index_ids);
 	mem_free(counts);
+}
+
+/*************************************************************************
+Prints info of the buffer buf_pool data structure. */
+
+void
+buf_print(void)
+/*===========*/
+{
+	ulint	i;
+
+	ut_ad(buf_pool_ptr);
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_print_instance(buf_pool_from_array(i));
+	}
 
 	ut_a(buf_validate());
 }
@@ -2358,28 +2533,35 @@ Returns the number of latched pages in the buffer pool. */
 ulint
 buf_get_latched_pages_number(void)
 {
+	buf_pool_t*	buf_pool;
 	buf_block_t*	block;
 	ulint		i;
+	ulint		j;
 	ulint		fixed_pages_number = 0;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (j = 0; j < srv_buf_pool_instances; j++) {
+		buf_pool = buf_pool_from_array(j);
 
-	for (i = 0; i < buf_pool->curr_size; i++) {
+		mutex_enter(&(buf_pool->mutex));
 
-		block = buf_pool_get_nth_block(buf_pool, i);
+		for (i = 0; i < buf_pool->curr_size; i++) {
 
-		if (block->magic_n == BUF_BLOCK_MAGIC_N) {
-			mutex_enter(&block->mutex);
+			block = buf_pool_get_nth_block(buf_pool, i);
 
-			if (block->buf_fix_count != 0 || block->io_fix != 0) {
-				fixed_pages_number++;
-			}
+			if (block->magic_n == BUF_BLOCK_MAGIC_N) {
+				mutex_enter(&block->mutex);
 
-			mutex_exit(&block->mutex);
+				if (block->buf_fix_count != 0
+				    || block->io_fix != 0) {
+					fixed_pages_number++;
+				}
+
+				mutex_exit(&block->mutex);
+			}
 		}
-	}
 
-	mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(buf_pool->mutex));
+	}
 
 	return(fixed_pages_number);
 }
@@ -2392,10 +2574,20 @@ ulint
 buf_get_n_pending_ios(void)
 /*=======================*/
 {
-	return(buf_pool->n_pend_reads
-	       + buf_pool->n_flush[BUF_FLUSH_LRU]
-	       + buf_pool->n_flush[BUF_FLUSH_LIST]
-	       + buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE]);
+	buf_pool_t*	buf_pool;
+	ulint		n_ios	= 0;
+	ulint		i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+
+		n_ios += buf_pool->n_pend_reads
+			+ buf_pool->n_flush[BUF_FLUSH_LRU]
+			+ buf_pool->n_flush[BUF_FLUSH_LIST]
+			+ buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE];
+	}
+
+	return(n_ios);
 }
 
 /*************************************************************************
@@ -2406,34 +2598,74 @@ ulint
 buf_get_modified_ratio_pct(void)
 /*============================*/
 {
-	ulint	ratio;
+	buf_pool_t*	buf_pool;
+	ulint		n_modified	= 0;
+	ulint		n_pages		= 0;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
 
-	ratio = (100 * UT_LIST_GET_LEN(buf_pool->flush_list))
-		/ (1 + UT_LIST_GET_LEN(buf_pool->LRU)
-		   + UT_LIST_GET_LEN(buf_pool->free));
+		mutex_enter(&(buf_pool->mutex));
 
-	/* 1 + is there to avoid division by zero */
+		n_modified += UT_LIST_GET_LEN(buf_pool->flush_list);
+		n_pages += UT_LIST_GET_LEN(buf_pool->LRU)
+			+ UT_LIST_GET_LEN(buf_pool->free);
 
-	mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(buf_pool->mutex));
+	}
+
+	/* 1 + is there to avoid division by zero */
 
-	return(ratio);
+	return((100 * n_modified) / (1 + n_pages));
 }
 
 /*************************************************************************
-Prints info of the buffer i/o. */
+Gets the sums of the statistics counters and list lengths of all the buffer
+pool instances. The values are read without holding the buffer pool
+mutexes. */
 
 void
-buf_print_io(
-/*=========*/
-	FILE*	file)	/* in/out: buffer where to print */
+buf_get_total_stat(
+/*===============*/
+	buf_pool_stat_t*	tot_stat)	/* out: sums over all
+						instances */
+{
+	buf_pool_t*	buf_pool;
+	ulint		i;
+
+	memset(tot_stat, 0, sizeof(*tot_stat));
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+
+		tot_stat->n_page_gets += buf_pool->n_page_gets;
+		tot_stat->n_pages_read += buf_pool->n_pages_read;
+		tot_stat->n_pages_written += buf_pool->n_pages_written;
+		tot_stat->n_pages_created += buf_pool->n_pages_created;
+		tot_stat->n_pend_reads += buf_pool->n_pend_reads;
+		tot_stat->LRU_len += UT_LIST_GET_LEN(buf_pool->LRU);
+		tot_stat->free_len += UT_LIST_GET_LEN(buf_pool->free);
+		tot_stat->flush_list_len
+			+= UT_LIST_GET_LEN(buf_pool->flush_list);
+		tot_stat->curr_size += buf_pool->curr_size;
+		tot_stat->max_size += buf_pool->max_size;
+	}
+}
+
+/*************************************************************************
+Prints info of the i/o of a buffer pool instance. */
+static
+void
+buf_print_io_instance(
+/*==================*/
+	buf_pool_t*	buf_pool,/* in: buffer pool instance */
+	FILE*		file)	/* in/out: buffer where to print */
 {
 	time_t	current_time;
 	double	time_elapsed;
 	ulint	size;
 
-	ut_ad(buf_pool);
 	size = buf_pool->curr_size;
 
 	mutex_enter(&(buf_pool->mutex));
@@ -2513,6 +2745,108 @@ buf_print_io(
 	mutex_exit(&(buf_pool->mutex));
 }
 
+/*************************************************************************
+Prints info of the buffer i/o. With several buffer pool instances the sums
+over the instances are printed first, and then each instance. */
+
+void
+buf_print_io(
+/*=========*/
+	FILE*	file)	/* in/out: buffer where to print */
+{
+	buf_pool_stat_t	tot_stat;
+	buf_pool_t*	buf_pool;
+	ulint		n_pend_flush[BUF_FLUSH_LIST + 1];
+	ulint		n_page_gets_old		= 0;
+	ulint		n_pages_read_old	= 0;
+	ulint		n_pages_created_old	= 0;
+	ulint		n_pages_written_old	= 0;
+	double		time_elapsed;
+	ulint		i;
+
+	ut_ad(buf_pool_ptr);
+
+	if (srv_buf_pool_instances == 1) {
+		buf_print_io_instance(buf_pool_ptr, file);
+
+		return;
+	}
+
+	buf_get_total_stat(&tot_stat);
+
+	n_pend_flush[BUF_FLUSH_LRU] = 0;
+	n_pend_flush[BUF_FLUSH_SINGLE_PAGE] = 0;
+	n_pend_flush[BUF_FLUSH_LIST] = 0;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+
+		n_pend_flush[BUF_FLUSH_LRU] += buf_pool->n_flush[BUF_FLUSH_LRU]
+			+ buf_pool->init_flush[BUF_FLUSH_LRU];
+		n_pend_flush[BUF_FLUSH_LIST]
+			+= buf_pool->n_flush[BUF_FLUSH_LIST]
+			+ buf_pool->init_flush[BUF_FLUSH_LIST];
+		n_pend_flush[BUF_FLUSH_SINGLE_PAGE]
+			+= buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE];
+
+		n_page_gets_old += buf_pool->n_page_gets_old;
+		n_pages_read_old += buf_pool->n_pages_read_old;
+		n_pages_created_old += buf_pool->n_pages_created_old;
+		n_pages_written_old += buf_pool->n_pages_written_old;
+	}
+
+	time_elapsed = 0.001 + difftime(time(NULL),
+					buf_pool_ptr->last_printout_time);
+
+	fprintf(file,
+		"Buffer pool size   %lu\n"
+		"Free buffers       %lu\n"
+		"Database pages     %lu\n"
+		"Modified db pages  %lu\n"
+		"Pending reads %lu\n"
+		"Pending writes: LRU %lu, flush list %lu, single page %lu\n"
+		"Pages read %lu, created %lu, written %lu\n"
+		"%.2f reads/s, %.2f creates/s, %.2f writes/s\n",
+		(ulong) tot_stat.curr_size,
+		(ulong) tot_stat.free_len,
+		(ulong) tot_stat.LRU_len,
+		(ulong) tot_stat.flush_list_len,
+		(ulong) tot_stat.n_pend_reads,
+		(ulong) n_pend_flush[BUF_FLUSH_LRU],
+		(ulong) n_pend_flush[BUF_FLUSH_LIST],
+		(ulong) n_pend_flush[BUF_FLUSH_SINGLE_PAGE],
+		(ulong) tot_stat.n_pages_read,
+		(ulong) tot_stat.n_pages_created,
+		(ulong) tot_stat.n_pages_written,
+		(tot_stat.n_pages_read - n_pages_read_old) / time_elapsed,
+		(tot_stat.n_pages_created - n_pages_created_old)
+		/ time_elapsed,
+		(tot_stat.n_pages_written - n_pages_written_old)
+		/ time_elapsed);
+
+	if (tot_stat.n_page_gets > n_page_gets_old) {
+		fprintf(file, "Buffer pool hit rate %lu / 1000\n",
+			(ulong)
+			(1000 - ((1000 * (tot_stat.n_pages_read
+					  - n_pages_read_old))
+				 / (tot_stat.n_page_gets
+				    - n_page_gets_old))));
+	} else {
+		fputs("No buffer pool page gets since the last printout\n",
+		      file);
+	}
+
+	fputs("----------------------\n"
+	      "INDIVIDUAL BUFFER POOL INFO\n"
+	      "----------------------\n", file);
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		fprintf(file, "---BUFFER POOL %lu\n", (ulong) i);
+
+		buf_print_io_instance(buf_pool_from_array(i), file);
+	}
+}
+
 /**************************************************************************
 Refreshes the statistics used to print per-second averages. */
 
@@ -2520,12 +2854,20 @@ void
 buf_refresh_io_stats(void)
 /*======================*/
 {
-	buf_pool->last_printout_time = time(NULL);
-	buf_pool->n_page_gets_old = buf_pool->n_page_gets;
-	buf_pool->n_pages_read_old = buf_pool->n_pages_read;
-	buf_pool->n_pages_created_old = buf_pool->n_pages_created;
-	buf_pool->n_pages_written_old = buf_pool->n_pages_written;
-	buf_pool->n_pages_awe_remapped_old = buf_pool->n_pages_awe_remapped;
+	buf_pool_t*	buf_pool;
+	ulint		i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+
+		buf_pool->last_printout_time = time(NULL);
+		buf_pool->n_page_gets_old = buf_pool->n_page_gets;
+		buf_pool->n_pages_read_old = buf_pool->n_pages_read;
+		buf_pool->n_pages_created_old = buf_pool->n_pages_created;
+		buf_pool->n_pages_written_old = buf_pool->n_pages_written;
+		buf_pool->n_pages_awe_remapped_old
+			= buf_pool->n_pages_awe_remapped;
+	}
 }
 
 /*************************************************************************
@@ -2535,22 +2877,26 @@ ibool
 buf_all_freed(void)
 /*===============*/
 {
+	buf_pool_t*	buf_pool;
 	buf_block_t*	block;
 	ulint		i;
+	ulint		j;
 
-	ut_ad(buf_pool);
+	ut_ad(buf_pool_ptr);
 
-	mutex_enter(&(buf_pool->mutex));
+	for (j = 0; j < srv_buf_pool_instances; j++) {
+		buf_pool = buf_pool_from_array(j);
 
-	for (i = 0; i < buf_pool->curr_size; i++) {
+		mutex_enter(&(buf_pool->mutex));
 
-		block = buf_pool_get_nth_block(buf_pool, i);
+		for (i = 0; i < buf_pool->curr_size; i++) {
 
-		mutex_enter(&block->mutex);
+			block = buf_pool_get_nth_block(buf_pool, i);
 
-		if (block->state == BUF_BLOCK_FILE_PAGE) {
+			mutex_enter(&block->mutex);
 
-			if (!buf_flush_ready_for_replace(block)) {
+			if (block->state == BUF_BLOCK_FILE_PAGE
+			    && !buf_flush_ready_for_replace(block)) {
 
 				fprintf(stderr,
 					"Page %lu %lu still fixed or dirty\n",
@@ -2558,13 +2904,13 @@ buf_all_freed(void)
 					(ulong) block->offset);
 				ut_error;
 			}
+
+			mutex_exit(&block->mutex);
 		}
 
-		mutex_exit(&block->mutex);
+		mutex_exit(&(buf_pool->mutex));
 	}
 
-	mutex_exit(&(buf_pool->mutex));
-
 	return(TRUE);
 }
 
@@ -2577,19 +2923,23 @@ buf_pool_check_no_pending_io(void)
 /*==============================*/
 				/* out: TRUE if there is no pending i/o */
 {
-	ibool	ret;
+	buf_pool_t*	buf_pool;
+	ibool		ret	= TRUE;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < srv_buf_pool_instances && ret; i++) {
+		buf_pool = buf_pool_from_array(i);
 
-	if (buf_pool->n_pend_reads + buf_pool->n_flush[BUF_FLUSH_LRU]
-	    + buf_pool->n_flush[BUF_FLUSH_LIST]
-	    + buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE]) {
-		ret = FALSE;
-	} else {
-		ret = TRUE;
-	}
+		mutex_enter(&(buf_pool->mutex));
 
-	mutex_exit(&(buf_pool->mutex));
+		if (buf_pool->n_pend_reads + buf_pool->n_flush[BUF_FLUSH_LRU]
+		    + buf_pool->n_flush[BUF_FLUSH_LIST]
+		    + buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE]) {
+			ret = FALSE;
+		}
+
+		mutex_exit(&(buf_pool->mutex));
+	}
 
 	return(ret);
 }
@@ -2600,14 +2950,22 @@ Gets the current length of the free list of buffer blocks. */
 ulint
 buf_get_free_list_len(void)
 /*=======================*/
+				/* out: sum of the lengths of the free
+				lists of all the instances */
 {
-	ulint	len;
+	buf_pool_t*	buf_pool;
+	ulint		len	= 0;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
 
-	len = UT_LIST_GET_LEN(buf_pool->free);
+		mutex_enter(&(buf_pool->mutex));
 
-	mutex_exit(&(buf_pool->mutex));
+		len += UT_LIST_GET_LEN(buf_pool->free);
+
+		mutex_exit(&(buf_pool->mutex));
+	}
 
 	return(len);
 }
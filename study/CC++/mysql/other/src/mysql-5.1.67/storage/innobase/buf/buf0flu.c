@@ -25,20 +25,29 @@ Created 11/11/1995 Heikki Tuuri
 #include "os0file.h"
 #include "trx0sys.h"
 #include "srv0srv.h"
+#include "srv0start.h"
 
 /* When flushed, dirty blocks are searched in neighborhoods of this size, and
 flushed along with the original page. */
 
-#define BUF_FLUSH_AREA		ut_min(BUF_READ_AHEAD_AREA,\
-		buf_pool->curr_size / 16)
+#define BUF_FLUSH_AREA(b)	ut_min(BUF_READ_AHEAD_AREA(b),\
+		(b)->curr_size / 16)
+
+/* Number of page cleaner threads running; protected by kernel_mutex */
+ulint	buf_flush_n_page_cleaners	= 0;
+
+/* The adaptive flushing aims at keeping the age of the oldest modification
+at this percentage of log_sys->max_modified_age_async */
+#define BUF_FLUSH_ADAPTIVE_TARGET_PCT	75
 
 /**********************************************************************
-Validates the flush list. */
+Validates the flush list of a buffer pool instance. */
 static
 ibool
-buf_flush_validate_low(void);
-/*========================*/
-		/* out: TRUE if ok */
+buf_flush_validate_low(
+/*===================*/
+				/* out: TRUE if ok */
+	buf_pool_t*	buf_pool);/* in: buffer pool instance */
 
 /************************************************************************
 Inserts a modified block into the flush list. */
@@ -48,6 +57,8 @@ buf_flush_insert_into_flush_list(
 /*=============================*/
 	buf_block_t*	block)	/* in: block which is modified */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
@@ -59,7 +70,7 @@ buf_flush_insert_into_flush_list(
 
 	UT_LIST_ADD_FIRST(flush_list, buf_pool->flush_list, block);
 
-	ut_ad(buf_flush_validate_low());
+	ut_ad(buf_flush_validate_low(buf_pool));
 }
 
 /************************************************************************
@@ -72,6 +83,7 @@ buf_flush_insert_sorted_into_flush_list(
 /*====================================*/
 	buf_block_t*	block)	/* in: block which is modified */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
 	buf_block_t*	prev_b;
 	buf_block_t*	b;
 
@@ -94,7 +106,7 @@ buf_flush_insert_sorted_into_flush_list(
 				     block);
 	}
 
-	ut_ad(buf_flush_validate_low());
+	ut_ad(buf_flush_validate_low(buf_pool));
 }
 
 /************************************************************************
@@ -108,7 +120,7 @@ buf_flush_ready_for_replace(
 	buf_block_t*	block)	/* in: buffer control block, must be in state
 				BUF_BLOCK_FILE_PAGE and in the LRU list */
 {
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(buf_pool_from_block(block)->mutex)));
 	ut_ad(mutex_own(&block->mutex));
 	if (block->state != BUF_BLOCK_FILE_PAGE) {
 		ut_print_timestamp(stderr);
@@ -142,7 +154,7 @@ buf_flush_ready_for_flush(
 				BUF_BLOCK_FILE_PAGE */
 	ulint		flush_type)/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 {
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(buf_pool_from_block(block)->mutex)));
 	ut_ad(mutex_own(&(block->mutex)));
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
@@ -173,7 +185,8 @@ buf_flush_write_complete(
 /*=====================*/
 	buf_block_t*	block)	/* in: pointer to the block in question */
 {
-	ut_ad(block);
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
@@ -457,6 +470,8 @@ buf_flush_init_for_writing(
 	ulint	space,		/* in: space id */
 	ulint	page_no)	/* in: page number */
 {
+	ulint	checksum;
+
 	/* Write the newest modification lsn to the page header and trailer */
 	mach_write_to_8(page + FIL_PAGE_LSN, newest_lsn);
 
@@ -467,12 +482,33 @@ buf_flush_init_for_writing(
 	mach_write_to_4(page + FIL_PAGE_OFFSET, page_no);
 	mach_write_to_4(page + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID, space);
 
+	if (!srv_use_checksums
+	    || srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_NONE) {
+
+		mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM,
+				BUF_NO_CHECKSUM_MAGIC);
+		mach_write_to_4(page + UNIV_PAGE_SIZE
+				- FIL_PAGE_END_LSN_OLD_CHKSUM,
+				BUF_NO_CHECKSUM_MAGIC);
+		return;
+	}
+
+	if (srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_CRC32) {
+		/* The CRC-32C does not cover the checksum fields: store
+		it to both of them */
+
+		checksum = buf_calc_page_crc32(page);
+
+		mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM, checksum);
+		mach_write_to_4(page + UNIV_PAGE_SIZE
+				- FIL_PAGE_END_LSN_OLD_CHKSUM, checksum);
+		return;
+	}
+
 	/* Store the new formula checksum */
 
 	mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM,
-			srv_use_checksums
-			? buf_calc_page_new_checksum(page)
-			: BUF_NO_CHECKSUM_MAGIC);
+			buf_calc_page_new_checksum(page));
 
 	/* We overwrite the first 4 bytes of the end lsn field to store
 	the old formula checksum. Since it depends also on the field
@@ -480,9 +516,7 @@ buf_flush_init_for_writing(
 	new formula checksum. */
 
 	mach_write_to_4(page + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM,
-			srv_use_checksums
-			? buf_calc_page_old_checksum(page)
-			: BUF_NO_CHECKSUM_MAGIC);
+			buf_calc_page_old_checksum(page));
 }
 
 /************************************************************************
@@ -543,6 +577,7 @@ buf_flush_try_page(
 	ulint	flush_type)	/* in: BUF_FLUSH_LRU, BUF_FLUSH_LIST, or
 				BUF_FLUSH_SINGLE_PAGE */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	buf_block_t*	block;
 	ibool		locked;
 
@@ -551,7 +586,7 @@ buf_flush_try_page(
 
 	mutex_enter(&(buf_pool->mutex));
 
-	block = buf_page_hash_get(space, offset);
+	block = buf_page_hash_get(buf_pool, space, offset);
 
 	ut_a(!block || block->state == BUF_BLOCK_FILE_PAGE);
 
@@ -737,6 +772,8 @@ buf_flush_page_try(
 					mutexes released */
 	buf_block_t*	block)		/*!< in/out: buffer control block */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
 	ut_ad(mutex_own(&buf_pool->mutex));
 	ut_ad(block->state == BUF_BLOCK_FILE_PAGE);
 	ut_ad(mutex_own(&block->mutex));
@@ -806,6 +843,7 @@ ulint
 buf_flush_try_neighbors(
 /*====================*/
 				/* out: number of pages flushed */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance of the page */
 	ulint	space,		/* in: space id */
 	ulint	offset,		/* in: page offset */
 	ulint	flush_type)	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
@@ -817,8 +855,9 @@ buf_flush_try_neighbors(
 
 	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 
-	low = (offset / BUF_FLUSH_AREA) * BUF_FLUSH_AREA;
-	high = (offset / BUF_FLUSH_AREA + 1) * BUF_FLUSH_AREA;
+	low = (offset / BUF_FLUSH_AREA(buf_pool)) * BUF_FLUSH_AREA(buf_pool);
+	high = (offset / BUF_FLUSH_AREA(buf_pool) + 1)
+		* BUF_FLUSH_AREA(buf_pool);
 
 	if (UT_LIST_GET_LEN(buf_pool->LRU) < BUF_LRU_OLD_MIN_LEN) {
 		/* If there is little space, it is better not to flush any
@@ -838,7 +877,14 @@ buf_flush_try_neighbors(
 
 	for (i = low; i < high; i++) {
 
-		block = buf_page_hash_get(space, i);
+		if (buf_pool_get(space, i) != buf_pool) {
+			/* The flush area is not a power of 2 and crosses
+			into pages cached in another instance */
+
+			continue;
+		}
+
+		block = buf_page_hash_get(buf_pool, space, i);
 		ut_a(!block || block->state == BUF_BLOCK_FILE_PAGE);
 
 		if (!block) {
@@ -892,7 +938,8 @@ buf_flush_try_neighbors(
 }
 
 /***********************************************************************
-This utility flushes dirty blocks from the end of the LRU list or flush_list.
+This utility flushes dirty blocks from the end of the LRU list or flush_list
+of a buffer pool instance.
 NOTE 1: in the case of an LRU flush the calling thread may own latches to
 pages: to avoid deadlocks, this function must be written so that it cannot
 end up waiting for these latches! NOTE 2: in the case of a flush list flush,
@@ -904,6 +951,7 @@ buf_flush_batch(
 				/* out: number of blocks for which the write
 				request was queued; ULINT_UNDEFINED if there
 				was a flush of the same type already running */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance */
 	ulint	flush_type,	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST; if
 				BUF_FLUSH_LIST, then the caller must not own
 				any latches on pages */
@@ -990,7 +1038,7 @@ buf_flush_batch(
 
 				/* Try to flush also all the neighbors */
 				page_count += buf_flush_try_neighbors(
-					space, offset, flush_type);
+					buf_pool, space, offset, flush_type);
 
 				mutex_enter(&(buf_pool->mutex));
 
@@ -1045,17 +1093,77 @@ buf_flush_batch(
 	return(page_count);
 }
 
+/***********************************************************************
+Flushes dirty blocks from the end of the flush lists of all the buffer pool
+instances. The instances are flushed one after another, each with an equal
+share of min_n. The calling thread is not allowed to own any latches on
+pages! */
+
+ulint
+buf_flush_list(
+/*===========*/
+				/* out: number of blocks for which the write
+				request was queued; ULINT_UNDEFINED if there
+				was a flush list flush already running in
+				some instance, which was then skipped */
+	ulint	min_n,		/* in: wished minimum mumber of blocks flushed
+				(it is not guaranteed that the actual number
+				is that big, though) */
+	dulint	lsn_limit)	/* in: all blocks whose oldest_modification
+				is smaller than this should be flushed (if
+				their number does not exceed min_n) */
+{
+	ulint	n_flushed	= 0;
+	ibool	skipped		= FALSE;
+	ulint	i;
+
+	if (min_n != ULINT_MAX) {
+		/* Round up, so that a small batch is not split into
+		nothing */
+
+		min_n = (min_n + srv_buf_pool_instances - 1)
+			/ srv_buf_pool_instances;
+	}
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		ulint	n;
+
+		n = buf_flush_batch(buf_pool_from_array(i), BUF_FLUSH_LIST,
+				    min_n, lsn_limit);
+
+		if (n == ULINT_UNDEFINED) {
+			skipped = TRUE;
+		} else {
+			n_flushed += n;
+		}
+	}
+
+	return(skipped ? ULINT_UNDEFINED : n_flushed);
+}
+
 /**********************************************************************
 Waits until a flush batch of the given type ends */
 
 void
 buf_flush_wait_batch_end(
 /*=====================*/
-	ulint	type)	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance, or NULL to
+				wait for the batches of all the instances */
+	ulint		type)	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 {
+	ulint	i;
+
 	ut_ad((type == BUF_FLUSH_LRU) || (type == BUF_FLUSH_LIST));
 
-	os_event_wait(buf_pool->no_flush[type]);
+	if (buf_pool != NULL) {
+		os_event_wait(buf_pool->no_flush[type]);
+
+		return;
+	}
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		os_event_wait(buf_pool_from_array(i)->no_flush[type]);
+	}
 }
 
 /**********************************************************************
@@ -1064,10 +1172,13 @@ a big enough margin of replaceable blocks near the end of the LRU list
 and in the free list. */
 static
 ulint
-buf_flush_LRU_recommendation(void)
-/*==============================*/
-			/* out: number of blocks which should be flushed
-			from the end of the LRU list */
+buf_flush_LRU_recommendation(
+/*=========================*/
+				/* out: number of blocks which should be
+				flushed from the end of the LRU list */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance */
+	ulint		margin)	/* in: a flush is recommended if there are
+				fewer replaceable blocks than this */
 {
 	buf_block_t*	block;
 	ulint		n_replaceable;
@@ -1080,9 +1191,9 @@ buf_flush_LRU_recommendation(void)
 	block = UT_LIST_GET_LAST(buf_pool->LRU);
 
 	while ((block != NULL)
-	       && (n_replaceable < BUF_FLUSH_FREE_BLOCK_MARGIN
-		   + BUF_FLUSH_EXTRA_MARGIN)
-	       && (distance < BUF_LRU_FREE_SEARCH_LEN)) {
+	       && (n_replaceable < BUF_FLUSH_FREE_BLOCK_MARGIN(buf_pool)
+		   + BUF_FLUSH_EXTRA_MARGIN(buf_pool))
+	       && (distance < BUF_LRU_FREE_SEARCH_LEN(buf_pool))) {
 
 		mutex_enter(&block->mutex);
 
@@ -1099,50 +1210,353 @@ buf_flush_LRU_recommendation(void)
 
 	mutex_exit(&(buf_pool->mutex));
 
-	if (n_replaceable >= BUF_FLUSH_FREE_BLOCK_MARGIN) {
+	if (n_replaceable >= margin) {
 
 		return(0);
 	}
 
-	return(BUF_FLUSH_FREE_BLOCK_MARGIN + BUF_FLUSH_EXTRA_MARGIN
+	return(BUF_FLUSH_FREE_BLOCK_MARGIN(buf_pool)
+	       + BUF_FLUSH_EXTRA_MARGIN(buf_pool)
 	       - n_replaceable);
 }
 
 /*************************************************************************
-Flushes pages from the end of the LRU list if there is too small a margin
-of replaceable pages there or in the free list. VERY IMPORTANT: this function
-is called also by threads which have locks on pages. To avoid deadlocks, we
-flush only pages such that the s-lock required for flushing can be acquired
-immediately, without waiting. */
+Flushes pages from the end of the LRU list of a buffer pool instance if there
+is too small a margin of replaceable pages there or in the free list. VERY
+IMPORTANT: this function is called also by threads which have locks on pages.
+To avoid deadlocks, we flush only pages such that the s-lock required for
+flushing can be acquired immediately, without waiting. */
 
 void
-buf_flush_free_margin(void)
-/*=======================*/
+buf_flush_free_margin(
+/*==================*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
 {
 	ulint	n_to_flush;
 	ulint	n_flushed;
 
-	n_to_flush = buf_flush_LRU_recommendation();
+	n_to_flush = buf_flush_LRU_recommendation(
+		buf_pool, BUF_FLUSH_FREE_BLOCK_MARGIN(buf_pool));
 
 	if (n_to_flush > 0) {
-		n_flushed = buf_flush_batch(BUF_FLUSH_LRU, n_to_flush,
-					    ut_dulint_zero);
+		n_flushed = buf_flush_batch(buf_pool, BUF_FLUSH_LRU,
+					    n_to_flush, ut_dulint_zero);
 		if (n_flushed == ULINT_UNDEFINED) {
 			/* There was an LRU type flush batch already running;
 			let us wait for it to end */
 
-			buf_flush_wait_batch_end(BUF_FLUSH_LRU);
+			buf_flush_wait_batch_end(buf_pool, BUF_FLUSH_LRU);
+		}
+	}
+}
+
+/*************************************************************************
+Flushes pages from the end of the LRU lists of all the buffer pool instances
+where the margin of replaceable pages is too small. */
+
+void
+buf_flush_free_margins(void)
+/*========================*/
+{
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_flush_free_margin(buf_pool_from_array(i));
+	}
+}
+
+/*************************************************************************
+Asks the page cleaners to flush the blocks whose oldest modification is
+below lsn_limit. This is called by a thread which finds the checkpoint age
+past the asynchronous preflush limit, so that it does not have to do the
+flush itself. */
+
+void
+buf_flush_request_page_cleaners(
+/*============================*/
+	dulint	lsn_limit)	/* in: the blocks whose oldest_modification
+				is smaller than this should be flushed */
+{
+	buf_pool_t*	buf_pool;
+	ulint		i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+
+		mutex_enter(&(buf_pool->mutex));
+
+		if (ut_dulint_cmp(lsn_limit, buf_pool->page_cleaner_lsn) > 0) {
+			buf_pool->page_cleaner_lsn = lsn_limit;
+		}
+
+		mutex_exit(&(buf_pool->mutex));
+	}
+
+	srv_page_cleaner_requests++;
+}
+
+/*************************************************************************
+Sleeps about a second, or less if a flush is requested from the page
+cleaner of a buffer pool instance or the server is shutting down. */
+static
+void
+buf_flush_page_cleaner_sleep(
+/*=========================*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
+{
+	ulint	i;
+
+	for (i = 0; i < 10; i++) {
+		os_thread_sleep(100000);
+
+		/* A dirty read is enough here: a request which we miss
+		is noticed at the latest on the next round */
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_CLEANUP
+		    || !ut_dulint_is_zero(buf_pool->page_cleaner_lsn)) {
+
+			return;
 		}
 	}
 }
 
+/*************************************************************************
+Flushes pages from the flush list of a buffer pool instance and adds the
+number of pages to the page cleaner statistics. */
+static
+void
+buf_flush_page_cleaner_flush_list(
+/*==============================*/
+	buf_pool_t*	buf_pool,	/* in: buffer pool instance */
+	ulint		min_n,		/* in: wished minimum number of blocks
+					flushed in all the instances */
+	dulint		lsn_limit)	/* in: the blocks whose
+					oldest_modification is smaller than
+					this should be flushed */
+{
+	ulint	n_flushed;
+
+	if (min_n != ULINT_MAX) {
+		min_n = (min_n + srv_buf_pool_instances - 1)
+			/ srv_buf_pool_instances;
+	}
+
+	n_flushed = buf_flush_batch(buf_pool, BUF_FLUSH_LIST, min_n,
+				    lsn_limit);
+
+	if (n_flushed != ULINT_UNDEFINED) {
+		srv_page_cleaner_list_flushed += n_flushed;
+	}
+}
+
+/*************************************************************************
+Computes how much the adaptive flushing should advance the oldest
+modification in the buffer pool in a round of the page cleaners. Below the
+low water mark it does nothing; at BUF_FLUSH_ADAPTIVE_TARGET_PCT of the
+asynchronous preflush limit it keeps pace with the redo log generation,
+and above that it flushes faster, in proportion to the age. */
+static
+ulint
+buf_flush_adaptive_advance(
+/*=======================*/
+				/* out: lsn advance in bytes, 0 if no
+				flush is needed */
+	ulint	age,		/* in: age of the oldest modification */
+	ulint	redo_rate)	/* in: redo generated per second */
+{
+	ulint	lwm;
+	ulint	target;
+
+	if (!srv_adaptive_flushing) {
+
+		return(0);
+	}
+
+	lwm = log_sys->max_modified_age_async / 100
+		* srv_adaptive_flushing_lwm;
+	target = log_sys->max_modified_age_async / 100
+		* BUF_FLUSH_ADAPTIVE_TARGET_PCT;
+
+	if (age <= lwm || target <= lwm) {
+
+		return(0);
+	}
+
+	return((ulint) ((double) redo_rate * (age - lwm) / (target - lwm)));
+}
+
+/*************************************************************************
+The page cleaner thread of a buffer pool instance. Once a second, or when
+a user thread requests it, it flushes the end of the LRU list to keep a
+margin of replaceable blocks there, and the flush list to keep the number
+of modified pages under srv_max_buf_pool_modified_pct and the checkpoint
+age under the asynchronous preflush limit. This replaces the flushing
+which was done in the master thread and in user threads. The flush list
+batches follow the redo generation rate, see buf_flush_adaptive_advance(),
+and are limited by srv_io_capacity and srv_io_capacity_max. */
+
+os_thread_ret_t
+buf_flush_page_cleaner_thread(
+/*==========================*/
+			/* out: a dummy parameter */
+	void*	arg)	/* in: pointer to the index of the buffer pool
+			instance, an ulint */
+{
+	buf_pool_t*	buf_pool	= buf_pool_from_array(*(ulint*) arg);
+	ulint		n_rounds	= 0;
+	ulint		n_to_flush;
+	ulint		n_flushed;
+	dulint		lsn_limit;
+	dulint		lsn;
+	dulint		oldest_lsn;
+	dulint		last_lsn;
+	ulint		last_sec;
+	ulint		last_usec;
+	ulint		sec;
+	ulint		usec;
+	double		elapsed;
+	ulint		redo_rate	= 0;
+	ulint		advance;
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "Page cleaner thread starts, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif
+	mutex_enter(&kernel_mutex);
+	buf_flush_n_page_cleaners++;
+	mutex_exit(&kernel_mutex);
+
+	last_lsn = log_get_lsn();
+	ut_usectime(&last_sec, &last_usec);
+
+	while (srv_shutdown_state < SRV_SHUTDOWN_CLEANUP) {
+
+		buf_flush_page_cleaner_sleep(buf_pool);
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_CLEANUP) {
+
+			break;
+		}
+
+		n_rounds++;
+
+		/* Keep a bigger margin of replaceable blocks than the one
+		at which the user threads start flushing themselves */
+
+		n_to_flush = buf_flush_LRU_recommendation(
+			buf_pool, BUF_FLUSH_FREE_BLOCK_MARGIN(buf_pool)
+			+ BUF_FLUSH_EXTRA_MARGIN(buf_pool));
+
+		if (n_to_flush > 0) {
+			n_flushed = buf_flush_batch(buf_pool, BUF_FLUSH_LRU,
+						    n_to_flush,
+						    ut_dulint_zero);
+
+			if (n_flushed != ULINT_UNDEFINED) {
+				srv_page_cleaner_lru_flushed += n_flushed;
+			}
+		}
+
+		mutex_enter(&(buf_pool->mutex));
+
+		lsn_limit = buf_pool->page_cleaner_lsn;
+		buf_pool->page_cleaner_lsn = ut_dulint_zero;
+
+		mutex_exit(&(buf_pool->mutex));
+
+		if (!ut_dulint_is_zero(lsn_limit)) {
+			/* Make the checkpoint age smaller as requested */
+
+			buf_flush_page_cleaner_flush_list(buf_pool, ULINT_MAX,
+							  lsn_limit);
+		}
+
+		/* Estimate the redo generation rate, smoothed over the
+		rounds. Read the oldest modification before the lsn: it
+		cannot be newer than an lsn read after it. */
+
+		oldest_lsn = buf_pool_get_oldest_modification();
+		lsn = log_get_lsn();
+		ut_usectime(&sec, &usec);
+
+		elapsed = ((double) sec - (double) last_sec)
+			+ ((double) usec - (double) last_usec) / 1000000.0;
+
+		if (elapsed > 0.0) {
+			redo_rate = (ulint) ((redo_rate
+					      + ut_dulint_minus(lsn, last_lsn)
+					      / elapsed) / 2);
+			srv_redo_rate = redo_rate;
+		}
+
+		last_lsn = lsn;
+		last_sec = sec;
+		last_usec = usec;
+
+		advance = 0;
+
+		if (!ut_dulint_is_zero(oldest_lsn)) {
+			advance = buf_flush_adaptive_advance(
+				ut_dulint_minus(lsn, oldest_lsn), redo_rate);
+		}
+
+		if (advance > 0) {
+			n_flushed = buf_flush_batch(
+				buf_pool, BUF_FLUSH_LIST,
+				ut_max(srv_io_capacity, srv_io_capacity_max)
+				/ srv_buf_pool_instances + 1,
+				ut_dulint_add(oldest_lsn, advance));
+
+			if (n_flushed != ULINT_UNDEFINED) {
+				srv_page_cleaner_list_flushed += n_flushed;
+				srv_adaptive_flushed += n_flushed;
+			}
+		}
+
+		if (buf_get_modified_ratio_pct()
+		    > srv_max_buf_pool_modified_pct) {
+
+			/* Try to keep the number of modified pages in the
+			buffer pool under the limit wished by the user */
+
+			buf_flush_page_cleaner_flush_list(
+				buf_pool, SRV_PCT_IO(100), ut_dulint_max);
+
+		} else if (advance == 0 && n_rounds % 10 == 0) {
+
+			/* Flush a few oldest pages about once in 10 seconds
+			to make a new checkpoint younger; if there are lots
+			of modified pages (> 70 %), we assume we can afford
+			the full i/o capacity */
+
+			buf_flush_page_cleaner_flush_list(
+				buf_pool,
+				buf_get_modified_ratio_pct() > 70
+				? SRV_PCT_IO(100) : SRV_PCT_IO(10),
+				ut_dulint_max);
+		}
+	}
+
+	mutex_enter(&kernel_mutex);
+	buf_flush_n_page_cleaners--;
+	mutex_exit(&kernel_mutex);
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /**********************************************************************
-Validates the flush list. */
+Validates the flush list of a buffer pool instance. */
 static
 ibool
-buf_flush_validate_low(void)
-/*========================*/
-		/* out: TRUE if ok */
+buf_flush_validate_low(
+/*===================*/
+				/* out: TRUE if ok */
+	buf_pool_t*	buf_pool)/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	dulint		om;
@@ -1168,20 +1582,26 @@ buf_flush_validate_low(void)
 }
 
 /**********************************************************************
-Validates the flush list. */
+Validates the flush lists. */
 
 ibool
 buf_flush_validate(void)
 /*====================*/
 		/* out: TRUE if ok */
 {
-	ibool	ret;
+	buf_pool_t*	buf_pool;
+	ibool		ret	= TRUE;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < srv_buf_pool_instances && ret; i++) {
+		buf_pool = buf_pool_from_array(i);
 
-	ret = buf_flush_validate_low();
+		mutex_enter(&(buf_pool->mutex));
 
-	mutex_exit(&(buf_pool->mutex));
+		ret = buf_flush_validate_low(buf_pool);
+
+		mutex_exit(&(buf_pool->mutex));
+	}
 
 	return(ret);
 }
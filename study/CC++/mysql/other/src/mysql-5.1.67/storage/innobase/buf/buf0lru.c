@@ -100,7 +100,8 @@ static
 void
 buf_LRU_drop_page_hash_for_tablespace(
 /*==================================*/
-	ulint	id)	/* in: space id */
+	buf_pool_t*	buf_pool,	/* in: buffer pool instance */
+	ulint		id)		/* in: space id */
 {
 	buf_block_t*	block;
 	ulint*		page_arr;
@@ -185,13 +186,14 @@ next_page:
 }
 
 /**********************************************************************
-Invalidates all pages belonging to a given tablespace when we are deleting
-the data file(s) of that tablespace. */
-
+Invalidates all pages belonging to a given tablespace in a buffer pool
+instance. */
+static
 void
-buf_LRU_invalidate_tablespace(
-/*==========================*/
-	ulint	id)	/* in: space id */
+buf_LRU_invalidate_tablespace_instance(
+/*===================================*/
+	buf_pool_t*	buf_pool,	/* in: buffer pool instance */
+	ulint		id)		/* in: space id */
 {
 	buf_block_t*	block;
 	ulint		page_no;
@@ -203,7 +205,7 @@ buf_LRU_invalidate_tablespace(
 	attempt and does not guarantee that all pages hash entries
 	will be dropped. We get rid of remaining page hash entries
 	one by one below. */
-	buf_LRU_drop_page_hash_for_tablespace(id);
+	buf_LRU_drop_page_hash_for_tablespace(buf_pool, id);
 
 scan_again:
 	mutex_enter(&(buf_pool->mutex));
@@ -285,15 +287,34 @@ next_page:
 	}
 }
 
+/**********************************************************************
+Invalidates all pages belonging to a given tablespace when we are deleting
+the data file(s) of that tablespace. */
+
+void
+buf_LRU_invalidate_tablespace(
+/*==========================*/
+	ulint	id)	/* in: space id */
+{
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_LRU_invalidate_tablespace_instance(
+			buf_pool_from_array(i), id);
+	}
+}
+
 /**********************************************************************
 Gets the minimum LRU_position field for the blocks in an initial segment
 (determined by BUF_LRU_INITIAL_RATIO) of the LRU list. The limit is not
 guaranteed to be precise, because the ulint_clock may wrap around. */
 
 ulint
-buf_LRU_get_recent_limit(void)
-/*==========================*/
-			/* out: the limit; zero if could not determine it */
+buf_LRU_get_recent_limit(
+/*=====================*/
+				/* out: the limit; zero if could not
+				determine it */
+	buf_pool_t*	buf_pool)/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	ulint		len;
@@ -329,6 +350,10 @@ buf_LRU_free_block(
 				/* out: TRUE if freed */
 	buf_block_t*	block)	/* in/out: block to be freed */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
+	ut_ad(mutex_own(&(buf_pool->mutex)));
+
 	if (!buf_flush_ready_for_replace(block)) {
 		return(FALSE);
 	}
@@ -382,6 +407,7 @@ ibool
 buf_LRU_search_and_free_block(
 /*==========================*/
 				/* out: TRUE if freed */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance */
 	ulint	n_iterations)	/* in: how many times this has been called
 				repeatedly without result: a high value means
 				that we should search farther; if value is
@@ -443,16 +469,29 @@ operations need new buffer blocks, and the i/o work done in flushing would be
 wasted. */
 
 void
-buf_LRU_try_free_flushed_blocks(void)
-/*=================================*/
+buf_LRU_try_free_flushed_blocks(
+/*============================*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance, or NULL
+					for all the instances */
 {
+	ulint	i;
+
+	if (buf_pool == NULL) {
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+			buf_LRU_try_free_flushed_blocks(
+				buf_pool_from_array(i));
+		}
+
+		return;
+	}
+
 	mutex_enter(&(buf_pool->mutex));
 
 	while (buf_pool->LRU_flush_ended > 0) {
 
 		mutex_exit(&(buf_pool->mutex));
 
-		buf_LRU_search_and_free_block(1);
+		buf_LRU_search_and_free_block(buf_pool, 1);
 
 		mutex_enter(&(buf_pool->mutex));
 	}
@@ -471,32 +510,38 @@ buf_LRU_buf_pool_running_out(void)
 				/* out: TRUE if less than 25 % of buffer pool
 				left */
 {
-	ibool	ret	= FALSE;
+	buf_pool_t*	buf_pool;
+	ulint		n_avail		= 0;
+	ulint		max_size	= 0;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
 
-	if (!recv_recovery_on && UT_LIST_GET_LEN(buf_pool->free)
-	    + UT_LIST_GET_LEN(buf_pool->LRU) < buf_pool->max_size / 4) {
+		mutex_enter(&(buf_pool->mutex));
 
-		ret = TRUE;
-	}
+		n_avail += UT_LIST_GET_LEN(buf_pool->free)
+			+ UT_LIST_GET_LEN(buf_pool->LRU);
+		max_size += buf_pool->max_size;
 
-	mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(buf_pool->mutex));
+	}
 
-	return(ret);
+	return(!recv_recovery_on && n_avail < max_size / 4);
 }
 
 /**********************************************************************
-Returns a free block from buf_pool. The block is taken off the free list.
-If it is empty, blocks are moved from the end of the LRU list to the free
-list. */
+Returns a free block from a buffer pool instance. The block is taken off the
+free list. If it is empty, blocks are moved from the end of the LRU list to
+the free list. */
 
 buf_block_t*
-buf_LRU_get_free_block(void)
-/*========================*/
+buf_LRU_get_free_block(
+/*===================*/
 				/* out: the free control block; also if AWE is
 				used, it is guaranteed that the block has its
 				page mapped to a frame when we return */
+	buf_pool_t*	buf_pool)/* in: buffer pool instance */
 {
 	buf_block_t*	block		= NULL;
 	ibool		freed;
@@ -615,7 +660,7 @@ loop:
 
 	mutex_exit(&(buf_pool->mutex));
 
-	freed = buf_LRU_search_and_free_block(n_iterations);
+	freed = buf_LRU_search_and_free_block(buf_pool, n_iterations);
 
 	if (freed > 0) {
 		goto loop;
@@ -657,7 +702,7 @@ loop:
 
 	/* No free block was found: try to flush the LRU list */
 
-	buf_flush_free_margin();
+	buf_flush_free_margin(buf_pool);
 	++srv_buf_pool_wait_free;
 
 	os_aio_simulated_wake_handler_threads();
@@ -671,7 +716,7 @@ loop:
 
 		mutex_exit(&(buf_pool->mutex));
 
-		buf_LRU_try_free_flushed_blocks();
+		buf_LRU_try_free_flushed_blocks(buf_pool);
 	} else {
 		mutex_exit(&(buf_pool->mutex));
 	}
@@ -691,8 +736,9 @@ Moves the LRU_old pointer so that the length of the old blocks list
 is inside the allowed limits. */
 UNIV_INLINE
 void
-buf_LRU_old_adjust_len(void)
-/*========================*/
+buf_LRU_old_adjust_len(
+/*===================*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
 {
 	ulint	old_len;
 	ulint	new_len;
@@ -735,8 +781,9 @@ Initializes the old blocks pointer in the LRU list. This function should be
 called when the LRU list grows to BUF_LRU_OLD_MIN_LEN length. */
 static
 void
-buf_LRU_old_init(void)
-/*==================*/
+buf_LRU_old_init(
+/*=============*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 
@@ -759,7 +806,7 @@ buf_LRU_old_init(void)
 	buf_pool->LRU_old = UT_LIST_GET_FIRST(buf_pool->LRU);
 	buf_pool->LRU_old_len = UT_LIST_GET_LEN(buf_pool->LRU);
 
-	buf_LRU_old_adjust_len();
+	buf_LRU_old_adjust_len(buf_pool);
 }
 
 /**********************************************************************
@@ -770,8 +817,8 @@ buf_LRU_remove_block(
 /*=================*/
 	buf_block_t*	block)	/* in: control block */
 {
-	ut_ad(buf_pool);
-	ut_ad(block);
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
@@ -821,7 +868,7 @@ buf_LRU_remove_block(
 	}
 
 	/* Adjust the length of the old block list if necessary */
-	buf_LRU_old_adjust_len();
+	buf_LRU_old_adjust_len(buf_pool);
 }
 
 /**********************************************************************
@@ -832,10 +879,9 @@ buf_LRU_add_block_to_end_low(
 /*=========================*/
 	buf_block_t*	block)	/* in: control block */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
 	buf_block_t*	last_block;
 
-	ut_ad(buf_pool);
-	ut_ad(block);
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
@@ -847,7 +893,7 @@ buf_LRU_add_block_to_end_low(
 	if (last_block) {
 		block->LRU_position = last_block->LRU_position;
 	} else {
-		block->LRU_position = buf_pool_clock_tic();
+		block->LRU_position = buf_pool_clock_tic(buf_pool);
 	}
 
 	ut_a(!block->in_LRU_list);
@@ -872,14 +918,14 @@ buf_LRU_add_block_to_end_low(
 
 		/* Adjust the length of the old block list if necessary */
 
-		buf_LRU_old_adjust_len();
+		buf_LRU_old_adjust_len(buf_pool);
 
 	} else if (UT_LIST_GET_LEN(buf_pool->LRU) == BUF_LRU_OLD_MIN_LEN) {
 
 		/* The LRU list is now long enough for LRU_old to become
 		defined: init it */
 
-		buf_LRU_old_init();
+		buf_LRU_old_init(buf_pool);
 	}
 }
 
@@ -895,17 +941,16 @@ buf_LRU_add_block_low(
 				LRU list is very short, the block is added to
 				the start, regardless of this parameter */
 {
-	ulint	cl;
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+	ulint		cl;
 
-	ut_ad(buf_pool);
-	ut_ad(block);
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 	ut_a(!block->in_LRU_list);
 
 	block->old = old;
-	cl = buf_pool_clock_tic();
+	cl = buf_pool_clock_tic(buf_pool);
 
 	if (srv_use_awe && block->frame) {
 		/* Add to the list of mapped pages; for simplicity we always
@@ -941,14 +986,14 @@ buf_LRU_add_block_low(
 
 		/* Adjust the length of the old block list if necessary */
 
-		buf_LRU_old_adjust_len();
+		buf_LRU_old_adjust_len(buf_pool);
 
 	} else if (UT_LIST_GET_LEN(buf_pool->LRU) == BUF_LRU_OLD_MIN_LEN) {
 
 		/* The LRU list is now long enough for LRU_old to become
 		defined: init it */
 
-		buf_LRU_old_init();
+		buf_LRU_old_init(buf_pool);
 	}
 }
 
@@ -1000,10 +1045,10 @@ buf_LRU_block_free_non_file_page(
 /*=============================*/
 	buf_block_t*	block)	/* in: block, must not contain a file page */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
 
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 	ut_ad(mutex_own(&block->mutex));
-	ut_ad(block);
 
 	ut_a((block->state == BUF_BLOCK_MEMORY)
 	     || (block->state == BUF_BLOCK_READY_FOR_USE));
@@ -1042,9 +1087,10 @@ buf_LRU_block_remove_hashed_page(
 				be in a state where it can be freed; there
 				may or may not be a hash index to the page */
 {
+	buf_pool_t*	buf_pool = buf_pool_from_block(block);
+
 	ut_ad(mutex_own(&(buf_pool->mutex)));
 	ut_ad(mutex_own(&block->mutex));
-	ut_ad(block);
 
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 	ut_a(block->io_fix == 0);
@@ -1059,22 +1105,24 @@ buf_LRU_block_remove_hashed_page(
 
 	buf_block_modify_clock_inc(block);
 
-	if (block != buf_page_hash_get(block->space, block->offset)) {
+	if (block != buf_page_hash_get(buf_pool, block->space,
+				       block->offset)) {
 		fprintf(stderr,
 			"InnoDB: Error: page %lu %lu not found"
 			" in the hash table\n",
 			(ulong) block->space,
 			(ulong) block->offset);
-		if (buf_page_hash_get(block->space, block->offset)) {
+		if (buf_page_hash_get(buf_pool, block->space,
+				      block->offset)) {
 			fprintf(stderr,
 				"InnoDB: In hash table we find block"
 				" %p of %lu %lu which is not %p\n",
 				(void*) buf_page_hash_get
-				(block->space, block->offset),
+				(buf_pool, block->space, block->offset),
 				(ulong) buf_page_hash_get
-				(block->space, block->offset)->space,
+				(buf_pool, block->space, block->offset)->space,
 				(ulong) buf_page_hash_get
-				(block->space, block->offset)->offset,
+				(buf_pool, block->space, block->offset)->offset,
 				(void*) block);
 		}
 
@@ -1104,7 +1152,7 @@ buf_LRU_block_free_hashed_page(
 	buf_block_t*	block)	/* in: block, must contain a file page and
 				be in a state where it can be freed */
 {
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(buf_pool_from_block(block)->mutex)));
 	ut_ad(mutex_own(&block->mutex));
 
 	ut_a(block->state == BUF_BLOCK_REMOVE_HASH);
@@ -1116,18 +1164,18 @@ buf_LRU_block_free_hashed_page(
 
 #ifdef UNIV_DEBUG
 /**************************************************************************
-Validates the LRU list. */
-
-ibool
-buf_LRU_validate(void)
-/*==================*/
+Validates the LRU list of a buffer pool instance. */
+static
+void
+buf_LRU_validate_instance(
+/*======================*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	ulint		old_len;
 	ulint		new_len;
 	ulint		LRU_pos;
 
-	ut_ad(buf_pool);
 	mutex_enter(&(buf_pool->mutex));
 
 	if (UT_LIST_GET_LEN(buf_pool->LRU) >= BUF_LRU_OLD_MIN_LEN) {
@@ -1184,24 +1232,40 @@ buf_LRU_validate(void)
 	}
 
 	mutex_exit(&(buf_pool->mutex));
-	return(TRUE);
 }
 
 /**************************************************************************
-Prints the LRU list. */
+Validates the LRU lists. */
+
+ibool
+buf_LRU_validate(void)
+/*==================*/
+{
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_LRU_validate_instance(buf_pool_from_array(i));
+	}
 
+	return(TRUE);
+}
+
+/**************************************************************************
+Prints the LRU list of a buffer pool instance. */
+static
 void
-buf_LRU_print(void)
-/*===============*/
+buf_LRU_print_instance(
+/*===================*/
+	buf_pool_t*	buf_pool)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	buf_frame_t*	frame;
 	ulint		len;
 
-	ut_ad(buf_pool);
 	mutex_enter(&(buf_pool->mutex));
 
-	fprintf(stderr, "Pool ulint clock %lu\n",
+	fprintf(stderr, "Pool %lu ulint clock %lu\n",
+		(ulong) (buf_pool - buf_pool_ptr),
 		(ulong) buf_pool->ulint_clock);
 
 	block = UT_LIST_GET_FIRST(buf_pool->LRU);
@@ -1247,4 +1311,18 @@ buf_LRU_print(void)
 
 	mutex_exit(&(buf_pool->mutex));
 }
+
+/**************************************************************************
+Prints the LRU lists. */
+
+void
+buf_LRU_print(void)
+/*===============*/
+{
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_LRU_print_instance(buf_pool_from_array(i));
+	}
+}
 #endif /* UNIV_DEBUG */
@@ -26,23 +26,43 @@ extern ulint srv_buf_pool_reads;
 
 /* The size in blocks of the area where the random read-ahead algorithm counts
 the accessed pages when deciding whether to read-ahead */
-#define	BUF_READ_AHEAD_RANDOM_AREA	BUF_READ_AHEAD_AREA
+#define	BUF_READ_AHEAD_RANDOM_AREA(b)	BUF_READ_AHEAD_AREA(b)
 
 /* There must be at least this many pages in buf_pool in the area to start
 a random read-ahead */
-#define BUF_READ_AHEAD_RANDOM_THRESHOLD	(5 + BUF_READ_AHEAD_RANDOM_AREA / 8)
+#define BUF_READ_AHEAD_RANDOM_THRESHOLD(b)			\
+	(5 + BUF_READ_AHEAD_RANDOM_AREA(b) / 8)
 
 /* The linear read-ahead area size */
-#define	BUF_READ_AHEAD_LINEAR_AREA	BUF_READ_AHEAD_AREA
+#define	BUF_READ_AHEAD_LINEAR_AREA(b)	BUF_READ_AHEAD_AREA(b)
 
 /* The linear read-ahead threshold */
-#define BUF_READ_AHEAD_LINEAR_THRESHOLD	(3 * BUF_READ_AHEAD_LINEAR_AREA / 8)
+#define BUF_READ_AHEAD_LINEAR_THRESHOLD(b)			\
+	(3 * BUF_READ_AHEAD_LINEAR_AREA(b) / 8)
 
 /* If there are buf_pool->curr_size per the number below pending reads, then
 read-ahead is not done: this is to prevent flooding the buffer pool with
 i/o-fixed buffer blocks */
 #define BUF_READ_AHEAD_PEND_LIMIT	2
 
+/************************************************************************
+Returns the number of pending reads in all the buffer pool instances. */
+static
+ulint
+buf_read_get_n_pend_reads(void)
+/*===========================*/
+			/* out: number of pending reads */
+{
+	ulint	n_pend_reads	= 0;
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		n_pend_reads += buf_pool_from_array(i)->n_pend_reads;
+	}
+
+	return(n_pend_reads);
+}
+
 /************************************************************************
 Low-level function which reads a page asynchronously from a file to the
 buffer buf_pool if it is not already there, in which case does nothing.
@@ -166,6 +186,7 @@ buf_read_ahead_random(
 	ulint	offset)	/* in: page number of a page which the current thread
 			wants to access */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	ib_longlong	tablespace_version;
 	buf_block_t*	block;
 	ulint		recent_blocks	= 0;
@@ -196,10 +217,10 @@ buf_read_ahead_random(
 
 	tablespace_version = fil_space_get_version(space);
 
-	low  = (offset / BUF_READ_AHEAD_RANDOM_AREA)
-		* BUF_READ_AHEAD_RANDOM_AREA;
-	high = (offset / BUF_READ_AHEAD_RANDOM_AREA + 1)
-		* BUF_READ_AHEAD_RANDOM_AREA;
+	low  = (offset / BUF_READ_AHEAD_RANDOM_AREA(buf_pool))
+		* BUF_READ_AHEAD_RANDOM_AREA(buf_pool);
+	high = (offset / BUF_READ_AHEAD_RANDOM_AREA(buf_pool) + 1)
+		* BUF_READ_AHEAD_RANDOM_AREA(buf_pool);
 	if (high > fil_space_get_size(space)) {
 
 		high = fil_space_get_size(space);
@@ -209,7 +230,7 @@ buf_read_ahead_random(
 	of the LRU list, to determine which blocks have recently been added
 	to the start of the list. */
 
-	LRU_recent_limit = buf_LRU_get_recent_limit();
+	LRU_recent_limit = buf_LRU_get_recent_limit(buf_pool);
 
 	mutex_enter(&(buf_pool->mutex));
 
@@ -224,7 +245,7 @@ buf_read_ahead_random(
 	that is, reside near the start of the LRU list. */
 
 	for (i = low; i < high; i++) {
-		block = buf_page_hash_get(space, i);
+		block = buf_page_hash_get(buf_pool, space, i);
 
 		if ((block)
 		    && (block->LRU_position > LRU_recent_limit)
@@ -236,7 +257,7 @@ buf_read_ahead_random(
 
 	mutex_exit(&(buf_pool->mutex));
 
-	if (recent_blocks < BUF_READ_AHEAD_RANDOM_THRESHOLD) {
+	if (recent_blocks < BUF_READ_AHEAD_RANDOM_THRESHOLD(buf_pool)) {
 		/* Do nothing */
 
 		return(0);
@@ -331,7 +352,7 @@ buf_read_page(
 	}
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(buf_pool_get(space, offset));
 
 	return(count > 0);
 }
@@ -368,6 +389,7 @@ buf_read_ahead_linear(
 	ulint	offset)	/* in: page number of a page; NOTE: the current thread
 			must want access to this page (see NOTE 3 above) */
 {
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	ib_longlong	tablespace_version;
 	buf_block_t*	block;
 	buf_frame_t*	frame;
@@ -397,10 +419,10 @@ buf_read_ahead_linear(
 		return(0);
 	}
 
-	low  = (offset / BUF_READ_AHEAD_LINEAR_AREA)
-		* BUF_READ_AHEAD_LINEAR_AREA;
-	high = (offset / BUF_READ_AHEAD_LINEAR_AREA + 1)
-		* BUF_READ_AHEAD_LINEAR_AREA;
+	low  = (offset / BUF_READ_AHEAD_LINEAR_AREA(buf_pool))
+		* BUF_READ_AHEAD_LINEAR_AREA(buf_pool);
+	high = (offset / BUF_READ_AHEAD_LINEAR_AREA(buf_pool) + 1)
+		* BUF_READ_AHEAD_LINEAR_AREA(buf_pool);
 
 	if ((offset != low) && (offset != high - 1)) {
 		/* This is not a border page of the area: return */
@@ -443,7 +465,7 @@ buf_read_ahead_linear(
 	fail_count = 0;
 
 	for (i = low; i < high; i++) {
-		block = buf_page_hash_get(space, i);
+		block = buf_page_hash_get(buf_pool, space, i);
 
 		if ((block == NULL) || !block->accessed) {
 			/* Not accessed */
@@ -460,8 +482,8 @@ buf_read_ahead_linear(
 		}
 	}
 
-	if (fail_count > BUF_READ_AHEAD_LINEAR_AREA
-	    - BUF_READ_AHEAD_LINEAR_THRESHOLD) {
+	if (fail_count > BUF_READ_AHEAD_LINEAR_AREA(buf_pool)
+	    - BUF_READ_AHEAD_LINEAR_THRESHOLD(buf_pool)) {
 		/* Too many failures: return */
 
 		mutex_exit(&(buf_pool->mutex));
@@ -472,7 +494,7 @@ buf_read_ahead_linear(
 	/* If we got this far, we know that enough pages in the area have
 	been accessed in the right order: linear read-ahead can be sensible */
 
-	block = buf_page_hash_get(space, offset);
+	block = buf_page_hash_get(buf_pool, space, offset);
 
 	if (block == NULL) {
 		mutex_exit(&(buf_pool->mutex));
@@ -508,10 +530,14 @@ buf_read_ahead_linear(
 		return(0);
 	}
 
-	low  = (new_offset / BUF_READ_AHEAD_LINEAR_AREA)
-		* BUF_READ_AHEAD_LINEAR_AREA;
-	high = (new_offset / BUF_READ_AHEAD_LINEAR_AREA + 1)
-		* BUF_READ_AHEAD_LINEAR_AREA;
+	/* The area to read may be cached in another instance */
+
+	buf_pool = buf_pool_get(space, new_offset);
+
+	low  = (new_offset / BUF_READ_AHEAD_LINEAR_AREA(buf_pool))
+		* BUF_READ_AHEAD_LINEAR_AREA(buf_pool);
+	high = (new_offset / BUF_READ_AHEAD_LINEAR_AREA(buf_pool) + 1)
+		* BUF_READ_AHEAD_LINEAR_AREA(buf_pool);
 
 	if ((new_offset != low) && (new_offset != high - 1)) {
 		/* This is not a border page of the area: return */
@@ -570,7 +596,7 @@ buf_read_ahead_linear(
 	os_aio_simulated_wake_handler_threads();
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(buf_pool);
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints && (count > 0)) {
@@ -612,8 +638,9 @@ buf_read_ibuf_merge_pages(
 #ifdef UNIV_IBUF_DEBUG
 	ut_a(n_stored < UNIV_PAGE_SIZE);
 #endif
-	while (buf_pool->n_pend_reads
-	       > buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+	while (buf_read_get_n_pend_reads()
+	       > buf_pool_get_curr_size() / UNIV_PAGE_SIZE
+	       / BUF_READ_AHEAD_PEND_LIMIT) {
 		os_thread_sleep(500000);
 	}
 
@@ -635,8 +662,8 @@ buf_read_ibuf_merge_pages(
 
 	os_aio_simulated_wake_handler_threads();
 
-	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	/* Flush pages from the end of the LRU lists if necessary */
+	buf_flush_free_margins();
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints) {
@@ -674,14 +701,18 @@ buf_read_recv_pages(
 
 		os_aio_print_debug = FALSE;
 
-		while (buf_pool->n_pend_reads >= recv_n_pool_free_frames / 2) {
+		/* Poll often: several recovery threads may be waiting
+		here, and the read queue should not run empty */
+
+		while (buf_read_get_n_pend_reads()
+		       >= recv_n_pool_free_frames / 2) {
 
 			os_aio_simulated_wake_handler_threads();
-			os_thread_sleep(500000);
+			os_thread_sleep(10000);
 
 			count++;
 
-			if (count > 100) {
+			if (count > 5000) {
 				fprintf(stderr,
 					"InnoDB: Error: InnoDB has waited for"
 					" 50 seconds for pending\n"
@@ -689,7 +720,7 @@ buf_read_recv_pages(
 					" be finished.\n"
 					"InnoDB: Number of pending reads %lu,"
 					" pending pread calls %lu\n",
-					(ulong) buf_pool->n_pend_reads,
+					(ulong) buf_read_get_n_pend_reads(),
 					(ulong)os_file_n_pending_preads);
 
 				os_aio_print_debug = TRUE;
@@ -712,8 +743,8 @@ buf_read_recv_pages(
 
 	os_aio_simulated_wake_handler_threads();
 
-	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	/* Flush pages from the end of the LRU lists if necessary */
+	buf_flush_free_margins();
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints) {
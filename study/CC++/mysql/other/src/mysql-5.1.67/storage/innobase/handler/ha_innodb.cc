@@ -42,8 +42,6 @@ have disabled the InnoDB inlining in this file. */
 
 /** to protect innobase_open_files */
 static pthread_mutex_t innobase_share_mutex;
-/** to force correct commit order in binlog */
-static pthread_mutex_t prepare_commit_mutex;
 static ulong commit_threads = 0;
 static pthread_mutex_t commit_threads_m;
 static pthread_cond_t commit_cond;
@@ -96,7 +94,9 @@ static long innobase_mirrored_log_groups, innobase_log_files_in_group,
 	innobase_log_buffer_size, innobase_buffer_pool_awe_mem_mb,
 	innobase_additional_mem_pool_size, innobase_file_io_threads,
 	innobase_lock_wait_timeout, innobase_force_recovery,
-	innobase_open_files, innobase_autoinc_lock_mode;
+	innobase_open_files, innobase_autoinc_lock_mode,
+	innobase_buffer_pool_instances, innobase_recovery_threads,
+	innobase_purge_threads, innobase_adaptive_hash_index_partitions;
 static ulong innobase_commit_concurrency = 0;
 
 static long long innobase_buffer_pool_size, innobase_log_file_size;
@@ -121,6 +121,7 @@ static char*	innobase_log_arch_dir			= NULL;
 #endif /* UNIV_LOG_ARCHIVE */
 static my_bool	innobase_use_doublewrite		= TRUE;
 static my_bool	innobase_use_checksums			= TRUE;
+static my_bool	innobase_use_native_aio			= TRUE;
 static my_bool	innobase_file_per_table			= FALSE;
 static my_bool	innobase_locks_unsafe_for_binlog	= FALSE;
 static my_bool	innobase_rollback_on_timeout		= FALSE;
@@ -149,6 +150,24 @@ static TYPELIB innodb_stats_method_typelib = {
 	NULL
 };
 
+/* Possible values for system variable "innodb_checksum_algorithm", in the
+order of srv_checksum_algorithm_enum */
+static const char* innodb_checksum_algorithm_names[] = {
+	"innodb",
+	"crc32",
+	"none",
+	NullS
+};
+
+/* Used to define an enumerate type of the system variable
+innodb_checksum_algorithm */
+static TYPELIB innodb_checksum_algorithm_typelib = {
+	array_elements(innodb_checksum_algorithm_names) - 1,
+	"innodb_checksum_algorithm_typelib",
+	innodb_checksum_algorithm_names,
+	NULL
+};
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in selects it is not sensible to call
 srv_active_wake_master_thread after each fetch or search, we only do
@@ -169,6 +188,7 @@ static INNOBASE_SHARE *get_share(const char *table_name);
 static void free_share(INNOBASE_SHARE *share);
 static int innobase_close_connection(handlerton *hton, THD* thd);
 static int innobase_commit(handlerton *hton, THD* thd, bool all);
+static void innobase_commit_ordered(handlerton *hton, THD* thd, bool all);
 static int innobase_rollback(handlerton *hton, THD* thd, bool all);
 static int innobase_rollback_to_savepoint(handlerton *hton, THD* thd,
            void *savepoint);
@@ -407,6 +427,12 @@ innobase_commit_low(
 	trx_t*	trx);	/* in: transaction handle */
 
 static SHOW_VAR innodb_status_variables[]= {
+  {"adaptive_flushed",
+  (char*) &export_vars.innodb_adaptive_flushed,		  SHOW_LONG},
+  {"adaptive_hash_hits",
+  (char*) &export_vars.innodb_adaptive_hash_hits,	  SHOW_LONG},
+  {"adaptive_hash_misses",
+  (char*) &export_vars.innodb_adaptive_hash_misses,	  SHOW_LONG},
   {"buffer_pool_pages_data",
   (char*) &export_vars.innodb_buffer_pool_pages_data,	  SHOW_LONG},
   {"buffer_pool_pages_dirty",
@@ -435,6 +461,10 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_buffer_pool_wait_free,	  SHOW_LONG},
   {"buffer_pool_write_requests",
   (char*) &export_vars.innodb_buffer_pool_write_requests, SHOW_LONG},
+  {"checkpoint_age",
+  (char*) &export_vars.innodb_checkpoint_age,		  SHOW_LONG},
+  {"checkpoint_max_age",
+  (char*) &export_vars.innodb_checkpoint_max_age,	  SHOW_LONG},
   {"data_fsyncs",
   (char*) &export_vars.innodb_data_fsyncs,		  SHOW_LONG},
   {"data_pending_fsyncs",
@@ -455,6 +485,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_dblwr_pages_written,	  SHOW_LONG},
   {"dblwr_writes",
   (char*) &export_vars.innodb_dblwr_writes,		  SHOW_LONG},
+  {"history_list_length",
+  (char*) &export_vars.innodb_history_list_length,	  SHOW_LONG},
   {"log_waits",
   (char*) &export_vars.innodb_log_waits,		  SHOW_LONG},
   {"log_write_requests",
@@ -469,6 +501,14 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_os_log_pending_writes,	  SHOW_LONG},
   {"os_log_written",
   (char*) &export_vars.innodb_os_log_written,		  SHOW_LONG},
+  {"page_cleaner_list_flushed",
+  (char*) &export_vars.innodb_page_cleaner_list_flushed,  SHOW_LONG},
+  {"page_cleaner_lru_flushed",
+  (char*) &export_vars.innodb_page_cleaner_lru_flushed,	  SHOW_LONG},
+  {"page_cleaner_requests",
+  (char*) &export_vars.innodb_page_cleaner_requests,	  SHOW_LONG},
+  {"page_cleaner_threads",
+  (char*) &export_vars.innodb_page_cleaner_threads,	  SHOW_LONG},
   {"page_size",
   (char*) &export_vars.innodb_page_size,		  SHOW_LONG},
   {"pages_created",
@@ -477,6 +517,10 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_pages_read,		  SHOW_LONG},
   {"pages_written",
   (char*) &export_vars.innodb_pages_written,		  SHOW_LONG},
+  {"purge_threads",
+  (char*) &export_vars.innodb_purge_threads,		  SHOW_LONG},
+  {"redo_rate",
+  (char*) &export_vars.innodb_redo_rate,		  SHOW_LONG},
   {"row_lock_current_waits",
   (char*) &export_vars.innodb_row_lock_current_waits,	  SHOW_LONG},
   {"row_lock_time",
@@ -1792,6 +1836,7 @@ innobase_init(
         innobase_hton->savepoint_rollback=innobase_rollback_to_savepoint;
         innobase_hton->savepoint_release=innobase_release_savepoint;
         innobase_hton->commit=innobase_commit;
+        innobase_hton->commit_ordered=innobase_commit_ordered;
         innobase_hton->rollback=innobase_rollback;
         innobase_hton->prepare=innobase_xa_prepare;
         innobase_hton->recover=innobase_xa_recover;
@@ -1977,15 +2022,20 @@ innobase_init(
 		determined by .._awe_mem_mb. */
 	}
 
+	srv_buf_pool_instances = (ulint) innobase_buffer_pool_instances;
+
 	srv_mem_pool_size = (ulint) innobase_additional_mem_pool_size;
 
 	srv_n_file_io_threads = (ulint) innobase_file_io_threads;
+	srv_n_recv_threads = (ulint) innobase_recovery_threads;
+	srv_n_purge_threads = (ulint) innobase_purge_threads;
 
 	srv_lock_wait_timeout = (ulint) innobase_lock_wait_timeout;
 	srv_force_recovery = (ulint) innobase_force_recovery;
 
 	srv_use_doublewrite_buf = (ibool) innobase_use_doublewrite;
 	srv_use_checksums = (ibool) innobase_use_checksums;
+	srv_use_native_aio = (ibool) innobase_use_native_aio;
 
 #ifdef HAVE_LARGE_PAGES
         if ((os_use_large_pages = (ibool) my_use_large_pages))
@@ -2002,6 +2052,8 @@ innobase_init(
 
 	srv_use_adaptive_hash_indexes =
 		(ibool) innobase_adaptive_hash_index;
+	srv_n_adaptive_hash_parts =
+		(ulint) innobase_adaptive_hash_index_partitions;
 
 	srv_print_verbose_log = mysqld_embedded ? 0 : 1;
 
@@ -2041,10 +2093,15 @@ innobase_init(
 		goto error;
 	}
 
+	/* The startup may have used fewer instances than configured */
+	innobase_buffer_pool_instances = (long) srv_buf_pool_instances;
+
+	/* Native aio is turned off if the kernel does not support it */
+	innobase_use_native_aio = (my_bool) srv_use_native_aio;
+
 	(void) hash_init(&innobase_open_tables,system_charset_info, 32, 0, 0,
 					(hash_get_key) innobase_get_key, 0, 0);
 	pthread_mutex_init(&innobase_share_mutex, MY_MUTEX_INIT_FAST);
-	pthread_mutex_init(&prepare_commit_mutex, MY_MUTEX_INIT_FAST);
 	pthread_mutex_init(&commit_threads_m, MY_MUTEX_INIT_FAST);
 	pthread_mutex_init(&commit_cond_m, MY_MUTEX_INIT_FAST);
 	pthread_mutex_init(&analyze_mutex, MY_MUTEX_INIT_FAST);
@@ -2084,7 +2141,6 @@ innobase_end(handlerton *hton, ha_panic_function type)
 		my_free(internal_innobase_data_file_path,
 						MYF(MY_ALLOW_ZERO_PTR));
 		pthread_mutex_destroy(&innobase_share_mutex);
-		pthread_mutex_destroy(&prepare_commit_mutex);
 		pthread_mutex_destroy(&commit_threads_m);
 		pthread_mutex_destroy(&commit_cond_m);
 		pthread_mutex_destroy(&analyze_mutex);
@@ -2174,6 +2230,101 @@ innobase_start_trx_and_assign_read_view(
 	DBUG_RETURN(0);
 }
 
+/*********************************************************************
+Commits a transaction, letting at most innodb_commit_concurrency threads
+commit at a time. If trx->flush_log_later is set, the log is not flushed
+here but in trx_commit_complete_for_mysql(). */
+static
+void
+innobase_commit_throttled(
+/*======================*/
+	trx_t*		trx,		/* in: transaction handle */
+	const char*	log_file_name,	/* in: MySQL binlog file name */
+	ib_longlong	log_offset)	/* in: binlog position after the
+					transaction, for ibbackup */
+{
+retry:
+	if (innobase_commit_concurrency > 0) {
+		pthread_mutex_lock(&commit_cond_m);
+		commit_threads++;
+
+		if (commit_threads > innobase_commit_concurrency) {
+			commit_threads--;
+			pthread_cond_wait(&commit_cond,
+				&commit_cond_m);
+			pthread_mutex_unlock(&commit_cond_m);
+			goto retry;
+		}
+		else {
+			pthread_mutex_unlock(&commit_cond_m);
+		}
+	}
+
+	trx->mysql_log_file_name = log_file_name;
+	trx->mysql_log_offset = log_offset;
+
+	innobase_commit_low(trx);
+
+	if (innobase_commit_concurrency > 0) {
+		pthread_mutex_lock(&commit_cond_m);
+		commit_threads--;
+		pthread_cond_signal(&commit_cond);
+		pthread_mutex_unlock(&commit_cond_m);
+	}
+}
+
+/*********************************************************************
+Commits a transaction in memory, making it visible to other transactions,
+in the order in which the transactions were written to the MySQL binlog:
+this keeps the commit order of InnoDB and the binlog the same, as ibbackup
+needs. Called after the transaction has been written to the binlog,
+possibly in the thread of another transaction of the same binlog group
+commit. The log is flushed later in innobase_commit(). */
+static
+void
+innobase_commit_ordered(
+/*====================*/
+        handlerton *hton, /* in: Innodb handlerton */
+	THD* 	thd,	/* in: MySQL thread handle of the user for whom
+			the transaction should be committed */
+	bool	all)	/* in:	TRUE - commit transaction
+				FALSE - the current SQL statement ended */
+{
+	trx_t*		trx;
+	const char*	log_file_name;
+	ib_longlong	log_offset;
+
+	DBUG_ENTER("innobase_commit_ordered");
+
+	/* We may be running in another thread than that of thd: do not
+	create a trx here, or touch the latches of the trx */
+
+	trx = thd_to_trx(thd);
+
+	if (trx == NULL
+	    || (!all && thd_test_options(thd,
+					 OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN))) {
+		DBUG_VOID_RETURN;
+	}
+
+	/* The search latch and a FIFO ticket were released in
+	innobase_xa_prepare() */
+	ut_a(!trx->has_search_latch);
+	ut_a(!trx->declared_to_be_inside_innodb);
+
+	log_offset = (ib_longlong) mysql_bin_log_commit_pos(thd,
+							    &log_file_name);
+
+	trx->flush_log_later = TRUE;
+	innobase_commit_throttled(trx, log_file_name, log_offset);
+	trx->flush_log_later = FALSE;
+
+	/* Tell innobase_commit() that only the log flush is left */
+	trx->active_trans = 2;
+
+	DBUG_VOID_RETURN;
+}
+
 /*********************************************************************
 Commits a transaction in an InnoDB database or marks an SQL statement
 ended. */
@@ -2232,41 +2383,21 @@ innobase_commit(
 		/* We were instructed to commit the whole transaction, or
 		this is an SQL statement end and autocommit is on */
 
-		/* We need current binlog position for ibbackup to work.
-		Note, the position is current because of
-		prepare_commit_mutex */
-retry:
-		if (innobase_commit_concurrency > 0) {
-			pthread_mutex_lock(&commit_cond_m);
-			commit_threads++;
-
-			if (commit_threads > innobase_commit_concurrency) {
-				commit_threads--;
-				pthread_cond_wait(&commit_cond,
-					&commit_cond_m);
-				pthread_mutex_unlock(&commit_cond_m);
-				goto retry;
-			}
-			else {
-				pthread_mutex_unlock(&commit_cond_m);
-			}
-		}
-
-		trx->mysql_log_file_name = mysql_bin_log_file_name();
-		trx->mysql_log_offset = (ib_longlong) mysql_bin_log_file_pos();
-
-		innobase_commit_low(trx);
-
-		if (innobase_commit_concurrency > 0) {
-			pthread_mutex_lock(&commit_cond_m);
-			commit_threads--;
-			pthread_cond_signal(&commit_cond);
-			pthread_mutex_unlock(&commit_cond_m);
-		}
-
 		if (trx->active_trans == 2) {
+			/* The transaction was already committed in memory
+			by innobase_commit_ordered(), in the order of the
+			binlog: only the log flush is left. The threads of
+			a binlog group commit get here concurrently, so
+			that log_write_up_to() can combine their flushes */
+
+			trx_commit_complete_for_mysql(trx);
+		} else {
+			/* The binlog position is not exact here, as this
+			commit is not ordered with the binlog writes */
 
-			pthread_mutex_unlock(&prepare_commit_mutex);
+			innobase_commit_throttled(
+				trx, mysql_bin_log_file_name(),
+				(ib_longlong) mysql_bin_log_file_pos());
 		}
 
 		trx->active_trans = 0;
@@ -2921,7 +3052,7 @@ ha_innobase::open(
 	thd = ha_thd();
 
 	/* Under some cases MySQL seems to call this function while
-	holding btr_search_latch. This breaks the latching order as
+	holding an adaptive hash index latch. This breaks the latching order as
 	we acquire dict_sys->mutex below and leads to a deadlock. */
 	if (thd != NULL) {
 		innobase_release_temporary_latches(ht, thd);
@@ -8652,18 +8783,16 @@ innobase_xa_prepare(
 		  thread2> prepare; write to binlog; commit
 		  thread1>			     ... commit
 
-		To ensure this will not happen we're taking the mutex on
-		prepare, and releasing it on commit.
+		We do not serialize from prepare to commit to prevent this:
+		the binlog group commit calls innobase_commit_ordered() for
+		the transactions in the order it wrote them to the binlog,
+		and only the log flush is left to innobase_commit().
+
+		As innobase_commit_ordered() may run in the thread of another
+		transaction, release a possible FIFO ticket and the search
+		latch now, also when XA is not supported. */
 
-		Note: only do it for normal commits, done via ha_commit_trans.
-		If 2pc protocol is executed by external transaction
-		coordinator, it will be just a regular MySQL client
-		executing XA PREPARE and XA COMMIT commands.
-		In this case we cannot know how many minutes or hours
-		will be between XA PREPARE and XA COMMIT, and we don't want
-		to block for undefined period of time. */
-		pthread_mutex_lock(&prepare_commit_mutex);
-		trx->active_trans = 2;
+		innobase_release_stat_resources(trx);
 	}
 
 	if (!THDVAR(thd, support_xa)) {
@@ -9061,6 +9190,14 @@ static MYSQL_SYSVAR_BOOL(checksums, innobase_use_checksums,
   "Disable with --skip-innodb-checksums.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_ENUM(checksum_algorithm, srv_checksum_algorithm,
+  PLUGIN_VAR_RQCMDARG,
+  "The checksum algorithm of the pages InnoDB writes: INNODB (default), "
+  "CRC32 (CRC-32C, using the SSE4.2 crc32 instruction if the CPU has it) "
+  "or NONE. Pages written with any of them are accepted when read.",
+  NULL, NULL, SRV_CHECKSUM_ALGORITHM_INNODB,
+  &innodb_checksum_algorithm_typelib);
+
 static MYSQL_SYSVAR_STR(data_home_dir, innobase_data_home_dir,
   PLUGIN_VAR_READONLY,
   "The common part for InnoDB table spaces.",
@@ -9124,11 +9261,36 @@ static MYSQL_SYSVAR_ULONG(max_dirty_pages_pct, srv_max_buf_pool_modified_pct,
   "Percentage of dirty pages allowed in bufferpool.",
   NULL, NULL, 90, 0, 100, 0);
 
+static MYSQL_SYSVAR_ULONG(io_capacity, srv_io_capacity,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of IOPs the server can do. Tunes the background flushing.",
+  NULL, NULL, 200, 100, ~0UL, 0);
+
+static MYSQL_SYSVAR_ULONG(io_capacity_max, srv_io_capacity_max,
+  PLUGIN_VAR_RQCMDARG,
+  "Limit of the pages the adaptive flushing may flush per second.",
+  NULL, NULL, 2000, 100, ~0UL, 0);
+
+static MYSQL_SYSVAR_BOOL(adaptive_flushing, srv_adaptive_flushing,
+  PLUGIN_VAR_NOCMDARG,
+  "Flush the buffer pool at the rate the redo log is generated, to keep the checkpoint age below the limit where user threads must flush (enabled by default).",
+  NULL, NULL, TRUE);
+
+static MYSQL_SYSVAR_ULONG(adaptive_flushing_lwm, srv_adaptive_flushing_lwm,
+  PLUGIN_VAR_RQCMDARG,
+  "Percentage of the asynchronous preflush limit of the checkpoint age at which the adaptive flushing starts.",
+  NULL, NULL, 10, 0, 70, 0);
+
 static MYSQL_SYSVAR_ULONG(max_purge_lag, srv_max_purge_lag,
   PLUGIN_VAR_RQCMDARG,
   "Desired maximum length of the purge queue (0 = no limit)",
   NULL, NULL, 0, 0, ~0UL, 0);
 
+static MYSQL_SYSVAR_ULONG(max_purge_lag_delay, srv_max_purge_lag_delay,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum delay in microseconds of DML statements caused by innodb_max_purge_lag (0 = no maximum)",
+  NULL, NULL, 0, 0, 10000000, 0);
+
 static MYSQL_SYSVAR_BOOL(rollback_on_timeout, innobase_rollback_on_timeout,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Roll back the complete transaction on lock wait timeout, for 4.x compatibility (disabled by default)",
@@ -9158,6 +9320,11 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, innobase_adaptive_hash_index,
   "Disable with --skip-innodb-adaptive-hash-index.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_LONG(adaptive_hash_index_partitions, innobase_adaptive_hash_index_partitions,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of partitions of the adaptive hash index. Each partition has its own hash table and latch, and each index is mapped to one partition by its id.",
+  NULL, NULL, 8L, 1L, 64L, 0);
+
 static MYSQL_SYSVAR_LONG(additional_mem_pool_size, innobase_additional_mem_pool_size,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Size of a memory pool InnoDB uses to store data dictionary information and other internal data structures.",
@@ -9173,6 +9340,11 @@ static MYSQL_SYSVAR_LONGLONG(buffer_pool_size, innobase_buffer_pool_size,
   "The size of the memory buffer InnoDB uses to cache data and indexes of its tables.",
   NULL, NULL, 8*1024*1024L, 1024*1024L, LONGLONG_MAX, 1024*1024L);
 
+static MYSQL_SYSVAR_LONG(buffer_pool_instances, innobase_buffer_pool_instances,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of buffer pool instances, each with its own mutex, page hash and lists. Each instance gets at least 16MB of the buffer pool.",
+  NULL, NULL, 1L, 1L, 64L, 0);
+
 static MYSQL_SYSVAR_ULONG(commit_concurrency, innobase_commit_concurrency,
   PLUGIN_VAR_RQCMDARG,
   "Helps in performance tuning in heavily concurrent environments.",
@@ -9188,6 +9360,23 @@ static MYSQL_SYSVAR_LONG(file_io_threads, innobase_file_io_threads,
   "Number of file I/O threads in InnoDB.",
   NULL, NULL, 4, 4, 64, 0);
 
+static MYSQL_SYSVAR_LONG(recovery_threads, innobase_recovery_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads which apply the redo log to different pages in parallel in crash recovery.",
+  NULL, NULL, 4L, 1L, 64L, 0);
+
+static MYSQL_SYSVAR_LONG(purge_threads, innobase_purge_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of purge threads. 0 runs purge in the master thread, 1 in a separate purge thread, and more in that many worker threads which purge the undo log records of different tables in parallel.",
+  NULL, NULL, 1L, 0L, 32L, 0);
+
+static MYSQL_SYSVAR_BOOL(use_native_aio, innobase_use_native_aio,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Use native asynchronous I/O (io_submit) on Linux, falling back to "
+  "simulated AIO if the kernel does not support it (enabled by default). "
+  "Disable with --skip-innodb-use-native-aio.",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_LONG(force_recovery, innobase_force_recovery,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Helps to save your data in case the disk image of the database becomes corrupt.",
@@ -9279,8 +9468,10 @@ static MYSQL_SYSVAR_UINT(trx_rseg_n_slots_debug, trx_rseg_n_slots_debug,
 static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(additional_mem_pool_size),
   MYSQL_SYSVAR(autoextend_increment),
+  MYSQL_SYSVAR(buffer_pool_instances),
   MYSQL_SYSVAR(buffer_pool_size),
   MYSQL_SYSVAR(checksums),
+  MYSQL_SYSVAR(checksum_algorithm),
   MYSQL_SYSVAR(commit_concurrency),
   MYSQL_SYSVAR(concurrency_tickets),
   MYSQL_SYSVAR(data_file_path),
@@ -9288,6 +9479,9 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(doublewrite),
   MYSQL_SYSVAR(fast_shutdown),
   MYSQL_SYSVAR(file_io_threads),
+  MYSQL_SYSVAR(use_native_aio),
+  MYSQL_SYSVAR(recovery_threads),
+  MYSQL_SYSVAR(purge_threads),
   MYSQL_SYSVAR(file_per_table),
   MYSQL_SYSVAR(flush_log_at_trx_commit),
   MYSQL_SYSVAR(flush_method),
@@ -9303,13 +9497,19 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(log_files_in_group),
   MYSQL_SYSVAR(log_group_home_dir),
   MYSQL_SYSVAR(max_dirty_pages_pct),
+  MYSQL_SYSVAR(io_capacity),
+  MYSQL_SYSVAR(io_capacity_max),
+  MYSQL_SYSVAR(adaptive_flushing),
+  MYSQL_SYSVAR(adaptive_flushing_lwm),
   MYSQL_SYSVAR(max_purge_lag),
+  MYSQL_SYSVAR(max_purge_lag_delay),
   MYSQL_SYSVAR(mirrored_log_groups),
   MYSQL_SYSVAR(open_files),
   MYSQL_SYSVAR(rollback_on_timeout),
   MYSQL_SYSVAR(stats_on_metadata),
   MYSQL_SYSVAR(use_legacy_cardinality_algorithm),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(adaptive_hash_index_partitions),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(status_file),
   MYSQL_SYSVAR(support_xa),
@@ -224,6 +224,14 @@ const char* mysql_bin_log_file_name(void);
  */
 ulonglong mysql_bin_log_file_pos(void);
 
+/** Get the binlog position of a transaction while it is committed in
+ * the binlog order (see handlerton::commit_ordered).
+ * @param thd the thread of the transaction
+ * @param out_file the name of the binlog file
+ * @return byte offset of the end of the transaction in the binlog
+ */
+ulonglong mysql_bin_log_commit_pos(MYSQL_THD thd, const char **out_file);
+
 /**
   Check if a user thread is a replication slave thread
   @param thd  user thread
@@ -1939,7 +1939,8 @@ ibuf_get_merge_page_nos(
 
 	*n_stored = 0;
 
-	limit = ut_min(IBUF_MAX_N_PAGES_MERGED, buf_pool->curr_size / 4);
+	limit = ut_min(IBUF_MAX_N_PAGES_MERGED, buf_pool_get_curr_size()
+		       / UNIV_PAGE_SIZE / 4);
 
 	if (page_rec_is_supremum(rec)) {
 
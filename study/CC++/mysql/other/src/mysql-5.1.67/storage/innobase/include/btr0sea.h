@@ -23,7 +23,9 @@ Creates and initializes the adaptive search system at a database start. */
 void
 btr_search_sys_create(
 /*==================*/
-	ulint	hash_size);	/* in: hash index hash table size */
+	ulint	hash_size,	/* in: hash index hash table size, split
+				evenly between the partitions */
+	ulint	n_parts);	/* in: number of hash index partitions */
 /************************************************************************
 Returns search info for an index. */
 UNIV_INLINE
@@ -32,6 +34,31 @@ btr_search_get_info(
 /*================*/
 				/* out: search info; search mutex reserved */
 	dict_index_t*	index);	/* in: index */
+/************************************************************************
+Returns the adaptive hash index partition of an index. */
+UNIV_INLINE
+btr_search_part_t*
+btr_search_get_part(
+/*================*/
+				/* out: hash index partition */
+	dict_index_t*	index);	/* in: index */
+/************************************************************************
+Returns the latch protecting the adaptive hash index partition of an
+index. */
+UNIV_INLINE
+rw_lock_t*
+btr_search_get_latch(
+/*=================*/
+				/* out: partition latch */
+	dict_index_t*	index);	/* in: index */
+/************************************************************************
+Returns the hash table of the adaptive hash index partition of an index. */
+UNIV_INLINE
+hash_table_t*
+btr_search_get_hash_index(
+/*======================*/
+				/* out: partition hash table */
+	dict_index_t*	index);	/* in: index */
 /*********************************************************************
 Creates and initializes a search info struct. */
 
@@ -41,13 +68,14 @@ btr_search_info_create(
 				/* out, own: search info struct */
 	mem_heap_t*	heap);	/* in: heap where created */
 /*********************************************************************
-Returns the value of ref_count. The value is protected by
-btr_search_latch. */
+Returns the value of ref_count. The value is protected by the latch
+of the hash index partition of the index. */
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
 				/* out: ref_count value. */
-	btr_search_t*   info);	/* in: search info. */
+	btr_search_t*   info,	/* in: search info. */
+	dict_index_t*	index);	/* in: index of info */
 /*************************************************************************
 Updates the search info. */
 UNIV_INLINE
@@ -73,7 +101,8 @@ btr_search_guess_on_hash(
 	ulint		latch_mode,	/* in: BTR_SEARCH_LEAF, ... */
 	btr_cur_t*	cursor,		/* out: tree cursor */
 	ulint		has_search_latch,/* in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on the hash index
+					partition latch of index:
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr);		/* in: mtr */
 /************************************************************************
@@ -141,6 +170,23 @@ ibool
 btr_search_validate(void);
 /*======================*/
 				/* out: TRUE if ok */
+/************************************************************************
+Prints info of the adaptive hash index partitions. */
+
+void
+btr_search_print_info(
+/*==================*/
+	FILE*	file);	/* in: file where to print */
+/************************************************************************
+Sums the hits and misses of the adaptive hash index partitions. */
+
+void
+btr_search_get_n_hits(
+/*==================*/
+	ulint*	n_hits,		/* out: searches which found the record
+				through the hash index */
+	ulint*	n_misses);	/* out: searches which tried the hash
+				index in vain */
 
 /* The search info struct in an index */
 
@@ -148,7 +194,8 @@ struct btr_search_struct{
 	ulint	ref_count;	/* Number of blocks in this index tree
 				that have search index built
 				i.e. block->index points to this index.
-				Protected by btr_search_latch except
+				Protected by the latch of the hash
+				index partition except
 				when during initialization in
 				btr_search_info_create(). */
 
@@ -195,32 +242,49 @@ struct btr_search_struct{
 #endif /* UNIV_DEBUG */
 };
 
+/* A partition of the adaptive hash index. The hash index is split into
+independent partitions by index id, so that searches and modifications on
+different indexes do not contend on the same latch. */
+
+struct btr_search_part_struct{
+	rw_lock_t	latch;	/* the latch protecting the partition: this
+				latch protects the
+				(1) hash table of the partition;
+				(2) columns of a record to which we have a
+				pointer in the hash table;
+				(3) the hash index fields of the blocks
+				whose block->index maps to this partition;
+
+				but does NOT protect:
+
+				(4) next record offset field in a record;
+				(5) next or previous records on the same page.
+
+				Bear in mind (4) and (5) when using the hash
+				index. */
+	hash_table_t*	hash_index;/* the hash table of the partition */
+	ulint		n_hits;	/* number of searches which found the record
+				through this partition; not protected by
+				any latch */
+	ulint		n_misses;/* number of searches which tried this
+				partition in vain; not protected by any
+				latch */
+	byte		pad[64];/* padding to keep the latches of
+				neighbouring partitions on separate cache
+				lines */
+};
+
 /* The hash index system */
 
 typedef struct btr_search_sys_struct	btr_search_sys_t;
 
 struct btr_search_sys_struct{
-	hash_table_t*	hash_index;
+	ulint			n_parts;/* number of partitions */
+	btr_search_part_t*	parts;	/* array of n_parts partitions */
 };
 
 extern btr_search_sys_t*	btr_search_sys;
 
-/* The latch protecting the adaptive search system: this latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
-
-but does NOT protect:
-
-(3) next record offset field in a record;
-(4) next or previous records on the same page.
-
-Bear in mind (3) and (4) when using the hash index.
-*/
-
-extern rw_lock_t*	btr_search_latch_temp;
-
-#define btr_search_latch	(*btr_search_latch_temp)
-
 #ifdef UNIV_SEARCH_PERF_STAT
 extern ulint	btr_search_n_succ;
 extern ulint	btr_search_n_hash_fail;
@@ -17,6 +17,7 @@ Created 2/17/1996 Heikki Tuuri
 typedef struct btr_pcur_struct		btr_pcur_t;
 typedef struct btr_cur_struct		btr_cur_t;
 typedef struct btr_search_struct	btr_search_t;
+typedef struct btr_search_part_struct	btr_search_part_t;
 
 #if defined UNIV_DEBUG || defined UNIV_BLOB_LIGHT_DEBUG
 #define BTR_EXTERN_FIELD_REF_SIZE	20
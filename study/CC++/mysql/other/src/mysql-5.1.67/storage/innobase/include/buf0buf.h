@@ -54,8 +54,24 @@ Created 11/5/1995 Heikki Tuuri
 #define BUF_KEEP_OLD	52
 /* Magic value to use instead of checksums when they are disabled */
 #define BUF_NO_CHECKSUM_MAGIC 0xDEADBEEFUL
-
-extern buf_pool_t*	buf_pool;	/* The buffer pool of the database */
+/* Minimum number of pages in a buffer pool instance; startup uses fewer
+instances than configured if the pool is too small for that many */
+#define BUF_POOL_INSTANCE_MIN_SIZE	1024
+/* Maximum number of buffer pool instances */
+#define BUF_POOL_MAX_INSTANCES		64
+
+/* The buffer pool is split into srv_buf_pool_instances instances. A file
+page always goes to the instance buf_pool_get() computes from its address,
+and each instance has its own mutex, page hash, LRU list, free list and
+flush list. The frames and control blocks of all instances are allocated
+as one array, so that buf_block_align() works for any frame. */
+
+extern buf_pool_t*	buf_pool_ptr;	/* The buffer pool instances of the
+					database */
+extern byte*		buf_pool_frame_zero;/* The first buffer frame of all
+					instances */
+extern byte*		buf_pool_high_end;/* The end of the buffer frames of
+					all instances */
 #ifdef UNIV_DEBUG
 extern ibool		buf_debug_prints;/* If this is set TRUE, the program
 					prints info whenever read or flush
@@ -82,6 +98,32 @@ buf_pool_init(
 				where physical memory pages are mapped; if
 				AWE is not used then this must be the same
 				as max_size */
+/************************************************************************
+Returns the buffer pool instance with the given number. */
+UNIV_INLINE
+buf_pool_t*
+buf_pool_from_array(
+/*================*/
+				/* out: buffer pool instance */
+	ulint	index);		/* in: number of the instance,
+				< srv_buf_pool_instances */
+/************************************************************************
+Returns the buffer pool instance a file page belongs to. */
+UNIV_INLINE
+buf_pool_t*
+buf_pool_get(
+/*=========*/
+				/* out: buffer pool instance */
+	ulint	space,		/* in: space id */
+	ulint	offset);	/* in: page number */
+/************************************************************************
+Returns the buffer pool instance a control block belongs to. */
+UNIV_INLINE
+buf_pool_t*
+buf_pool_from_block(
+/*================*/
+				/* out: buffer pool instance */
+	buf_block_t*	block);	/* in: control block */
 /*************************************************************************
 Gets the current size of buffer buf_pool in bytes. In the case of AWE, the
 size of AWE window (= the frames). */
@@ -384,6 +426,16 @@ buf_calc_page_old_checksum(
 			/* out: checksum */
 	byte*	 page);	/* in: buffer page */
 /************************************************************************
+Calculates the CRC-32C checksum of a page, which innodb_checksum_algorithm
+crc32 stores to both checksum fields of the page. It covers the same bytes
+as buf_calc_page_new_checksum(). */
+
+ulint
+buf_calc_page_crc32(
+/*================*/
+			/* out: checksum */
+	byte*	page);	/* in: buffer page */
+/************************************************************************
 Checks if a page is corrupt. */
 
 ibool
@@ -504,6 +556,15 @@ database pages in the buffer pool. */
 ulint
 buf_get_modified_ratio_pct(void);
 /*============================*/
+/*************************************************************************
+Sums up the statistics of all the buffer pool instances. The counters are
+read without holding the buffer pool mutexes. */
+
+void
+buf_get_total_stat(
+/*===============*/
+	buf_pool_stat_t*	tot_stat);	/* out: sums over all
+						instances */
 /**************************************************************************
 Refreshes the statistics used to print per-second averages. */
 
@@ -660,17 +721,19 @@ UNIV_INLINE
 buf_block_t*
 buf_page_hash_get(
 /*==============*/
-			/* out: block, NULL if not found */
-	ulint	space,	/* in: space id */
-	ulint	offset);/* in: offset of the page within space */
+				/* out: block, NULL if not found */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance of the page */
+	ulint		space,	/* in: space id */
+	ulint		offset);/* in: offset of the page within space */
 /***********************************************************************
 Increments the pool clock by one and returns its new value. Remember that
 in the 32 bit version the clock wraps around at 4 billion! */
 UNIV_INLINE
 ulint
-buf_pool_clock_tic(void);
-/*====================*/
-			/* out: new clock value */
+buf_pool_clock_tic(
+/*===============*/
+				/* out: new clock value */
+	buf_pool_t*	buf_pool);/* in: buffer pool instance */
 /*************************************************************************
 Gets the current length of the free list of buffer blocks. */
 
@@ -709,6 +772,8 @@ struct buf_block_struct{
 	ulint		offset;		/* page number within the space */
 	ulint		lock_hash_val;	/* hashed value of the page address
 					in the record lock hash table */
+	ulint		buf_pool_index;	/* number of the buffer pool
+					instance which owns this block */
 	mutex_t		mutex;		/* mutex protecting this block:
 					state (also protected by the buffer
 					pool mutex), io_fix, buf_fix_count,
@@ -820,7 +885,8 @@ struct buf_block_struct{
 					indexed in the hash index */
 
 	/* These 6 fields may only be modified when we have
-	an x-latch on btr_search_latch AND
+	an x-latch on the latch of the hash index partition
+	of block->index AND
 	a) we are holding an s-latch or x-latch on block->lock or
 	b) we know that block->buf_fix_count == 0.
 
@@ -856,28 +922,49 @@ struct buf_block_struct{
 
 #define BUF_BLOCK_MAGIC_N	41526563
 
-/* The buffer pool structure. NOTE! The definition appears here only for
-other modules of this directory (buf) to see it. Do not use from outside! */
+/* Statistics summed over the buffer pool instances */
+
+struct buf_pool_stat_struct{
+	ulint		n_page_gets;	/* number of page gets performed */
+	ulint		n_pages_read;	/* number read operations */
+	ulint		n_pages_written;/* number write operations */
+	ulint		n_pages_created;/* number of pages created in the pool
+					with no read */
+	ulint		n_pend_reads;	/* number of pending read operations */
+	ulint		LRU_len;	/* length of the LRU lists */
+	ulint		free_len;	/* length of the free lists */
+	ulint		flush_list_len;	/* length of the flush lists */
+	ulint		curr_size;	/* current pool size in pages */
+	ulint		max_size;	/* number of control blocks */
+};
+
+/* The buffer pool instance structure. NOTE! The definition appears here only
+for other modules of this directory (buf) to see it. Do not use from
+outside! */
 
 struct buf_pool_struct{
 
 	/* 1. General fields */
 
 	mutex_t		mutex;		/* mutex protecting the buffer pool
-					struct and control blocks, except the
-					read-write lock in them */
+					instance and its control blocks,
+					except the read-write lock in them */
 	byte*		frame_mem;	/* pointer to the memory area which
-					was allocated for the frames; in AWE
-					this is the virtual address space
-					window where we map pages stored
-					in physical memory */
-	byte*		frame_zero;	/* pointer to the first buffer frame:
-					this may differ from frame_mem, because
-					this is aligned by the frame size */
+					was allocated for the frames of all
+					the instances; in AWE this is the
+					virtual address space window where
+					we map pages stored in physical
+					memory */
+	byte*		frame_zero;	/* pointer to the first buffer frame
+					of this instance: in the first
+					instance this may differ from
+					frame_mem, because this is aligned by
+					the frame size */
 	byte*		high_end;	/* pointer to the end of the buffer
-					frames */
+					frames of this instance */
 	ulint		n_frames;	/* number of frames */
-	buf_block_t*	blocks;		/* array of buffer control blocks */
+	buf_block_t*	blocks;		/* array of buffer control blocks of
+					this instance */
 	buf_block_t**	blocks_of_frames;/* inverse mapping which can be used
 					to retrieve the buffer control block
 					of a frame; this is an array which
@@ -888,7 +975,10 @@ struct buf_pool_struct{
 					for each frame, even if the frame does
 					not contain any data; note that in AWE
 					there are more control blocks than
-					buffer frames */
+					buffer frames; the arrays of the
+					instances are consecutive parts of
+					one array, which buf_block_align()
+					uses for all the frames */
 	os_awe_t*	awe_info;	/* if AWE is used, AWE info for the
 					physical 4 kB memory pages associated
 					with buffer frames */
@@ -955,6 +1045,11 @@ struct buf_pool_struct{
 					this is incremented by one; this is
 					set to zero when a buffer block is
 					allocated */
+	dulint		page_cleaner_lsn;/* the page cleaner of this instance
+					should flush the blocks whose
+					oldest_modification is smaller than
+					this; ut_dulint_zero if there is no
+					such request */
 
 	/* 3. LRU replacement algorithm fields */
 
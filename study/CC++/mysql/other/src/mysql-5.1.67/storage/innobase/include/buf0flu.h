@@ -13,6 +13,10 @@ Created 11/5/1995 Heikki Tuuri
 #include "buf0types.h"
 #include "ut0byte.h"
 #include "mtr0types.h"
+#include "os0thread.h"
+
+/* Number of page cleaner threads running; protected by kernel_mutex */
+extern ulint	buf_flush_n_page_cleaners;
 
 /************************************************************************
 Updates the flush system data structures when a write is completed. */
@@ -22,12 +26,20 @@ buf_flush_write_complete(
 /*=====================*/
 	buf_block_t*	block);	/* in: pointer to the block in question */
 /*************************************************************************
-Flushes pages from the end of the LRU list if there is too small
-a margin of replaceable pages there. */
+Flushes pages from the end of the LRU list of a buffer pool instance if there
+is too small a margin of replaceable pages there. */
 
 void
-buf_flush_free_margin(void);
-/*=======================*/
+buf_flush_free_margin(
+/*==================*/
+	buf_pool_t*	buf_pool);	/* in: buffer pool instance */
+/*************************************************************************
+Flushes pages from the end of the LRU lists of all the buffer pool instances
+where the margin of replaceable pages is too small. */
+
+void
+buf_flush_free_margins(void);
+/*========================*/
 /************************************************************************
 Initializes a page for writing to the tablespace. */
 
@@ -53,7 +65,8 @@ buf_flush_page_try(
 	buf_block_t*	block);		/*!< in/out: buffer control block */
 #endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
 /***********************************************************************
-This utility flushes dirty blocks from the end of the LRU list or flush_list.
+This utility flushes dirty blocks from the end of the LRU list or flush_list
+of a buffer pool instance.
 NOTE 1: in the case of an LRU flush the calling thread may own latches to
 pages: to avoid deadlocks, this function must be written so that it cannot
 end up waiting for these latches! NOTE 2: in the case of a flush list flush,
@@ -63,7 +76,9 @@ ulint
 buf_flush_batch(
 /*============*/
 				/* out: number of blocks for which the write
-				request was queued */
+				request was queued; ULINT_UNDEFINED if there
+				was a flush of the same type already running */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance */
 	ulint	flush_type,	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST; if
 				BUF_FLUSH_LIST, then the caller must not own
 				any latches on pages */
@@ -74,13 +89,51 @@ buf_flush_batch(
 				oldest_modification is smaller than this
 				should be flushed (if their number does not
 				exceed min_n), otherwise ignored */
+/***********************************************************************
+Flushes dirty blocks from the end of the flush lists of all the buffer pool
+instances. The calling thread is not allowed to own any latches on pages! */
+
+ulint
+buf_flush_list(
+/*===========*/
+				/* out: number of blocks for which the write
+				request was queued; ULINT_UNDEFINED if there
+				was a flush list flush already running in
+				some instance, which was then skipped */
+	ulint	min_n,		/* in: wished minimum mumber of blocks flushed
+				(it is not guaranteed that the actual number
+				is that big, though) */
+	dulint	lsn_limit);	/* in: all blocks whose oldest_modification
+				is smaller than this should be flushed (if
+				their number does not exceed min_n) */
+/*************************************************************************
+Asks the page cleaners to flush the blocks whose oldest modification is
+below lsn_limit. */
+
+void
+buf_flush_request_page_cleaners(
+/*============================*/
+	dulint	lsn_limit);	/* in: the blocks whose oldest_modification
+				is smaller than this should be flushed */
+/*************************************************************************
+The page cleaner thread of a buffer pool instance. It flushes the end of the
+LRU list and the flush list of the instance in the background. */
+
+os_thread_ret_t
+buf_flush_page_cleaner_thread(
+/*==========================*/
+			/* out: a dummy parameter */
+	void*	arg);	/* in: pointer to the index of the buffer pool
+			instance, an ulint */
 /**********************************************************************
 Waits until a flush batch of the given type ends */
 
 void
 buf_flush_wait_batch_end(
 /*=====================*/
-	ulint	type);	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance, or NULL to
+				wait for the batches of all the instances */
+	ulint		type);	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 /************************************************************************
 This function should be called at a mini-transaction commit, if a page was
 modified in it. Puts the block to the list of modified blocks, if it not
@@ -112,7 +165,7 @@ buf_flush_ready_for_replace(
 	buf_block_t*	block);	/* in: buffer control block, must be in state
 				BUF_BLOCK_FILE_PAGE and in the LRU list */
 /**********************************************************************
-Validates the flush list. */
+Validates the flush lists. */
 
 ibool
 buf_flush_validate(void);
@@ -122,10 +175,10 @@ buf_flush_validate(void);
 /* When buf_flush_free_margin is called, it tries to make this many blocks
 available to replacement in the free list and at the end of the LRU list (to
 make sure that a read-ahead batch can be read efficiently in a single
-sweep). */
+sweep). The margins are per buffer pool instance b. */
 
-#define BUF_FLUSH_FREE_BLOCK_MARGIN	(5 + BUF_READ_AHEAD_AREA)
-#define BUF_FLUSH_EXTRA_MARGIN		(BUF_FLUSH_FREE_BLOCK_MARGIN / 4 + 100)
+#define BUF_FLUSH_FREE_BLOCK_MARGIN(b)	(5 + BUF_READ_AHEAD_AREA(b))
+#define BUF_FLUSH_EXTRA_MARGIN(b)	(BUF_FLUSH_FREE_BLOCK_MARGIN(b) / 4 + 100)
 
 #ifndef UNIV_NONINL
 #include "buf0flu.ic"
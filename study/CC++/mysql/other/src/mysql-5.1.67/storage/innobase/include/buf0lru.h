@@ -23,8 +23,10 @@ operations need new buffer blocks, and the i/o work done in flushing would be
 wasted. */
 
 void
-buf_LRU_try_free_flushed_blocks(void);
-/*==================================*/
+buf_LRU_try_free_flushed_blocks(
+/*============================*/
+	buf_pool_t*	buf_pool);	/* in: buffer pool instance, or NULL
+					for all the instances */
 /**********************************************************************
 Returns TRUE if less than 25 % of the buffer pool is available. This can be
 used in heuristics to prevent huge transactions eating up the whole buffer
@@ -44,7 +46,7 @@ These are low-level functions
 
 #define BUF_LRU_OLD_MIN_LEN	80
 
-#define BUF_LRU_FREE_SEARCH_LEN		(5 + 2 * BUF_READ_AHEAD_AREA)
+#define BUF_LRU_FREE_SEARCH_LEN(b)	(5 + 2 * BUF_READ_AHEAD_AREA(b))
 
 /**********************************************************************
 Invalidates all pages belonging to a given tablespace when we are deleting
@@ -62,11 +64,14 @@ Gets the minimum LRU_position field for the blocks in an initial segment
 guaranteed to be precise, because the ulint_clock may wrap around. */
 
 ulint
-buf_LRU_get_recent_limit(void);
-/*==========================*/
-			/* out: the limit; zero if could not determine it */
+buf_LRU_get_recent_limit(
+/*=====================*/
+				/* out: the limit; zero if could not
+				determine it */
+	buf_pool_t*	buf_pool);/* in: buffer pool instance */
 /**********************************************************************
-Try to put a block from the LRU list to the free list. */
+Try to put a block from the LRU list to the free list. The caller must hold
+the mutex of the buffer pool instance of the block. */
 
 ibool
 buf_LRU_free_block(
@@ -81,6 +86,7 @@ ibool
 buf_LRU_search_and_free_block(
 /*==========================*/
 				/* out: TRUE if freed */
+	buf_pool_t*	buf_pool,/* in: buffer pool instance */
 	ulint	n_iterations);	 /* in: how many times this has been called
 				repeatedly without result: a high value means
 				that we should search farther; if value is
@@ -88,16 +94,17 @@ buf_LRU_search_and_free_block(
 				of pages in the buffer pool from the end
 				of the LRU list */
 /**********************************************************************
-Returns a free block from the buf_pool. The block is taken off the
-free list. If it is empty, blocks are moved from the end of the
+Returns a free block from a buffer pool instance. The block is taken off
+the free list. If it is empty, blocks are moved from the end of the
 LRU list to the free list. */
 
 buf_block_t*
-buf_LRU_get_free_block(void);
-/*=========================*/
+buf_LRU_get_free_block(
+/*===================*/
 				/* out: the free control block; also if AWE is
 				used, it is guaranteed that the block has its
 				page mapped to a frame when we return */
+	buf_pool_t*	buf_pool);/* in: buffer pool instance */
 /**********************************************************************
 Puts a block back to the free list. */
 
@@ -90,10 +90,11 @@ buf_read_recv_pages(
 	ulint	n_stored);	/* in: number of page numbers in the array */
 
 /* The size in pages of the area which the read-ahead algorithms read if
-invoked */
+invoked in the buffer pool instance b; never more than the 64 pages which
+buf_pool_get() keeps in the same instance */
 
-#define	BUF_READ_AHEAD_AREA					\
-	ut_min(64, ut_2_power_up(buf_pool->curr_size / 32))
+#define	BUF_READ_AHEAD_AREA(b)					\
+	ut_min(64, ut_2_power_up((b)->curr_size / 32))
 
 /* Modes used in read-ahead */
 #define BUF_READ_IBUF_PAGES_ONLY	131
@@ -56,25 +56,6 @@ log_calc_where_lsn_is(
 						files */
 	ib_longlong	log_file_size);		/* in: log file size
 						(including the header) */
-/****************************************************************
-Writes to the log the string given. The log must be released with
-log_release. */
-UNIV_INLINE
-dulint
-log_reserve_and_write_fast(
-/*=======================*/
-			/* out: end lsn of the log record, ut_dulint_zero if
-			did not succeed */
-	byte*	str,	/* in: string */
-	ulint	len,	/* in: string length */
-	dulint*	start_lsn,/* out: start lsn of the log record */
-	ibool*	success);/* out: TRUE if success */
-/***************************************************************************
-Releases the log mutex. */
-UNIV_INLINE
-void
-log_release(void);
-/*=============*/
 /***************************************************************************
 Checks if there is need for a log buffer flush or a new checkpoint, and does
 this if yes. Any database operation should call this when it has modified
@@ -85,30 +66,48 @@ void
 log_free_check(void);
 /*================*/
 /****************************************************************
-Opens the log for log_write_low. The log must be closed with log_close and
-released with log_release. */
+Reserves space in the log buffer for a log record group. No latch is held
+when this returns: the space is reserved by advancing log_sys->reserved_lsn
+atomically. The string must be copied with log_write_low, after which the
+log must be closed with log_close and released with log_release. */
 
 dulint
 log_reserve_and_open(
 /*=================*/
-			/* out: start lsn of the log record */
-	ulint	len);	/* in: length of data to be catenated */
+			/* out: start lsn of the log record group */
+	ulint	len,	/* in: length of data to be catenated */
+	dulint*	end_lsn);/* out: end lsn of the log record group */
 /****************************************************************
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Copies a string to the log buffer at an lsn within space reserved with
+log_reserve_and_open. Several threads may copy to the log buffer at the same
+time. */
 
-void
+dulint
 log_write_low(
 /*==========*/
+				/* out: lsn after the string */
 	byte*	str,		/* in: string */
-	ulint	str_len);	/* in: string length */
+	ulint	str_len,	/* in: string length */
+	dulint	lsn);		/* in: lsn where to copy the string */
 /****************************************************************
-Closes the log. */
+Closes the log after the log record group has been copied. Waits until the
+log record groups reserved before this one have been released, so that the
+caller can add the modified pages to the flush lists in the lsn order. */
 
-dulint
-log_close(void);
-/*===========*/
-			/* out: lsn */
+void
+log_close(
+/*======*/
+	dulint	start_lsn,	/* in: start lsn of the log record group */
+	dulint	end_lsn);	/* in: end lsn of the log record group */
+/***************************************************************************
+Releases the log: advances the current lsn past the log record group, which
+allows the next log record group to be released and the log to be written
+up to it. */
+
+void
+log_release(
+/*========*/
+	dulint	end_lsn);	/* in: end lsn of the log record group */
 /****************************************************************
 Gets the current lsn. */
 UNIV_INLINE
@@ -122,6 +121,16 @@ Initializes the log. */
 void
 log_init(void);
 /*==========*/
+/**********************************************************
+Makes the log buffer continue from a given lsn, after the log has been
+recovered or reset. The caller must own the log mutex. */
+
+void
+log_buf_init_at_lsn(
+/*================*/
+	dulint	lsn,	/* in: the new current lsn */
+	byte*	block);	/* in: the log block containing lsn, or NULL if the
+			block should be initialized */
 /**********************************************************************
 Inits a log group to the log system. */
 
@@ -493,8 +502,8 @@ Peeks the current lsn. */
 ibool
 log_peek_lsn(
 /*=========*/
-			/* out: TRUE if success, FALSE if could not get the
-			log system mutex */
+			/* out: TRUE; the current lsn can be read without
+			the log system mutex */
        dulint*	lsn);	/* out: if returns TRUE, current lsn is here */
 /**************************************************************************
 Refreshes the statistics used to print per-second averages. */
@@ -684,20 +693,44 @@ struct log_struct{
 	byte		pad[64];	/* padding to prevent other memory
 					update hotspots from residing on the
 					same memory cache line */
-	dulint		lsn;		/* log sequence number */
-	ulint		buf_free;	/* first free offset within the log
-					buffer */
-	mutex_t		mutex;		/* mutex protecting the log */
-	byte*		buf;		/* log buffer */
+	ib_ulonglong	reserved_lsn;	/* end of the log space reserved by
+					mini-transactions; a mini-transaction
+					reserves the space for its log records
+					by advancing this atomically, and then
+					copies the records to the log buffer
+					without holding any latch */
+	byte		pad1[64];	/* padding between the fields updated
+					by log_reserve_and_open and by
+					log_release */
+	ib_ulonglong	ready_lsn;	/* log sequence number: all the log
+					record groups below this lsn have been
+					copied to the log buffer, and the pages
+					they modified are in the flush lists;
+					the mini-transactions advance this in
+					log_release in the order of their
+					reservations */
+	ib_ulonglong	buf_limit_lsn;	/* log may be copied to the log buffer
+					up to this lsn without overwriting log
+					which has not yet been written to the
+					log files */
+#ifndef HAVE_ATOMIC_BUILTINS_64
+	mutex_t		lsn_mutex;	/* protects the three fields above on
+					platforms without 64-bit atomic
+					operations */
+#endif /* !HAVE_ATOMIC_BUILTINS_64 */
+	mutex_t		mutex;		/* mutex protecting the log writes
+					and checkpoints */
+	byte*		buf;		/* log buffer: the log block which
+					contains lsn is at the offset
+					lsn % buf_size */
 	ulint		buf_size;	/* log buffer size in bytes */
-	ulint		max_buf_free;	/* recommended maximum value of
-					buf_free, after which the buffer is
-					flushed */
-	ulint		old_buf_free;	/* value of buf free when log was
-					last time opened; only in the debug
-					version */
-	dulint		old_lsn;	/* value of lsn when log was last time
-					opened; only in the debug version */
+	ulint		max_buf_free;	/* recommended maximum amount of
+					unwritten log in the buffer, after
+					which the buffer is flushed */
+	byte*		write_buf;	/* the last, incomplete block of a log
+					write is copied here, so that the block
+					which is written does not change while
+					other threads copy to the log buffer */
 	ibool		check_flush_or_checkpoint;
 					/* this is set to TRUE when there may
 					be need to flush the log buffer, or
@@ -712,13 +745,6 @@ struct log_struct{
 
 	/* The fields involved in the log buffer flush */
 
-	ulint		buf_next_to_write;/* first offset in the log buffer
-					where the byte content may not exist
-					written to file, e.g., the start
-					offset of a log record catenated
-					later; this is advanced when a flush
-					operation is completed to all the log
-					groups */
 	dulint		written_to_some_lsn;
 					/* first log sequence number not yet
 					written to any log group; for this to
@@ -733,10 +759,6 @@ struct log_struct{
 					log groups */
 	dulint		write_lsn;	/* end lsn for the current running
 					write */
-	ulint		write_end_offset;/* the data in buffer has been written
-					up to this offset when the current
-					write ends: this field will then
-					be copied to buf_next_to_write */
 	dulint		current_flush_lsn;/* end lsn for the current running
 					write + flush operation */
 	dulint		flushed_to_disk_lsn;
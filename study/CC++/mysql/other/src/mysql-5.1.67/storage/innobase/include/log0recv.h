@@ -313,6 +313,15 @@ struct recv_sys_struct{
 	hash_table_t*	addr_hash;/* hash table of file addresses of pages */
 	ulint		n_addrs;/* number of not processed hashed file
 				addresses in the hash table */
+	ulint		n_apply_threads;
+				/* number of threads which scan the hash
+				table in the current log rec application
+				batch; thread i applies the hash cells i,
+				i + n_apply_threads, ... */
+	ulint		n_apply_threads_active;
+				/* number of those threads which have not
+				yet finished their part of the batch;
+				protected by mutex */
 };
 
 extern recv_sys_t*	recv_sys;
@@ -342,6 +351,9 @@ roll-forward */
 
 extern ulint	recv_n_pool_free_frames;
 
+/* Maximum number of threads applying a log rec application batch */
+#define RECV_MAX_N_APPLY_THREADS	64
+
 #ifndef UNIV_NONINL
 #include "log0recv.ic"
 #endif
@@ -41,6 +41,19 @@ extern ulint	os_n_pending_writes;
 
 #endif
 
+#if defined(__linux__) && !defined(UNIV_HOTBACKUP) && !defined(POSIX_ASYNC_IO)
+#include <sys/syscall.h>
+# if defined(__NR_io_setup) && defined(__NR_io_submit) \
+	&& defined(__NR_io_getevents) && defined(__NR_io_destroy)
+
+/* Linux kernel aio is used through the io_setup, io_submit and
+io_getevents system calls; we check at run-time whether the kernel
+supports it, and fall back to simulated aio if not */
+#define LINUX_NATIVE_AIO
+
+# endif
+#endif
+
 #ifdef __WIN__
 #define os_file_t	HANDLE
 #else
@@ -670,6 +683,40 @@ os_aio_posix_handle(
 				restart the operation, for example */
 	void**	message2);
 #endif
+#ifdef LINUX_NATIVE_AIO
+/**************************************************************************
+Checks if the running kernel supports Linux native aio, by setting up an
+aio context and doing a test write and read through it on a temporary
+file. */
+
+ibool
+os_aio_linux_native_supported(void);
+/*================================*/
+				/* out: TRUE if supported */
+/**************************************************************************
+This function is only used in Linux native asynchronous i/o. Waits for an
+aio operation in the segment to complete; the kernel completion events are
+reaped with io_getevents. NOTE: this function will also take care of
+freeing the aio slot, therefore no other thread is allowed to do the
+freeing! */
+
+ibool
+os_aio_linux_handle(
+/*================*/
+				/* out: TRUE if the aio operation succeeded */
+	ulint	segment,	/* in: the number of the segment in the aio
+				arrays to wait for; segment 0 is the ibuf
+				i/o thread, segment 1 the log i/o thread,
+				then follow the non-ibuf read threads, and as
+				the last are the non-ibuf write threads */
+	fil_node_t**message1,	/* out: the messages passed with the aio
+				request; note that also in the case where
+				the aio operation failed, these output
+				parameters are valid and can be used to
+				restart the operation, for example */
+	void**	message2,
+	ulint*	type);		/* out: OS_FILE_WRITE or ..._READ */
+#endif /* LINUX_NATIVE_AIO */
 /**************************************************************************
 Does simulated aio. This function should be called by an i/o-handler
 thread. */
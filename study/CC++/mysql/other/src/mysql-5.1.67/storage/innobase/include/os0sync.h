@@ -261,6 +261,24 @@ os_fast_mutex_free(
 /*===============*/
 	os_fast_mutex_t*	fast_mutex);	/* in: mutex to free */
 
+#if defined(HAVE_GCC_ATOMIC_BUILTINS) && SIZEOF_LONG == 8
+/* Atomic operations on 64-bit integers. The log system uses these to reserve
+space in the log buffer without holding log_sys->mutex. */
+#define HAVE_ATOMIC_BUILTINS_64
+
+/**************************************************************
+Compares *ptr to old_val and, if they are equal, stores new_val to *ptr.
+Returns TRUE if the swap was done. This is a full memory barrier. */
+# define os_compare_and_swap_ull(ptr, old_val, new_val) \
+	__sync_bool_compare_and_swap(ptr, old_val, new_val)
+
+/**************************************************************
+Reads *ptr. This is a full memory barrier: the memory updates done before
+the value was stored with os_compare_and_swap_ull() are visible after it. */
+# define os_atomic_read_ull(ptr) \
+	__sync_add_and_fetch(ptr, 0)
+#endif /* HAVE_GCC_ATOMIC_BUILTINS && SIZEOF_LONG == 8 */
+
 #ifndef UNIV_NONINL
 #include "os0sync.ic"
 #endif
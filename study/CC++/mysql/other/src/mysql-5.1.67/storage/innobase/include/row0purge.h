@@ -25,9 +25,24 @@ purge_node_t*
 row_purge_node_create(
 /*==================*/
 				/* out, own: purge node */
-	que_thr_t*	parent,	/* in: parent node, i.e., a thr node */
+	que_thr_t*	parent,	/* in: parent node, i.e., a thr node, or
+				NULL if the node is used outside a query
+				graph */
 	mem_heap_t*	heap);	/* in: memory heap where created */
 /***************************************************************
+Does the purge for the operation recorded in an undo log record fetched
+from the history list. The caller must keep the history from being
+truncated until this returns. */
+
+void
+row_purge_undo_rec(
+/*===============*/
+	purge_node_t*	node,	/* in: row purge node */
+	trx_undo_rec_t*	undo_rec,/* in: copy of the undo log record, or
+				&trx_purge_dummy_rec */
+	dulint		roll_ptr,/* in: roll pointer to the record */
+	trx_t*		trx);	/* in: purge transaction */
+/***************************************************************
 Does the purge operation for a single undo log record. This is a high-level
 function used in an SQL execution graph. */
 
@@ -85,12 +85,22 @@ extern ulong	srv_flush_log_at_trx_commit;
 extern byte	srv_latin1_ordering[256];/* The sort order table of the latin1
 					character set */
 extern ulint	srv_pool_size;
+extern ulint	srv_buf_pool_instances;
 extern ulint	srv_awe_window_size;
 extern ulint	srv_mem_pool_size;
 extern ulint	srv_lock_table_size;
 
 extern ulint	srv_n_file_io_threads;
 
+/* Number of threads which apply the hashed redo log records to pages in a
+crash recovery batch */
+extern ulint	srv_n_recv_threads;
+
+/* Number of purge threads: 0 runs purge in the master thread, 1 in a
+separate purge thread, and n > 1 in a purge coordinator thread which hands
+the undo log records to n purge worker threads */
+extern ulint	srv_n_purge_threads;
+
 /* The "innodb_stats_method" setting, decides how InnoDB is going
 to treat NULL value when collecting statistics. It is not defined
 as enum type because the configure option takes unsigned integer type. */
@@ -131,13 +141,33 @@ extern ibool	srv_innodb_status;
 extern ibool	srv_use_doublewrite_buf;
 extern ibool	srv_use_checksums;
 
+/* The checksum algorithm of the pages InnoDB writes, a value of
+srv_checksum_algorithm_enum */
+extern ulong	srv_checksum_algorithm;
+
+/* If TRUE, use the native asynchronous i/o of the OS where InnoDB
+supports it (Linux kernel aio); FALSE forces simulated aio */
+extern ibool	srv_use_native_aio;
+
 extern ibool	srv_set_thread_priorities;
 extern int	srv_query_thread_priority;
 
 extern ulong	srv_max_buf_pool_modified_pct;
 extern ulong	srv_max_purge_lag;
+extern ulong	srv_max_purge_lag_delay;
+
+extern ulong	srv_io_capacity;
+extern ulong	srv_io_capacity_max;
+extern char	srv_adaptive_flushing;
+extern ulong	srv_adaptive_flushing_lwm;
+
+/* The number of pages which is p percent of the i/o capacity */
+#define SRV_PCT_IO(p)	((ulint) (srv_io_capacity * (p) / 100))
 extern ibool	srv_use_awe;
 extern ibool	srv_use_adaptive_hash_indexes;
+/* Number of partitions of the adaptive hash index; each partition has its
+own hash table and latch, and an index is mapped to one by its id */
+extern ulint	srv_n_adaptive_hash_parts;
 /*-------------------------------------------*/
 
 extern ulint	srv_n_rows_inserted;
@@ -184,6 +214,12 @@ extern mutex_t*	kernel_mutex_temp;/* mutex protecting the server, trx structs,
 
 #define SRV_MAX_N_IO_THREADS	100
 
+/* Maximum number of purge worker threads */
+#define SRV_MAX_N_PURGE_THREADS	32
+
+/* Maximum number of adaptive hash index partitions */
+#define SRV_MAX_N_ADAPTIVE_HASH_PARTS	64
+
 /* Array of English strings describing the current state of an
 i/o handler thread */
 extern const char* srv_io_thread_op_info[];
@@ -231,6 +267,22 @@ extern ulint srv_buf_pool_wait_free;
 buffer pool to disk */
 extern ulint srv_buf_pool_flushed;
 
+/* the numbers of pages the page cleaner threads have flushed from the
+end of the LRU lists and from the flush lists */
+extern ulint srv_page_cleaner_lru_flushed;
+extern ulint srv_page_cleaner_list_flushed;
+
+/* number of times a user thread left a preflush for a younger checkpoint
+to the page cleaners instead of doing it itself */
+extern ulint srv_page_cleaner_requests;
+
+/* number of pages the adaptive flushing has flushed */
+extern ulint srv_adaptive_flushed;
+
+/* the redo generation rate last estimated by the page cleaners, in bytes
+per second */
+extern ulint srv_redo_rate;
+
 /* variable to count the number of buffer pool reads that led to the
 reading of a disk page */
 extern ulint srv_buf_pool_reads;
@@ -305,6 +357,19 @@ enum srv_stats_method_name_enum {
 
 typedef enum srv_stats_method_name_enum		srv_stats_method_name_t;
 
+/* Alternatives for srv_checksum_algorithm, which could be changed by
+setting innodb_checksum_algorithm. A page written with any of them is
+accepted when it is read. */
+enum srv_checksum_algorithm_enum {
+	SRV_CHECKSUM_ALGORITHM_INNODB,	/* buf_calc_page_new_checksum() and
+					buf_calc_page_old_checksum(); this
+					is the default */
+	SRV_CHECKSUM_ALGORITHM_CRC32,	/* buf_calc_page_crc32() stored to
+					both checksum fields */
+	SRV_CHECKSUM_ALGORITHM_NONE	/* BUF_NO_CHECKSUM_MAGIC stored to
+					both checksum fields */
+};
+
 /*************************************************************************
 Boots Innobase server. */
 
@@ -560,6 +625,18 @@ struct export_var_struct{
 	ulint innodb_pages_created;
 	ulint innodb_pages_read;
 	ulint innodb_pages_written;
+	ulint innodb_page_cleaner_threads;
+	ulint innodb_history_list_length;
+	ulint innodb_purge_threads;
+	ulint innodb_adaptive_hash_hits;
+	ulint innodb_adaptive_hash_misses;
+	ulint innodb_page_cleaner_lru_flushed;
+	ulint innodb_page_cleaner_list_flushed;
+	ulint innodb_page_cleaner_requests;
+	ulint innodb_checkpoint_age;
+	ulint innodb_checkpoint_max_age;
+	ulint innodb_redo_rate;
+	ulint innodb_adaptive_flushed;
 	ulint innodb_row_lock_waits;
 	ulint innodb_row_lock_current_waits;
 	ib_longlong innodb_row_lock_time;
@@ -17,6 +17,8 @@ Created 3/26/1996 Heikki Tuuri
 #include "page0page.h"
 #include "usr0sess.h"
 #include "fil0fil.h"
+#include "row0types.h"
+#include "os0thread.h"
 
 /* The global data structure coordinating a purge */
 extern trx_purge_t*	purge_sys;
@@ -25,6 +27,10 @@ extern trx_purge_t*	purge_sys;
 which needs no purge */
 extern trx_undo_rec_t	trx_purge_dummy_rec;
 
+/* Number of purge threads (the coordinator and the workers) which have
+not exited */
+extern ulint		trx_purge_n_threads;
+
 /************************************************************************
 Calculates the file address of an undo log header when we have the file
 address of its history list node. */
@@ -94,6 +100,30 @@ trx_purge(void);
 /*===========*/
 				/* out: number of undo log pages handled in
 				the batch */
+/*************************************************************************
+The purge coordinator thread. It runs the purge batches, which the master
+thread runs when there are no purge threads. If there are purge worker
+threads, the coordinator hands the undo log records of a batch to them,
+the records of one table always to the same worker, and waits until they
+have purged them. In a fast shutdown the thread exits at once, in a slow
+shutdown when the history list has been purged. */
+
+os_thread_ret_t
+trx_purge_coordinator_thread(
+/*=========================*/
+			/* out: a dummy parameter */
+	void*	arg);	/* in: a dummy parameter required by
+			os_thread_create */
+/*************************************************************************
+A purge worker thread. It purges the undo log records which the
+coordinator has handed to it, and exits when the coordinator exits. */
+
+os_thread_ret_t
+trx_purge_worker_thread(
+/*====================*/
+			/* out: a dummy parameter */
+	void*	arg);	/* in: pointer to the index of the worker,
+			an ulint */
 /**********************************************************************
 Prints information of the purge system to stderr. */
 
@@ -157,6 +187,41 @@ struct trx_purge_struct{
 	mem_heap_t*	heap;		/* Temporary storage used during a
 					purge: can be emptied after purge
 					completes */
+	/*-----------------------------*/
+	ulint		n_workers;	/* Number of purge worker threads, 0
+					if the batch is run by the query graph
+					in the thread calling trx_purge() */
+	trx_purge_worker_t* workers;	/* Array of the worker states */
+	mem_heap_t*	rec_heap;	/* Copies of the undo log records
+					handed to the workers in the current
+					batch */
+	ulint		n_busy;		/* Number of workers which have not
+					yet purged their records of the
+					current batch; protected by mutex */
+	os_event_t	batch_done;	/* Set when n_busy drops to 0 */
+	ibool		workers_exit;	/* TRUE when the workers should
+					exit */
+};
+
+/* An undo log record handed to a purge worker */
+struct trx_purge_rec_struct{
+	trx_undo_rec_t*	undo_rec;	/* copy of the undo log record */
+	dulint		roll_ptr;	/* roll pointer to the record */
+	trx_purge_rec_t* next;		/* next record of the same worker */
+};
+
+/* The state of a purge worker thread */
+struct trx_purge_worker_struct{
+	trx_t*		trx;		/* Transaction of the worker, used
+					in freezing the data dictionary */
+	purge_node_t*	node;		/* Purge node of the worker */
+	trx_purge_rec_t* first;		/* First record to purge in the
+					current batch, or NULL */
+	trx_purge_rec_t* last;		/* Last record to purge in the
+					current batch */
+	ulint		n_recs;		/* Number of records in the list */
+	os_event_t	event;		/* Set when the worker has got records
+					to purge, or should exit */
 };
 
 #define TRX_PURGE_ON		1	/* purge operation is running */
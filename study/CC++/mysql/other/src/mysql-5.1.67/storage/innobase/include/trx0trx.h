@@ -15,6 +15,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "usr0types.h"
 #include "que0types.h"
 #include "mem0mem.h"
+#include "sync0rw.h"
 #include "read0types.h"
 #include "dict0types.h"
 #include "trx0xa.h"
@@ -480,6 +481,9 @@ struct trx_struct{
 	ibool		has_search_latch;
 					/* TRUE if this trx has latched the
 					search system latch in S-mode */
+	rw_lock_t*	search_latch;	/* if has_search_latch, the latch of
+					the adaptive hash index partition
+					which this trx holds in S-mode */
 	ulint		search_latch_timeout;
 					/* If we notice that someone is
 					waiting for our S-lock on the search
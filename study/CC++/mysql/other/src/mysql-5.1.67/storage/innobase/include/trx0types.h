@@ -22,6 +22,8 @@ typedef struct trx_undo_struct	trx_undo_t;
 typedef struct trx_undo_arr_struct trx_undo_arr_t;
 typedef struct trx_undo_inf_struct trx_undo_inf_t;
 typedef struct trx_purge_struct	trx_purge_t;
+typedef struct trx_purge_worker_struct trx_purge_worker_t;
+typedef struct trx_purge_rec_struct trx_purge_rec_t;
 typedef struct roll_node_struct	roll_node_t;
 typedef struct commit_node_struct commit_node_t;
 typedef struct trx_named_savept_struct trx_named_savept_t;
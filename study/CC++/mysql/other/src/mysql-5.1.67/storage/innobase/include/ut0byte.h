@@ -64,6 +64,14 @@ ut_conv_dulint_to_longlong(
 			/* out: value in ib_longlong type */
 	dulint	d);	/* in: dulint */
 /***********************************************************
+Converts a 64-bit integer to a dulint. */
+UNIV_INLINE
+dulint
+ut_conv_ulonglong_to_dulint(
+/*========================*/
+				/* out: value in dulint type */
+	ib_ulonglong	n);	/* in: 64-bit integer */
+/***********************************************************
 Tests if a dulint is zero. */
 UNIV_INLINE
 ibool
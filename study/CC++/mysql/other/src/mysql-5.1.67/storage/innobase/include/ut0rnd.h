@@ -112,7 +112,27 @@ ut_find_prime(
 /*==========*/
 			/* out: prime */
 	ulint	 n);	 /* in: positive number > 100 */
+/*****************************************************************
+Initializes the tables of the software CRC-32C and checks if the CPU has
+the SSE4.2 crc32 instruction. Must be called before ut_crc32c(). */
+
+void
+ut_crc32c_init(void);
+/*================*/
+/*****************************************************************
+Calculates the CRC-32C (Castagnoli) checksum of a string of bytes. Uses the
+SSE4.2 crc32 instruction if the CPU has it, else a table driven algorithm
+which handles 8 bytes per step. */
+
+ib_uint32_t
+ut_crc32c(
+/*======*/
+				/* out: CRC-32C checksum */
+	const byte*	buf,	/* in: string of bytes */
+	ulint		len);	/* in: length */
 
+/* TRUE if ut_crc32c() uses the SSE4.2 crc32 instruction */
+extern ibool	ut_crc32c_sse42_enabled;
 
 #ifndef UNIV_NONINL
 #include "ut0rnd.ic"
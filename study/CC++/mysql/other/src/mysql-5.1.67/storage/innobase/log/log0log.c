@@ -23,6 +23,7 @@ Created 12/9/1995 Heikki Tuuri
 #include "srv0start.h"
 #include "trx0sys.h"
 #include "trx0trx.h"
+#include "trx0purge.h"
 
 /*
 General philosophy of InnoDB redo-logs:
@@ -156,7 +157,7 @@ log_fsp_current_free_limit_set_and_checkpoint(
 }
 
 /********************************************************************
-Returns the oldest modified block lsn in the pool, or log_sys->lsn if none
+Returns the oldest modified block lsn in the pool, or the current lsn if none
 exists. */
 static
 dulint
@@ -171,194 +172,316 @@ log_buf_pool_get_oldest_modification(void)
 
 	if (ut_dulint_is_zero(lsn)) {
 
-		lsn = log_sys->lsn;
+		/* The pages modified by the log record groups below the
+		current lsn are already in the flush lists */
+
+		lsn = log_get_lsn();
 	}
 
 	return(lsn);
 }
 
+#ifdef HAVE_ATOMIC_BUILTINS_64
+# define log_lsn_cas(field, old_val, new_val)	\
+	os_compare_and_swap_ull(field, old_val, new_val)
+#else /* HAVE_ATOMIC_BUILTINS_64 */
 /****************************************************************
-Opens the log for log_write_low. The log must be closed with log_close and
-released with log_release. */
+Compares and swaps one of the lsn fields of the log system which are
+updated without holding log_sys->mutex. */
+static
+ibool
+log_lsn_cas(
+/*========*/
+				/* out: TRUE if the field was swapped */
+	ib_ulonglong*	field,	/* in/out: &log_sys->reserved_lsn,
+				ready_lsn or buf_limit_lsn */
+	ib_ulonglong	old_val,/* in: expected value of the field */
+	ib_ulonglong	new_val)/* in: new value of the field */
+{
+	ibool	success;
 
-dulint
-log_reserve_and_open(
-/*=================*/
-			/* out: start lsn of the log record */
-	ulint	len)	/* in: length of data to be catenated */
+	mutex_enter(&(log_sys->lsn_mutex));
+
+	success = (*field == old_val);
+
+	if (success) {
+		*field = new_val;
+	}
+
+	mutex_exit(&(log_sys->lsn_mutex));
+
+	return(success);
+}
+#endif /* HAVE_ATOMIC_BUILTINS_64 */
+
+/****************************************************************
+Calculates the lsn after a string catenated to the log: the lsn grows also
+by the trailers and headers of the log blocks which the string fills. */
+UNIV_INLINE
+ib_ulonglong
+log_calc_end_lsn(
+/*=============*/
+				/* out: lsn after the string */
+	ib_ulonglong	lsn,	/* in: lsn where the string starts */
+	ulint		len)	/* in: string length */
 {
-	log_t*	log			= log_sys;
-	ulint	len_upper_limit;
-#ifdef UNIV_LOG_ARCHIVE
-	ulint	archived_lsn_age;
-	ulint	dummy;
-#endif /* UNIV_LOG_ARCHIVE */
-#ifdef UNIV_DEBUG
-	ulint	count			= 0;
-#endif /* UNIV_DEBUG */
+	ulint	part_len;
 
-	ut_a(len < log->buf_size / 2);
-loop:
-	mutex_enter(&(log->mutex));
+	for (;;) {
+		part_len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			- (ulint) (lsn % OS_FILE_LOG_BLOCK_SIZE);
 
-	/* Calculate an upper limit for the space the string may take in the
-	log buffer */
+		if (len < part_len) {
 
-	len_upper_limit = LOG_BUF_WRITE_MARGIN + (5 * len) / 4;
+			return(lsn + len);
+		}
 
-	if (log->buf_free + len_upper_limit > log->buf_size) {
+		/* The string fills the block: it continues after the
+		header of the next block */
 
-		mutex_exit(&(log->mutex));
+		lsn += part_len + LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+		len -= part_len;
+	}
+}
 
-		/* Not enough free space, do a syncronous flush of the log
-		buffer */
+/****************************************************************
+Waits until the current lsn has advanced to a given lsn. */
+static
+void
+log_wait_for_lsn(
+/*=============*/
+	ib_ulonglong	lsn)	/* in: lsn to wait for */
+{
+	ulint	i	= 0;
 
-		log_buffer_flush_to_disk();
+	/* Spin on a plain read of the field, and check the value with an
+	atomic read, which also makes the log buffer contents below the lsn
+	visible to this thread */
 
-		srv_log_waits++;
+	while (*(volatile ib_ulonglong*) &log_sys->ready_lsn < lsn
+	       || log_lsn_read(&(log_sys->ready_lsn)) < lsn) {
 
-		ut_ad(++count < 50);
+		if (i < SYNC_SPIN_ROUNDS) {
+			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 
-		goto loop;
+			i++;
+		} else {
+			os_thread_yield();
+		}
 	}
+}
 
+/****************************************************************
+Reserves space in the log buffer. */
+static
+ib_ulonglong
+log_reserve_low(
+/*============*/
+				/* out: end lsn of the reserved space */
+	ulint		len,	/* in: length of data to be catenated */
+	ibool		fill,	/* in: TRUE if the rest of the current log
+				block should be reserved, instead of len
+				bytes */
+	ib_ulonglong*	start)	/* out: start lsn of the reserved space */
+{
+	log_t*		log	= log_sys;
+	ib_ulonglong	end;
 #ifdef UNIV_LOG_ARCHIVE
-	if (log->archiving_state != LOG_ARCH_OFF) {
+	ulint		archived_lsn_age;
+	ulint		dummy;
+#endif /* UNIV_LOG_ARCHIVE */
 
-		archived_lsn_age = ut_dulint_minus(log->lsn,
-						   log->archived_lsn);
-		if (archived_lsn_age + len_upper_limit
-		    > log->max_archived_lsn_age) {
-			/* Not enough free archived space in log groups: do a
-			synchronous archive write batch: */
+	ut_a(len < log->buf_size / 2);
 
-			mutex_exit(&(log->mutex));
+#ifdef UNIV_LOG_ARCHIVE
+	while (log->archiving_state != LOG_ARCH_OFF) {
+
+		mutex_enter(&(log->mutex));
 
-			ut_ad(len_upper_limit <= log->max_archived_lsn_age);
+		archived_lsn_age = ut_dulint_minus(log_get_lsn(),
+						   log->archived_lsn);
 
-			log_archive_do(TRUE, &dummy);
+		mutex_exit(&(log->mutex));
 
-			ut_ad(++count < 50);
+		if (archived_lsn_age + LOG_BUF_WRITE_MARGIN + (5 * len) / 4
+		    <= log->max_archived_lsn_age) {
 
-			goto loop;
+			break;
 		}
+
+		/* Not enough free archived space in log groups: do a
+		synchronous archive write batch: */
+
+		log_archive_do(TRUE, &dummy);
 	}
 #endif /* UNIV_LOG_ARCHIVE */
 
-#ifdef UNIV_LOG_DEBUG
-	log->old_buf_free = log->buf_free;
-	log->old_lsn = log->lsn;
-#endif
-	return(log->lsn);
+	/* Reserve the space by advancing reserved_lsn: where the string
+	ends depends on where it starts, because of the log block headers
+	and trailers */
+
+	do {
+		*start = log_lsn_read(&(log->reserved_lsn));
+
+		if (fill) {
+			len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+				- (ulint) (*start % OS_FILE_LOG_BLOCK_SIZE);
+		}
+
+		end = log_calc_end_lsn(*start, len);
+
+	} while (!log_lsn_cas(&(log->reserved_lsn), *start, end));
+
+	/* The log buffer holds the log between buf_limit_lsn - buf_size and
+	buf_limit_lsn: if the space is beyond that, wait until enough of the
+	log has been written to the log files. The log below *start can be
+	written, because its space was reserved before this; we only need to
+	wait for the log up to end - buf_size + OS_FILE_LOG_BLOCK_SIZE, which
+	is below *start. */
+
+	while (end > log_lsn_read(&(log->buf_limit_lsn))) {
+
+		log_write_up_to(ut_conv_ulonglong_to_dulint(
+					end - log->buf_size
+					+ OS_FILE_LOG_BLOCK_SIZE),
+				LOG_WAIT_ALL_GROUPS, FALSE);
+
+		srv_log_waits++;
+	}
+
+	return(end);
 }
 
 /****************************************************************
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Reserves space in the log buffer for a log record group. No latch is held
+when this returns: the space is reserved by advancing log_sys->reserved_lsn
+atomically. The string must be copied with log_write_low, after which the
+log must be closed with log_close and released with log_release. */
 
-void
+dulint
+log_reserve_and_open(
+/*=================*/
+			/* out: start lsn of the log record group */
+	ulint	len,	/* in: length of data to be catenated */
+	dulint*	end_lsn)/* out: end lsn of the log record group */
+{
+	ib_ulonglong	start;
+
+	*end_lsn = ut_conv_ulonglong_to_dulint(
+		log_reserve_low(len, FALSE, &start));
+
+	return(ut_conv_ulonglong_to_dulint(start));
+}
+
+/****************************************************************
+Copies a string to the log buffer at an lsn within space reserved with
+log_reserve_and_open. Several threads may copy to the log buffer at the same
+time: each thread writes only to its own part of the log buffer, and the
+header of a log block only if the block starts within it. The data length and
+checkpoint number fields of the log blocks are set when the blocks are
+written to the log files. */
+
+dulint
 log_write_low(
 /*==========*/
+				/* out: lsn after the string */
 	byte*	str,		/* in: string */
-	ulint	str_len)	/* in: string length */
+	ulint	str_len,	/* in: string length */
+	dulint	lsn)		/* in: lsn where to copy the string */
 {
-	log_t*	log	= log_sys;
-	ulint	len;
-	ulint	data_len;
-	byte*	log_block;
+	log_t*		log	= log_sys;
+	ib_ulonglong	pos;
+	ulint		offset;
+	ulint		len;
+	byte*		log_block;
+
+	pos = (ib_ulonglong) ut_conv_dulint_to_longlong(lsn);
 
-	ut_ad(mutex_own(&(log->mutex)));
+	srv_log_write_requests++;
 part_loop:
+	offset = (ulint) (pos % OS_FILE_LOG_BLOCK_SIZE);
+
+	log_block = log->buf + (ulint) ((pos - offset) % log->buf_size);
+
 	/* Calculate a part length */
 
-	data_len = (log->buf_free % OS_FILE_LOG_BLOCK_SIZE) + str_len;
+	len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE - offset;
 
-	if (data_len <= OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+	if (str_len < len) {
 
 		/* The string fits within the current log block */
 
-		len = str_len;
-	} else {
-		data_len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE;
+		ut_memcpy(log_block + offset, str, str_len);
 
-		len = OS_FILE_LOG_BLOCK_SIZE
-			- (log->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-			- LOG_BLOCK_TRL_SIZE;
+		return(ut_conv_ulonglong_to_dulint(pos + str_len));
 	}
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
+	ut_memcpy(log_block + offset, str, len);
 
 	str_len -= len;
 	str = str + len;
 
-	log_block = ut_align_down(log->buf + log->buf_free,
-				  OS_FILE_LOG_BLOCK_SIZE);
-	log_block_set_data_len(log_block, data_len);
-
-	if (data_len == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
-		/* This block became full */
-		log_block_set_data_len(log_block, OS_FILE_LOG_BLOCK_SIZE);
-		log_block_set_checkpoint_no(log_block,
-					    log_sys->next_checkpoint_no);
-		len += LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE;
-
-		log->lsn = ut_dulint_add(log->lsn, len);
+	/* This block became full: initialize the next block header. The
+	thread which copies to the rest of the block may be faster than us:
+	we must not touch the fields which it sets. */
 
-		/* Initialize the next block header */
-		log_block_init(log_block + OS_FILE_LOG_BLOCK_SIZE, log->lsn);
-	} else {
-		log->lsn = ut_dulint_add(log->lsn, len);
-	}
+	pos += len + LOG_BLOCK_TRL_SIZE;
 
-	log->buf_free += len;
+	log_block = log->buf + (ulint) (pos % log->buf_size);
 
-	ut_ad(log->buf_free <= log->buf_size);
+	log_block_set_hdr_no(log_block, log_block_convert_lsn_to_no(
+				     ut_conv_ulonglong_to_dulint(pos)));
+	log_block_set_first_rec_group(log_block, 0);
 
-	if (str_len > 0) {
-		goto part_loop;
-	}
+	pos += LOG_BLOCK_HDR_SIZE;
 
-	srv_log_write_requests++;
+	goto part_loop;
 }
 
 /****************************************************************
-Closes the log. */
+Closes the log after the log record group has been copied. Waits until the
+log record groups reserved before this one have been released, so that the
+caller can add the modified pages to the flush lists in the lsn order. */
 
-dulint
-log_close(void)
-/*===========*/
-			/* out: lsn */
+void
+log_close(
+/*======*/
+	dulint	start_lsn,	/* in: start lsn of the log record group */
+	dulint	end_lsn)	/* in: end lsn of the log record group */
 {
-	byte*	log_block;
-	ulint	first_rec_group;
-	dulint	oldest_lsn;
-	dulint	lsn;
-	log_t*	log	= log_sys;
-	ulint	checkpoint_age;
-
-	ut_ad(mutex_own(&(log->mutex)));
+	byte*		log_block;
+	dulint		oldest_lsn;
+	log_t*		log	= log_sys;
+	ulint		checkpoint_age;
+	ib_ulonglong	start;
+	ib_ulonglong	end;
 
-	lsn = log->lsn;
+	start = (ib_ulonglong) ut_conv_dulint_to_longlong(start_lsn);
+	end = (ib_ulonglong) ut_conv_dulint_to_longlong(end_lsn);
 
-	log_block = ut_align_down(log->buf + log->buf_free,
-				  OS_FILE_LOG_BLOCK_SIZE);
-	first_rec_group = log_block_get_first_rec_group(log_block);
+	ut_ad(start < end);
 
-	if (first_rec_group == 0) {
+	if (start / OS_FILE_LOG_BLOCK_SIZE != end / OS_FILE_LOG_BLOCK_SIZE) {
 		/* We initialized a new log block which was not written
 		full by the current mtr: the next mtr log record group
-		will start within this block at the offset data_len */
+		will start within this block at the offset where this one
+		ends */
+
+		log_block = log->buf
+			+ (ulint) ((end - end % OS_FILE_LOG_BLOCK_SIZE)
+				   % log->buf_size);
 
 		log_block_set_first_rec_group(
-			log_block, log_block_get_data_len(log_block));
+			log_block, (ulint) (end % OS_FILE_LOG_BLOCK_SIZE));
 	}
 
-	if (log->buf_free > log->max_buf_free) {
+	if (end + log->buf_size - log_lsn_read(&(log->buf_limit_lsn))
+	    > log->max_buf_free) {
 
 		log->check_flush_or_checkpoint = TRUE;
 	}
 
-	checkpoint_age = ut_dulint_minus(lsn, log->last_checkpoint_lsn);
+	checkpoint_age = ut_dulint_minus(end_lsn, log->last_checkpoint_lsn);
 
 	if (checkpoint_age >= log->log_group_capacity) {
 		/* TODO: split btr_store_big_rec_extern_fields() into small
@@ -397,20 +520,39 @@ log_close(void)
 	oldest_lsn = buf_pool_get_oldest_modification();
 
 	if (ut_dulint_is_zero(oldest_lsn)
-	    || (ut_dulint_minus(lsn, oldest_lsn)
+	    || (ut_dulint_minus(end_lsn, oldest_lsn)
 		> log->max_modified_age_async)
 	    || checkpoint_age > log->max_checkpoint_age_async) {
 
 		log->check_flush_or_checkpoint = TRUE;
 	}
 function_exit:
+	/* The flush lists must stay sorted on oldest_modification: wait
+	for our turn to add pages to them */
 
-#ifdef UNIV_LOG_DEBUG
-	log_check_log_recs(log->buf + log->old_buf_free,
-			   log->buf_free - log->old_buf_free, log->old_lsn);
-#endif
+	log_wait_for_lsn(start);
+}
 
-	return(lsn);
+/***************************************************************************
+Releases the log: advances the current lsn past the log record group, which
+allows the next log record group to be released and the log to be written
+up to it. */
+
+void
+log_release(
+/*========*/
+	dulint	end_lsn)	/* in: end lsn of the log record group */
+{
+	ib_ulonglong	ready;
+
+	ready = log_lsn_read(&(log_sys->ready_lsn));
+
+	ut_ad(ready < (ib_ulonglong) ut_conv_dulint_to_longlong(end_lsn));
+
+	/* No other thread can advance the lsn until we have done it */
+
+	ut_a(log_lsn_cas(&(log_sys->ready_lsn), ready,
+			 (ib_ulonglong) ut_conv_dulint_to_longlong(end_lsn)));
 }
 
 #ifdef UNIV_LOG_ARCHIVE
@@ -422,26 +564,21 @@ void
 log_pad_current_log_block(void)
 /*===========================*/
 {
-	byte	b		= MLOG_DUMMY_RECORD;
-	ulint	pad_length;
-	ulint	i;
-	dulint	lsn;
+	byte		b		= MLOG_DUMMY_RECORD;
+	ib_ulonglong	start;
+	ib_ulonglong	end;
+	dulint		lsn;
 
-	/* We retrieve lsn only because otherwise gcc crashed on HP-UX */
-	lsn = log_reserve_and_open(OS_FILE_LOG_BLOCK_SIZE);
+	end = log_reserve_low(0, TRUE, &start);
 
-	pad_length = OS_FILE_LOG_BLOCK_SIZE
-		- (log_sys->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-		- LOG_BLOCK_TRL_SIZE;
+	lsn = ut_conv_ulonglong_to_dulint(start);
 
-	for (i = 0; i < pad_length; i++) {
-		log_write_low(&b, 1);
+	while (ut_conv_dulint_to_longlong(lsn) < end) {
+		lsn = log_write_low(&b, 1, lsn);
 	}
 
-	lsn = log_sys->lsn;
-
-	log_close();
-	log_release();
+	log_close(ut_conv_ulonglong_to_dulint(start), lsn);
+	log_release(lsn);
 
 	ut_a((ut_dulint_get_low(lsn) % OS_FILE_LOG_BLOCK_SIZE)
 	     == LOG_BLOCK_HDR_SIZE);
@@ -736,14 +873,12 @@ log_init(void)
 	log_sys = mem_alloc(sizeof(log_t));
 
 	mutex_create(&log_sys->mutex, SYNC_LOG);
+#ifndef HAVE_ATOMIC_BUILTINS_64
+	mutex_create(&log_sys->lsn_mutex, SYNC_NO_ORDER_CHECK);
+#endif /* !HAVE_ATOMIC_BUILTINS_64 */
 
 	mutex_enter(&(log_sys->mutex));
 
-	/* Start the lsn from one log block from zero: this way every
-	log record has a start lsn != zero, a fact which we will use */
-
-	log_sys->lsn = LOG_START_LSN;
-
 	ut_a(LOG_BUFFER_SIZE >= 16 * OS_FILE_LOG_BLOCK_SIZE);
 	ut_a(LOG_BUFFER_SIZE >= 4 * UNIV_PAGE_SIZE);
 
@@ -754,6 +889,9 @@ log_init(void)
 
 	memset(log_sys->buf, '\0', LOG_BUFFER_SIZE);
 
+	log_sys->write_buf = ut_align(mem_alloc(2 * OS_FILE_LOG_BLOCK_SIZE),
+				      OS_FILE_LOG_BLOCK_SIZE);
+
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
 	log_sys->check_flush_or_checkpoint = TRUE;
@@ -765,14 +903,15 @@ log_init(void)
 	log_sys->last_printout_time = time(NULL);
 	/*----------------------------*/
 
-	log_sys->buf_next_to_write = 0;
-
 	log_sys->write_lsn = ut_dulint_zero;
 	log_sys->current_flush_lsn = ut_dulint_zero;
 	log_sys->flushed_to_disk_lsn = ut_dulint_zero;
 
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	/* Start the lsn from one log block from zero: this way every
+	log record has a start lsn != zero, a fact which we will use */
+
+	log_sys->written_to_some_lsn = LOG_START_LSN;
+	log_sys->written_to_all_lsn = LOG_START_LSN;
 
 	log_sys->n_pending_writes = 0;
 
@@ -788,7 +927,7 @@ log_init(void)
 	log_sys->adm_checkpoint_interval = ULINT_MAX;
 
 	log_sys->next_checkpoint_no = ut_dulint_zero;
-	log_sys->last_checkpoint_lsn = log_sys->lsn;
+	log_sys->last_checkpoint_lsn = LOG_START_LSN;
 	log_sys->n_pending_checkpoint_writes = 0;
 
 	rw_lock_create(&log_sys->checkpoint_lock, SYNC_NO_ORDER_CHECK);
@@ -802,7 +941,7 @@ log_init(void)
 #ifdef UNIV_LOG_ARCHIVE
 	/* Under MySQL, log archiving is always off */
 	log_sys->archiving_state = LOG_ARCH_OFF;
-	log_sys->archived_lsn = log_sys->lsn;
+	log_sys->archived_lsn = LOG_START_LSN;
 	log_sys->next_archived_lsn = ut_dulint_zero;
 
 	log_sys->n_pending_archive_ios = 0;
@@ -824,11 +963,8 @@ log_init(void)
 
 	/*----------------------------*/
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn = ut_dulint_add(LOG_START_LSN, LOG_BLOCK_HDR_SIZE);
+	log_buf_init_at_lsn(ut_dulint_add(LOG_START_LSN, LOG_BLOCK_HDR_SIZE),
+			    NULL);
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -836,14 +972,58 @@ log_init(void)
 	recv_sys_create();
 	recv_sys_init(FALSE, buf_pool_get_curr_size());
 
-	recv_sys->parse_start_lsn = log_sys->lsn;
-	recv_sys->scanned_lsn = log_sys->lsn;
+	recv_sys->parse_start_lsn = log_get_lsn();
+	recv_sys->scanned_lsn = log_get_lsn();
 	recv_sys->scanned_checkpoint_no = 0;
-	recv_sys->recovered_lsn = log_sys->lsn;
+	recv_sys->recovered_lsn = log_get_lsn();
 	recv_sys->limit_lsn = ut_dulint_max;
 #endif
 }
 
+/**********************************************************
+Makes the log buffer continue from a given lsn, after the log has been
+recovered or reset. The caller must own the log mutex. */
+
+void
+log_buf_init_at_lsn(
+/*================*/
+	dulint	lsn,	/* in: the new current lsn */
+	byte*	block)	/* in: the log block containing lsn, or NULL if the
+			block should be initialized */
+{
+	ib_ulonglong	block_lsn;
+	ulint		offset;
+	byte*		log_block;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	offset = ut_dulint_get_low(lsn) % OS_FILE_LOG_BLOCK_SIZE;
+	block_lsn = (ib_ulonglong) ut_conv_dulint_to_longlong(lsn) - offset;
+
+	ut_a(offset >= LOG_BLOCK_HDR_SIZE);
+	ut_a(offset < OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE);
+
+	log_block = log_sys->buf + (ulint) (block_lsn % log_sys->buf_size);
+
+	if (block) {
+		ut_memcpy(log_block, block, OS_FILE_LOG_BLOCK_SIZE);
+	} else {
+		log_block_init(log_block, lsn);
+	}
+
+	if (log_block_get_first_rec_group(log_block) == 0) {
+		/* The next log record group will start at lsn */
+
+		log_block_set_first_rec_group(log_block, offset);
+	}
+
+	/* No other thread uses the log yet */
+
+	log_sys->reserved_lsn = block_lsn + offset;
+	log_sys->ready_lsn = block_lsn + offset;
+	log_sys->buf_limit_lsn = block_lsn + log_sys->buf_size;
+}
+
 /**********************************************************************
 Inits a log group to the log system. */
 
@@ -992,32 +1172,25 @@ log_sys_check_flush_completion(void)
 /*================================*/
 			/* out: LOG_UNLOCK_FLUSH_LOCK or 0 */
 {
-	ulint	move_start;
-	ulint	move_end;
+	ib_ulonglong	limit;
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
 	if (log_sys->n_pending_writes == 0) {
 
 		log_sys->written_to_all_lsn = log_sys->write_lsn;
-		log_sys->buf_next_to_write = log_sys->write_end_offset;
 
-		if (log_sys->write_end_offset > log_sys->max_buf_free / 2) {
-			/* Move the log buffer content to the start of the
-			buffer */
+		/* The log buffer space of the written log blocks can be
+		reused; the last, incomplete block will be written again */
 
-			move_start = ut_calc_align_down(
-				log_sys->write_end_offset,
-				OS_FILE_LOG_BLOCK_SIZE);
-			move_end = ut_calc_align(log_sys->buf_free,
-						 OS_FILE_LOG_BLOCK_SIZE);
+		limit = (ib_ulonglong) ut_conv_dulint_to_longlong(
+			ut_dulint_align_down(log_sys->write_lsn,
+					     OS_FILE_LOG_BLOCK_SIZE))
+			+ log_sys->buf_size;
 
-			ut_memmove(log_sys->buf, log_sys->buf + move_start,
-				   move_end - move_start);
-			log_sys->buf_free -= move_start;
-
-			log_sys->buf_next_to_write -= move_start;
-		}
+		ut_a(log_lsn_cas(&(log_sys->buf_limit_lsn),
+				 log_lsn_read(&(log_sys->buf_limit_lsn)),
+				 limit));
 
 		return(LOG_UNLOCK_FLUSH_LOCK);
 	}
@@ -1274,6 +1447,55 @@ loop:
 	}
 }
 
+/**********************************************************
+Writes the log between two lsn's to a log file group: the complete log blocks
+are written from the log buffer, and the last, incomplete block from
+log_sys->write_buf. */
+static
+void
+log_group_write_log_buf(
+/*====================*/
+	log_group_t*	group,		/* in: log group */
+	ib_ulonglong	start_lsn,	/* in: write the log from this lsn */
+	ib_ulonglong	end_lsn)	/* in: write the log up to this lsn */
+{
+	ib_ulonglong	area_start;
+	ib_ulonglong	area_end;
+	ulint		new_data_offset;
+	ulint		offset;
+	ulint		len;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	area_start = start_lsn - start_lsn % OS_FILE_LOG_BLOCK_SIZE;
+	area_end = end_lsn - end_lsn % OS_FILE_LOG_BLOCK_SIZE;
+
+	new_data_offset = (ulint) (start_lsn - area_start);
+
+	while (area_start < area_end) {
+		/* The log buffer is circular: do not write over its end */
+
+		offset = (ulint) (area_start % log_sys->buf_size);
+
+		len = log_sys->buf_size - offset;
+
+		if (area_start + len > area_end) {
+			len = (ulint) (area_end - area_start);
+		}
+
+		log_group_write_buf(group, log_sys->buf + offset, len,
+				    ut_conv_ulonglong_to_dulint(area_start),
+				    new_data_offset);
+
+		new_data_offset = 0;
+		area_start += len;
+	}
+
+	log_group_write_buf(group, log_sys->write_buf, OS_FILE_LOG_BLOCK_SIZE,
+			    ut_conv_ulonglong_to_dulint(area_end),
+			    new_data_offset);
+}
+
 /**********************************************************
 This function is called, e.g., when a transaction wants to commit. It checks
 that the log has been written to the log file up to the last log entry written
@@ -1292,10 +1514,11 @@ log_write_up_to(
 			flushed to disk */
 {
 	log_group_t*	group;
-	ulint		start_offset;
-	ulint		end_offset;
-	ulint		area_start;
-	ulint		area_end;
+	ib_ulonglong	start_lsn;
+	ib_ulonglong	end_lsn;
+	ib_ulonglong	area_start;
+	ib_ulonglong	area_end;
+	byte*		log_block;
 #ifdef UNIV_DEBUG
 	ulint		loop_count	= 0;
 #endif /* UNIV_DEBUG */
@@ -1308,6 +1531,21 @@ log_write_up_to(
 		return;
 	}
 
+	if (ut_dulint_cmp(lsn, ut_dulint_max) != 0) {
+		/* The log can only be written up to the current lsn: wait
+		until the log record groups below lsn have been copied to the
+		log buffer */
+
+		end_lsn = log_lsn_read(&(log_sys->reserved_lsn));
+
+		if (end_lsn > (ib_ulonglong) ut_conv_dulint_to_longlong(lsn)) {
+			end_lsn = (ib_ulonglong) ut_conv_dulint_to_longlong(
+				lsn);
+		}
+
+		log_wait_for_lsn(end_lsn);
+	}
+
 loop:
 #ifdef UNIV_DEBUG
 	loop_count++;
@@ -1372,8 +1610,11 @@ loop:
 		goto loop;
 	}
 
-	if (!flush_to_disk
-	    && log_sys->buf_free == log_sys->buf_next_to_write) {
+	start_lsn = (ib_ulonglong) ut_conv_dulint_to_longlong(
+		log_sys->written_to_all_lsn);
+	end_lsn = log_lsn_read(&(log_sys->ready_lsn));
+
+	if (!flush_to_disk && start_lsn == end_lsn) {
 		/* Nothing to write and no flush to disk requested */
 
 		mutex_exit(&(log_sys->mutex));
@@ -1389,8 +1630,8 @@ loop:
 				log_sys->written_to_all_lsn),
 			(ulong) ut_dulint_get_low(
 				log_sys->written_to_all_lsn),
-			(ulong) ut_dulint_get_high(log_sys->lsn),
-			(ulong)	ut_dulint_get_low(log_sys->lsn));
+			(ulong) (end_lsn >> 32),
+			(ulong) (end_lsn & 0xFFFFFFFFUL));
 	}
 #endif /* UNIV_DEBUG */
 	log_sys->n_pending_writes++;
@@ -1402,49 +1643,58 @@ loop:
 	os_event_reset(log_sys->no_flush_event);
 	os_event_reset(log_sys->one_flushed_event);
 
-	start_offset = log_sys->buf_next_to_write;
-	end_offset = log_sys->buf_free;
-
-	area_start = ut_calc_align_down(start_offset, OS_FILE_LOG_BLOCK_SIZE);
-	area_end = ut_calc_align(end_offset, OS_FILE_LOG_BLOCK_SIZE);
+	area_start = start_lsn - start_lsn % OS_FILE_LOG_BLOCK_SIZE;
+	area_end = end_lsn - end_lsn % OS_FILE_LOG_BLOCK_SIZE;
 
-	ut_ad(area_end - area_start > 0);
-
-	log_sys->write_lsn = log_sys->lsn;
+	log_sys->write_lsn = ut_conv_ulonglong_to_dulint(end_lsn);
 
 	if (flush_to_disk) {
-		log_sys->current_flush_lsn = log_sys->lsn;
+		log_sys->current_flush_lsn = log_sys->write_lsn;
 	}
 
 	log_sys->one_flushed = FALSE;
 
-	log_block_set_flush_bit(log_sys->buf + area_start, TRUE);
-	log_block_set_checkpoint_no(
-		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		log_sys->next_checkpoint_no);
+	/* The log blocks before area_end are complete, and no other thread
+	writes to them any more */
 
-	/* Copy the last, incompletely written, log block a log block length
-	up, so that when the flush operation writes from the log buffer, the
-	segment to write will not be changed by writers to the log */
+	for (; area_start < area_end; area_start += OS_FILE_LOG_BLOCK_SIZE) {
+		log_block = log_sys->buf
+			+ (ulint) (area_start % log_sys->buf_size);
 
-	ut_memcpy(log_sys->buf + area_end,
-		  log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
+		log_block_set_data_len(log_block, OS_FILE_LOG_BLOCK_SIZE);
+		log_block_set_checkpoint_no(log_block,
+					    log_sys->next_checkpoint_no);
+	}
+
+	/* Copy the last, incompletely written, log block to write_buf, so
+	that the block which is written will not be changed by threads which
+	copy more log to it */
+
+	ut_memcpy(log_sys->write_buf,
+		  log_sys->buf + (ulint) (area_end % log_sys->buf_size),
 		  OS_FILE_LOG_BLOCK_SIZE);
 
-	log_sys->buf_free += OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->write_end_offset = log_sys->buf_free;
+	log_block_set_data_len(log_sys->write_buf,
+			       (ulint) (end_lsn % OS_FILE_LOG_BLOCK_SIZE));
+	log_block_set_checkpoint_no(log_sys->write_buf,
+				    log_sys->next_checkpoint_no);
+
+	area_start = start_lsn - start_lsn % OS_FILE_LOG_BLOCK_SIZE;
+
+	if (area_start == area_end) {
+		log_block_set_flush_bit(log_sys->write_buf, TRUE);
+	} else {
+		log_block_set_flush_bit(
+			log_sys->buf + (ulint) (area_start % log_sys->buf_size),
+			TRUE);
+	}
 
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
 	/* Do the write to the log files */
 
 	while (group) {
-		log_group_write_buf(
-			group, log_sys->buf + area_start,
-			area_end - area_start,
-			ut_dulint_align_down(log_sys->written_to_all_lsn,
-					     OS_FILE_LOG_BLOCK_SIZE),
-			start_offset - area_start);
+		log_group_write_log_buf(group, start_lsn, end_lsn);
 
 		log_group_set_fields(group, log_sys->write_lsn);
 
@@ -1505,15 +1755,7 @@ void
 log_buffer_flush_to_disk(void)
 /*==========================*/
 {
-	dulint	lsn;
-
-	mutex_enter(&(log_sys->mutex));
-
-	lsn = log_sys->lsn;
-
-	mutex_exit(&(log_sys->mutex));
-
-	log_write_up_to(lsn, LOG_WAIT_ALL_GROUPS, TRUE);
+	log_write_up_to(log_get_lsn(), LOG_WAIT_ALL_GROUPS, TRUE);
 }
 
 /********************************************************************
@@ -1530,14 +1772,17 @@ log_flush_margin(void)
 
 	mutex_enter(&(log->mutex));
 
-	if (log->buf_free > log->max_buf_free) {
+	lsn = log_get_lsn();
+
+	if (ut_dulint_minus(lsn, ut_dulint_align_down(log->written_to_all_lsn,
+						      OS_FILE_LOG_BLOCK_SIZE))
+	    > log->max_buf_free) {
 
 		if (log->n_pending_writes > 0) {
 			/* A flush is running: hope that it will provide enough
 			free space */
 		} else {
 			do_flush = TRUE;
-			lsn = log->lsn;
 		}
 	}
 
@@ -1579,10 +1824,10 @@ log_preflush_pool_modified_pages(
 		recv_apply_hashed_log_recs(TRUE);
 	}
 
-	n_pages = buf_flush_batch(BUF_FLUSH_LIST, ULINT_MAX, new_oldest);
+	n_pages = buf_flush_list(ULINT_MAX, new_oldest);
 
 	if (sync) {
-		buf_flush_wait_batch_end(BUF_FLUSH_LIST);
+		buf_flush_wait_batch_end(NULL, BUF_FLUSH_LIST);
 	}
 
 	if (n_pages == ULINT_UNDEFINED) {
@@ -1919,7 +2164,7 @@ log_checkpoint(
 
 	/* Because log also contains headers and dummy log records,
 	if the buffer pool contains no dirty buffers, oldest_lsn
-	gets the value log_sys->lsn from the previous function,
+	gets the current lsn from the previous function,
 	and we must make sure that the log is flushed up to that
 	lsn. If there are dirty buffers in the buffer pool, then our
 	write-ahead-logging algorithm ensures that the log has been flushed
@@ -2044,7 +2289,7 @@ loop:
 
 	oldest_lsn = log_buf_pool_get_oldest_modification();
 
-	age = ut_dulint_minus(log->lsn, oldest_lsn);
+	age = ut_dulint_minus(log_get_lsn(), oldest_lsn);
 
 	if (age > log->max_modified_age_sync) {
 
@@ -2060,7 +2305,8 @@ loop:
 		advance = 0;
 	}
 
-	checkpoint_age = ut_dulint_minus(log->lsn, log->last_checkpoint_lsn);
+	checkpoint_age = ut_dulint_minus(log_get_lsn(),
+					 log->last_checkpoint_lsn);
 
 	if (checkpoint_age > log->max_checkpoint_age) {
 		/* A checkpoint is urgent: we do it synchronously */
@@ -2081,7 +2327,14 @@ loop:
 
 	mutex_exit(&(log->mutex));
 
-	if (advance) {
+	if (advance && !sync && buf_flush_n_page_cleaners > 0) {
+		/* The flush is not urgent: let the page cleaners do it in
+		the background */
+
+		buf_flush_request_page_cleaners(
+			ut_dulint_add(oldest_lsn, advance));
+
+	} else if (advance) {
 		dulint	new_oldest = ut_dulint_add(oldest_lsn, advance);
 
 		success = log_preflush_pool_modified_pages(new_oldest, sync);
@@ -2605,10 +2858,10 @@ loop:
 
 		*n_bytes = log_sys->archive_buf_size;
 
-		if (ut_dulint_cmp(limit_lsn, log_sys->lsn) >= 0) {
+		if (ut_dulint_cmp(limit_lsn, log_get_lsn()) >= 0) {
 
 			limit_lsn = ut_dulint_align_down(
-				log_sys->lsn, OS_FILE_LOG_BLOCK_SIZE);
+				log_get_lsn(), OS_FILE_LOG_BLOCK_SIZE);
 		}
 	}
 
@@ -2701,7 +2954,7 @@ log_archive_all(void)
 		return;
 	}
 
-	present_lsn = log_sys->lsn;
+	present_lsn = log_get_lsn();
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -2915,7 +3168,7 @@ log_archive_archivelog(void)
 		log_sys->archiving_state = LOG_ARCH_ON;
 
 		log_sys->archived_lsn
-			= ut_dulint_align_down(log_sys->lsn,
+			= ut_dulint_align_down(log_get_lsn(),
 					       OS_FILE_LOG_BLOCK_SIZE);
 		mutex_exit(&(log_sys->mutex));
 
@@ -2949,7 +3202,7 @@ loop:
 		return;
 	}
 
-	age = ut_dulint_minus(log->lsn, log->archived_lsn);
+	age = ut_dulint_minus(log_get_lsn(), log->archived_lsn);
 
 	if (age > log->max_archived_lsn_age) {
 
@@ -3041,11 +3294,14 @@ loop:
 
 	/* We need the monitor threads to stop before we proceed with a
 	normal shutdown. In case of very fast shutdown, however, we can
-	proceed without waiting for monitor threads. */
+	proceed without waiting for monitor threads. The purge threads
+	complete the purge first in a slow shutdown. */
 
 	if (srv_fast_shutdown < 2
 	   && (srv_error_monitor_active
-	      || srv_lock_timeout_active || srv_monitor_active)) {
+	      || srv_lock_timeout_active || srv_monitor_active
+	      || buf_flush_n_page_cleaners > 0
+	      || trx_purge_n_threads > 0)) {
 
 		mutex_exit(&kernel_mutex);
 
@@ -3118,7 +3374,7 @@ loop:
 
 	mutex_enter(&(log_sys->mutex));
 
-	lsn = log_sys->lsn;
+	lsn = log_get_lsn();
 
 	if ((ut_dulint_cmp(lsn, log_sys->last_checkpoint_lsn) != 0)
 #ifdef UNIV_LOG_ARCHIVE
@@ -3181,7 +3437,7 @@ loop:
 	/* Make some checks that the server really is quiet */
 	ut_a(srv_n_threads_active[SRV_MASTER] == 0);
 	ut_a(buf_all_freed());
-	ut_a(0 == ut_dulint_cmp(lsn, log_sys->lsn));
+	ut_a(0 == ut_dulint_cmp(lsn, log_get_lsn()));
 
 	if (ut_dulint_cmp(lsn, srv_start_lsn) < 0) {
 		fprintf(stderr,
@@ -3205,7 +3461,7 @@ loop:
 	/* Make some checks that the server really is quiet */
 	ut_a(srv_n_threads_active[SRV_MASTER] == 0);
 	ut_a(buf_all_freed());
-	ut_a(0 == ut_dulint_cmp(lsn, log_sys->lsn));
+	ut_a(0 == ut_dulint_cmp(lsn, log_get_lsn()));
 }
 
 /**********************************************************
@@ -3243,8 +3499,8 @@ log_check_log_recs(
 	ut_memcpy(scan_buf, start, end - start);
 
 	recv_scan_log_recs(TRUE,
-			   (buf_pool->n_frames
-			    - recv_n_pool_free_frames) * UNIV_PAGE_SIZE,
+			   buf_pool_get_curr_size()
+			   - recv_n_pool_free_frames * UNIV_PAGE_SIZE,
 			   FALSE, scan_buf, end - start,
 			   ut_dulint_align_down(buf_start_lsn,
 						OS_FILE_LOG_BLOCK_SIZE),
@@ -3265,19 +3521,13 @@ Peeks the current lsn. */
 ibool
 log_peek_lsn(
 /*=========*/
-			/* out: TRUE if success, FALSE if could not get the
-			log system mutex */
+			/* out: TRUE; the current lsn can be read without
+			the log system mutex */
 	dulint*	lsn)	/* out: if returns TRUE, current lsn is here */
 {
-	if (0 == mutex_enter_nowait(&(log_sys->mutex))) {
-		*lsn = log_sys->lsn;
-
-		mutex_exit(&(log_sys->mutex));
+	*lsn = log_get_lsn();
 
-		return(TRUE);
-	}
-
-	return(FALSE);
+	return(TRUE);
 }
 
 /**********************************************************
@@ -3290,15 +3540,18 @@ log_print(
 {
 	double	time_elapsed;
 	time_t	current_time;
+	dulint	lsn;
 
 	mutex_enter(&(log_sys->mutex));
 
+	lsn = log_get_lsn();
+
 	fprintf(file,
 		"Log sequence number %lu %lu\n"
 		"Log flushed up to   %lu %lu\n"
 		"Last checkpoint at  %lu %lu\n",
-		(ulong) ut_dulint_get_high(log_sys->lsn),
-		(ulong) ut_dulint_get_low(log_sys->lsn),
+		(ulong) ut_dulint_get_high(lsn),
+		(ulong) ut_dulint_get_low(lsn),
 		(ulong) ut_dulint_get_high(log_sys->flushed_to_disk_lsn),
 		(ulong) ut_dulint_get_low(log_sys->flushed_to_disk_lsn),
 		(ulong) ut_dulint_get_high(log_sys->last_checkpoint_lsn),
@@ -169,6 +169,8 @@ recv_sys_init(
 
 	recv_sys->addr_hash = hash_create(available_memory / 512);
 	recv_sys->n_addrs = 0;
+	recv_sys->n_apply_threads = 0;
+	recv_sys->n_apply_threads_active = 0;
 
 	recv_sys->apply_log_recs = FALSE;
 	recv_sys->apply_batch_on = FALSE;
@@ -1376,52 +1378,31 @@ recv_read_in_area(
 }
 
 /***********************************************************************
-Empties the hash table of stored log records, applying them to appropriate
-pages. */
-
+Applies the hashed log records of the hash cells of one apply thread: the
+records of a page already in the buffer pool are applied here, other pages
+are read in in batches around the page, and the i/o-handler threads apply
+the records when the reads complete. */
+static
 void
-recv_apply_hashed_log_recs(
-/*=======================*/
-	ibool	allow_ibuf)	/* in: if TRUE, also ibuf operations are
-				allowed during the application; if FALSE,
-				no ibuf operations are allowed, and after
-				the application all file pages are flushed to
-				disk and invalidated in buffer pool: this
-				alternative means that no new log records
-				can be generated during the application;
-				the caller must in this case own the log
-				mutex */
+recv_apply_hashed_log_recs_low(
+/*===========================*/
+	ulint	id)	/* in: number of the apply thread, 0 for the thread
+			which started the batch; thread 0 prints the
+			progress */
 {
 	recv_addr_t* recv_addr;
 	page_t*	page;
 	ulint	i;
+	ulint	n_cells;
 	ulint	space;
 	ulint	page_no;
-	ulint	n_pages;
-	ibool	has_printed	= FALSE;
 	mtr_t	mtr;
-loop:
-	mutex_enter(&(recv_sys->mutex));
-
-	if (recv_sys->apply_batch_on) {
-
-		mutex_exit(&(recv_sys->mutex));
-
-		os_thread_sleep(500000);
-
-		goto loop;
-	}
 
-	ut_ad(!allow_ibuf == mutex_own(&log_sys->mutex));
+	mutex_enter(&(recv_sys->mutex));
 
-	if (!allow_ibuf) {
-		recv_no_ibuf_operations = TRUE;
-	}
+	n_cells = hash_get_n_cells(recv_sys->addr_hash);
 
-	recv_sys->apply_log_recs = TRUE;
-	recv_sys->apply_batch_on = TRUE;
-
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
+	for (i = id; i < n_cells; i += recv_sys->n_apply_threads) {
 
 		recv_addr = HASH_GET_FIRST(recv_sys->addr_hash, i);
 
@@ -1430,15 +1411,6 @@ loop:
 			page_no = recv_addr->page_no;
 
 			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ut_print_timestamp(stderr);
-					fputs("  InnoDB: Starting an"
-					      " apply batch of log records"
-					      " to the database...\n"
-					      "InnoDB: Progress in percents: ",
-					      stderr);
-					has_printed = TRUE;
-				}
 
 				mutex_exit(&(recv_sys->mutex));
 
@@ -1466,20 +1438,118 @@ loop:
 			recv_addr = HASH_GET_NEXT(addr_hash, recv_addr);
 		}
 
-		if (has_printed
-		    && (i * 100) / hash_get_n_cells(recv_sys->addr_hash)
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
+		if (id == 0 && (i * 100) / n_cells
+		    != ((i + recv_sys->n_apply_threads) * 100) / n_cells) {
 
-			fprintf(stderr, "%lu ", (ulong)
-				((i * 100)
-				 / hash_get_n_cells(recv_sys->addr_hash)));
+			fprintf(stderr, "%lu ", (ulong) ((i * 100) / n_cells));
 		}
 	}
 
-	/* Wait until all the pages have been processed */
+	ut_a(recv_sys->n_apply_threads_active > 0);
+	recv_sys->n_apply_threads_active--;
+
+	mutex_exit(&(recv_sys->mutex));
+}
+
+/***********************************************************************
+A thread which applies its share of the hashed log records in a log rec
+application batch, and exits. */
+static
+os_thread_ret_t
+recv_apply_thread(
+/*==============*/
+	void*	arg)	/* in: pointer to the number of the apply thread */
+{
+	recv_apply_hashed_log_recs_low(*((ulint*) arg));
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/***********************************************************************
+Empties the hash table of stored log records, applying them to appropriate
+pages. The hash cells are divided among srv_n_recv_threads threads which
+apply the records to different pages in parallel. */
+
+void
+recv_apply_hashed_log_recs(
+/*=======================*/
+	ibool	allow_ibuf)	/* in: if TRUE, also ibuf operations are
+				allowed during the application; if FALSE,
+				no ibuf operations are allowed, and after
+				the application all file pages are flushed to
+				disk and invalidated in buffer pool: this
+				alternative means that no new log records
+				can be generated during the application;
+				the caller must in this case own the log
+				mutex */
+{
+	static ulint	thread_nos[RECV_MAX_N_APPLY_THREADS];
+	ulint		n_threads;
+	ulint		i;
+	ulint		n_pages;
+	ibool		has_printed	= FALSE;
+loop:
+	mutex_enter(&(recv_sys->mutex));
+
+	if (recv_sys->apply_batch_on) {
+
+		mutex_exit(&(recv_sys->mutex));
+
+		os_thread_sleep(500000);
+
+		goto loop;
+	}
+
+	ut_ad(!allow_ibuf == mutex_own(&log_sys->mutex));
+
+	if (!allow_ibuf) {
+		recv_no_ibuf_operations = TRUE;
+	}
+
+	recv_sys->apply_log_recs = TRUE;
+	recv_sys->apply_batch_on = TRUE;
+
+	if (recv_sys->n_addrs > 0) {
+		ut_print_timestamp(stderr);
+		fputs("  InnoDB: Starting an"
+		      " apply batch of log records"
+		      " to the database...\n"
+		      "InnoDB: Progress in percents: ",
+		      stderr);
+		has_printed = TRUE;
+	}
+
+	/* Do not start more threads than there are pages to recover */
+
+	n_threads = ut_min(srv_n_recv_threads, RECV_MAX_N_APPLY_THREADS);
+	n_threads = ut_min(n_threads, recv_sys->n_addrs);
+
+	if (n_threads == 0) {
+		n_threads = 1;
+	}
+
+	recv_sys->n_apply_threads = n_threads;
+	recv_sys->n_apply_threads_active = n_threads;
+
+	mutex_exit(&(recv_sys->mutex));
+
+	for (i = 1; i < n_threads; i++) {
+		thread_nos[i] = i;
+
+		os_thread_create(recv_apply_thread, thread_nos + i, NULL);
+	}
 
-	while (recv_sys->n_addrs != 0) {
+	recv_apply_hashed_log_recs_low(0);
+
+	mutex_enter(&(recv_sys->mutex));
+
+	/* Wait until the other apply threads have finished and all the
+	pages have been processed */
+
+	while (recv_sys->n_apply_threads_active != 0
+	       || recv_sys->n_addrs != 0) {
 
 		mutex_exit(&(recv_sys->mutex));
 
@@ -1500,11 +1570,10 @@ loop:
 		mutex_exit(&(recv_sys->mutex));
 		mutex_exit(&(log_sys->mutex));
 
-		n_pages = buf_flush_batch(BUF_FLUSH_LIST, ULINT_MAX,
-					  ut_dulint_max);
+		n_pages = buf_flush_list(ULINT_MAX, ut_dulint_max);
 		ut_a(n_pages != ULINT_UNDEFINED);
 
-		buf_flush_wait_batch_end(BUF_FLUSH_LIST);
+		buf_flush_wait_batch_end(NULL, BUF_FLUSH_LIST);
 
 		buf_pool_invalidate();
 
@@ -1587,7 +1656,7 @@ recv_apply_log_recs_for_backup(void)
 			/* We simulate a page read made by the buffer pool, to
 			make sure the recovery apparatus works ok, for
 			example, the buf_frame_align() function. We must init
-			the block corresponding to buf_pool->frame_zero
+			the block corresponding to buf_pool_frame_zero
 			(== page). */
 
 			buf_page_init_for_backup_restore(
@@ -2421,8 +2490,8 @@ recv_group_scan_log_recs(
 				       group, start_lsn, end_lsn);
 
 		finished = recv_scan_log_recs(
-			TRUE, (buf_pool->n_frames - recv_n_pool_free_frames)
-			* UNIV_PAGE_SIZE, TRUE, log_sys->buf, RECV_SCAN_SIZE,
+			TRUE, buf_pool_get_curr_size()
+			- recv_n_pool_free_frames * UNIV_PAGE_SIZE, TRUE, log_sys->buf, RECV_SCAN_SIZE,
 			start_lsn, contiguous_lsn, group_scanned_lsn);
 		start_lsn = end_lsn;
 	}
@@ -2812,15 +2881,10 @@ recv_recovery_from_checkpoint_start(
 		srv_start_lsn = recv_sys->recovered_lsn;
 	}
 
-	log_sys->lsn = recv_sys->recovered_lsn;
-
-	ut_memcpy(log_sys->buf, recv_sys->last_block, OS_FILE_LOG_BLOCK_SIZE);
+	log_sys->written_to_some_lsn = recv_sys->recovered_lsn;
+	log_sys->written_to_all_lsn = recv_sys->recovered_lsn;
 
-	log_sys->buf_free = ut_dulint_get_low(log_sys->lsn)
-		% OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->buf_next_to_write = log_sys->buf_free;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	log_buf_init_at_lsn(recv_sys->recovered_lsn, recv_sys->last_block);
 
 	log_sys->last_checkpoint_lsn = checkpoint_lsn;
 
@@ -2939,12 +3003,12 @@ recv_reset_logs(
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
-	log_sys->lsn = ut_dulint_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
+	lsn = ut_dulint_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
 
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
 	while (group) {
-		group->lsn = log_sys->lsn;
+		group->lsn = lsn;
 		group->lsn_offset = LOG_FILE_HDR_SIZE;
 #ifdef UNIV_LOG_ARCHIVE
 		group->archived_file_no = arch_log_no;
@@ -2959,22 +3023,17 @@ recv_reset_logs(
 		group = UT_LIST_GET_NEXT(log_groups, group);
 	}
 
-	log_sys->buf_next_to_write = 0;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	log_sys->written_to_some_lsn = lsn;
+	log_sys->written_to_all_lsn = lsn;
 
 	log_sys->next_checkpoint_no = ut_dulint_zero;
 	log_sys->last_checkpoint_lsn = ut_dulint_zero;
 
 #ifdef UNIV_LOG_ARCHIVE
-	log_sys->archived_lsn = log_sys->lsn;
+	log_sys->archived_lsn = lsn;
 #endif /* UNIV_LOG_ARCHIVE */
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn = ut_dulint_add(log_sys->lsn, LOG_BLOCK_HDR_SIZE);
+	log_buf_init_at_lsn(ut_dulint_add(lsn, LOG_BLOCK_HDR_SIZE), NULL);
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -3245,8 +3304,8 @@ ask_again:
 		       read_offset % UNIV_PAGE_SIZE, len, buf, NULL);
 
 		ret = recv_scan_log_recs(
-			TRUE, (buf_pool->n_frames - recv_n_pool_free_frames)
-			* UNIV_PAGE_SIZE, TRUE, buf, len, start_lsn,
+			TRUE, buf_pool_get_curr_size()
+			- recv_n_pool_free_frames * UNIV_PAGE_SIZE, TRUE, buf, len, start_lsn,
 			&dummy_lsn, &scanned_lsn);
 
 		if (ut_dulint_cmp(scanned_lsn, file_end_lsn) == 0) {
@@ -57,7 +57,7 @@ mlog_write_initial_log_record(
 	ut_ad(type <= MLOG_BIGGEST_TYPE);
 	ut_ad(type > MLOG_8BYTES);
 
-	if (ptr < buf_pool->frame_zero || ptr >= buf_pool->high_end) {
+	if (ptr < buf_pool_frame_zero || ptr >= buf_pool_high_end) {
 		fprintf(stderr,
 			"InnoDB: Error: trying to write to"
 			" a stray memory location %p\n", (void*) ptr);
@@ -221,7 +221,7 @@ mlog_write_ulint(
 {
 	byte*	log_ptr;
 
-	if (ptr < buf_pool->frame_zero || ptr >= buf_pool->high_end) {
+	if (ptr < buf_pool_frame_zero || ptr >= buf_pool_high_end) {
 		fprintf(stderr,
 			"InnoDB: Error: trying to write to"
 			" a stray memory location %p\n", (void*) ptr);
@@ -268,8 +268,8 @@ mlog_write_dulint(
 {
 	byte*	log_ptr;
 
-	if (UNIV_UNLIKELY(ptr < buf_pool->frame_zero)
-	    || UNIV_UNLIKELY(ptr >= buf_pool->high_end)) {
+	if (UNIV_UNLIKELY(ptr < buf_pool_frame_zero)
+	    || UNIV_UNLIKELY(ptr >= buf_pool_high_end)) {
 		fprintf(stderr,
 			"InnoDB: Error: trying to write to"
 			" a stray memory location %p\n", (void*) ptr);
@@ -313,8 +313,8 @@ mlog_write_string(
 {
 	byte*	log_ptr;
 
-	if (UNIV_UNLIKELY(ptr < buf_pool->frame_zero)
-	    || UNIV_UNLIKELY(ptr >= buf_pool->high_end)) {
+	if (UNIV_UNLIKELY(ptr < buf_pool_frame_zero)
+	    || UNIV_UNLIKELY(ptr >= buf_pool_high_end)) {
 		fprintf(stderr,
 			"InnoDB: Error: trying to write to"
 			" a stray memory location %p\n", (void*) ptr);
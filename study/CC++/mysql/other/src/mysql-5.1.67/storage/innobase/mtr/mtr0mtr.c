@@ -114,8 +114,9 @@ mtr_log_reserve_and_write(
 	dyn_array_t*	mlog;
 	dyn_block_t*	block;
 	ulint		data_size;
-	ibool		success;
 	byte*		first_data;
+	byte		dummy		= MLOG_DUMMY_RECORD;
+	dulint		lsn;
 
 	ut_ad(mtr);
 
@@ -130,36 +131,38 @@ mtr_log_reserve_and_write(
 				     | MLOG_SINGLE_REC_FLAG);
 	}
 
-	if (mlog->heap == NULL) {
-		mtr->end_lsn = log_reserve_and_write_fast(
-			first_data, dyn_block_get_used(mlog),
-			&(mtr->start_lsn), &success);
-		if (success) {
-
-			return;
-		}
-	}
-
 	data_size = dyn_array_get_data_size(mlog);
 
-	/* Open the database log for log_write_low */
-	mtr->start_lsn = log_reserve_and_open(data_size);
+	if (mtr->log_mode == MTR_LOG_ALL && data_size > 0) {
 
-	if (mtr->log_mode == MTR_LOG_ALL) {
+		/* Reserve space in the log and copy the log records there;
+		other mtrs may copy their records at the same time */
+
+		mtr->start_lsn = log_reserve_and_open(data_size,
+						      &(mtr->end_lsn));
+		lsn = mtr->start_lsn;
 
 		block = mlog;
 
 		while (block != NULL) {
-			log_write_low(dyn_block_get_data(block),
-				      dyn_block_get_used(block));
+			lsn = log_write_low(dyn_block_get_data(block),
+					    dyn_block_get_used(block), lsn);
 			block = dyn_array_get_next_block(mlog, block);
 		}
 	} else {
-		ut_ad(mtr->log_mode == MTR_LOG_NONE);
-		/* Do nothing */
+		ut_ad(mtr->log_mode == MTR_LOG_NONE
+		      || data_size == 0);
+
+		/* Write a dummy record: the mtr needs an lsn range of its
+		own so that its pages are inserted to the flush list in
+		lsn order */
+
+		mtr->start_lsn = log_reserve_and_open(1, &(mtr->end_lsn));
+
+		log_write_low(&dummy, 1, mtr->start_lsn);
 	}
 
-	mtr->end_lsn = log_close();
+	log_close(mtr->start_lsn, mtr->end_lsn);
 }
 
 /*******************************************************************
@@ -180,18 +183,20 @@ mtr_commit(
 		mtr_log_reserve_and_write(mtr);
 	}
 
-	/* We first update the modification info to buffer pages, and only
-	after that release the log mutex: this guarantees that when the log
-	mutex is free, all buffer pages contain an up-to-date info of their
-	modifications. This fact is used in making a checkpoint when we look
-	at the oldest modification of any page in the buffer pool. It is also
-	required when we insert modified buffer pages in to the flush list
-	which must be sorted on oldest_modification. */
+	/* log_close() waited until all mtrs before this one in the log
+	were released. We first update the modification info to buffer
+	pages, and only after that release the log up to our end lsn: this
+	guarantees that all buffer pages modified below log_get_lsn()
+	contain an up-to-date info of their modifications. This fact is
+	used in making a checkpoint when we look at the oldest modification
+	of any page in the buffer pool. It is also required when we insert
+	modified buffer pages in to the flush list which must be sorted on
+	oldest_modification. */
 
 	mtr_memo_pop_all(mtr);
 
 	if (mtr->modifications) {
-		log_release();
+		log_release(mtr->end_lsn);
 	}
 
 #ifdef UNIV_DEBUG
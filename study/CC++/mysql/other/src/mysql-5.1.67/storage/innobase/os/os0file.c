@@ -28,6 +28,15 @@ Created 10/21/1995 Heikki Tuuri
 
 #endif
 
+#ifdef LINUX_NATIVE_AIO
+#include <linux/aio_abi.h>
+
+/* An i/o-handler thread waits at most this many nanoseconds in one
+io_getevents call, so that it notices shutdown and the requests which
+were completed synchronously because the kernel refused to queue them */
+#define OS_AIO_REAP_TIMEOUT	500000000UL
+#endif /* LINUX_NATIVE_AIO */
+
 /* This specifies the file permissions InnoDB uses when it creates files in
 Unix; the value of os_innodb_umask is initialized in ha_innodb.cc to
 my_umask */
@@ -98,6 +107,12 @@ struct os_aio_slot_struct{
 #elif defined(POSIX_ASYNC_IO)
 	struct aiocb	control;	/* Posix control block for aio
 					request */
+#elif defined(LINUX_NATIVE_AIO)
+	struct iocb	control;	/* Linux control block for aio
+					request */
+	ib_longlong	n_bytes;	/* result of a completed request:
+					number of bytes transferred, or
+					a negative error code */
 #endif
 };
 
@@ -128,6 +143,15 @@ struct os_aio_array_struct{
 				  in WaitForMultipleObjects; used only in
 				  Windows */
 #endif
+#ifdef LINUX_NATIVE_AIO
+	aio_context_t*	aio_ctx;  /* Linux aio contexts, one for each
+				  segment, or NULL if native aio is not
+				  used for this array */
+	struct io_event* aio_events;
+				  /* Array of n_slots completion events,
+				  used by io_getevents; each segment
+				  uses its own part of the array */
+#endif
 };
 
 /* Array of events used in simulated aio */
@@ -2940,6 +2964,10 @@ os_aio_array_create(
 	array->slots		= ut_malloc(n * sizeof(os_aio_slot_t));
 #ifdef __WIN__
 	array->native_events	= ut_malloc(n * sizeof(os_native_event_t));
+#endif
+#ifdef LINUX_NATIVE_AIO
+	array->aio_ctx		= NULL;
+	array->aio_events	= NULL;
 #endif
 	for (i = 0; i < n; i++) {
 		slot = os_aio_array_get_nth_slot(array, i);
@@ -2960,6 +2988,235 @@ os_aio_array_create(
 	return(array);
 }
 
+#ifdef LINUX_NATIVE_AIO
+/* Wrappers for the Linux aio system calls: we do not depend on libaio.
+Like syscall(2), these return -1 and set errno on failure. */
+
+static
+int
+os_aio_linux_io_setup(
+/*==================*/
+	unsigned	nr_events,	/* in: max number of pending events */
+	aio_context_t*	ctx)		/* out: aio context */
+{
+	return((int) syscall(__NR_io_setup, nr_events, ctx));
+}
+
+static
+int
+os_aio_linux_io_destroy(
+/*====================*/
+	aio_context_t	ctx)		/* in: aio context */
+{
+	return((int) syscall(__NR_io_destroy, ctx));
+}
+
+static
+int
+os_aio_linux_io_submit(
+/*===================*/
+	aio_context_t	ctx,		/* in: aio context */
+	long		nr,		/* in: number of control blocks */
+	struct iocb**	iocbpp)		/* in: control blocks */
+{
+	return((int) syscall(__NR_io_submit, ctx, nr, iocbpp));
+}
+
+static
+int
+os_aio_linux_io_getevents(
+/*======================*/
+	aio_context_t	ctx,		/* in: aio context */
+	long		min_nr,		/* in: wait for at least this many */
+	long		nr,		/* in: reap at most this many */
+	struct io_event* events,	/* out: completion events */
+	struct timespec* timeout)	/* in: timeout, or NULL */
+{
+	return((int) syscall(__NR_io_getevents, ctx, min_nr, nr, events,
+			     timeout));
+}
+
+/****************************************************************************
+Fills in the Linux aio control block of a slot. */
+static
+void
+os_aio_linux_prepare_iocb(
+/*======================*/
+	struct iocb*	iocb,	/* out: control block */
+	ulint		type,	/* in: OS_FILE_READ or OS_FILE_WRITE */
+	os_file_t	file,	/* in: file handle */
+	void*		buf,	/* in: buffer */
+	ulint		len,	/* in: length of the i/o */
+	ib_ulonglong	offset,	/* in: file offset */
+	void*		data)	/* in: returned in the completion event */
+{
+	memset(iocb, 0, sizeof(struct iocb));
+
+	iocb->aio_data = (ib_ulonglong) (ulint) data;
+	iocb->aio_lio_opcode = type == OS_FILE_READ
+		? IOCB_CMD_PREAD : IOCB_CMD_PWRITE;
+	iocb->aio_fildes = file;
+	iocb->aio_buf = (ib_ulonglong) (ulint) buf;
+	iocb->aio_nbytes = len;
+	iocb->aio_offset = (ib_longlong) offset;
+}
+
+/****************************************************************************
+Sets up a Linux aio context for each segment of an aio array. Each context
+can hold all the slots of its segment, so that io_submit never has to wait
+for room in the kernel queue. */
+static
+ibool
+os_aio_linux_create_io_ctx(
+/*=======================*/
+				/* out: TRUE on success; FALSE if the
+				kernel refused, in which case no context
+				is left set up for the array */
+	os_aio_array_t*	array)	/* in: aio array */
+{
+	ulint	n_per_seg;
+	ulint	i;
+
+	n_per_seg = array->n_slots / array->n_segments;
+
+	array->aio_ctx = ut_malloc(array->n_segments * sizeof(aio_context_t));
+
+	for (i = 0; i < array->n_segments; i++) {
+		array->aio_ctx[i] = 0;
+
+		if (os_aio_linux_io_setup((unsigned) n_per_seg,
+					  &array->aio_ctx[i])) {
+
+			ut_print_timestamp(stderr);
+			fprintf(stderr,
+				"  InnoDB: Warning: io_setup() failed"
+				" for %lu events, errno %d.\n"
+				"InnoDB: Check /proc/sys/fs/aio-max-nr.\n",
+				(ulong) n_per_seg, errno);
+
+			while (i > 0) {
+				i--;
+				os_aio_linux_io_destroy(array->aio_ctx[i]);
+			}
+
+			ut_free(array->aio_ctx);
+			array->aio_ctx = NULL;
+
+			return(FALSE);
+		}
+	}
+
+	array->aio_events = ut_malloc(array->n_slots
+				      * sizeof(struct io_event));
+
+	return(TRUE);
+}
+
+/****************************************************************************
+Destroys the Linux aio contexts of an aio array, if it has any, and frees
+the memory set up for them by os_aio_linux_create_io_ctx(). */
+static
+void
+os_aio_linux_free_io_ctx(
+/*=====================*/
+	os_aio_array_t*	array)	/* in: aio array */
+{
+	ulint	i;
+
+	if (array->aio_ctx == NULL) {
+
+		return;
+	}
+
+	for (i = 0; i < array->n_segments; i++) {
+		os_aio_linux_io_destroy(array->aio_ctx[i]);
+	}
+
+	ut_free(array->aio_ctx);
+	array->aio_ctx = NULL;
+
+	ut_free(array->aio_events);
+	array->aio_events = NULL;
+}
+
+/****************************************************************************
+Checks if the running kernel supports Linux native aio, by setting up an
+aio context and doing a test write and read through it on a temporary
+file. */
+
+ibool
+os_aio_linux_native_supported(void)
+/*===============================*/
+				/* out: TRUE if supported */
+{
+	aio_context_t	ctx	= 0;
+	struct iocb	iocb;
+	struct iocb*	p_iocb	= &iocb;
+	struct io_event	event;
+	struct timespec	timeout;
+	byte*		buf2;
+	byte*		buf;
+	int		fd;
+	ibool		ok	= FALSE;
+
+	if (os_aio_linux_io_setup(1, &ctx)) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Warning: io_setup() failed with errno %d:"
+			" Linux native aio is not available.\n", errno);
+
+		return(FALSE);
+	}
+
+	fd = innobase_mysql_tmpfile();
+
+	if (fd < 0) {
+		os_aio_linux_io_destroy(ctx);
+
+		return(FALSE);
+	}
+
+	buf2 = ut_malloc(2 * UNIV_PAGE_SIZE);
+	buf = ut_align(buf2, UNIV_PAGE_SIZE);
+	memset(buf, 0xA5, UNIV_PAGE_SIZE);
+
+	timeout.tv_sec = 5;
+	timeout.tv_nsec = 0;
+
+	os_aio_linux_prepare_iocb(&iocb, OS_FILE_WRITE, fd, buf,
+				  UNIV_PAGE_SIZE, 0, NULL);
+
+	if (os_aio_linux_io_submit(ctx, 1, &p_iocb) == 1
+	    && os_aio_linux_io_getevents(ctx, 1, 1, &event, &timeout) == 1
+	    && event.res == UNIV_PAGE_SIZE) {
+
+		memset(buf, 0, UNIV_PAGE_SIZE);
+
+		os_aio_linux_prepare_iocb(&iocb, OS_FILE_READ, fd, buf,
+					  UNIV_PAGE_SIZE, 0, NULL);
+
+		ok = os_aio_linux_io_submit(ctx, 1, &p_iocb) == 1
+			&& os_aio_linux_io_getevents(ctx, 1, 1, &event,
+						     &timeout) == 1
+			&& event.res == UNIV_PAGE_SIZE
+			&& buf[0] == 0xA5 && buf[UNIV_PAGE_SIZE - 1] == 0xA5;
+	}
+
+	if (!ok) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Warning: a test i/o through Linux native"
+			" aio failed, errno %d.\n", errno);
+	}
+
+	ut_free(buf2);
+	close(fd);
+	os_aio_linux_io_destroy(ctx);
+
+	return(ok);
+}
+#endif /* LINUX_NATIVE_AIO */
+
 /****************************************************************************
 Initializes the asynchronous io system. Calls also os_io_init_simple.
 Creates a separate aio array for
@@ -3025,6 +3282,28 @@ os_aio_init(
 
 	os_aio_sync_array = os_aio_array_create(n_slots_sync, 1);
 
+#ifdef LINUX_NATIVE_AIO
+	if (os_aio_use_native_aio
+	    && !(os_aio_linux_create_io_ctx(os_aio_ibuf_array)
+		 && os_aio_linux_create_io_ctx(os_aio_log_array)
+		 && os_aio_linux_create_io_ctx(os_aio_read_array)
+		 && os_aio_linux_create_io_ctx(os_aio_write_array))) {
+
+		/* The slot arrays work as well for simulated aio; only
+		the contexts which were set up must go */
+
+		os_aio_linux_free_io_ctx(os_aio_ibuf_array);
+		os_aio_linux_free_io_ctx(os_aio_log_array);
+		os_aio_linux_free_io_ctx(os_aio_read_array);
+		os_aio_linux_free_io_ctx(os_aio_write_array);
+
+		fprintf(stderr,
+			"InnoDB: Warning: falling back to simulated aio.\n");
+
+		os_aio_use_native_aio = FALSE;
+	}
+#endif /* LINUX_NATIVE_AIO */
+
 	os_aio_n_segments = n_segments;
 
 	os_aio_validate();
@@ -3297,7 +3576,20 @@ loop:
 		goto loop;
 	}
 
-	for (i = 0;; i++) {
+	i = 0;
+
+#ifdef LINUX_NATIVE_AIO
+	if (os_aio_use_native_aio && array->n_segments > 1) {
+		/* Each segment has its own aio context and i/o-handler
+		thread: spread the requests over the segments, keeping
+		every area of 64 consecutive pages in one segment */
+
+		i = ((offset / UNIV_PAGE_SIZE) >> 6) % array->n_segments
+			* (array->n_slots / array->n_segments);
+	}
+#endif /* LINUX_NATIVE_AIO */
+
+	for (;; i = (i + 1) % array->n_slots) {
 		slot = os_aio_array_get_nth_slot(array, i);
 
 		if (slot->reserved == FALSE) {
@@ -3396,6 +3688,101 @@ os_aio_array_free_slot(
 	os_mutex_exit(array->mutex);
 }
 
+#ifdef LINUX_NATIVE_AIO
+/**************************************************************************
+Submits the i/o request of a reserved slot to the Linux aio context of its
+segment. If the kernel refuses the request, for example because the file
+system does not support aio on the file, the i/o is done synchronously
+here, and the i/o-handler thread of the segment only passes on the
+completion. */
+static
+void
+os_aio_linux_dispatch(
+/*==================*/
+	os_aio_array_t*	array,	/* in: aio array */
+	os_aio_slot_t*	slot)	/* in: reserved slot */
+{
+	static ibool	warned	= FALSE;
+	struct iocb*	iocb	= &slot->control;
+	ulint		type	= slot->type;
+	ulint		len	= slot->len;
+	ulint		segment;
+	ibool		ret;
+
+	ut_ad(slot->reserved);
+	ut_ad(array->aio_ctx);
+
+	if (srv_unix_file_flush_method == SRV_UNIX_O_DIRECT) {
+		/* O_DIRECT i/o must be done from and to buffers aligned
+		to the sector size; all InnoDB file i/o buffers are */
+
+		ut_a(((ulint) slot->buf) % OS_FILE_SECTOR_SIZE == 0);
+		ut_a(slot->len % OS_FILE_SECTOR_SIZE == 0);
+	}
+
+	segment = slot->pos / (array->n_slots / array->n_segments);
+
+	os_aio_linux_prepare_iocb(iocb, slot->type, slot->file, slot->buf,
+				  slot->len,
+				  (((ib_ulonglong) slot->offset_high) << 32)
+				  + slot->offset,
+				  slot);
+	for (;;) {
+		if (os_aio_linux_io_submit(array->aio_ctx[segment],
+					   1, &iocb) == 1) {
+			/* The slot may already have been completed and
+			freed by the i/o-handler thread: do not touch it */
+
+			if (type == OS_FILE_READ) {
+				os_n_file_reads++;
+				os_bytes_read_since_printout += len;
+			} else {
+				os_n_file_writes++;
+			}
+
+			return;
+		}
+
+		if (errno != EAGAIN && errno != EINTR) {
+
+			break;
+		}
+
+		/* The kernel is temporarily short of resources */
+
+		os_thread_sleep(1000);
+	}
+
+	if (!warned) {
+		warned = TRUE;
+
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Warning: io_submit() failed for file %s,"
+			" errno %d;\n"
+			"InnoDB: doing the i/o synchronously. This warning"
+			" is printed only once.\n",
+			slot->name, errno);
+	}
+
+	if (slot->type == OS_FILE_READ) {
+		ret = os_file_read(slot->file, slot->buf, slot->offset,
+				   slot->offset_high, slot->len);
+	} else {
+		ret = os_file_write(slot->name, slot->file, slot->buf,
+				    slot->offset, slot->offset_high,
+				    slot->len);
+	}
+
+	os_mutex_enter(array->mutex);
+
+	slot->n_bytes = ret ? (ib_longlong) slot->len : -1;
+	slot->io_already_done = TRUE;
+
+	os_mutex_exit(array->mutex);
+}
+#endif /* LINUX_NATIVE_AIO */
+
 /**************************************************************************
 Wakes up a simulated aio i/o-handler thread if it has something to do. */
 static
@@ -3611,6 +3998,8 @@ try_again:
 			slot->control.aio_lio_opcode = LIO_READ;
 			err = (ulint) aio_read(&(slot->control));
 			fprintf(stderr, "Starting POSIX aio read %lu\n", err);
+#elif defined(LINUX_NATIVE_AIO)
+			os_aio_linux_dispatch(array, slot);
 #endif
 		} else {
 			if (!wake_later) {
@@ -3629,6 +4018,8 @@ try_again:
 			slot->control.aio_lio_opcode = LIO_WRITE;
 			err = (ulint) aio_write(&(slot->control));
 			fprintf(stderr, "Starting POSIX aio write %lu\n", err);
+#elif defined(LINUX_NATIVE_AIO)
+			os_aio_linux_dispatch(array, slot);
 #endif
 		} else {
 			if (!wake_later) {
@@ -3915,6 +4306,182 @@ os_aio_posix_handle(
 }
 #endif
 
+#ifdef LINUX_NATIVE_AIO
+/**************************************************************************
+Waits for completion events in the aio context of a segment, and marks the
+completed slots. Returns also after OS_AIO_REAP_TIMEOUT if nothing
+completes. */
+static
+void
+os_aio_linux_collect(
+/*=================*/
+	os_aio_array_t*	array,	/* in: aio array */
+	ulint		segment,/* in: local segment number in the array */
+	ulint		n)	/* in: number of slots in a segment */
+{
+	struct io_event* events;
+	struct timespec	timeout;
+	os_aio_slot_t*	slot;
+	int		ret;
+	int		i;
+
+	events = array->aio_events + segment * n;
+
+	timeout.tv_sec = 0;
+	timeout.tv_nsec = OS_AIO_REAP_TIMEOUT;
+
+	ret = os_aio_linux_io_getevents(array->aio_ctx[segment], 1, (long) n,
+					events, &timeout);
+	if (ret < 0) {
+		if (errno == EINTR) {
+
+			return;
+		}
+
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Error: io_getevents() failed, errno %d\n",
+			errno);
+		ut_error;
+	}
+
+	if (ret == 0) {
+
+		return;
+	}
+
+	os_mutex_enter(array->mutex);
+
+	for (i = 0; i < ret; i++) {
+		slot = (os_aio_slot_t*) (ulint) events[i].data;
+
+		ut_a(slot->reserved);
+		ut_a(!slot->io_already_done);
+
+		slot->n_bytes = (ib_longlong) events[i].res;
+		slot->io_already_done = TRUE;
+	}
+
+	os_mutex_exit(array->mutex);
+}
+
+/**************************************************************************
+This function is only used in Linux native asynchronous i/o. Waits for an
+aio operation in the segment to complete; the kernel completion events are
+reaped with io_getevents. NOTE: this function will also take care of
+freeing the aio slot, therefore no other thread is allowed to do the
+freeing! */
+
+ibool
+os_aio_linux_handle(
+/*================*/
+				/* out: TRUE if the aio operation succeeded */
+	ulint	global_segment,	/* in: the number of the segment in the aio
+				arrays to wait for; segment 0 is the ibuf
+				i/o thread, segment 1 the log i/o thread,
+				then follow the non-ibuf read threads, and as
+				the last are the non-ibuf write threads */
+	fil_node_t**message1,	/* out: the messages passed with the aio
+				request; note that also in the case where
+				the aio operation failed, these output
+				parameters are valid and can be used to
+				restart the operation, for example */
+	void**	message2,
+	ulint*	type)		/* out: OS_FILE_WRITE or ..._READ */
+{
+	os_aio_array_t*	array;
+	os_aio_slot_t*	slot;
+	ulint		segment;
+	ulint		n;
+	ulint		i;
+	ibool		ret;
+
+	segment = os_aio_get_array_and_local_segment(&array, global_segment);
+
+	ut_ad(array->aio_ctx);
+	ut_ad(segment < array->n_segments);
+
+	n = array->n_slots / array->n_segments;
+
+	for (;;) {
+		srv_set_io_thread_op_info(global_segment,
+					  "looking for completed aio requests");
+
+		os_mutex_enter(array->mutex);
+
+		for (i = 0; i < n; i++) {
+			slot = os_aio_array_get_nth_slot(array,
+							 i + segment * n);
+
+			if (slot->reserved && slot->io_already_done) {
+
+				goto found;
+			}
+		}
+
+		os_mutex_exit(array->mutex);
+
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+
+			os_thread_exit(NULL);
+		}
+
+		srv_set_io_thread_op_info(global_segment,
+					  "waiting for completed aio requests");
+
+		os_aio_linux_collect(array, segment, n);
+	}
+
+found:
+	*message1 = slot->message1;
+	*message2 = slot->message2;
+
+	*type = slot->type;
+
+	os_mutex_exit(array->mutex);
+
+	/* Only this thread handles the slot until it is freed */
+
+	ret = TRUE;
+
+	if (UNIV_UNLIKELY(slot->n_bytes != (ib_longlong) slot->len)) {
+		/* A failed or partial i/o: do it again synchronously, so
+		that os_file_read and os_file_write handle the error */
+
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Warning: Linux aio %s of %lu bytes at"
+			" offset %lu %lu in file %s returned %ld;\n"
+			"InnoDB: retrying the i/o synchronously.\n",
+			slot->type == OS_FILE_READ ? "read" : "write",
+			(ulong) slot->len, (ulong) slot->offset_high,
+			(ulong) slot->offset, slot->name,
+			(long) slot->n_bytes);
+
+		if (slot->type == OS_FILE_READ) {
+			ret = os_file_read(slot->file, slot->buf,
+					   slot->offset, slot->offset_high,
+					   slot->len);
+		} else {
+			ret = os_file_write(slot->name, slot->file, slot->buf,
+					    slot->offset, slot->offset_high,
+					    slot->len);
+		}
+	}
+
+# ifdef UNIV_DO_FLUSH
+	if (slot->type == OS_FILE_WRITE
+	    && !os_do_not_call_flush_at_each_write) {
+		ut_a(TRUE == os_file_flush(slot->file));
+	}
+# endif /* UNIV_DO_FLUSH */
+
+	os_aio_array_free_slot(array, slot);
+
+	return(ret);
+}
+#endif /* LINUX_NATIVE_AIO */
+
 /**************************************************************************
 Do a 'last millisecond' check that the page end is sensible;
 reported page checksum errors from Linux seem to wipe over the page end. */
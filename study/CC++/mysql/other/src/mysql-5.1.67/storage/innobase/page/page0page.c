@@ -194,8 +194,10 @@ page_set_max_trx_id(
 
 	block = buf_block_align(page);
 
+	/* The page is x-latched: block->index cannot change */
+
 	if (block->is_hashed) {
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(block->index));
 	}
 
 	/* It is not necessary to write this change to the redo log, as
@@ -205,7 +207,7 @@ page_set_max_trx_id(
 	mach_write_to_8(page + PAGE_HEADER + PAGE_MAX_TRX_ID, trx_id);
 
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(block->index));
 	}
 }
 
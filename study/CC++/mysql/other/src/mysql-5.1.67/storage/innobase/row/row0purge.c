@@ -34,12 +34,14 @@ purge_node_t*
 row_purge_node_create(
 /*==================*/
 				/* out, own: purge node */
-	que_thr_t*	parent,	/* in: parent node, i.e., a thr node */
+	que_thr_t*	parent,	/* in: parent node, i.e., a thr node, or
+				NULL if the node is used outside a query
+				graph */
 	mem_heap_t*	heap)	/* in: memory heap where created */
 {
 	purge_node_t*	node;
 
-	ut_ad(parent && heap);
+	ut_ad(heap);
 
 	node = mem_heap_alloc(heap, sizeof(purge_node_t));
 
@@ -478,11 +480,10 @@ row_purge_parse_undo_rec(
 	ibool*		updated_extern,
 				/* out: TRUE if an externally stored field
 				was updated */
-	que_thr_t*	thr)	/* in: query thread */
+	trx_t*		trx)	/* in: purge transaction */
 {
 	dict_index_t*	clust_index;
 	byte*		ptr;
-	trx_t*		trx;
 	dulint		undo_no;
 	dulint		table_id;
 	dulint		trx_id;
@@ -490,9 +491,7 @@ row_purge_parse_undo_rec(
 	ulint		info_bits;
 	ulint		type;
 
-	ut_ad(node && thr);
-
-	trx = thr_get_trx(thr);
+	ut_ad(node && trx);
 
 	ptr = trx_undo_rec_get_pars(
 		node->undo_rec, &type, &node->cmpl_info,
@@ -574,45 +573,32 @@ row_purge_parse_undo_rec(
 }
 
 /***************************************************************
-Fetches an undo log record and does the purge for the recorded operation.
-If none left, or the current purge completed, returns the control to the
-parent node, which is always a query thread node. */
-static
-ulint
-row_purge(
-/*======*/
-				/* out: DB_SUCCESS if operation successfully
-				completed, else error code */
+Does the purge for the operation recorded in an undo log record fetched
+from the history list. The caller must keep the history from being
+truncated until this returns. */
+
+void
+row_purge_undo_rec(
+/*===============*/
 	purge_node_t*	node,	/* in: row purge node */
-	que_thr_t*	thr)	/* in: query thread */
+	trx_undo_rec_t*	undo_rec,/* in: copy of the undo log record, or
+				&trx_purge_dummy_rec */
+	dulint		roll_ptr,/* in: roll pointer to the record */
+	trx_t*		trx)	/* in: purge transaction */
 {
-	dulint	roll_ptr;
 	ibool	purge_needed;
 	ibool	updated_extern;
-	trx_t*	trx;
-
-	ut_ad(node && thr);
 
-	trx = thr_get_trx(thr);
-
-	node->undo_rec = trx_purge_fetch_next_rec(&roll_ptr,
-						  &(node->reservation),
-						  node->heap);
-	if (!node->undo_rec) {
-		/* Purge completed for this query thread */
-
-		thr->run_node = que_node_get_parent(node);
-
-		return(DB_SUCCESS);
-	}
+	ut_ad(node && undo_rec && trx);
 
+	node->undo_rec = undo_rec;
 	node->roll_ptr = roll_ptr;
 
 	if (node->undo_rec == &trx_purge_dummy_rec) {
 		purge_needed = FALSE;
 	} else {
 		purge_needed = row_purge_parse_undo_rec(node, &updated_extern,
-							thr);
+							trx);
 		/* If purge_needed == TRUE, we must also remember to unfreeze
 		data dictionary! */
 	}
@@ -640,8 +626,40 @@ row_purge(
 	}
 
 	/* Do some cleanup */
-	trx_purge_rec_release(node->reservation);
 	mem_heap_empty(node->heap);
+}
+
+/***************************************************************
+Fetches an undo log record and does the purge for the recorded operation.
+If none left, or the current purge completed, returns the control to the
+parent node, which is always a query thread node. */
+static
+ulint
+row_purge(
+/*======*/
+				/* out: DB_SUCCESS if operation successfully
+				completed, else error code */
+	purge_node_t*	node,	/* in: row purge node */
+	que_thr_t*	thr)	/* in: query thread */
+{
+	trx_undo_rec_t*	undo_rec;
+	dulint		roll_ptr;
+
+	ut_ad(node && thr);
+
+	undo_rec = trx_purge_fetch_next_rec(&roll_ptr, &(node->reservation),
+					    node->heap);
+	if (!undo_rec) {
+		/* Purge completed for this query thread */
+
+		thr->run_node = que_node_get_parent(node);
+
+		return(DB_SUCCESS);
+	}
+
+	row_purge_undo_rec(node, undo_rec, roll_ptr, thr_get_trx(thr));
+
+	trx_purge_rec_release(node->reservation);
 
 	thr->run_node = node;
 
@@ -1079,7 +1079,7 @@ row_sel_try_search_shortcut(
 	ut_ad(plan->unique_search);
 	ut_ad(!plan->must_get_clust);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
+	ut_ad(rw_lock_own(btr_search_get_latch(index), RW_LOCK_SHARED));
 #endif /* UNIV_SYNC_DEBUG */
 
 	row_sel_open_pcur(node, plan, TRUE, mtr);
@@ -1166,7 +1166,8 @@ row_sel(
 	rec_t*		rec;
 	rec_t*		old_vers;
 	rec_t*		clust_rec;
-	ibool		search_latch_locked;
+	rw_lock_t*	search_latch;	/* the adaptive hash index partition
+					latch we hold in s-mode, or NULL */
 	ibool		consistent_read;
 
 	/* The following flag becomes TRUE when we are doing a
@@ -1201,7 +1202,7 @@ row_sel(
 
 	ut_ad(thr->run_node == node);
 
-	search_latch_locked = FALSE;
+	search_latch = NULL;
 
 	if (node->read_view) {
 		/* In consistent reads, we try to do with the hash index and
@@ -1252,11 +1253,21 @@ table_loop:
 	if (consistent_read && plan->unique_search && !plan->pcur_is_open
 	    && !plan->must_get_clust
 	    && !plan->table->big_rows) {
-		if (!search_latch_locked) {
-			rw_lock_s_lock(&btr_search_latch);
+		if (search_latch
+		    && search_latch != btr_search_get_latch(index)) {
+			/* The index of this table maps to another hash
+			index partition: we never hold two of them */
 
-			search_latch_locked = TRUE;
-		} else if (btr_search_latch.writer_is_wait_ex) {
+			rw_lock_s_unlock(search_latch);
+
+			search_latch = NULL;
+		}
+
+		if (!search_latch) {
+			search_latch = btr_search_get_latch(index);
+
+			rw_lock_s_lock(search_latch);
+		} else if (search_latch->writer_is_wait_ex) {
 
 			/* There is an x-latch request waiting: release the
 			s-latch for a moment; as an s-latch here is often
@@ -1265,8 +1276,8 @@ table_loop:
 			from acquiring an s-latch for a long time, lowering
 			performance significantly in multiprocessors. */
 
-			rw_lock_s_unlock(&btr_search_latch);
-			rw_lock_s_lock(&btr_search_latch);
+			rw_lock_s_unlock(search_latch);
+			rw_lock_s_lock(search_latch);
 		}
 
 		found_flag = row_sel_try_search_shortcut(node, plan, &mtr);
@@ -1288,17 +1299,17 @@ table_loop:
 		mtr_start(&mtr);
 	}
 
-	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+	if (search_latch) {
+		rw_lock_s_unlock(search_latch);
 
-		search_latch_locked = FALSE;
+		search_latch = NULL;
 	}
 
 	if (!plan->pcur_is_open) {
 		/* Evaluate the expressions to build the search tuple and
 		open the cursor */
 
-		row_sel_open_pcur(node, plan, search_latch_locked, &mtr);
+		row_sel_open_pcur(node, plan, search_latch != NULL, &mtr);
 
 		cursor_just_opened = TRUE;
 
@@ -1684,7 +1695,7 @@ skip_lock:
 	}
 
 next_rec:
-	ut_ad(!search_latch_locked);
+	ut_ad(!search_latch);
 
 	if (mtr_has_extra_clust_latch) {
 
@@ -1736,7 +1747,7 @@ next_table:
 
 		plan->cursor_at_end = TRUE;
 	} else {
-		ut_ad(!search_latch_locked);
+		ut_ad(!search_latch);
 
 		plan->stored_cursor_rec_processed = TRUE;
 
@@ -1765,8 +1776,8 @@ next_table_no_mtr:
 
 		thr->run_node = que_node_get_parent(node);
 
-		if (search_latch_locked) {
-			rw_lock_s_unlock(&btr_search_latch);
+		if (search_latch) {
+			rw_lock_s_unlock(search_latch);
 		}
 
 		err = DB_SUCCESS;
@@ -1813,8 +1824,8 @@ table_exhausted_no_mtr:
 
 			thr->run_node = que_node_get_parent(node);
 
-			if (search_latch_locked) {
-				rw_lock_s_unlock(&btr_search_latch);
+			if (search_latch) {
+				rw_lock_s_unlock(search_latch);
 			}
 
 			goto func_exit;
@@ -1824,8 +1835,8 @@ table_exhausted_no_mtr:
 
 		thr->run_node = que_node_get_parent(node);
 
-		if (search_latch_locked) {
-			rw_lock_s_unlock(&btr_search_latch);
+		if (search_latch) {
+			rw_lock_s_unlock(search_latch);
 		}
 
 		goto func_exit;
@@ -1844,7 +1855,7 @@ stop_for_a_while:
 	inserted new records which should have appeared in the result set,
 	which would result in the phantom problem. */
 
-	ut_ad(!search_latch_locked);
+	ut_ad(!search_latch);
 
 	plan->stored_cursor_rec_processed = FALSE;
 	btr_pcur_store_position(&(plan->pcur), &mtr);
@@ -1864,7 +1875,7 @@ commit_mtr_for_a_while:
 
 	plan->stored_cursor_rec_processed = TRUE;
 
-	ut_ad(!search_latch_locked);
+	ut_ad(!search_latch);
 	btr_pcur_store_position(&(plan->pcur), &mtr);
 
 	mtr_commit(&mtr);
@@ -1883,7 +1894,7 @@ lock_wait_or_error:
 
 	ut_ad(!btr_pcur_is_before_first_on_page(&(plan->pcur), &mtr)
 	      || !node->asc);
-	ut_ad(!search_latch_locked);
+	ut_ad(!search_latch);
 
 	plan->stored_cursor_rec_processed = FALSE;
 	btr_pcur_store_position(&(plan->pcur), &mtr);
@@ -3373,15 +3384,16 @@ row_search_for_mysql(
 	/* PHASE 0: Release a possible s-latch we are holding on the
 	adaptive hash index latch if there is someone waiting behind */
 
-	if (UNIV_UNLIKELY(btr_search_latch.writer != RW_LOCK_NOT_LOCKED)
-	    && trx->has_search_latch) {
+	if (trx->has_search_latch
+	    && UNIV_UNLIKELY(trx->search_latch->writer
+			     != RW_LOCK_NOT_LOCKED)) {
 
 		/* There is an x-latch request on the adaptive hash index:
 		release the s-latch to reduce starvation and wait for
 		BTR_SEA_TIMEOUT rounds before trying to keep it again over
 		calls from MySQL */
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 		trx->has_search_latch = FALSE;
 
 		trx->search_latch_timeout = BTR_SEA_TIMEOUT;
@@ -3535,8 +3547,20 @@ row_search_for_mysql(
 			hash index semaphore! */
 
 #ifndef UNIV_SEARCH_DEBUG
+			if (trx->has_search_latch
+			    && trx->search_latch
+			    != btr_search_get_latch(index)) {
+				/* We kept the latch of another hash
+				index partition over calls from MySQL */
+
+				rw_lock_s_unlock(trx->search_latch);
+				trx->has_search_latch = FALSE;
+			}
+
 			if (!trx->has_search_latch) {
-				rw_lock_s_lock(&btr_search_latch);
+				trx->search_latch = btr_search_get_latch(
+					index);
+				rw_lock_s_lock(trx->search_latch);
 				trx->has_search_latch = TRUE;
 			}
 #endif
@@ -3570,7 +3594,7 @@ row_search_for_mysql(
 
 					trx->search_latch_timeout--;
 
-					rw_lock_s_unlock(&btr_search_latch);
+					rw_lock_s_unlock(trx->search_latch);
 					trx->has_search_latch = FALSE;
 				}
 
@@ -3590,7 +3614,7 @@ row_search_for_mysql(
 
 					trx->search_latch_timeout--;
 
-					rw_lock_s_unlock(&btr_search_latch);
+					rw_lock_s_unlock(trx->search_latch);
 					trx->has_search_latch = FALSE;
 				}
 
@@ -3610,7 +3634,7 @@ shortcut_fails_too_big_rec:
 	/* PHASE 3: Open or restore index cursor position */
 
 	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 		trx->has_search_latch = FALSE;
 	}
 
@@ -3850,8 +3874,8 @@ wrong_offs:
 				" buffer frame %p\n"
 				"InnoDB: buffer pool high end %p,"
 				" buf block fix count %lu\n",
-				(void*) rec, (void*) buf_pool->frame_zero,
-				(void*) buf_pool->high_end,
+				(void*) rec, (void*) buf_pool_frame_zero,
+				(void*) buf_pool_high_end,
 				(ulong)buf_block_align(rec)->buf_fix_count);
 			fprintf(stderr,
 				"InnoDB: Index corruption: rec offs %lu"
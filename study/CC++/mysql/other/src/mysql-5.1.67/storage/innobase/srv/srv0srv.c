@@ -175,6 +175,9 @@ ulint	srv_pool_size		= ULINT_MAX;	/* size in pages; MySQL inits
 						this to size in kilobytes but
 						we normalize this to pages in
 						srv_boot() */
+ulint	srv_buf_pool_instances	= 1;		/* number of buffer pool
+						instances the pages are
+						hashed to */
 ulint	srv_awe_window_size	= 0;		/* size in pages; MySQL inits
 						this to bytes, but we
 						normalize it to pages in
@@ -184,6 +187,15 @@ ulint	srv_lock_table_size	= ULINT_MAX;
 
 ulint	srv_n_file_io_threads	= ULINT_MAX;
 
+/* Number of threads which apply the hashed redo log records to pages in a
+crash recovery batch */
+ulint	srv_n_recv_threads	= 4;
+
+/* Number of purge threads: 0 runs purge in the master thread, 1 in a
+separate purge thread, and n > 1 in a purge coordinator thread which hands
+the undo log records to n purge worker threads */
+ulint	srv_n_purge_threads	= 1;
+
 #ifdef UNIV_LOG_ARCHIVE
 ibool	srv_log_archive_on	= FALSE;
 ibool	srv_archive_recovery	= 0;
@@ -215,6 +227,25 @@ that during a time of heavy update/insert activity. */
 
 ulong	srv_max_buf_pool_modified_pct	= 90;
 
+/* The number of i/o operations per second the server can do. The page
+cleaners size their background flush batches as percentages of this. */
+
+ulong	srv_io_capacity			= 200;
+
+/* The upper limit of the pages flushed per second by the adaptive
+flushing */
+
+ulong	srv_io_capacity_max		= 2000;
+
+/* If TRUE, the page cleaners flush the buffer pool at the rate the redo
+log is generated, so that the checkpoint age does not reach the limit
+where the user threads have to flush. The flushing starts when the age of
+the oldest modification exceeds srv_adaptive_flushing_lwm percent of
+that limit. */
+
+char	srv_adaptive_flushing		= TRUE;
+ulong	srv_adaptive_flushing_lwm	= 10;
+
 /* variable counts amount of data read in total (in bytes) */
 ulint srv_data_read = 0;
 
@@ -262,6 +293,22 @@ ulint srv_buf_pool_wait_free = 0;
 pool to the disk */
 ulint srv_buf_pool_flushed = 0;
 
+/* the numbers of pages the page cleaner threads have flushed from the
+end of the LRU lists and from the flush lists */
+ulint srv_page_cleaner_lru_flushed = 0;
+ulint srv_page_cleaner_list_flushed = 0;
+
+/* number of times a user thread left a preflush for a younger checkpoint
+to the page cleaners instead of doing it itself */
+ulint srv_page_cleaner_requests = 0;
+
+/* number of pages the adaptive flushing has flushed */
+ulint srv_adaptive_flushed = 0;
+
+/* the redo generation rate last estimated by the page cleaners, in bytes
+per second */
+ulint srv_redo_rate = 0;
+
 /* variable to count the number of buffer pool reads that led to the
 reading of a disk page */
 ulint srv_buf_pool_reads = 0;
@@ -355,6 +402,13 @@ ibool	srv_innodb_status	= FALSE;
 ibool	srv_use_doublewrite_buf	= TRUE;
 ibool	srv_use_checksums = TRUE;
 
+/* The checksum algorithm of the pages InnoDB writes */
+ulong	srv_checksum_algorithm = SRV_CHECKSUM_ALGORITHM_INNODB;
+
+/* Use Linux kernel aio (io_submit) instead of simulated aio when the
+kernel supports it */
+ibool	srv_use_native_aio = TRUE;
+
 ibool	srv_set_thread_priorities = TRUE;
 int	srv_query_thread_priority = 0;
 
@@ -362,6 +416,9 @@ int	srv_query_thread_priority = 0;
 disable adaptive hash indexes */
 ibool	srv_use_awe			= FALSE;
 ibool	srv_use_adaptive_hash_indexes	= TRUE;
+/* Number of partitions of the adaptive hash index; each partition has its
+own hash table and latch, and an index is mapped to one by its id */
+ulint	srv_n_adaptive_hash_parts	= 8;
 
 /*-------------------------------------------*/
 ulong	srv_n_spin_wait_rounds	= 20;
@@ -989,6 +1046,7 @@ srv_general_init(void)
 	sync_init();
 	mem_init(srv_mem_pool_size);
 	thr_local_init();
+	ut_crc32c_init();
 }
 
 /*======================= InnoDB Server FIFO queue =======================*/
@@ -996,6 +1054,10 @@ srv_general_init(void)
 /* Maximum allowable purge history length.  <=0 means 'infinite'. */
 ulong	srv_max_purge_lag		= 0;
 
+/* Maximum delay in microseconds of a DML statement when the history list
+length exceeds srv_max_purge_lag. 0 means no maximum. */
+ulong	srv_max_purge_lag_delay		= 0;
+
 /*************************************************************************
 Puts an OS thread to wait if there are too many concurrent threads
 (>= srv_thread_concurrency) inside InnoDB. The threads wait in a FIFO queue. */
@@ -1742,7 +1804,7 @@ srv_printf_innodb_monitor(
 	      "-------------------------------------\n", file);
 	ibuf_print(file);
 
-	ha_print_info(file, btr_search_sys->hash_index);
+	btr_search_print_info(file);
 
 	fprintf(file,
 		"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -1846,6 +1908,21 @@ Function to pass InnoDB status variables to MySQL */
 void
 srv_export_innodb_status(void)
 {
+	buf_pool_stat_t	stat;
+	dulint		oldest_lsn;
+	ulint		checkpoint_age	= 0;
+
+	buf_get_total_stat(&stat);
+
+	/* Read the oldest modification first: it can only be older than
+	the current lsn read after it */
+
+	oldest_lsn = buf_pool_get_oldest_modification();
+
+	if (!ut_dulint_is_zero(oldest_lsn)) {
+		checkpoint_age = ut_dulint_minus(log_get_lsn(), oldest_lsn);
+	}
+
 	mutex_enter(&srv_innodb_monitor_mutex);
 
 	export_vars.innodb_data_pending_reads
@@ -1860,7 +1937,7 @@ srv_export_innodb_status(void)
 	export_vars.innodb_data_reads = os_n_file_reads;
 	export_vars.innodb_data_writes = os_n_file_writes;
 	export_vars.innodb_data_written = srv_data_written;
-	export_vars.innodb_buffer_pool_read_requests = buf_pool->n_page_gets;
+	export_vars.innodb_buffer_pool_read_requests = stat.n_page_gets;
 	export_vars.innodb_buffer_pool_write_requests
 		= srv_buf_pool_write_requests;
 	export_vars.innodb_buffer_pool_wait_free = srv_buf_pool_wait_free;
@@ -1869,20 +1946,19 @@ srv_export_innodb_status(void)
 	export_vars.innodb_buffer_pool_read_ahead_rnd = srv_read_ahead_rnd;
 	export_vars.innodb_buffer_pool_read_ahead_seq = srv_read_ahead_seq;
 	export_vars.innodb_buffer_pool_pages_data
-		= UT_LIST_GET_LEN(buf_pool->LRU);
+		= stat.LRU_len;
 	export_vars.innodb_buffer_pool_pages_dirty
-		= UT_LIST_GET_LEN(buf_pool->flush_list);
+		= stat.flush_list_len;
 	export_vars.innodb_buffer_pool_pages_free
-		= UT_LIST_GET_LEN(buf_pool->free);
+		= stat.free_len;
 #ifdef UNIV_DEBUG
 	export_vars.innodb_buffer_pool_pages_latched
 		= buf_get_latched_pages_number();
 #endif /* UNIV_DEBUG */
-	export_vars.innodb_buffer_pool_pages_total = buf_pool->curr_size;
+	export_vars.innodb_buffer_pool_pages_total = stat.curr_size;
 
-	export_vars.innodb_buffer_pool_pages_misc = buf_pool->max_size
-		- UT_LIST_GET_LEN(buf_pool->LRU)
-		- UT_LIST_GET_LEN(buf_pool->free);
+	export_vars.innodb_buffer_pool_pages_misc = stat.max_size
+		- stat.LRU_len - stat.free_len;
 	export_vars.innodb_page_size = UNIV_PAGE_SIZE;
 	export_vars.innodb_log_waits = srv_log_waits;
 	export_vars.innodb_os_log_written = srv_os_log_written;
@@ -1893,9 +1969,23 @@ srv_export_innodb_status(void)
 	export_vars.innodb_log_writes = srv_log_writes;
 	export_vars.innodb_dblwr_pages_written = srv_dblwr_pages_written;
 	export_vars.innodb_dblwr_writes = srv_dblwr_writes;
-	export_vars.innodb_pages_created = buf_pool->n_pages_created;
-	export_vars.innodb_pages_read = buf_pool->n_pages_read;
-	export_vars.innodb_pages_written = buf_pool->n_pages_written;
+	export_vars.innodb_pages_created = stat.n_pages_created;
+	export_vars.innodb_pages_read = stat.n_pages_read;
+	export_vars.innodb_pages_written = stat.n_pages_written;
+	export_vars.innodb_page_cleaner_threads = buf_flush_n_page_cleaners;
+	export_vars.innodb_history_list_length = trx_sys->rseg_history_len;
+	export_vars.innodb_purge_threads = trx_purge_n_threads;
+	btr_search_get_n_hits(&export_vars.innodb_adaptive_hash_hits,
+			      &export_vars.innodb_adaptive_hash_misses);
+	export_vars.innodb_page_cleaner_lru_flushed
+		= srv_page_cleaner_lru_flushed;
+	export_vars.innodb_page_cleaner_list_flushed
+		= srv_page_cleaner_list_flushed;
+	export_vars.innodb_page_cleaner_requests = srv_page_cleaner_requests;
+	export_vars.innodb_checkpoint_age = checkpoint_age;
+	export_vars.innodb_checkpoint_max_age = log_sys->max_modified_age_async;
+	export_vars.innodb_redo_rate = srv_redo_rate;
+	export_vars.innodb_adaptive_flushed = srv_adaptive_flushed;
 	export_vars.innodb_row_lock_waits = srv_n_lock_wait_count;
 	export_vars.innodb_row_lock_current_waits
 		= srv_n_lock_wait_current_count;
@@ -2314,6 +2404,22 @@ srv_wake_master_thread(void)
 	mutex_exit(&kernel_mutex);
 }
 
+/*************************************************************************
+Returns the number of log and buffer pool i/os done since startup. */
+static
+ulint
+srv_get_n_ios(void)
+/*===============*/
+			/* out: number of i/os */
+{
+	buf_pool_stat_t	stat;
+
+	buf_get_total_stat(&stat);
+
+	return(log_sys->n_log_ios + stat.n_pages_read
+	       + stat.n_pages_written);
+}
+
 /*************************************************************************
 The master thread controlling the server. */
 
@@ -2336,9 +2442,7 @@ srv_master_thread(
 	ulint		n_tables_to_drop;
 	ulint		n_ios;
 	ulint		n_ios_old;
-	ulint		n_ios_very_old;
 	ulint		n_pend_ios;
-	ibool		skip_sleep	= FALSE;
 	ulint		i;
 
 #ifdef UNIV_DEBUG_THREAD_CREATION
@@ -2363,8 +2467,6 @@ loop:
 
 	srv_main_thread_op_info = "reserving kernel mutex";
 
-	n_ios_very_old = log_sys->n_log_ios + buf_pool->n_pages_read
-		+ buf_pool->n_pages_written;
 	mutex_enter(&kernel_mutex);
 
 	/* Store the user activity counter at the start of this loop */
@@ -2378,21 +2480,14 @@ loop:
 	}
 
 	/* ---- We run the following loop approximately once per second
-	when there is database activity */
-
-	skip_sleep = FALSE;
+	when there is database activity. The page cleaner threads flush
+	the buffer pool meanwhile. */
 
 	for (i = 0; i < 10; i++) {
-		n_ios_old = log_sys->n_log_ios + buf_pool->n_pages_read
-			+ buf_pool->n_pages_written;
+		n_ios_old = srv_get_n_ios();
 		srv_main_thread_op_info = "sleeping";
 
-		if (!skip_sleep) {
-
-			os_thread_sleep(1000000);
-		}
-
-		skip_sleep = FALSE;
+		os_thread_sleep(1000000);
 
 		/* ALTER TABLE in MySQL requires on Unix that the table handler
 		can drop tables lazily after there no longer are SELECT
@@ -2426,8 +2521,7 @@ loop:
 
 		n_pend_ios = buf_get_n_pending_ios()
 			+ log_sys->n_pending_writes;
-		n_ios = log_sys->n_log_ios + buf_pool->n_pages_read
-			+ buf_pool->n_pages_written;
+		n_ios = srv_get_n_ios();
 		if (n_pend_ios < 3 && (n_ios - n_ios_old < 5)) {
 			srv_main_thread_op_info = "doing insert buffer merge";
 			ibuf_contract_for_n_pages(
@@ -2438,23 +2532,6 @@ loop:
 			log_buffer_flush_to_disk();
 		}
 
-		if (UNIV_UNLIKELY(buf_get_modified_ratio_pct()
-				  > srv_max_buf_pool_modified_pct)) {
-
-			/* Try to keep the number of modified pages in the
-			buffer pool under the limit wished by the user */
-
-			n_pages_flushed = buf_flush_batch(BUF_FLUSH_LIST, 100,
-							  ut_dulint_max);
-
-			/* If we had to do the flush, it may have taken
-			even more than 1 second, and also, there may be more
-			to flush. Do not sleep 1 second during the next
-			iteration of this loop. */
-
-			skip_sleep = TRUE;
-		}
-
 		if (srv_activity_count == old_activity_count) {
 
 			/* There is no user activity at the moment, go to
@@ -2472,22 +2549,6 @@ loop:
 	seconds */
 	mem_validate_all_blocks();
 #endif
-	/* If there were less than 200 i/os during the 10 second period,
-	we assume that there is free disk i/o capacity available, and it
-	makes sense to flush 100 pages. */
-
-	n_pend_ios = buf_get_n_pending_ios() + log_sys->n_pending_writes;
-	n_ios = log_sys->n_log_ios + buf_pool->n_pages_read
-		+ buf_pool->n_pages_written;
-	if (n_pend_ios < 3 && (n_ios - n_ios_very_old < 200)) {
-
-		srv_main_thread_op_info = "flushing buffer pool pages";
-		buf_flush_batch(BUF_FLUSH_LIST, 100, ut_dulint_max);
-
-		srv_main_thread_op_info = "flushing log";
-		log_buffer_flush_to_disk();
-	}
-
 	/* We run a batch of insert buffer merge every 10 seconds,
 	even if the server were active */
 
@@ -2498,9 +2559,9 @@ loop:
 	log_buffer_flush_to_disk();
 
 	/* We run a full purge every 10 seconds, even if the server
-	were active */
+	were active, unless the purge threads run it */
 
-	n_pages_purged = 1;
+	n_pages_purged = (srv_n_purge_threads == 0);
 
 	last_flush_time = time(NULL);
 
@@ -2524,27 +2585,6 @@ loop:
 		}
 	}
 
-	srv_main_thread_op_info = "flushing buffer pool pages";
-
-	/* Flush a few oldest pages to make a new checkpoint younger */
-
-	if (buf_get_modified_ratio_pct() > 70) {
-
-		/* If there are lots of modified pages in the buffer pool
-		(> 70 %), we assume we can afford reserving the disk(s) for
-		the time it requires to flush 100 pages */
-
-		n_pages_flushed = buf_flush_batch(BUF_FLUSH_LIST, 100,
-						  ut_dulint_max);
-	} else {
-		/* Otherwise, we only flush a small number of pages so that
-		we do not unnecessarily use much disk i/o capacity from
-		other work */
-
-		n_pages_flushed = buf_flush_batch(BUF_FLUSH_LIST, 10,
-						  ut_dulint_max);
-	}
-
 	srv_main_thread_op_info = "making checkpoint";
 
 	/* Make a new checkpoint about once in 10 seconds */
@@ -2591,9 +2631,9 @@ background_loop:
 
 	srv_main_thread_op_info = "purging";
 
-	/* Run a full purge */
+	/* Run a full purge, unless the purge threads run it */
 
-	n_pages_purged = 1;
+	n_pages_purged = (srv_n_purge_threads == 0);
 
 	last_flush_time = time(NULL);
 
@@ -2647,8 +2687,8 @@ flush_loop:
 	srv_main_thread_op_info = "flushing buffer pool pages";
 
 	if (srv_fast_shutdown < 2) {
-		n_pages_flushed = buf_flush_batch(BUF_FLUSH_LIST, 100,
-						  ut_dulint_max);
+		n_pages_flushed = buf_flush_list(SRV_PCT_IO(100),
+						 ut_dulint_max);
 	} else {
 		/* In the fastest shutdown we do not flush the buffer pool
 		to data files: we set n_pages_flushed to 0 artificially. */
@@ -2666,7 +2706,7 @@ flush_loop:
 	mutex_exit(&kernel_mutex);
 
 	srv_main_thread_op_info = "waiting for buffer pool flush to end";
-	buf_flush_wait_batch_end(BUF_FLUSH_LIST);
+	buf_flush_wait_batch_end(NULL, BUF_FLUSH_LIST);
 
 	srv_main_thread_op_info = "flushing log";
 
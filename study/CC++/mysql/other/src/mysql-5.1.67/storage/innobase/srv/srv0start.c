@@ -89,6 +89,9 @@ static ulint		ios;
 
 static ulint		n[SRV_MAX_N_IO_THREADS + 6];
 static os_thread_id_t	thread_ids[SRV_MAX_N_IO_THREADS + 6];
+/* Arguments of the page cleaner threads: the buffer pool instance ids */
+static ulint		page_cleaner_n[BUF_POOL_MAX_INSTANCES];
+static ulint		purge_worker_n[SRV_MAX_N_PURGE_THREADS];
 
 /* We use this mutex to test the return value of pthread_mutex_trylock
    on successful locking. HP-UX does NOT return 0, though Linux et al do. */
@@ -1230,6 +1233,18 @@ innobase_start_or_create_for_mysql(void)
 		srv_n_file_io_threads = SRV_MAX_N_IO_THREADS;
 	}
 
+#ifdef LINUX_NATIVE_AIO
+	if (srv_use_native_aio) {
+		if (os_aio_linux_native_supported()) {
+			os_aio_use_native_aio = TRUE;
+		} else {
+			fprintf(stderr,
+				"InnoDB: Warning: Linux native aio is not"
+				" supported, using simulated aio.\n");
+		}
+	}
+#endif /* LINUX_NATIVE_AIO */
+
 	if (!os_aio_use_native_aio) {
 		/* In simulated aio we currently have use only for 4 threads */
 		srv_n_file_io_threads = 4;
@@ -1239,10 +1254,37 @@ innobase_start_or_create_for_mysql(void)
 			    srv_n_file_io_threads,
 			    SRV_MAX_N_PENDING_SYNC_IOS);
 	} else {
+#ifdef LINUX_NATIVE_AIO
+		/* Unlike Windows, Linux does not limit the number of
+		pending i/os of a thread: queue as deep as simulated aio,
+		and let every i/o-handler thread reap its own aio context */
+
+		os_aio_init(8 * SRV_N_PENDING_IOS_PER_THREAD
+			    * srv_n_file_io_threads,
+			    srv_n_file_io_threads,
+			    SRV_MAX_N_PENDING_SYNC_IOS);
+#else
 		os_aio_init(SRV_N_PENDING_IOS_PER_THREAD
 			    * srv_n_file_io_threads,
 			    srv_n_file_io_threads,
 			    SRV_MAX_N_PENDING_SYNC_IOS);
+#endif /* LINUX_NATIVE_AIO */
+	}
+
+	/* os_aio_init() falls back to simulated aio if it cannot set up
+	the native aio contexts */
+	srv_use_native_aio = os_aio_use_native_aio;
+
+	if (os_aio_use_native_aio) {
+		fprintf(stderr,
+			"InnoDB: Using native aio with %lu i/o threads\n",
+			(ulong) srv_n_file_io_threads);
+	}
+
+	if (ut_crc32c_sse42_enabled) {
+		fprintf(stderr,
+			"InnoDB: Using SSE4.2 crc32 instructions"
+			" for CRC-32C page checksums\n");
 	}
 
 	fil_init(srv_max_n_open_files);
@@ -1277,9 +1319,33 @@ innobase_start_or_create_for_mysql(void)
 		tolerate remapping of pages in AWE */
 
 		srv_use_adaptive_hash_indexes = FALSE;
+
+		/* A page may be mapped to any frame of the window, which
+		is only possible if the window belongs to one instance */
+
+		srv_buf_pool_instances = 1;
+
 		ret = buf_pool_init(srv_pool_size, srv_pool_size,
 				    srv_awe_window_size);
 	} else {
+		/* Do not split the buffer pool into instances which are
+		too small to hold a read-ahead area and a free margin */
+
+		ut_a(srv_buf_pool_instances <= BUF_POOL_MAX_INSTANCES);
+
+		while (srv_buf_pool_instances > 1
+		       && srv_pool_size / srv_buf_pool_instances
+		       < BUF_POOL_INSTANCE_MIN_SIZE) {
+			srv_buf_pool_instances--;
+		}
+
+		if (srv_buf_pool_instances > 1) {
+			fprintf(stderr,
+				"InnoDB: Using %lu buffer pool instances\n",
+				(ulong) srv_buf_pool_instances);
+		}
+
+
 		ret = buf_pool_init(srv_pool_size, srv_pool_size,
 				    srv_pool_size);
 	}
@@ -1638,6 +1704,33 @@ innobase_start_or_create_for_mysql(void)
 
 	os_thread_create(&srv_master_thread, NULL, thread_ids
 			 + (1 + SRV_MAX_N_IO_THREADS));
+
+	/* Create the page cleaner threads which flush the buffer pool
+	instances in the background */
+
+	if (srv_force_recovery < SRV_FORCE_NO_BACKGROUND) {
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+			page_cleaner_n[i] = i;
+
+			os_thread_create(&buf_flush_page_cleaner_thread,
+					 page_cleaner_n + i, NULL);
+		}
+	}
+
+	/* Create the purge threads, which run the purge instead of the
+	master thread */
+
+	if (srv_force_recovery < SRV_FORCE_NO_BACKGROUND
+	    && srv_n_purge_threads > 0) {
+		os_thread_create(&trx_purge_coordinator_thread, NULL, NULL);
+
+		for (i = 0; i < purge_sys->n_workers; i++) {
+			purge_worker_n[i] = i;
+
+			os_thread_create(&trx_purge_worker_thread,
+					 purge_worker_n + i, NULL);
+		}
+	}
 #ifdef UNIV_DEBUG
 	/* buf_debug_prints = TRUE; */
 #endif /* UNIV_DEBUG */
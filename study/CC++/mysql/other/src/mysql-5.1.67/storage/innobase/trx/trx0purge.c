@@ -25,6 +25,8 @@ Created 3/26/1996 Heikki Tuuri
 #include "row0upd.h"
 #include "trx0rec.h"
 #include "srv0que.h"
+#include "srv0srv.h"
+#include "srv0start.h"
 #include "os0thread.h"
 
 /* The global data structure coordinating a purge */
@@ -34,6 +36,10 @@ trx_purge_t*	purge_sys = NULL;
 which needs no purge */
 trx_undo_rec_t	trx_purge_dummy_rec;
 
+/* Number of purge threads (the coordinator and the workers) which have
+not exited */
+ulint		trx_purge_n_threads	= 0;
+
 /*********************************************************************
 Checks if trx_id is >= purge_view: then it is guaranteed that its update
 undo log still exists in the system. */
@@ -190,6 +196,55 @@ trx_purge_graph_build(void)
 	return(fork);
 }
 
+/************************************************************************
+Creates the states of the purge worker threads, if more than one purge
+thread was requested. Each worker has its own purge node, and its own
+transaction object for freezing the data dictionary. */
+static
+void
+trx_purge_workers_create(void)
+/*==========================*/
+{
+	trx_purge_worker_t*	worker;
+	ulint			i;
+
+	ut_ad(mutex_own(&kernel_mutex));
+
+	purge_sys->n_workers = srv_n_purge_threads > 1
+		? srv_n_purge_threads : 0;
+	purge_sys->workers = NULL;
+	purge_sys->rec_heap = NULL;
+	purge_sys->n_busy = 0;
+	purge_sys->batch_done = NULL;
+	purge_sys->workers_exit = FALSE;
+
+	if (purge_sys->n_workers == 0) {
+
+		return;
+	}
+
+	purge_sys->workers = mem_alloc(purge_sys->n_workers
+				       * sizeof(trx_purge_worker_t));
+	purge_sys->rec_heap = mem_heap_create(16384);
+	purge_sys->batch_done = os_event_create(NULL);
+
+	for (i = 0; i < purge_sys->n_workers; i++) {
+		worker = purge_sys->workers + i;
+
+		worker->trx = trx_create(purge_sys->sess);
+		worker->trx->is_purge = 1;
+
+		ut_a(trx_start_low(worker->trx, ULINT_UNDEFINED));
+
+		worker->node = row_purge_node_create(
+			NULL, mem_heap_create(512));
+		worker->first = NULL;
+		worker->last = NULL;
+		worker->n_recs = 0;
+		worker->event = os_event_create(NULL);
+	}
+}
+
 /************************************************************************
 Creates the global purge system control structure and inits the history
 mutex. */
@@ -228,6 +283,8 @@ trx_purge_sys_create(void)
 
 	purge_sys->query = trx_purge_graph_build();
 
+	trx_purge_workers_create();
+
 	purge_sys->view = read_view_oldest_copy_or_open_new(ut_dulint_zero,
 							    purge_sys->heap);
 }
@@ -1011,6 +1068,118 @@ trx_purge_rec_release(
 	mutex_exit(&(purge_sys->mutex));
 }
 
+/***********************************************************************
+Hands the undo log records of a purge batch to the purge workers and waits
+until they have purged them. The records of one table always go to the same
+worker, so that the records of a row are purged in the history order. */
+static
+void
+trx_purge_run_workers(void)
+/*=======================*/
+{
+	trx_purge_worker_t*	worker;
+	trx_purge_rec_t*	rec;
+	trx_undo_rec_t*		undo_rec;
+	trx_undo_inf_t*		batch_cell;
+	trx_undo_inf_t*		cell;
+	dulint			roll_ptr;
+	dulint			undo_no;
+	dulint			table_id;
+	ulint			type;
+	ulint			cmpl_info;
+	ibool			updated_extern;
+	ulint			n_busy;
+	ulint			i;
+
+	/* The purge array has room for only a few records. Instead of
+	keeping a cell for each record handed to a worker, we keep one
+	for the whole batch: the history is not truncated while a cell
+	is in use, and the purge of an externally stored field needs
+	the undo log page of the record. */
+
+	mutex_enter(&(purge_sys->mutex));
+
+	batch_cell = trx_purge_arr_store_info(purge_sys->purge_trx_no,
+					      purge_sys->purge_undo_no);
+
+	mutex_exit(&(purge_sys->mutex));
+
+	for (;;) {
+		undo_rec = trx_purge_fetch_next_rec(&roll_ptr, &cell,
+						    purge_sys->rec_heap);
+		if (undo_rec == NULL) {
+
+			break;
+		}
+
+		trx_purge_rec_release(cell);
+
+		if (undo_rec == &trx_purge_dummy_rec) {
+			/* The whole undo log needs no purge */
+
+			continue;
+		}
+
+		trx_undo_rec_get_pars(undo_rec, &type, &cmpl_info,
+				      &updated_extern, &undo_no, &table_id);
+
+		worker = purge_sys->workers
+			+ ut_fold_dulint(table_id) % purge_sys->n_workers;
+
+		rec = mem_heap_alloc(purge_sys->rec_heap,
+				     sizeof(trx_purge_rec_t));
+		rec->undo_rec = undo_rec;
+		rec->roll_ptr = roll_ptr;
+		rec->next = NULL;
+
+		if (worker->last) {
+			worker->last->next = rec;
+		} else {
+			worker->first = rec;
+		}
+
+		worker->last = rec;
+		worker->n_recs++;
+	}
+
+	n_busy = 0;
+
+	for (i = 0; i < purge_sys->n_workers; i++) {
+		if (purge_sys->workers[i].n_recs > 0) {
+			n_busy++;
+		}
+	}
+
+	if (n_busy > 0) {
+		mutex_enter(&(purge_sys->mutex));
+
+		purge_sys->n_busy = n_busy;
+		os_event_reset(purge_sys->batch_done);
+
+		mutex_exit(&(purge_sys->mutex));
+
+		for (i = 0; i < purge_sys->n_workers; i++) {
+			if (purge_sys->workers[i].n_recs > 0) {
+				os_event_set(purge_sys->workers[i].event);
+			}
+		}
+
+		os_event_wait(purge_sys->batch_done);
+	}
+
+	/* The history could not be truncated in the last fetch */
+
+	mutex_enter(&(purge_sys->mutex));
+
+	trx_purge_arr_remove_info(batch_cell);
+
+	trx_purge_truncate_if_arr_empty();
+
+	mutex_exit(&(purge_sys->mutex));
+
+	mem_heap_empty(purge_sys->rec_heap);
+}
+
 /***********************************************************************
 This function runs a purge batch. */
 
@@ -1069,6 +1238,12 @@ trx_purge(void)
 			by at least 5000 microseconds. */
 			srv_dml_needed_delay = (ulint) ((ratio - .5) * 10000);
 		}
+
+		/* innodb_max_purge_lag_delay > 0 caps the delay */
+		if (srv_max_purge_lag_delay > 0
+		    && srv_dml_needed_delay > srv_max_purge_lag_delay) {
+			srv_dml_needed_delay = srv_max_purge_lag_delay;
+		}
 	}
 
 	purge_sys->view = read_view_oldest_copy_or_open_new(ut_dulint_zero,
@@ -1079,14 +1254,23 @@ trx_purge(void)
 
 	purge_sys->state = TRX_PURGE_ON;
 
-	/* Handle at most 20 undo log pages in one purge batch */
+	/* Handle at most 20 undo log pages per purge thread in one purge
+	batch */
 
-	purge_sys->handle_limit = purge_sys->n_pages_handled + 20;
+	purge_sys->handle_limit = purge_sys->n_pages_handled
+		+ 20 * ut_max(purge_sys->n_workers, 1);
 
 	old_pages_handled = purge_sys->n_pages_handled;
 
 	mutex_exit(&(purge_sys->mutex));
 
+	if (purge_sys->n_workers > 0) {
+		trx_purge_run_workers();
+
+		return((ulint) (purge_sys->n_pages_handled
+				- old_pages_handled));
+	}
+
 	mutex_enter(&kernel_mutex);
 
 	thr = que_fork_start_command(purge_sys->query);
@@ -1119,6 +1303,158 @@ trx_purge(void)
 	return((ulint) (purge_sys->n_pages_handled - old_pages_handled));
 }
 
+/*************************************************************************
+Sleeps about a second, or less if the server is shutting down. */
+static
+void
+trx_purge_coordinator_sleep(void)
+/*=============================*/
+{
+	ulint	i;
+
+	for (i = 0; i < 10; i++) {
+		os_thread_sleep(100000);
+
+		if (srv_shutdown_state > 0) {
+
+			return;
+		}
+	}
+}
+
+/*************************************************************************
+The purge coordinator thread. It runs the purge batches, which the master
+thread runs when there are no purge threads. If there are purge worker
+threads, the coordinator hands the undo log records of a batch to them,
+the records of one table always to the same worker, and waits until they
+have purged them. In a fast shutdown the thread exits at once, in a slow
+shutdown when the history list has been purged. */
+
+os_thread_ret_t
+trx_purge_coordinator_thread(
+/*=========================*/
+			/* out: a dummy parameter */
+	void*	arg __attribute__((unused)))
+			/* in: a dummy parameter required by
+			os_thread_create */
+{
+	ulint	n_pages_purged;
+	ulint	i;
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "Purge coordinator thread starts, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif
+	mutex_enter(&kernel_mutex);
+	trx_purge_n_threads++;
+	mutex_exit(&kernel_mutex);
+
+	for (;;) {
+		if (srv_fast_shutdown && srv_shutdown_state > 0) {
+
+			break;
+		}
+
+		n_pages_purged = trx_purge();
+
+		if (n_pages_purged == 0) {
+			if (srv_shutdown_state > 0) {
+				/* In a slow shutdown we run purge to
+				completion */
+
+				break;
+			}
+
+			trx_purge_coordinator_sleep();
+		}
+	}
+
+	/* Let the workers exit */
+
+	purge_sys->workers_exit = TRUE;
+
+	for (i = 0; i < purge_sys->n_workers; i++) {
+		os_event_set(purge_sys->workers[i].event);
+	}
+
+	mutex_enter(&kernel_mutex);
+	trx_purge_n_threads--;
+	mutex_exit(&kernel_mutex);
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*************************************************************************
+A purge worker thread. It purges the undo log records which the
+coordinator has handed to it, and exits when the coordinator exits. */
+
+os_thread_ret_t
+trx_purge_worker_thread(
+/*====================*/
+			/* out: a dummy parameter */
+	void*	arg)	/* in: pointer to the index of the worker,
+			an ulint */
+{
+	trx_purge_worker_t*	worker;
+	trx_purge_rec_t*	rec;
+
+	worker = purge_sys->workers + *((ulint*) arg);
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "Purge worker thread starts, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif
+	mutex_enter(&kernel_mutex);
+	trx_purge_n_threads++;
+	mutex_exit(&kernel_mutex);
+
+	for (;;) {
+		os_event_wait(worker->event);
+		os_event_reset(worker->event);
+
+		if (worker->n_recs > 0) {
+			for (rec = worker->first; rec; rec = rec->next) {
+				row_purge_undo_rec(worker->node,
+						   rec->undo_rec,
+						   rec->roll_ptr,
+						   worker->trx);
+			}
+
+			worker->first = NULL;
+			worker->last = NULL;
+			worker->n_recs = 0;
+
+			mutex_enter(&(purge_sys->mutex));
+
+			purge_sys->n_busy--;
+
+			if (purge_sys->n_busy == 0) {
+				os_event_set(purge_sys->batch_done);
+			}
+
+			mutex_exit(&(purge_sys->mutex));
+		}
+
+		if (purge_sys->workers_exit) {
+
+			break;
+		}
+	}
+
+	mutex_enter(&kernel_mutex);
+	trx_purge_n_threads--;
+	mutex_exit(&kernel_mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /**********************************************************************
 Prints information of the purge system to stderr. */
 
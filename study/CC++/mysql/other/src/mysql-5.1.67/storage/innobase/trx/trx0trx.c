@@ -180,6 +180,7 @@ trx_create(
 
 	trx->dict_operation_lock_mode = 0;
 	trx->has_search_latch = FALSE;
+	trx->search_latch = NULL;
 	trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 
 	trx->declared_to_be_inside_innodb = FALSE;
@@ -267,7 +268,7 @@ trx_search_latch_release_if_reserved(
 	trx_t*	   trx) /* in: transaction */
 {
 	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 
 		trx->has_search_latch = FALSE;
 	}
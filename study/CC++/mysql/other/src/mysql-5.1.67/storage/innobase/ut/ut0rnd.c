@@ -7,6 +7,7 @@ Created 5/11/1994 Heikki Tuuri
 ********************************************************************/
 
 #include "ut0rnd.h"
+#include "ut0mem.h"
 
 #ifdef UNIV_NONINL
 #include "ut0rnd.ic"
@@ -76,3 +77,185 @@ next_n:		;
 
 	return(n);
 }
+
+/* The CRC-32C polynomial in the reversed bit order */
+#define UT_CRC32C_POLY	0x82F63B78UL
+
+/* Tables of the software CRC-32C: ut_crc32c_table[0] is the usual byte at a
+time table, and ut_crc32c_table[k][n] is the CRC of the byte n followed by k
+zero bytes */
+static ib_uint32_t	ut_crc32c_table[8][256];
+
+/* TRUE if ut_crc32c() uses the SSE4.2 crc32 instruction */
+ibool	ut_crc32c_sse42_enabled = FALSE;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/*****************************************************************
+Checks if the CPU supports the SSE4.2 crc32 instruction. */
+static
+ibool
+ut_crc32c_sse42_supported(void)
+/*===========================*/
+				/* out: TRUE if supported */
+{
+	ib_uint32_t	eax;
+	ib_uint32_t	ebx;
+	ib_uint32_t	ecx;
+	ib_uint32_t	edx;
+
+	asm("cpuid"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (1), "c" (0));
+
+	/* CPUID.01H:ECX.SSE42[bit 20] */
+
+	return((ecx >> 20) & 1);
+}
+
+/*****************************************************************
+Calculates CRC-32C with the SSE4.2 crc32 instruction, 8 bytes at a time
+after aligning the string pointer. */
+static
+ib_uint32_t
+ut_crc32c_sse42(
+/*============*/
+				/* out: CRC-32C checksum */
+	const byte*	buf,	/* in: string of bytes */
+	ulint		len)	/* in: length */
+{
+	ib_ulonglong	crc	= 0xFFFFFFFFUL;
+	ib_ulonglong	data;
+	ib_uint32_t	crc32;
+
+	crc32 = (ib_uint32_t) crc;
+
+	while (len > 0 && ((ulint) buf & 7)) {
+		asm("crc32b %1, %0" : "+r" (crc32) : "rm" (*buf));
+		buf++;
+		len--;
+	}
+
+	crc = crc32;
+
+	while (len >= 8) {
+		ut_memcpy(&data, buf, 8);
+		asm("crc32q %1, %0" : "+r" (crc) : "rm" (data));
+		buf += 8;
+		len -= 8;
+	}
+
+	crc32 = (ib_uint32_t) crc;
+
+	while (len > 0) {
+		asm("crc32b %1, %0" : "+r" (crc32) : "rm" (*buf));
+		buf++;
+		len--;
+	}
+
+	return(~crc32);
+}
+#endif /* __GNUC__ && __x86_64__ */
+
+/*****************************************************************
+Calculates CRC-32C with the slicing-by-8 tables. */
+static
+ib_uint32_t
+ut_crc32c_slice8(
+/*=============*/
+				/* out: CRC-32C checksum */
+	const byte*	buf,	/* in: string of bytes */
+	ulint		len)	/* in: length */
+{
+	ib_uint32_t	crc	= 0xFFFFFFFFUL;
+
+	while (len > 0 && ((ulint) buf & 7)) {
+		crc = ut_crc32c_table[0][(crc ^ *buf) & 0xFF] ^ (crc >> 8);
+		buf++;
+		len--;
+	}
+
+	while (len >= 8) {
+		crc ^= (ib_uint32_t) buf[0]
+			| ((ib_uint32_t) buf[1] << 8)
+			| ((ib_uint32_t) buf[2] << 16)
+			| ((ib_uint32_t) buf[3] << 24);
+
+		crc = ut_crc32c_table[7][crc & 0xFF]
+			^ ut_crc32c_table[6][(crc >> 8) & 0xFF]
+			^ ut_crc32c_table[5][(crc >> 16) & 0xFF]
+			^ ut_crc32c_table[4][crc >> 24]
+			^ ut_crc32c_table[3][buf[4]]
+			^ ut_crc32c_table[2][buf[5]]
+			^ ut_crc32c_table[1][buf[6]]
+			^ ut_crc32c_table[0][buf[7]];
+		buf += 8;
+		len -= 8;
+	}
+
+	while (len > 0) {
+		crc = ut_crc32c_table[0][(crc ^ *buf) & 0xFF] ^ (crc >> 8);
+		buf++;
+		len--;
+	}
+
+	return(~crc);
+}
+
+/*****************************************************************
+Initializes the tables of the software CRC-32C and checks if the CPU has
+the SSE4.2 crc32 instruction. Must be called before ut_crc32c(). */
+
+void
+ut_crc32c_init(void)
+/*================*/
+{
+	ib_uint32_t	crc;
+	ulint		i;
+	ulint		k;
+
+	for (i = 0; i < 256; i++) {
+		crc = (ib_uint32_t) i;
+
+		for (k = 0; k < 8; k++) {
+			crc = (crc & 1) ? (crc >> 1) ^ UT_CRC32C_POLY
+				: crc >> 1;
+		}
+
+		ut_crc32c_table[0][i] = crc;
+	}
+
+	for (i = 0; i < 256; i++) {
+		crc = ut_crc32c_table[0][i];
+
+		for (k = 1; k < 8; k++) {
+			crc = ut_crc32c_table[0][crc & 0xFF] ^ (crc >> 8);
+			ut_crc32c_table[k][i] = crc;
+		}
+	}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	ut_crc32c_sse42_enabled = ut_crc32c_sse42_supported();
+#endif /* __GNUC__ && __x86_64__ */
+}
+
+/*****************************************************************
+Calculates the CRC-32C (Castagnoli) checksum of a string of bytes. Uses the
+SSE4.2 crc32 instruction if the CPU has it, else a table driven algorithm
+which handles 8 bytes per step. */
+
+ib_uint32_t
+ut_crc32c(
+/*======*/
+				/* out: CRC-32C checksum */
+	const byte*	buf,	/* in: string of bytes */
+	ulint		len)	/* in: length */
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (ut_crc32c_sse42_enabled) {
+
+		return(ut_crc32c_sse42(buf, len));
+	}
+#endif /* __GNUC__ && __x86_64__ */
+
+	return(ut_crc32c_slice8(buf, len));
+}